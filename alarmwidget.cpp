@@ -0,0 +1,269 @@
+#include "alarmwidget.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QGroupBox>
+#include <QColor>
+#include <QDateTime>
+#include <QFile>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QMessageBox>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include "protocol/DeviceStatusTracker.h"
+
+namespace {
+enum RuleColumn {
+    RULE_COLUMN_NAME = 0,
+    RULE_COLUMN_CONDITION,
+    RULE_COLUMN_HOLD,
+    RULE_COLUMN_ACTION,
+    RULE_COLUMN_RAISED,
+    RULE_COLUMN_COUNT
+};
+
+enum AlarmColumn {
+    ALARM_COLUMN_RULE = 0,
+    ALARM_COLUMN_SLAVE,
+    ALARM_COLUMN_TIME,
+    ALARM_COLUMN_MISMATCH,
+    ALARM_COLUMN_COUNT
+};
+
+QString SlaveIdToString(uint32_t slaveId)
+{
+    return QString("0x%1").arg(slaveId, 8, 16, QChar('0')).toUpper();
+}
+}
+
+AlarmWidget::AlarmWidget(WhtsProtocol::RuleEngine *pRuleEngine, QWidget *parent)
+    : QWidget(parent)
+    , m_pRuleEngine(pRuleEngine)
+    , m_pPushButtonLoad(nullptr)
+    , m_pPushButtonReset(nullptr)
+    , m_pLabelRules(nullptr)
+    , m_pTableWidgetRules(nullptr)
+    , m_pTableWidgetAlarms(nullptr)
+{
+    InitializeUI();
+}
+
+void AlarmWidget::InitializeUI()
+{
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+
+    QHBoxLayout *controlLayout = new QHBoxLayout();
+    m_pPushButtonLoad = new QPushButton("加载规则", this);
+    m_pPushButtonReset = new QPushButton("清除告警", this);
+    m_pLabelRules = new QLabel("未加载告警规则", this);
+    controlLayout->addWidget(m_pPushButtonLoad);
+    controlLayout->addWidget(m_pPushButtonReset);
+    controlLayout->addWidget(m_pLabelRules, 1);
+    mainLayout->addLayout(controlLayout);
+
+    QGroupBox *rulesGroup = new QGroupBox("规则", this);
+    QVBoxLayout *rulesLayout = new QVBoxLayout(rulesGroup);
+    m_pTableWidgetRules = new QTableWidget(0, RULE_COLUMN_COUNT, this);
+    m_pTableWidgetRules->setHorizontalHeaderLabels({"名称", "条件", "持续(ms)", "动作", "触发次数"});
+    m_pTableWidgetRules->verticalHeader()->setVisible(false);
+    m_pTableWidgetRules->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_pTableWidgetRules->horizontalHeader()->setSectionResizeMode(RULE_COLUMN_CONDITION, QHeaderView::Stretch);
+    rulesLayout->addWidget(m_pTableWidgetRules);
+    mainLayout->addWidget(rulesGroup);
+
+    QGroupBox *alarmsGroup = new QGroupBox("当前告警", this);
+    QVBoxLayout *alarmsLayout = new QVBoxLayout(alarmsGroup);
+    m_pTableWidgetAlarms = new QTableWidget(0, ALARM_COLUMN_COUNT, this);
+    m_pTableWidgetAlarms->setHorizontalHeaderLabels({"规则", "从机", "告警时间", "导通不一致位数"});
+    m_pTableWidgetAlarms->verticalHeader()->setVisible(false);
+    m_pTableWidgetAlarms->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_pTableWidgetAlarms->horizontalHeader()->setSectionResizeMode(ALARM_COLUMN_RULE, QHeaderView::Stretch);
+    alarmsLayout->addWidget(m_pTableWidgetAlarms);
+    mainLayout->addWidget(alarmsGroup);
+
+    connect(m_pPushButtonLoad, &QPushButton::clicked, this, &AlarmWidget::OnLoadClicked);
+    connect(m_pPushButtonReset, &QPushButton::clicked, this, &AlarmWidget::OnResetClicked);
+}
+
+bool AlarmWidget::ParseRules(const QByteArray &json, std::vector<WhtsProtocol::RuleEngine::Rule> &rules,
+                             QString &error)
+{
+    QJsonParseError parseError;
+    QJsonDocument doc = QJsonDocument::fromJson(json, &parseError);
+    if (parseError.error != QJsonParseError::NoError || !doc.isObject()) {
+        error = QString("JSON 解析失败: %1").arg(parseError.errorString());
+        return false;
+    }
+
+    rules.clear();
+    QJsonArray array = doc.object()["rules"].toArray();
+    for (int i = 0; i < array.size(); ++i) {
+        QJsonObject object = array[i].toObject();
+        WhtsProtocol::RuleEngine::Rule rule;
+        rule.name = object["name"].toString(QString("规则 %1").arg(i + 1)).toStdString();
+        rule.slaveId = object.contains("slaveId") ? object["slaveId"].toInteger() : -1;
+        rule.holdMs = static_cast<uint32_t>(object["holdMs"].toInt());
+        rule.stop = object["stop"].toBool();
+
+        // 状态条件: {"EL1": 0, "EL2": 0} 编译为掩码和期望值
+        QJsonObject status = object["status"].toObject();
+        for (auto it = status.begin(); it != status.end(); ++it) {
+            bool found = false;
+            for (size_t bit = 0; bit < WhtsProtocol::DEVICE_STATUS_BIT_COUNT; ++bit) {
+                auto statusBit = static_cast<WhtsProtocol::DeviceStatusBit>(bit);
+                if (it.key().compare(WhtsProtocol::deviceStatusBitName(statusBit), Qt::CaseInsensitive) == 0) {
+                    uint16_t mask = WhtsProtocol::deviceStatusMask(statusBit);
+                    rule.statusMask |= mask;
+                    if (it.value().toInt()) {
+                        rule.statusValue |= mask;
+                    }
+                    found = true;
+                    break;
+                }
+            }
+            if (!found) {
+                error = QString("第 %1 条规则: 未知的状态位 \"%2\"").arg(i + 1).arg(it.key());
+                return false;
+            }
+        }
+
+        // 导通条件: 不一致位数超过阈值
+        if (object.contains("mismatchAbove")) {
+            rule.mismatchAbove = object["mismatchAbove"].toInteger();
+            QByteArray expected = QByteArray::fromHex(object["expected"].toString().toLatin1());
+            rule.expected.assign(expected.begin(), expected.end());
+        }
+
+        if (rule.statusMask == 0 && rule.mismatchAbove < 0) {
+            error = QString("第 %1 条规则没有条件").arg(i + 1);
+            return false;
+        }
+        rules.push_back(std::move(rule));
+    }
+
+    if (rules.empty()) {
+        error = "文件中没有规则";
+        return false;
+    }
+    return true;
+}
+
+QString AlarmWidget::RuleToString(const WhtsProtocol::RuleEngine::Rule &rule)
+{
+    QStringList terms;
+    for (size_t bit = 0; bit < WhtsProtocol::DEVICE_STATUS_BIT_COUNT; ++bit) {
+        auto statusBit = static_cast<WhtsProtocol::DeviceStatusBit>(bit);
+        uint16_t mask = WhtsProtocol::deviceStatusMask(statusBit);
+        if (rule.statusMask & mask) {
+            terms << QString("%1=%2").arg(WhtsProtocol::deviceStatusBitName(statusBit))
+                                     .arg((rule.statusValue & mask) ? 1 : 0);
+        }
+    }
+    if (rule.mismatchAbove >= 0) {
+        terms << QString("导通不一致 > %1 位 (%2)").arg(rule.mismatchAbove)
+                     .arg(rule.expected.empty() ? "相对首帧" : "相对期望值");
+    }
+    QString scope = rule.slaveId < 0 ? "任意从机" : SlaveIdToString(static_cast<uint32_t>(rule.slaveId));
+    return QString("%1: %2").arg(scope, terms.join(" 且 "));
+}
+
+void AlarmWidget::OnLoadClicked()
+{
+    QString fileName = QFileDialog::getOpenFileName(this, "加载告警规则", m_rulesFileName, "JSON (*.json)");
+    if (fileName.isEmpty()) {
+        return;
+    }
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        QMessageBox::warning(this, "警告", QString("无法打开文件: %1").arg(fileName));
+        return;
+    }
+
+    std::vector<WhtsProtocol::RuleEngine::Rule> rules;
+    QString error;
+    if (!ParseRules(file.readAll(), rules, error)) {
+        QMessageBox::warning(this, "警告", QString("告警规则无效: %1").arg(error));
+        return;
+    }
+
+    m_rulesFileName = fileName;
+    m_pRuleEngine->setRules(std::move(rules));
+    m_pLabelRules->setText(QString("%1 条规则 (%2)").arg(m_pRuleEngine->rules().size())
+                               .arg(QFileInfo(fileName).fileName()));
+    m_pTableWidgetAlarms->setRowCount(0);
+    PopulateRules();
+}
+
+void AlarmWidget::OnResetClicked()
+{
+    // 清空从机状态，条件仍成立的规则在下一帧重新告警
+    m_pRuleEngine->reset();
+    m_pTableWidgetAlarms->setRowCount(0);
+}
+
+void AlarmWidget::PopulateRules()
+{
+    const auto &rules = m_pRuleEngine->rules();
+    m_pTableWidgetRules->setRowCount(static_cast<int>(rules.size()));
+    for (size_t i = 0; i < rules.size(); ++i) {
+        int row = static_cast<int>(i);
+        m_pTableWidgetRules->setItem(row, RULE_COLUMN_NAME, new QTableWidgetItem(QString::fromStdString(rules[i].name)));
+        m_pTableWidgetRules->setItem(row, RULE_COLUMN_CONDITION, new QTableWidgetItem(RuleToString(rules[i])));
+        m_pTableWidgetRules->setItem(row, RULE_COLUMN_HOLD, new QTableWidgetItem(QString::number(rules[i].holdMs)));
+        m_pTableWidgetRules->setItem(row, RULE_COLUMN_ACTION, new QTableWidgetItem(rules[i].stop ? "告警并停止采集" : "告警"));
+        m_pTableWidgetRules->setItem(row, RULE_COLUMN_RAISED, new QTableWidgetItem());
+        UpdateRuleRow(i);
+    }
+}
+
+void AlarmWidget::UpdateRuleRow(size_t rule)
+{
+    QTableWidgetItem *item = m_pTableWidgetRules->item(static_cast<int>(rule), RULE_COLUMN_RAISED);
+    if (item) {
+        item->setText(QString::number(m_pRuleEngine->raisedCount(rule)));
+    }
+}
+
+int AlarmWidget::FindAlarmRow(size_t rule, uint32_t slaveId) const
+{
+    for (int row = 0; row < m_pTableWidgetAlarms->rowCount(); ++row) {
+        QTableWidgetItem *item = m_pTableWidgetAlarms->item(row, ALARM_COLUMN_RULE);
+        if (item && item->data(Qt::UserRole).toULongLong() == rule &&
+            item->data(Qt::UserRole + 1).toUInt() == slaveId) {
+            return row;
+        }
+    }
+    return -1;
+}
+
+void AlarmWidget::OnAlarm(const WhtsProtocol::RuleEngine::Alarm &alarm)
+{
+    UpdateRuleRow(alarm.rule);
+
+    int row = FindAlarmRow(alarm.rule, alarm.slaveId);
+    if (!alarm.raised) {
+        if (row >= 0) {
+            m_pTableWidgetAlarms->removeRow(row);
+        }
+        return;
+    }
+    if (row >= 0) {
+        return;
+    }
+
+    row = m_pTableWidgetAlarms->rowCount();
+    m_pTableWidgetAlarms->insertRow(row);
+    QTableWidgetItem *ruleItem = new QTableWidgetItem(QString::fromStdString(m_pRuleEngine->rules()[alarm.rule].name));
+    ruleItem->setData(Qt::UserRole, QVariant::fromValue<qulonglong>(alarm.rule));
+    ruleItem->setData(Qt::UserRole + 1, alarm.slaveId);
+    ruleItem->setForeground(QColor(220, 0, 0));
+    m_pTableWidgetAlarms->setItem(row, ALARM_COLUMN_RULE, ruleItem);
+    m_pTableWidgetAlarms->setItem(row, ALARM_COLUMN_SLAVE, new QTableWidgetItem(SlaveIdToString(alarm.slaveId)));
+    m_pTableWidgetAlarms->setItem(row, ALARM_COLUMN_TIME,
+        new QTableWidgetItem(QDateTime::currentDateTime().toString("hh:mm:ss.zzz")));
+    m_pTableWidgetAlarms->setItem(row, ALARM_COLUMN_MISMATCH, new QTableWidgetItem(QString::number(alarm.mismatch)));
+}
@@ -0,0 +1,49 @@
+#ifndef ALARMWIDGET_H
+#define ALARMWIDGET_H
+
+#include <QWidget>
+#include <QTableWidget>
+#include <QPushButton>
+#include <QLabel>
+
+#include "protocol/RuleEngine.h"
+
+// 告警规则面板：从 JSON 文件加载规则到规则引擎，显示每条规则的触发次数和当前告警
+class AlarmWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    AlarmWidget(WhtsProtocol::RuleEngine *pRuleEngine, QWidget *parent = nullptr);
+
+    // 规则文件格式见 readme
+    static bool ParseRules(const QByteArray &json, std::vector<WhtsProtocol::RuleEngine::Rule> &rules,
+                           QString &error);
+    static QString RuleToString(const WhtsProtocol::RuleEngine::Rule &rule);
+
+public slots:
+    // 由 MainWindow 在规则引擎发出告警/解除时调用
+    void OnAlarm(const WhtsProtocol::RuleEngine::Alarm &alarm);
+
+private slots:
+    void OnLoadClicked();
+    void OnResetClicked();
+
+private:
+    void InitializeUI();
+    void PopulateRules();
+    void UpdateRuleRow(size_t rule);
+    int FindAlarmRow(size_t rule, uint32_t slaveId) const;
+
+private:
+    WhtsProtocol::RuleEngine *m_pRuleEngine;
+    QString m_rulesFileName;
+
+    QPushButton *m_pPushButtonLoad;
+    QPushButton *m_pPushButtonReset;
+    QLabel *m_pLabelRules;
+    QTableWidget *m_pTableWidgetRules;
+    QTableWidget *m_pTableWidgetAlarms;
+};
+
+#endif // ALARMWIDGET_H
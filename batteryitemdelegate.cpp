@@ -0,0 +1,72 @@
+#include "batteryitemdelegate.h"
+#include <QPainter>
+#include <QApplication>
+
+namespace {
+constexpr int MARGIN_HORIZONTAL = 5;
+constexpr int MARGIN_VERTICAL = 2;
+constexpr int SPACING = 5;
+constexpr int BAR_HEIGHT = 20;
+constexpr int PERCENT_WIDTH = 35;
+
+// 与原进度条控件一致：充足绿色、中等黄色、不足红色
+QColor BatteryColor(int batteryLevel)
+{
+    if (batteryLevel >= 60) {
+        return QColor("#4CAF50");
+    } else if (batteryLevel >= 30) {
+        return QColor("#FF9800");
+    }
+    return QColor("#F44336");
+}
+}
+
+BatteryItemDelegate::BatteryItemDelegate(QObject *parent)
+    : QStyledItemDelegate(parent)
+{
+}
+
+void BatteryItemDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    QVariant value = index.data(Qt::DisplayRole);
+    if (!value.isValid()) {
+        QStyledItemDelegate::paint(painter, option, index);
+        return;
+    }
+    int batteryLevel = qBound(0, value.toInt(), 100);
+
+    // 先画背景（选中、交替行颜色），不画文本
+    QStyleOptionViewItem backgroundOption(option);
+    initStyleOption(&backgroundOption, index);
+    backgroundOption.text.clear();
+    const QWidget *widget = option.widget;
+    QStyle *style = widget ? widget->style() : QApplication::style();
+    style->drawControl(QStyle::CE_ItemViewItem, &backgroundOption, painter, widget);
+
+    QRect content = option.rect.adjusted(MARGIN_HORIZONTAL, MARGIN_VERTICAL, -MARGIN_HORIZONTAL, -MARGIN_VERTICAL);
+    int barHeight = qMin(BAR_HEIGHT, content.height());
+    QRect barRect(content.left(), content.center().y() - barHeight / 2 + 1,
+                  qMax(0, content.width() - PERCENT_WIDTH - SPACING), barHeight);
+    QRect textRect(barRect.right() + SPACING, content.top(), PERCENT_WIDTH, content.height());
+
+    painter->save();
+    painter->setRenderHint(QPainter::Antialiasing, false);
+    painter->setPen(option.palette.color(QPalette::Mid));
+    painter->setBrush(option.palette.color(QPalette::Base));
+    painter->drawRect(barRect.adjusted(0, 0, -1, -1));
+    if (batteryLevel > 0) {
+        QRect chunk = barRect.adjusted(1, 1, -1, -1);
+        chunk.setWidth(chunk.width() * batteryLevel / 100);
+        painter->fillRect(chunk, BatteryColor(batteryLevel));
+    }
+    painter->setPen(option.state & QStyle::State_Selected ? option.palette.color(QPalette::HighlightedText)
+                                                          : option.palette.color(QPalette::Text));
+    painter->drawText(textRect, Qt::AlignCenter, QString("%1%").arg(batteryLevel));
+    painter->restore();
+}
+
+QSize BatteryItemDelegate::sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    QSize size = QStyledItemDelegate::sizeHint(option, index);
+    return QSize(qMax(size.width(), 150), qMax(size.height(), BAR_HEIGHT + 2 * MARGIN_VERTICAL));
+}
@@ -0,0 +1,19 @@
+#ifndef BATTERYITEMDELEGATE_H
+#define BATTERYITEMDELEGATE_H
+
+#include <QStyledItemDelegate>
+
+// 电量单元格委托：按 DisplayRole 中 0-100 的电量直接绘制进度条和百分比，
+// 不为每行创建控件
+class BatteryItemDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+
+public:
+    explicit BatteryItemDelegate(QObject *parent = nullptr);
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+    QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+};
+
+#endif // BATTERYITEMDELEGATE_H
@@ -0,0 +1,283 @@
+#include "channelsweeper.h"
+#include "protocol/messages/Backend2Master.h"
+#include <algorithm>
+
+namespace {
+// 帧速率相差在该比例以内视为相同，再比较丢包和 RTT
+constexpr double THROUGHPUT_TIE_RATIO = 0.05;
+}
+
+double ChannelSweeper::ChannelResult::LossRatio() const
+{
+    return pingSent ? 1.0 - static_cast<double>(pingSucceeded) / static_cast<double>(pingSent) : 1.0;
+}
+
+ChannelSweeper::ChannelSweeper(PingEngine *pPingEngine, CommandEngine *pCommandEngine, QObject *parent)
+    : QObject(parent)
+    , m_pPingEngine(pPingEngine)
+    , m_pCommandEngine(pCommandEngine)
+    , m_phase(Phase::Idle)
+    , m_pPhaseTimer(new QTimer(this))
+    , m_bPingDone(false)
+    , m_bMinTimeElapsed(false)
+    , m_conductionFrames(0)
+    , m_switchToken(0)
+    , m_currentChannel(0)
+    , m_originalChannel(0)
+{
+    m_pPhaseTimer->setSingleShot(true);
+    connect(m_pPhaseTimer, &QTimer::timeout, this, &ChannelSweeper::OnPhaseTimeout);
+    connect(m_pPingEngine, &PingEngine::Finished, this, &ChannelSweeper::OnPingFinished);
+    connect(m_pPingEngine, &PingEngine::RunMeasured, this, &ChannelSweeper::OnRunMeasured);
+}
+
+bool ChannelSweeper::Start(const std::vector<uint32_t> &slaveIds, const Config &config)
+{
+    if (IsRunning() || slaveIds.empty() || m_pPingEngine->IsRunning()) {
+        return false;
+    }
+    if (config.firstChannel < MIN_CHANNEL || config.lastChannel > MAX_CHANNEL ||
+        config.firstChannel > config.lastChannel) {
+        return false;
+    }
+
+    m_config = config;
+    m_slaveIds = slaveIds;
+    m_results.clear();
+    m_results.reserve(config.lastChannel - config.firstChannel + 1);
+    m_originalChannel = m_currentChannel;
+    BeginChannel();
+    return true;
+}
+
+void ChannelSweeper::Stop()
+{
+    if (!IsRunning()) {
+        return;
+    }
+    // 先退出测量阶段，避免 Ping 引擎的 Finished 信号触发下一个信道
+    Phase phase = m_phase;
+    m_phase = Phase::Idle;
+    if (phase == Phase::Measuring) {
+        m_pPingEngine->Stop();
+    }
+    Finish(false);
+}
+
+void ChannelSweeper::SwitchTo(uint8_t channel)
+{
+    auto setChannel = std::make_shared<WhtsProtocol::Backend2Master::SetUwbChannelMessage>();
+    setChannel->channel = channel;
+    CommandEngine::Options options;
+    options.timeoutMs = m_config.responseTimeoutMs;
+    options.retries = 0;
+    uint64_t token = ++m_switchToken;
+    m_pCommandEngine->Send(setChannel, options).then(this, [this, token](const CommandResult &result) {
+        if (token == m_switchToken) {
+            OnSwitchResult(result);
+        }
+    });
+}
+
+void ChannelSweeper::OnSwitchResult(const CommandResult &result)
+{
+    if (m_phase != Phase::Switching && m_phase != Phase::Finishing) {
+        return;
+    }
+
+    if (result.status == CommandResult::Status::SendFailed || result.status == CommandResult::Status::Cancelled) {
+        emit StatusChanged("发送信道切换失败，扫描中止");
+        Finish(false);
+        return;
+    }
+
+    auto response = std::dynamic_pointer_cast<const WhtsProtocol::Master2Backend::SetUwbChannelResponseMessage>(
+        result.response);
+    if (m_phase == Phase::Finishing) {
+        if (!response) {
+            emit StatusChanged("最终信道切换未确认");
+        }
+        Finish(true);
+        return;
+    }
+
+    if (response && response->status == 0) {
+        m_results.back().switched = true;
+        m_phase = Phase::Settling;
+        m_pPhaseTimer->start(m_config.settleMs);
+    } else {
+        // 未收到切换响应或主机拒绝该信道，该信道视为不可用
+        CompleteMeasure();
+    }
+}
+
+void ChannelSweeper::BeginChannel()
+{
+    ChannelResult result;
+    result.channel = static_cast<uint8_t>(m_config.firstChannel + m_results.size());
+    m_results.push_back(result);
+
+    m_phase = Phase::Switching;
+    emit StatusChanged(QString("切换到信道 %1").arg(result.channel));
+    SwitchTo(result.channel);
+}
+
+void ChannelSweeper::BeginMeasure()
+{
+    m_phase = Phase::Measuring;
+    m_conductionFrames = 0;
+    m_bMinTimeElapsed = false;
+    m_measureTimer.start();
+    m_pPhaseTimer->start(m_config.minMeasureMs);
+
+    emit StatusChanged(QString("测量信道 %1").arg(m_results.back().channel));
+    // Ping 启动失败时只统计导通帧速率
+    m_bPingDone = !m_pPingEngine->Start(m_slaveIds, m_config.ping);
+}
+
+void ChannelSweeper::TryCompleteMeasure()
+{
+    if (m_phase == Phase::Measuring && m_bPingDone && m_bMinTimeElapsed) {
+        CompleteMeasure();
+    }
+}
+
+void ChannelSweeper::CompleteMeasure()
+{
+    ChannelResult &result = m_results.back();
+    if (result.switched) {
+        double seconds = m_measureTimer.elapsed() / 1000.0;
+        result.framesPerSecond = seconds > 0 ? m_conductionFrames / seconds : 0;
+    }
+    emit ChannelMeasured(static_cast<int>(m_results.size() - 1));
+
+    if (m_config.firstChannel + m_results.size() <= m_config.lastChannel) {
+        BeginChannel();
+        return;
+    }
+
+    // 全部信道测完，切换到最佳信道或恢复原信道
+    int best = BestIndex();
+    uint8_t target = (m_config.applyBest && best >= 0) ? m_results[best].channel : m_originalChannel;
+    if (target == 0 || target == m_currentChannel) {
+        Finish(true);
+        return;
+    }
+
+    m_phase = Phase::Finishing;
+    emit StatusChanged(QString("切换到信道 %1").arg(target));
+    SwitchTo(target);
+}
+
+void ChannelSweeper::Finish(bool completed)
+{
+    ++m_switchToken;
+    m_pPhaseTimer->stop();
+    m_phase = Phase::Idle;
+
+    int best = BestIndex();
+    uint8_t bestChannel = best >= 0 ? m_results[best].channel : 0;
+    if (completed) {
+        emit StatusChanged(bestChannel ? QString("扫描完成，推荐信道 %1，当前信道 %2").arg(bestChannel).arg(m_currentChannel)
+                                       : QString("扫描完成，没有可用信道"));
+    } else {
+        emit StatusChanged("扫描已停止");
+    }
+    emit Finished(completed, bestChannel);
+}
+
+void ChannelSweeper::OnSetChannelResponse(const WhtsProtocol::Master2Backend::SetUwbChannelResponseMessage &message)
+{
+    // 切换流程由命令结果驱动，这里只跟踪主机确认的信道（含测试序列等其他来源的切换）
+    if (message.status == 0) {
+        m_currentChannel = message.channel;
+    }
+}
+
+void ChannelSweeper::OnConductionFrame(uint32_t samples)
+{
+    if (m_phase == Phase::Measuring) {
+        m_conductionFrames += samples;
+    }
+}
+
+void ChannelSweeper::OnPhaseTimeout()
+{
+    switch (m_phase) {
+    case Phase::Settling:
+        BeginMeasure();
+        break;
+    case Phase::Measuring:
+        m_bMinTimeElapsed = true;
+        TryCompleteMeasure();
+        break;
+    default:
+        break;
+    }
+}
+
+void ChannelSweeper::OnPingFinished()
+{
+    if (m_phase == Phase::Measuring) {
+        m_bPingDone = true;
+        TryCompleteMeasure();
+    }
+}
+
+void ChannelSweeper::OnRunMeasured(uint32_t slaveId, quint16 sent, quint16 succeeded, quint64 rttNs)
+{
+    Q_UNUSED(slaveId)
+    if (m_phase != Phase::Measuring) {
+        return;
+    }
+    ChannelResult &result = m_results.back();
+    result.pingSent += sent;
+    result.pingSucceeded += succeeded;
+    if (succeeded > 0) {
+        result.rttNs.record(rttNs);
+    }
+}
+
+int ChannelSweeper::BestIndex() const
+{
+    bool haveThroughput = false;
+    for (const auto &result : m_results) {
+        if (result.switched && result.framesPerSecond > 0) {
+            haveThroughput = true;
+            break;
+        }
+    }
+
+    int best = -1;
+    for (int i = 0; i < static_cast<int>(m_results.size()); ++i) {
+        const ChannelResult &candidate = m_results[i];
+        if (!candidate.switched || (m_phase == Phase::Measuring && i == static_cast<int>(m_results.size()) - 1)) {
+            continue;
+        }
+        if (best < 0) {
+            best = i;
+            continue;
+        }
+
+        const ChannelResult &current = m_results[best];
+        if (haveThroughput) {
+            // 主要看导通帧速率
+            double higher = std::max(candidate.framesPerSecond, current.framesPerSecond);
+            double diff = candidate.framesPerSecond - current.framesPerSecond;
+            if (diff > higher * THROUGHPUT_TIE_RATIO) {
+                best = i;
+                continue;
+            }
+            if (-diff > higher * THROUGHPUT_TIE_RATIO) {
+                continue;
+            }
+        }
+        // 速率相当（或没有数据流）时比较丢包，再比较 RTT 中位数
+        if (candidate.LossRatio() < current.LossRatio() ||
+            (candidate.LossRatio() == current.LossRatio() &&
+             candidate.rttNs.percentile(50.0) < current.rttNs.percentile(50.0))) {
+            best = i;
+        }
+    }
+    return best;
+}
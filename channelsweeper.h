@@ -0,0 +1,111 @@
+#ifndef CHANNELSWEEPER_H
+#define CHANNELSWEEPER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <cstdint>
+#include <vector>
+
+#include "commandengine.h"
+#include "pingengine.h"
+#include "protocol/messages/Master2Backend.h"
+#include "protocol/utils/LatencyHistogram.h"
+
+// UWB 信道扫描：依次切换信道，在每个信道上测量导通数据帧速率、Ping 丢包和 RTT，
+// 最后推荐（或直接切换到）吞吐最高的信道。信道切换经 CommandEngine 发送并等待应答
+class ChannelSweeper : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr uint8_t MIN_CHANNEL = 5;
+    static constexpr uint8_t MAX_CHANNEL = 10;
+
+    struct Config {
+        uint8_t firstChannel = MIN_CHANNEL;
+        uint8_t lastChannel = MAX_CHANNEL;
+        int settleMs = 1000;             // 切换后等待从机跟随的时间
+        int minMeasureMs = 5000;         // 每个信道的最短测量时间
+        int responseTimeoutMs = 2000;    // 等待 SetUwbChannelResponse 的时间
+        bool applyBest = true;           // 结束后切换到最佳信道，否则恢复原信道
+        PingEngine::Config ping;         // 每个信道上的 Ping 参数（rounds 通常为 1）
+    };
+
+    struct ChannelResult {
+        uint8_t channel = 0;
+        bool switched = false;           // 主机确认已切换
+        double framesPerSecond = 0;      // 导通数据帧速率
+        uint64_t pingSent = 0;
+        uint64_t pingSucceeded = 0;
+        WhtsProtocol::LatencyHistogram rttNs;
+
+        double LossRatio() const;
+    };
+
+    ChannelSweeper(PingEngine *pPingEngine, CommandEngine *pCommandEngine, QObject *parent = nullptr);
+
+    bool Start(const std::vector<uint32_t> &slaveIds, const Config &config);
+    void Stop();
+    bool IsRunning() const { return m_phase != Phase::Idle; }
+
+    // 由 MainWindow 在收到任意 SetUwbChannelResponse 时调用，只记录当前信道
+    void OnSetChannelResponse(const WhtsProtocol::Master2Backend::SetUwbChannelResponseMessage &message);
+    // 批量数据帧按采样数计入
+    void OnConductionFrame(uint32_t samples = 1);
+
+    const std::vector<ChannelResult> &Results() const { return m_results; }
+    // 最佳信道在 Results() 中的下标，没有可用信道时为 -1
+    int BestIndex() const;
+    // 最近一次主机确认的信道，未知时为 0
+    uint8_t CurrentChannel() const { return m_currentChannel; }
+
+signals:
+    void ChannelMeasured(int index);
+    void StatusChanged(const QString &status);
+    // bestChannel 为 0 表示没有可用信道
+    void Finished(bool completed, uint8_t bestChannel);
+
+private slots:
+    void OnPhaseTimeout();
+    void OnPingFinished();
+    void OnRunMeasured(uint32_t slaveId, quint16 sent, quint16 succeeded, quint64 rttNs);
+
+private:
+    enum class Phase {
+        Idle,
+        Switching,    // 已发送 SetUwbChannel，等待响应
+        Settling,     // 等待从机跟随
+        Measuring,    // Ping + 统计导通帧
+        Finishing     // 切换到最终信道
+    };
+
+    void SwitchTo(uint8_t channel);
+    void OnSwitchResult(const CommandResult &result);
+    void BeginChannel();
+    void BeginMeasure();
+    void TryCompleteMeasure();
+    void CompleteMeasure();
+    void Finish(bool completed);
+
+private:
+    PingEngine *m_pPingEngine;
+    CommandEngine *m_pCommandEngine;
+    Config m_config;
+    std::vector<uint32_t> m_slaveIds;
+
+    Phase m_phase;
+    QTimer *m_pPhaseTimer;
+    QElapsedTimer m_measureTimer;
+    bool m_bPingDone;
+    bool m_bMinTimeElapsed;
+    uint64_t m_conductionFrames;
+
+    // 每次切换递增，丢弃已停止扫描迟到的命令结果
+    uint64_t m_switchToken;
+    uint8_t m_currentChannel;
+    uint8_t m_originalChannel;     // 扫描开始前的信道，用于不应用时恢复
+    std::vector<ChannelResult> m_results;
+};
+
+#endif // CHANNELSWEEPER_H
@@ -0,0 +1,218 @@
+#include "clipwidget.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QGroupBox>
+#include <QColor>
+
+#include "latencytracker.h"
+
+namespace {
+// 刷新周期（毫秒），同时决定事件队列被取出的频率
+constexpr int CLIP_REFRESH_INTERVAL_MS = 200;
+// 插拔记录表最多保留的行数
+constexpr int MAX_TRANSITION_ROWS = 500;
+
+enum StationColumn {
+    STATION_COLUMN_SLAVE = 0,
+    STATION_COLUMN_MODE,
+    STATION_COLUMN_EXPECTED,
+    STATION_COLUMN_CURRENT,
+    STATION_COLUMN_MISSING,
+    STATION_COLUMN_UNEXPECTED,
+    STATION_COLUMN_RESULT,
+    STATION_COLUMN_COMPLETE_MS,
+    STATION_COLUMN_INSERTS,
+    STATION_COLUMN_REMOVES,
+    STATION_COLUMN_TOTAL
+};
+
+enum TransitionColumn {
+    TRANSITION_COLUMN_SLAVE = 0,
+    TRANSITION_COLUMN_CLIP,
+    TRANSITION_COLUMN_ACTION,
+    TRANSITION_COLUMN_MONITORED,
+    TRANSITION_COLUMN_SINCE_START,
+    TRANSITION_COLUMN_PREVIOUS,
+    TRANSITION_COLUMN_TOTAL
+};
+
+QString SlaveIdToString(uint32_t slaveId)
+{
+    return QString("0x%1").arg(slaveId, 8, 16, QChar('0')).toUpper();
+}
+
+// 位图显示为卡钉序号列表，如 "0,1,5"
+QString ClipsToString(uint16_t clips)
+{
+    QStringList list;
+    for (size_t clip = 0; clip < WhtsProtocol::ClipTracker::CLIP_COUNT; ++clip) {
+        if (clips & (1u << clip)) {
+            list << QString::number(clip);
+        }
+    }
+    return list.isEmpty() ? QString("-") : list.join(",");
+}
+
+void SetCell(QTableWidget *table, int row, int column, const QString &text)
+{
+    QTableWidgetItem *item = table->item(row, column);
+    if (!item) {
+        item = new QTableWidgetItem();
+        table->setItem(row, column, item);
+    }
+    item->setText(text);
+}
+}
+
+ClipWidget::ClipWidget(WhtsProtocol::ClipTracker *pClipTracker, QWidget *parent)
+    : QWidget(parent)
+    , m_pClipTracker(pClipTracker)
+    , m_pPushButtonRestart(nullptr)
+    , m_pLabelSummary(nullptr)
+    , m_pTableWidgetStations(nullptr)
+    , m_pTableWidgetTransitions(nullptr)
+    , m_pRefreshTimer(nullptr)
+{
+    InitializeUI();
+
+    m_pRefreshTimer = new QTimer(this);
+    connect(m_pRefreshTimer, &QTimer::timeout, this, &ClipWidget::OnRefreshTimeout);
+    m_pRefreshTimer->start(CLIP_REFRESH_INTERVAL_MS);
+}
+
+void ClipWidget::InitializeUI()
+{
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+
+    QHBoxLayout *controlLayout = new QHBoxLayout();
+    m_pPushButtonRestart = new QPushButton("重新计时", this);
+    controlLayout->addWidget(m_pPushButtonRestart);
+    m_pLabelSummary = new QLabel(this);
+    controlLayout->addWidget(m_pLabelSummary, 1);
+    mainLayout->addLayout(controlLayout);
+
+    QGroupBox *stationsGroup = new QGroupBox("工位结果", this);
+    QVBoxLayout *stationsLayout = new QVBoxLayout(stationsGroup);
+    m_pTableWidgetStations = new QTableWidget(0, STATION_COLUMN_TOTAL, this);
+    m_pTableWidgetStations->setHorizontalHeaderLabels(
+        {"从机", "模式", "检测卡钉", "已插入", "缺少", "多余", "结果", "完成耗时(ms)", "插入次数", "拔出次数"});
+    m_pTableWidgetStations->verticalHeader()->setVisible(false);
+    m_pTableWidgetStations->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_pTableWidgetStations->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    stationsLayout->addWidget(m_pTableWidgetStations);
+    mainLayout->addWidget(stationsGroup);
+
+    QGroupBox *transitionsGroup = new QGroupBox("插拔记录（最新在上）", this);
+    QVBoxLayout *transitionsLayout = new QVBoxLayout(transitionsGroup);
+    m_pTableWidgetTransitions = new QTableWidget(0, TRANSITION_COLUMN_TOTAL, this);
+    m_pTableWidgetTransitions->setHorizontalHeaderLabels(
+        {"从机", "卡钉", "动作", "检测范围", "工位计时(ms)", "前一状态持续(ms)"});
+    m_pTableWidgetTransitions->verticalHeader()->setVisible(false);
+    m_pTableWidgetTransitions->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_pTableWidgetTransitions->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    transitionsLayout->addWidget(m_pTableWidgetTransitions);
+    mainLayout->addWidget(transitionsGroup);
+
+    connect(m_pPushButtonRestart, &QPushButton::clicked, this, &ClipWidget::OnRestartClicked);
+}
+
+void ClipWidget::OnRefreshTimeout()
+{
+    // 面板不可见时也取出事件，避免队列溢出丢失记录
+    m_transitions.clear();
+    m_pClipTracker->takeTransitions(m_transitions);
+    AppendTransitions(m_transitions);
+    UpdateStationTable();
+}
+
+void ClipWidget::AppendTransitions(const std::vector<WhtsProtocol::ClipTransition> &transitions)
+{
+    if (transitions.empty()) {
+        return;
+    }
+
+    // 一次到达的事件超过表格容量时只显示最新的部分
+    size_t first = transitions.size() > MAX_TRANSITION_ROWS ? transitions.size() - MAX_TRANSITION_ROWS : 0;
+    for (size_t i = first; i < transitions.size(); ++i) {
+        const WhtsProtocol::ClipTransition &transition = transitions[i];
+        m_pTableWidgetTransitions->insertRow(0);
+        SetCell(m_pTableWidgetTransitions, 0, TRANSITION_COLUMN_SLAVE, SlaveIdToString(transition.slaveId));
+        SetCell(m_pTableWidgetTransitions, 0, TRANSITION_COLUMN_CLIP, QString::number(transition.clip));
+        SetCell(m_pTableWidgetTransitions, 0, TRANSITION_COLUMN_ACTION, transition.inserted ? "插入" : "拔出");
+        SetCell(m_pTableWidgetTransitions, 0, TRANSITION_COLUMN_MONITORED, transition.monitored ? "是" : "否");
+        SetCell(m_pTableWidgetTransitions, 0, TRANSITION_COLUMN_SINCE_START, QString::number(transition.sinceStartMs));
+        SetCell(m_pTableWidgetTransitions, 0, TRANSITION_COLUMN_PREVIOUS, QString::number(transition.previousMs));
+        if (!transition.monitored) {
+            m_pTableWidgetTransitions->item(0, TRANSITION_COLUMN_MONITORED)->setForeground(QColor(220, 140, 0));
+        }
+    }
+    if (m_pTableWidgetTransitions->rowCount() > MAX_TRANSITION_ROWS) {
+        m_pTableWidgetTransitions->setRowCount(MAX_TRANSITION_ROWS);
+    }
+}
+
+void ClipWidget::UpdateStationTable()
+{
+    const auto stations = m_pClipTracker->stations();
+    int completed = 0;
+    for (const WhtsProtocol::ClipStationResult &station : stations) {
+        if (station.complete) {
+            ++completed;
+        }
+        // 每次开始计时后每个工位只通知一次（重新下发配置时工位重新计时）
+        if (!station.reachedComplete) {
+            m_completedStations.remove(station.slaveId);
+        } else if (!m_completedStations.contains(station.slaveId)) {
+            m_completedStations.insert(station.slaveId);
+            emit StationCompleted(station.slaveId, station.completeMs);
+        }
+    }
+    m_pLabelSummary->setText(QString("工位 %1，全部插入 %2，丢弃事件 %3")
+                                 .arg(stations.size()).arg(completed)
+                                 .arg(m_pClipTracker->droppedTransitions()));
+
+    if (!isVisible()) {
+        return;
+    }
+
+    m_pTableWidgetStations->setRowCount(static_cast<int>(stations.size()));
+    for (int row = 0; row < static_cast<int>(stations.size()); ++row) {
+        const WhtsProtocol::ClipStationResult &station = stations[row];
+        SetCell(m_pTableWidgetStations, row, STATION_COLUMN_SLAVE, SlaveIdToString(station.slaveId));
+        SetCell(m_pTableWidgetStations, row, STATION_COLUMN_MODE,
+                station.configured ? QString::number(station.clipMode) : QString("-"));
+        SetCell(m_pTableWidgetStations, row, STATION_COLUMN_EXPECTED,
+                station.configured ? ClipsToString(station.expected) : QString("未配置"));
+        SetCell(m_pTableWidgetStations, row, STATION_COLUMN_CURRENT, ClipsToString(station.current));
+        SetCell(m_pTableWidgetStations, row, STATION_COLUMN_MISSING, ClipsToString(station.missing));
+        SetCell(m_pTableWidgetStations, row, STATION_COLUMN_UNEXPECTED, ClipsToString(station.unexpected));
+
+        QString result;
+        QColor color;
+        if (!station.configured) {
+            result = "-";
+        } else if (station.complete) {
+            result = station.unexpected ? "完成（有多余卡钉）" : "完成";
+            color = station.unexpected ? QColor(220, 140, 0) : QColor(0, 160, 0);
+        } else {
+            result = "未完成";
+            color = QColor(220, 0, 0);
+        }
+        SetCell(m_pTableWidgetStations, row, STATION_COLUMN_RESULT, result);
+        m_pTableWidgetStations->item(row, STATION_COLUMN_RESULT)->setForeground(
+            color.isValid() ? QBrush(color) : QBrush());
+        SetCell(m_pTableWidgetStations, row, STATION_COLUMN_COMPLETE_MS,
+                station.reachedComplete ? QString::number(station.completeMs) : QString("-"));
+        SetCell(m_pTableWidgetStations, row, STATION_COLUMN_INSERTS, QString::number(station.inserts));
+        SetCell(m_pTableWidgetStations, row, STATION_COLUMN_REMOVES, QString::number(station.removes));
+    }
+}
+
+void ClipWidget::OnRestartClicked()
+{
+    m_pClipTracker->restart(LatencyTracker::NowNs() / 1000000);
+    m_completedStations.clear();
+    m_pTableWidgetTransitions->setRowCount(0);
+    UpdateStationTable();
+}
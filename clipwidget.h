@@ -0,0 +1,46 @@
+#ifndef CLIPWIDGET_H
+#define CLIPWIDGET_H
+
+#include <QWidget>
+#include <QTableWidget>
+#include <QPushButton>
+#include <QLabel>
+#include <QTimer>
+#include <QSet>
+
+#include "protocol/ClipTracker.h"
+
+// 卡钉检测面板：定时取出卡钉插拔事件，显示每个工位的检测结果和最近的插拔记录
+class ClipWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    ClipWidget(WhtsProtocol::ClipTracker *pClipTracker, QWidget *parent = nullptr);
+
+signals:
+    // 工位检测卡钉全部插入（每次开始计时后只发出一次）
+    void StationCompleted(uint32_t slaveId, quint64 elapsedMs);
+
+private slots:
+    void OnRefreshTimeout();
+    void OnRestartClicked();
+
+private:
+    void InitializeUI();
+    void AppendTransitions(const std::vector<WhtsProtocol::ClipTransition> &transitions);
+    void UpdateStationTable();
+
+private:
+    WhtsProtocol::ClipTracker *m_pClipTracker;
+    std::vector<WhtsProtocol::ClipTransition> m_transitions;
+    QSet<uint32_t> m_completedStations;
+
+    QPushButton *m_pPushButtonRestart;
+    QLabel *m_pLabelSummary;
+    QTableWidget *m_pTableWidgetStations;
+    QTableWidget *m_pTableWidgetTransitions;
+    QTimer *m_pRefreshTimer;
+};
+
+#endif // CLIPWIDGET_H
@@ -0,0 +1,390 @@
+#include "commandengine.h"
+#include "latencytracker.h"
+#include "protocol/Common.h"
+#include "protocol/messages/Backend2Master.h"
+#include "protocol/messages/Master2Backend.h"
+
+#include <algorithm>
+#include <vector>
+
+CommandEngine::CommandEngine(QObject *parent)
+    : QObject(parent)
+    , m_pTimeoutTimer(new QTimer(this))
+    , m_maxOutstanding(4)
+    , m_outstanding(0)
+{
+    m_pTimeoutTimer->setSingleShot(true);
+    connect(m_pTimeoutTimer, &QTimer::timeout, this, &CommandEngine::OnTimeout);
+}
+
+CommandEngine::~CommandEngine()
+{
+    CancelAll();
+}
+
+void CommandEngine::SetMaxOutstanding(size_t maxOutstanding)
+{
+    m_maxOutstanding = std::max<size_t>(1, maxOutstanding);
+    Pump();
+}
+
+int CommandEngine::ResponseIdFor(uint8_t requestMessageId)
+{
+    using WhtsProtocol::Backend2MasterMessageId;
+    using WhtsProtocol::Master2BackendMessageId;
+    switch (static_cast<Backend2MasterMessageId>(requestMessageId)) {
+    case Backend2MasterMessageId::SLAVE_CFG_MSG:
+        return static_cast<int>(Master2BackendMessageId::SLAVE_CFG_RSP_MSG);
+    case Backend2MasterMessageId::MODE_CFG_MSG:
+        return static_cast<int>(Master2BackendMessageId::MODE_CFG_RSP_MSG);
+    case Backend2MasterMessageId::SLAVE_RST_MSG:
+        return static_cast<int>(Master2BackendMessageId::RST_RSP_MSG);
+    case Backend2MasterMessageId::CTRL_MSG:
+        return static_cast<int>(Master2BackendMessageId::CTRL_RSP_MSG);
+    case Backend2MasterMessageId::INTERVAL_CFG_MSG:
+        return static_cast<int>(Master2BackendMessageId::INTERVAL_CFG_RSP_MSG);
+    case Backend2MasterMessageId::PING_CTRL_MSG:
+        return static_cast<int>(Master2BackendMessageId::PING_RES_MSG);
+    case Backend2MasterMessageId::DEVICE_LIST_REQ_MSG:
+        return static_cast<int>(Master2BackendMessageId::DEVICE_LIST_RSP_MSG);
+    case Backend2MasterMessageId::SET_UWB_CHAN_MSG:
+        return static_cast<int>(Master2BackendMessageId::SET_UWB_CHAN_RSP_MSG);
+    default:
+        // 清除设备列表等命令主机不应答
+        return -1;
+    }
+}
+
+bool CommandEngine::IsUrgent(const WhtsProtocol::Message &request)
+{
+    using WhtsProtocol::Backend2MasterMessageId;
+    switch (static_cast<Backend2MasterMessageId>(request.getMessageId())) {
+    case Backend2MasterMessageId::SLAVE_RST_MSG:
+        return true;
+    case Backend2MasterMessageId::CTRL_MSG: {
+        auto ctrl = dynamic_cast<const WhtsProtocol::Backend2Master::CtrlMessage *>(&request);
+        return ctrl && ctrl->runningStatus == 0;
+    }
+    default:
+        return false;
+    }
+}
+
+bool CommandEngine::IsResponseVerifiable(uint8_t requestMessageId)
+{
+    using WhtsProtocol::Backend2MasterMessageId;
+    switch (static_cast<Backend2MasterMessageId>(requestMessageId)) {
+    case Backend2MasterMessageId::CTRL_MSG:
+    case Backend2MasterMessageId::INTERVAL_CFG_MSG:
+    case Backend2MasterMessageId::SET_UWB_CHAN_MSG:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool CommandEngine::ResponseMatches(const WhtsProtocol::Message &request, const WhtsProtocol::Message &response)
+{
+    using namespace WhtsProtocol;
+    if (auto ctrl = dynamic_cast<const Backend2Master::CtrlMessage *>(&request)) {
+        auto ctrlResponse = dynamic_cast<const Master2Backend::CtrlResponseMessage *>(&response);
+        return ctrlResponse && ctrlResponse->runningStatus == ctrl->runningStatus;
+    }
+    if (auto interval = dynamic_cast<const Backend2Master::IntervalConfigMessage *>(&request)) {
+        auto intervalResponse = dynamic_cast<const Master2Backend::IntervalConfigResponseMessage *>(&response);
+        return intervalResponse && intervalResponse->intervalMs == interval->intervalMs;
+    }
+    if (auto channel = dynamic_cast<const Backend2Master::SetUwbChannelMessage *>(&request)) {
+        auto channelResponse = dynamic_cast<const Master2Backend::SetUwbChannelResponseMessage *>(&response);
+        return channelResponse && channelResponse->channel == channel->channel;
+    }
+    return true;
+}
+
+QFuture<CommandResult> CommandEngine::Send(std::shared_ptr<const WhtsProtocol::Message> request)
+{
+    return Send(std::move(request), Options());
+}
+
+QFuture<CommandResult> CommandEngine::Send(std::shared_ptr<const WhtsProtocol::Message> request,
+                                           const Options &options, const QObject *pOwner)
+{
+    auto pending = std::make_unique<Pending>();
+    pending->request = std::move(request);
+    pending->options = options;
+    pending->owner = pOwner;
+    pending->promise.start();
+    QFuture<CommandResult> future = pending->promise.future();
+
+    int responseId = pending->request ? ResponseIdFor(pending->request->getMessageId()) : -1;
+    if (responseId < 0) {
+        // 无应答的命令发送即完成
+        Channel immediate;
+        immediate.push_back(std::move(pending));
+        CommandResult::Status status = CommandResult::Status::Cancelled;
+        if (immediate.front()->request) {
+            ++m_outstanding;
+            status = Transmit(*immediate.front()) ? CommandResult::Status::Ok
+                                                  : CommandResult::Status::SendFailed;
+        }
+        Finish(immediate, status, nullptr, LatencyTracker::NowNs());
+        return future;
+    }
+
+    if (IsUrgent(*pending->request)) {
+        // 先发出紧急命令，再完成被取代的命令，避免结果回调里新发的命令排到它前面
+        bool sent = Transmit(*pending);
+        Supersede(static_cast<uint8_t>(responseId), std::move(pending), sent);
+        return future;
+    }
+
+    m_channels[static_cast<uint8_t>(responseId)].push_back(std::move(pending));
+    Pump();
+    return future;
+}
+
+QFuture<CommandResult> CommandEngine::Track(std::shared_ptr<const WhtsProtocol::Message> request)
+{
+    return Track(std::move(request), Options());
+}
+
+QFuture<CommandResult> CommandEngine::Track(std::shared_ptr<const WhtsProtocol::Message> request,
+                                            const Options &options)
+{
+    auto pending = std::make_unique<Pending>();
+    pending->request = std::move(request);
+    pending->options = options;
+    pending->promise.start();
+    QFuture<CommandResult> future = pending->promise.future();
+    if (!pending->request) {
+        Channel cancelled;
+        cancelled.push_back(std::move(pending));
+        Finish(cancelled, CommandResult::Status::Cancelled, nullptr, LatencyTracker::NowNs());
+        return future;
+    }
+
+    MarkSent(*pending);
+    int responseId = ResponseIdFor(pending->request->getMessageId());
+    if (responseId < 0) {
+        Channel immediate;
+        immediate.push_back(std::move(pending));
+        ++m_outstanding;
+        Finish(immediate, CommandResult::Status::Ok, nullptr, LatencyTracker::NowNs());
+        return future;
+    }
+    Supersede(static_cast<uint8_t>(responseId), std::move(pending), true);
+    return future;
+}
+
+void CommandEngine::Supersede(uint8_t responseId, std::unique_ptr<Pending> pending, bool sent)
+{
+    Channel &channel = m_channels[responseId];
+    Channel superseded = std::move(channel);
+    channel.clear();
+    channel.push_back(std::move(pending));
+    ++m_outstanding;
+    uint64_t nowNs = LatencyTracker::NowNs();
+    while (!superseded.empty()) {
+        Finish(superseded, CommandResult::Status::Cancelled, nullptr, nowNs);
+    }
+    if (!sent) {
+        Finish(channel, CommandResult::Status::SendFailed, nullptr, nowNs);
+    }
+    Pump();
+}
+
+bool CommandEngine::OnResponse(const std::shared_ptr<const WhtsProtocol::Message> &response, uint64_t arrivalNs)
+{
+    if (!response) {
+        return false;
+    }
+    auto it = m_channels.find(response->getMessageId());
+    if (it == m_channels.end() || it->second.empty() || it->second.front()->attempts == 0) {
+        // 其他模块（Ping 引擎等）直接发出的命令的应答，或已完成命令迟到的应答
+        return false;
+    }
+    if (!ResponseMatches(*it->second.front()->request, *response)) {
+        // 前一条命令重发后迟到的应答，不能完成当前命令
+        return false;
+    }
+    Finish(it->second, CommandResult::Status::Ok, response, arrivalNs);
+    Pump();
+    return true;
+}
+
+void CommandEngine::Cancel(const QObject *pOwner)
+{
+    if (!pOwner) {
+        return;
+    }
+    // 先全部摘出再完成，结果回调里可以直接发新命令
+    Channel cancelled;
+    for (auto &channel : m_channels) {
+        Channel kept;
+        for (auto &pending : channel.second) {
+            (pending->owner == pOwner ? cancelled : kept).push_back(std::move(pending));
+        }
+        channel.second = std::move(kept);
+    }
+    uint64_t nowNs = LatencyTracker::NowNs();
+    while (!cancelled.empty()) {
+        Finish(cancelled, CommandResult::Status::Cancelled, nullptr, nowNs);
+    }
+    Pump();
+}
+
+void CommandEngine::CancelAll()
+{
+    auto channels = std::move(m_channels);
+    m_channels.clear();
+    m_pTimeoutTimer->stop();
+    uint64_t nowNs = LatencyTracker::NowNs();
+    for (auto &channel : channels) {
+        while (!channel.second.empty()) {
+            Finish(channel.second, CommandResult::Status::Cancelled, nullptr, nowNs);
+        }
+    }
+    // 断开后不再等待迟到的应答
+    m_drainUntilNs.clear();
+    m_outstanding = 0;
+}
+
+size_t CommandEngine::Queued() const
+{
+    size_t queued = 0;
+    for (const auto &channel : m_channels) {
+        for (const auto &pending : channel.second) {
+            if (pending->attempts == 0) {
+                ++queued;
+            }
+        }
+    }
+    return queued;
+}
+
+void CommandEngine::OnTimeout()
+{
+    uint64_t nowNs = LatencyTracker::NowNs();
+    std::vector<uint8_t> expired;
+    for (const auto &channel : m_channels) {
+        if (!channel.second.empty() && channel.second.front()->attempts > 0 &&
+            channel.second.front()->deadlineNs <= nowNs) {
+            expired.push_back(channel.first);
+        }
+    }
+
+    for (uint8_t responseId : expired) {
+        Channel &channel = m_channels[responseId];
+        Pending &pending = *channel.front();
+        if (pending.attempts > pending.options.retries) {
+            Finish(channel, CommandResult::Status::Timeout, nullptr, nowNs);
+        } else if (!Transmit(pending)) {
+            Finish(channel, CommandResult::Status::SendFailed, nullptr, nowNs);
+        }
+    }
+    Pump();
+}
+
+void CommandEngine::Pump()
+{
+    uint64_t nowNs = LatencyTracker::NowNs();
+    for (auto &channel : m_channels) {
+        if (m_outstanding >= m_maxOutstanding) {
+            break;
+        }
+        auto drain = m_drainUntilNs.find(channel.first);
+        if (drain != m_drainUntilNs.end()) {
+            if (drain->second > nowNs) {
+                continue;
+            }
+            m_drainUntilNs.erase(drain);
+        }
+        // 同一应答类型的命令依次发送，发送失败的直接完成，继续下一条
+        while (!channel.second.empty() && channel.second.front()->attempts == 0) {
+            ++m_outstanding;
+            if (Transmit(*channel.second.front())) {
+                break;
+            }
+            Finish(channel.second, CommandResult::Status::SendFailed, nullptr, LatencyTracker::NowNs());
+            if (m_outstanding >= m_maxOutstanding) {
+                break;
+            }
+        }
+    }
+    RearmTimer();
+}
+
+void CommandEngine::MarkSent(Pending &pending)
+{
+    ++pending.attempts;
+    pending.sentNs = LatencyTracker::NowNs();
+    pending.deadlineNs = pending.sentNs + static_cast<uint64_t>(pending.options.timeoutMs) * 1000000;
+}
+
+bool CommandEngine::Transmit(Pending &pending)
+{
+    MarkSent(pending);
+    return m_sender && m_sender(*pending.request);
+}
+
+void CommandEngine::Finish(Channel &channel, CommandResult::Status status,
+                           std::shared_ptr<const WhtsProtocol::Message> response, uint64_t nowNs)
+{
+    // 先出队再完成，结果回调里可以直接发下一条命令
+    std::unique_ptr<Pending> pending = std::move(channel.front());
+    channel.pop_front();
+    if (pending->attempts > 0 && m_outstanding > 0) {
+        --m_outstanding;
+    }
+    // 重发过或未收到应答就结束的命令可能还有迟到的应答；无法核对内容时该类型等待一个超时周期
+    bool lateResponsePossible = pending->attempts > 1 ||
+                                (pending->attempts > 0 && status != CommandResult::Status::Ok);
+    if (lateResponsePossible && !IsResponseVerifiable(pending->request->getMessageId())) {
+        int responseId = ResponseIdFor(pending->request->getMessageId());
+        if (responseId >= 0) {
+            m_drainUntilNs[static_cast<uint8_t>(responseId)] =
+                LatencyTracker::NowNs() + static_cast<uint64_t>(pending->options.timeoutMs) * 1000000;
+        }
+    }
+
+    CommandResult result;
+    result.status = status;
+    result.response = std::move(response);
+    result.attempts = pending->attempts;
+    if (result.response && nowNs > pending->sentNs) {
+        result.latencyNs = nowNs - pending->sentNs;
+    }
+
+    if (status == CommandResult::Status::Timeout || status == CommandResult::Status::SendFailed) {
+        emit CommandFailed(QString::fromUtf8(pending->request->getMessageTypeName()),
+                           status == CommandResult::Status::Timeout ? QStringLiteral("应答超时")
+                                                                    : QStringLiteral("发送失败"),
+                           pending->attempts);
+    }
+    pending->promise.addResult(result);
+    pending->promise.finish();
+}
+
+void CommandEngine::RearmTimer()
+{
+    uint64_t nowNs = LatencyTracker::NowNs();
+    uint64_t earliest = UINT64_MAX;
+    for (const auto &channel : m_channels) {
+        if (!channel.second.empty() && channel.second.front()->attempts > 0) {
+            earliest = std::min(earliest, channel.second.front()->deadlineNs);
+        }
+    }
+    // 等待迟到应答结束后发送排队的命令（已到期的由 Pump 处理，受在途上限限制时不必再唤醒）
+    for (const auto &drain : m_drainUntilNs) {
+        auto channel = m_channels.find(drain.first);
+        if (drain.second > nowNs && channel != m_channels.end() && !channel->second.empty()) {
+            earliest = std::min(earliest, drain.second);
+        }
+    }
+    if (earliest == UINT64_MAX) {
+        m_pTimeoutTimer->stop();
+        return;
+    }
+    int delayMs = earliest > nowNs ? static_cast<int>((earliest - nowNs + 999999) / 1000000) : 0;
+    m_pTimeoutTimer->start(delayMs);
+}
@@ -0,0 +1,130 @@
+#ifndef COMMANDENGINE_H
+#define COMMANDENGINE_H
+
+#include <QFuture>
+#include <QObject>
+#include <QPromise>
+#include <QTimer>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+
+#include "protocol/messages/Message.h"
+
+// 命令结果；response 为匹配到的 Master2Backend 应答（超时/失败时为空）
+struct CommandResult {
+    enum class Status {
+        Ok,          // 收到匹配的应答（无应答的命令为发送成功）
+        Timeout,     // 重试用尽仍未收到应答
+        SendFailed,  // 发送器返回失败
+        Cancelled    // 断开连接等原因被取消
+    };
+
+    Status status = Status::Cancelled;
+    std::shared_ptr<const WhtsProtocol::Message> response;
+    int attempts = 0;        // 实际发送次数
+    uint64_t latencyNs = 0;  // 最后一次发送到收到应答
+
+    bool Ok() const { return status == Status::Ok; }
+};
+
+// 命令层：下发 Backend2Master 命令并返回 QFuture，由匹配的 Master2Backend 应答完成。
+// 协议里没有请求 ID，应答按消息类型匹配：同一应答类型同时只有一条命令在途，其余按顺序排队；
+// 应答回显了请求字段（控制、采集间隔、UWB 信道）时核对内容，否则重发过的命令完成后该类型
+// 暂停一个超时周期，丢弃迟到的应答。不同类型的命令可同时在途，最多 maxOutstanding 条。
+// 每条命令单独超时重试，排队时不计时。停止采集和复位是紧急命令，不排队也不受上限限制
+class CommandEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    using Sender = std::function<bool(const WhtsProtocol::Message &)>;
+
+    struct Options {
+        int timeoutMs = 1000;   // 每次发送等待应答的时间
+        int retries = 2;        // 超时后的重发次数
+    };
+
+    explicit CommandEngine(QObject *parent = nullptr);
+    ~CommandEngine() override;
+
+    void SetSender(const Sender &sender) { m_sender = sender; }
+    // 同时在途（已发送未应答）的命令上限
+    void SetMaxOutstanding(size_t maxOutstanding);
+
+    QFuture<CommandResult> Send(std::shared_ptr<const WhtsProtocol::Message> request);
+    // pOwner 用于按发起方取消（Cancel），可为空
+    QFuture<CommandResult> Send(std::shared_ptr<const WhtsProtocol::Message> request, const Options &options,
+                                const QObject *pOwner = nullptr);
+    // 调用方已直接发出的紧急命令（停止采集、复位）：只登记等待应答，超时后经发送器重发，
+    // 同样取代同一应答类型中排队和在途的命令
+    QFuture<CommandResult> Track(std::shared_ptr<const WhtsProtocol::Message> request);
+    QFuture<CommandResult> Track(std::shared_ptr<const WhtsProtocol::Message> request, const Options &options);
+
+    // 由 MainWindow 在解析出 Master2Backend 消息后调用；返回 true 表示匹配到了在途命令
+    bool OnResponse(const std::shared_ptr<const WhtsProtocol::Message> &response, uint64_t arrivalNs);
+
+    // 取消 pOwner 发起的在途和排队的命令（结果为 Cancelled），在途命令不再重发
+    void Cancel(const QObject *pOwner);
+    // 取消所有在途和排队的命令（结果为 Cancelled）
+    void CancelAll();
+
+    size_t Outstanding() const { return m_outstanding; }
+    size_t Queued() const;
+
+    // Backend2Master 命令对应的 Master2Backend 应答消息 ID，无应答的命令返回 -1
+    static int ResponseIdFor(uint8_t requestMessageId);
+    // 停止采集（CtrlMessage runningStatus=0）和 RstMessage 立即发送，
+    // 并取代同一应答类型中排队和在途的命令（结果为 Cancelled）
+    static bool IsUrgent(const WhtsProtocol::Message &request);
+    // 应答是否回显了可核对的请求字段
+    static bool IsResponseVerifiable(uint8_t requestMessageId);
+    // 应答内容与请求一致（无法核对的类型总是返回 true）
+    static bool ResponseMatches(const WhtsProtocol::Message &request, const WhtsProtocol::Message &response);
+
+signals:
+    // 命令超时或发送失败，便于统一记日志
+    void CommandFailed(const QString &messageType, const QString &reason, int attempts);
+
+private slots:
+    void OnTimeout();
+
+private:
+    struct Pending {
+        std::shared_ptr<const WhtsProtocol::Message> request;
+        Options options;
+        const QObject *owner = nullptr;
+        QPromise<CommandResult> promise;
+        int attempts = 0;
+        uint64_t sentNs = 0;
+        uint64_t deadlineNs = 0;
+    };
+
+    using Channel = std::deque<std::unique_ptr<Pending>>;
+
+    // 发送各应答类型队首尚未发送的命令
+    void Pump();
+    // 记录一次发送（次数、发送时间和超时截止时间）
+    void MarkSent(Pending &pending);
+    bool Transmit(Pending &pending);
+    // 紧急命令独占该应答类型的队列，原有命令以 Cancelled 完成
+    void Supersede(uint8_t responseId, std::unique_ptr<Pending> pending, bool sent);
+    // 完成队首命令并出队
+    void Finish(Channel &channel, CommandResult::Status status,
+                std::shared_ptr<const WhtsProtocol::Message> response, uint64_t nowNs);
+    void RearmTimer();
+
+private:
+    Sender m_sender;
+    QTimer *m_pTimeoutTimer;
+    size_t m_maxOutstanding;
+    size_t m_outstanding;
+    // 按应答消息 ID 排队，队首 attempts > 0 时为在途命令
+    std::map<uint8_t, Channel> m_channels;
+    // 等待迟到应答的应答类型及截止时间，期间不发送排队的命令
+    std::map<uint8_t, uint64_t> m_drainUntilNs;
+};
+
+#endif // COMMANDENGINE_H
@@ -0,0 +1,185 @@
+#include "devicetablemodel.h"
+
+#include <algorithm>
+#include <unordered_set>
+
+namespace {
+// 返回两条设备信息第一个/最后一个不同的列，相同时返回 -1
+std::pair<int, int> ChangedColumns(const DeviceTableModel::DeviceInfo &a, const DeviceTableModel::DeviceInfo &b)
+{
+    bool changed[DeviceTableModel::COLUMN_COUNT] = {
+        false,
+        a.shortId != b.shortId,
+        a.online != b.online,
+        a.versionMajor != b.versionMajor || a.versionMinor != b.versionMinor || a.versionPatch != b.versionPatch,
+        a.batteryLevel != b.batteryLevel,
+    };
+    int first = -1;
+    int last = -1;
+    for (int column = 0; column < DeviceTableModel::COLUMN_COUNT; ++column) {
+        if (changed[column]) {
+            if (first < 0) {
+                first = column;
+            }
+            last = column;
+        }
+    }
+    return {first, last};
+}
+}
+
+DeviceTableModel::DeviceTableModel(QObject *parent)
+    : QAbstractTableModel(parent)
+{
+}
+
+int DeviceTableModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : static_cast<int>(m_devices.size());
+}
+
+int DeviceTableModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : COLUMN_COUNT;
+}
+
+QVariant DeviceTableModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= static_cast<int>(m_devices.size())) {
+        return QVariant();
+    }
+    const DeviceInfo &device = m_devices[index.row()];
+
+    if (role == Qt::DisplayRole) {
+        switch (index.column()) {
+        case COLUMN_DEVICE_ID:
+            return QString("0x%1").arg(device.deviceId, 8, 16, QChar('0')).toUpper();
+        case COLUMN_SHORT_ID:
+            return QString::number(device.shortId);
+        case COLUMN_ONLINE:
+            return device.online ? "在线" : "离线";
+        case COLUMN_VERSION:
+            return QString("%1.%2.%3").arg(device.versionMajor).arg(device.versionMinor).arg(device.versionPatch);
+        case COLUMN_BATTERY:
+            return static_cast<int>(device.batteryLevel);
+        default:
+            break;
+        }
+    } else if (role == Qt::TextAlignmentRole && index.column() != COLUMN_DEVICE_ID) {
+        return static_cast<int>(Qt::AlignCenter);
+    }
+    return QVariant();
+}
+
+QVariant DeviceTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (role != Qt::DisplayRole || orientation != Qt::Horizontal) {
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+    switch (section) {
+    case COLUMN_DEVICE_ID:
+        return "设备ID";
+    case COLUMN_SHORT_ID:
+        return "短ID";
+    case COLUMN_ONLINE:
+        return "在线状态";
+    case COLUMN_VERSION:
+        return "版本";
+    case COLUMN_BATTERY:
+        return "电池电量";
+    default:
+        return QVariant();
+    }
+}
+
+int DeviceTableModel::Update(const std::vector<DeviceInfo> &devices)
+{
+    int changedRows = 0;
+
+    // 移除不在新列表中的设备，从后往前按连续区间删除
+    std::unordered_set<uint32_t> incomingIds;
+    incomingIds.reserve(devices.size());
+    for (const auto &device : devices) {
+        incomingIds.insert(device.deviceId);
+    }
+    size_t firstRemoved = m_devices.size();
+    for (int row = static_cast<int>(m_devices.size()) - 1; row >= 0;) {
+        if (incomingIds.count(m_devices[row].deviceId)) {
+            --row;
+            continue;
+        }
+        int last = row;
+        while (row >= 0 && !incomingIds.count(m_devices[row].deviceId)) {
+            --row;
+        }
+        beginRemoveRows(QModelIndex(), row + 1, last);
+        m_devices.erase(m_devices.begin() + row + 1, m_devices.begin() + last + 1);
+        endRemoveRows();
+        changedRows += last - row;
+        firstRemoved = static_cast<size_t>(row + 1);
+    }
+    if (changedRows > 0) {
+        RebuildIndex(firstRemoved);
+    }
+
+    // 更新已有设备，只通知变化的列
+    std::vector<DeviceInfo> added;
+    for (const auto &device : devices) {
+        auto it = m_rowById.find(device.deviceId);
+        if (it == m_rowById.end()) {
+            added.push_back(device);
+            continue;
+        }
+        DeviceInfo &current = m_devices[it->second];
+        std::pair<int, int> columns = ChangedColumns(current, device);
+        if (columns.first < 0) {
+            continue;
+        }
+        current = device;
+        int row = static_cast<int>(it->second);
+        emit dataChanged(index(row, columns.first), index(row, columns.second));
+        ++changedRows;
+    }
+
+    // 新设备追加到末尾（同一列表中重复的设备ID只取第一条）
+    if (!added.empty()) {
+        std::unordered_set<uint32_t> seen;
+        auto end = std::remove_if(added.begin(), added.end(),
+                                  [&seen](const DeviceInfo &device) { return !seen.insert(device.deviceId).second; });
+        added.erase(end, added.end());
+
+        int first = static_cast<int>(m_devices.size());
+        beginInsertRows(QModelIndex(), first, first + static_cast<int>(added.size()) - 1);
+        m_devices.insert(m_devices.end(), added.begin(), added.end());
+        RebuildIndex(static_cast<size_t>(first));
+        endInsertRows();
+        changedRows += static_cast<int>(added.size());
+    }
+    return changedRows;
+}
+
+void DeviceTableModel::Clear()
+{
+    if (m_devices.empty()) {
+        return;
+    }
+    beginResetModel();
+    m_devices.clear();
+    m_rowById.clear();
+    endResetModel();
+}
+
+void DeviceTableModel::RebuildIndex(size_t firstRow)
+{
+    // 删除行后 firstRow 之后的行号整体前移，先清掉失效的映射
+    for (auto it = m_rowById.begin(); it != m_rowById.end();) {
+        if (it->second >= firstRow) {
+            it = m_rowById.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    for (size_t row = firstRow; row < m_devices.size(); ++row) {
+        m_rowById[m_devices[row].deviceId] = row;
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef DEVICETABLEMODEL_H
+#define DEVICETABLEMODEL_H
+
+#include <QAbstractTableModel>
+#include <unordered_map>
+#include <vector>
+
+#include "protocol/messages/Master2Backend.h"
+
+// 设备列表模型：按设备ID维护行，每次收到设备列表只对变化的行发出
+// 插入/删除/数据变化通知，已有设备的行位置保持不变
+class DeviceTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    using DeviceInfo = WhtsProtocol::Master2Backend::DeviceListResponseMessage::DeviceInfo;
+
+    enum Column {
+        COLUMN_DEVICE_ID = 0,
+        COLUMN_SHORT_ID,
+        COLUMN_ONLINE,
+        COLUMN_VERSION,
+        COLUMN_BATTERY,
+        COLUMN_COUNT
+    };
+
+    // 电量列的 DisplayRole 为 0-100 的整数，由 BatteryItemDelegate 绘制
+    explicit DeviceTableModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    // 与最新的设备列表比较并更新，返回发生变化（新增、移除或字段变化）的行数
+    int Update(const std::vector<DeviceInfo> &devices);
+    void Clear();
+
+    const std::vector<DeviceInfo> &Devices() const { return m_devices; }
+
+private:
+    void RebuildIndex(size_t firstRow);
+
+private:
+    std::vector<DeviceInfo> m_devices;
+    std::unordered_map<uint32_t, size_t> m_rowById;
+};
+
+#endif // DEVICETABLEMODEL_H
@@ -0,0 +1,301 @@
+#include "historywidget.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QFileDialog>
+#include <QFile>
+#include <QTextStream>
+#include <QDateTime>
+#include <QMessageBox>
+#include <algorithm>
+
+#include "latencytracker.h"
+
+namespace {
+// 刷新从机列表和统计的周期（毫秒）
+constexpr int HISTORY_REFRESH_INTERVAL_MS = 1000;
+// 表格最多显示的条数（保留最新的），导出不受限制
+constexpr size_t MAX_DISPLAY_ROWS = 5000;
+// 历史存储的内存预算，决定保留条数的上限（默认配置下约 9900 条）
+constexpr size_t HISTORY_MEMORY_BUDGET_BYTES = 256u * 1024 * 1024;
+
+enum SampleColumn {
+    SAMPLE_COLUMN_TIME = 0,
+    SAMPLE_COLUMN_STATUS,
+    SAMPLE_COLUMN_LENGTH,
+    SAMPLE_COLUMN_DATA,
+    SAMPLE_COLUMN_TOTAL
+};
+
+QString SlaveIdToString(uint32_t slaveId)
+{
+    return QString("0x%1").arg(slaveId, 8, 16, QChar('0')).toUpper();
+}
+
+QString StatusToString(uint16_t status)
+{
+    return QString("0x%1").arg(status, 4, 16, QChar('0')).toUpper();
+}
+
+QString DataToString(const uint8_t *data, size_t length)
+{
+    return QByteArray(reinterpret_cast<const char *>(data), static_cast<int>(length)).toHex(' ').toUpper();
+}
+
+// 历史记录使用单调时钟毫秒，显示时换算为本机时间
+qint64 MonotonicToEpochOffsetMs()
+{
+    return QDateTime::currentMSecsSinceEpoch() - static_cast<qint64>(LatencyTracker::NowNs() / 1000000);
+}
+
+QString TimestampToString(qint64 epochOffsetMs, uint64_t timestampMs)
+{
+    return QDateTime::fromMSecsSinceEpoch(epochOffsetMs + static_cast<qint64>(timestampMs))
+        .toString("yyyy-MM-dd hh:mm:ss.zzz");
+}
+}
+
+HistoryWidget::HistoryWidget(WhtsProtocol::SampleHistory *pHistory, QSettings *pSettings, QWidget *parent)
+    : QWidget(parent)
+    , m_pHistory(pHistory)
+    , m_pSettings(pSettings)
+    , m_pComboBoxSlave(nullptr)
+    , m_pComboBoxKind(nullptr)
+    , m_pSpinBoxSeconds(nullptr)
+    , m_pPushButtonQuery(nullptr)
+    , m_pPushButtonExport(nullptr)
+    , m_pSpinBoxDepth(nullptr)
+    , m_pPushButtonClear(nullptr)
+    , m_pLabelSummary(nullptr)
+    , m_pTableWidgetSamples(nullptr)
+    , m_pRefreshTimer(nullptr)
+{
+    InitializeUI();
+    LoadSettings();
+
+    m_pRefreshTimer = new QTimer(this);
+    connect(m_pRefreshTimer, &QTimer::timeout, this, &HistoryWidget::OnRefreshTimeout);
+    m_pRefreshTimer->start(HISTORY_REFRESH_INTERVAL_MS);
+}
+
+void HistoryWidget::InitializeUI()
+{
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+
+    QHBoxLayout *controlLayout = new QHBoxLayout();
+    controlLayout->addWidget(new QLabel("从机:", this));
+    m_pComboBoxSlave = new QComboBox(this);
+    m_pComboBoxSlave->setMinimumWidth(120);
+    controlLayout->addWidget(m_pComboBoxSlave);
+    controlLayout->addWidget(new QLabel("类型:", this));
+    m_pComboBoxKind = new QComboBox(this);
+    m_pComboBoxKind->addItem("设备状态", static_cast<int>(WhtsProtocol::HistoryKind::STATUS));
+    m_pComboBoxKind->addItem("导通数据", static_cast<int>(WhtsProtocol::HistoryKind::CONDUCTION));
+    m_pComboBoxKind->addItem("阻值数据", static_cast<int>(WhtsProtocol::HistoryKind::RESISTANCE));
+    controlLayout->addWidget(m_pComboBoxKind);
+    controlLayout->addWidget(new QLabel("最近:", this));
+    m_pSpinBoxSeconds = new QSpinBox(this);
+    m_pSpinBoxSeconds->setRange(0, 86400);
+    m_pSpinBoxSeconds->setValue(60);
+    m_pSpinBoxSeconds->setSuffix(" 秒");
+    m_pSpinBoxSeconds->setSpecialValueText("全部");
+    controlLayout->addWidget(m_pSpinBoxSeconds);
+    m_pPushButtonQuery = new QPushButton("查询", this);
+    controlLayout->addWidget(m_pPushButtonQuery);
+    m_pPushButtonExport = new QPushButton("导出CSV", this);
+    controlLayout->addWidget(m_pPushButtonExport);
+    controlLayout->addStretch();
+    controlLayout->addWidget(new QLabel("保留条数:", this));
+    m_pSpinBoxDepth = new QSpinBox(this);
+    size_t maxDepth = WhtsProtocol::SampleHistory::maxDepth(m_pHistory->config(), HISTORY_MEMORY_BUDGET_BYTES);
+    m_pSpinBoxDepth->setRange(16, static_cast<int>(std::max<size_t>(16, maxDepth)));
+    m_pSpinBoxDepth->setToolTip(QString("每个从机每类采样保留的条数，修改后清空历史（预分配内存上限 %1 MB）")
+                                    .arg(HISTORY_MEMORY_BUDGET_BYTES / (1024 * 1024)));
+    controlLayout->addWidget(m_pSpinBoxDepth);
+    m_pPushButtonClear = new QPushButton("清空", this);
+    controlLayout->addWidget(m_pPushButtonClear);
+    mainLayout->addLayout(controlLayout);
+
+    m_pLabelSummary = new QLabel(this);
+    mainLayout->addWidget(m_pLabelSummary);
+
+    m_pTableWidgetSamples = new QTableWidget(0, SAMPLE_COLUMN_TOTAL, this);
+    m_pTableWidgetSamples->setHorizontalHeaderLabels({"时间", "设备状态", "长度", "数据"});
+    m_pTableWidgetSamples->verticalHeader()->setVisible(false);
+    m_pTableWidgetSamples->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_pTableWidgetSamples->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    m_pTableWidgetSamples->horizontalHeader()->setStretchLastSection(true);
+    mainLayout->addWidget(m_pTableWidgetSamples);
+
+    connect(m_pPushButtonQuery, &QPushButton::clicked, this, &HistoryWidget::OnQueryClicked);
+    connect(m_pPushButtonExport, &QPushButton::clicked, this, &HistoryWidget::OnExportClicked);
+    connect(m_pPushButtonClear, &QPushButton::clicked, this, &HistoryWidget::OnClearClicked);
+}
+
+void HistoryWidget::LoadSettings()
+{
+    const WhtsProtocol::SampleHistory::Config defaults;
+    m_pSpinBoxDepth->setValue(m_pSettings->value("History/Depth", static_cast<int>(defaults.depth)).toInt());
+    OnDepthChanged();
+
+    // 修改保留条数会清空历史，编辑完成后才生效
+    connect(m_pSpinBoxDepth, &QSpinBox::editingFinished, this, &HistoryWidget::OnDepthChanged);
+}
+
+void HistoryWidget::OnDepthChanged()
+{
+    size_t depth = static_cast<size_t>(m_pSpinBoxDepth->value());
+    if (depth != m_pHistory->config().depth) {
+        WhtsProtocol::SampleHistory::Config config = m_pHistory->config();
+        config.depth = depth;
+        if (!m_pHistory->configure(config)) {
+            // 分配失败时保留原有的存储和历史
+            m_pSpinBoxDepth->setValue(static_cast<int>(m_pHistory->config().depth));
+            QMessageBox::warning(this, "警告", QString("内存不足，无法保留 %1 条历史，仍保留 %2 条")
+                                 .arg(depth).arg(m_pHistory->config().depth));
+        } else {
+            m_pTableWidgetSamples->setRowCount(0);
+        }
+    }
+    m_pSettings->setValue("History/Depth", m_pSpinBoxDepth->value());
+    OnRefreshTimeout();
+}
+
+void HistoryWidget::OnRefreshTimeout()
+{
+    const WhtsProtocol::SampleHistory::Stats &stats = m_pHistory->stats();
+    m_pLabelSummary->setText(QString("从机 %1，已记录 %2，已覆盖 %3，截断 %4，超出从机上限 %5，预分配内存 %6 MB")
+                                 .arg(m_pHistory->slaves().size())
+                                 .arg(stats.recorded)
+                                 .arg(stats.overwritten)
+                                 .arg(stats.truncated)
+                                 .arg(stats.droppedSlaves)
+                                 .arg(m_pHistory->capacityBytes() / (1024.0 * 1024.0), 0, 'f', 1));
+
+    if (isVisible()) {
+        UpdateSlaveList();
+    }
+}
+
+void HistoryWidget::UpdateSlaveList()
+{
+    const std::vector<uint32_t> slaves = m_pHistory->slaves();
+    if (static_cast<int>(slaves.size()) == m_pComboBoxSlave->count()) {
+        return;
+    }
+
+    // 从机列表只增不减（清空除外），保持当前选择
+    QVariant current = m_pComboBoxSlave->currentData();
+    m_pComboBoxSlave->clear();
+    for (uint32_t slaveId : slaves) {
+        m_pComboBoxSlave->addItem(SlaveIdToString(slaveId), slaveId);
+    }
+    int index = m_pComboBoxSlave->findData(current);
+    m_pComboBoxSlave->setCurrentIndex(index >= 0 ? index : 0);
+}
+
+bool HistoryWidget::SelectedRange(uint32_t &slaveId, WhtsProtocol::HistoryKind &kind,
+                                  uint64_t &fromMs, uint64_t &toMs) const
+{
+    if (m_pComboBoxSlave->currentIndex() < 0) {
+        return false;
+    }
+    slaveId = m_pComboBoxSlave->currentData().toUInt();
+    kind = static_cast<WhtsProtocol::HistoryKind>(m_pComboBoxKind->currentData().toInt());
+    toMs = LatencyTracker::NowNs() / 1000000;
+    uint64_t spanMs = static_cast<uint64_t>(m_pSpinBoxSeconds->value()) * 1000;
+    fromMs = (spanMs == 0 || spanMs > toMs) ? 0 : toMs - spanMs;
+    return true;
+}
+
+void HistoryWidget::OnQueryClicked()
+{
+    UpdateSlaveList();
+    uint32_t slaveId = 0;
+    WhtsProtocol::HistoryKind kind = WhtsProtocol::HistoryKind::STATUS;
+    uint64_t fromMs = 0;
+    uint64_t toMs = 0;
+    if (!SelectedRange(slaveId, kind, fromMs, toMs)) {
+        m_pTableWidgetSamples->setRowCount(0);
+        return;
+    }
+
+    // 最新的采样显示在最上面
+    const qint64 epochOffsetMs = MonotonicToEpochOffsetMs();
+    int rows = 0;
+    m_pTableWidgetSamples->setUpdatesEnabled(false);
+    m_pTableWidgetSamples->setRowCount(0);
+    m_pTableWidgetSamples->setRowCount(static_cast<int>(std::min(m_pHistory->count(slaveId, kind), MAX_DISPLAY_ROWS)));
+    size_t visited = m_pHistory->query(slaveId, kind, fromMs, toMs,
+        [&](uint64_t timestampMs, uint16_t status, const uint8_t *data, size_t length) {
+            int row = m_pTableWidgetSamples->rowCount() - 1 - rows++;
+            m_pTableWidgetSamples->setItem(row, SAMPLE_COLUMN_TIME,
+                                           new QTableWidgetItem(TimestampToString(epochOffsetMs, timestampMs)));
+            m_pTableWidgetSamples->setItem(row, SAMPLE_COLUMN_STATUS, new QTableWidgetItem(StatusToString(status)));
+            m_pTableWidgetSamples->setItem(row, SAMPLE_COLUMN_LENGTH, new QTableWidgetItem(QString::number(length)));
+            m_pTableWidgetSamples->setItem(row, SAMPLE_COLUMN_DATA, new QTableWidgetItem(DataToString(data, length)));
+        },
+        MAX_DISPLAY_ROWS);
+    // 按范围内的实际条数去掉多分配的行（位于表格顶部）
+    m_pTableWidgetSamples->model()->removeRows(0, m_pTableWidgetSamples->rowCount() - static_cast<int>(visited));
+    m_pTableWidgetSamples->setUpdatesEnabled(true);
+}
+
+void HistoryWidget::OnExportClicked()
+{
+    UpdateSlaveList();
+    uint32_t slaveId = 0;
+    WhtsProtocol::HistoryKind kind = WhtsProtocol::HistoryKind::STATUS;
+    uint64_t fromMs = 0;
+    uint64_t toMs = 0;
+    if (!SelectedRange(slaveId, kind, fromMs, toMs)) {
+        QMessageBox::information(this, "提示", "没有可导出的历史数据");
+        return;
+    }
+
+    QString defaultName = QString("history_%1_%2_%3.csv")
+                              .arg(slaveId, 8, 16, QChar('0'))
+                              .arg(QString(WhtsProtocol::historyKindName(kind)).toLower())
+                              .arg(QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss"));
+    QString fileName = QFileDialog::getSaveFileName(this, "导出历史数据", defaultName, "CSV (*.csv)");
+    if (fileName.isEmpty()) {
+        return;
+    }
+
+    if (!ExportCsv(fileName, slaveId, kind, fromMs, toMs)) {
+        QMessageBox::warning(this, "警告", QString("导出失败: %1").arg(fileName));
+    }
+}
+
+bool HistoryWidget::ExportCsv(const QString &fileName, uint32_t slaveId, WhtsProtocol::HistoryKind kind,
+                              uint64_t fromMs, uint64_t toMs) const
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        return false;
+    }
+
+    const qint64 epochOffsetMs = MonotonicToEpochOffsetMs();
+    QTextStream stream(&file);
+    stream << "slave_id,kind,time,monotonic_ms,status,length,data\n";
+    const QString slave = SlaveIdToString(slaveId);
+    const QString kindName = WhtsProtocol::historyKindName(kind);
+    m_pHistory->query(slaveId, kind, fromMs, toMs,
+        [&](uint64_t timestampMs, uint16_t status, const uint8_t *data, size_t length) {
+            stream << slave << "," << kindName << ","
+                   << TimestampToString(epochOffsetMs, timestampMs) << ","
+                   << timestampMs << ","
+                   << StatusToString(status) << ","
+                   << length << ","
+                   << DataToString(data, length) << "\n";
+        });
+    return stream.status() == QTextStream::Ok;
+}
+
+void HistoryWidget::OnClearClicked()
+{
+    m_pHistory->clear();
+    m_pComboBoxSlave->clear();
+    m_pTableWidgetSamples->setRowCount(0);
+    OnRefreshTimeout();
+}
@@ -0,0 +1,55 @@
+#ifndef HISTORYWIDGET_H
+#define HISTORYWIDGET_H
+
+#include <QWidget>
+#include <QTableWidget>
+#include <QPushButton>
+#include <QComboBox>
+#include <QSpinBox>
+#include <QLabel>
+#include <QTimer>
+#include <QSettings>
+
+#include "protocol/SampleHistory.h"
+
+// 历史数据面板：按从机和采样类型查询最近的状态/导通/阻值采样，可导出为 CSV
+class HistoryWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    HistoryWidget(WhtsProtocol::SampleHistory *pHistory, QSettings *pSettings, QWidget *parent = nullptr);
+
+private slots:
+    void OnRefreshTimeout();
+    void OnDepthChanged();
+    void OnQueryClicked();
+    void OnExportClicked();
+    void OnClearClicked();
+
+private:
+    void InitializeUI();
+    void LoadSettings();
+    void UpdateSlaveList();
+    // 当前选择的从机、类型和时间范围，没有可查询的从机时返回 false
+    bool SelectedRange(uint32_t &slaveId, WhtsProtocol::HistoryKind &kind, uint64_t &fromMs, uint64_t &toMs) const;
+    bool ExportCsv(const QString &fileName, uint32_t slaveId, WhtsProtocol::HistoryKind kind,
+                   uint64_t fromMs, uint64_t toMs) const;
+
+private:
+    WhtsProtocol::SampleHistory *m_pHistory;
+    QSettings *m_pSettings;
+
+    QComboBox *m_pComboBoxSlave;
+    QComboBox *m_pComboBoxKind;
+    QSpinBox *m_pSpinBoxSeconds;
+    QPushButton *m_pPushButtonQuery;
+    QPushButton *m_pPushButtonExport;
+    QSpinBox *m_pSpinBoxDepth;
+    QPushButton *m_pPushButtonClear;
+    QLabel *m_pLabelSummary;
+    QTableWidget *m_pTableWidgetSamples;
+    QTimer *m_pRefreshTimer;
+};
+
+#endif // HISTORYWIDGET_H
@@ -0,0 +1,260 @@
+#include "intervalcontroller.h"
+#include "protocol/messages/Backend2Master.h"
+#include <algorithm>
+#include <cmath>
+
+IntervalController::IntervalController(const WhtsProtocol::ProtocolStats *pStats, CommandEngine *pCommandEngine,
+                                       QObject *parent)
+    : QObject(parent)
+    , m_pStats(pStats)
+    , m_pCommandEngine(pCommandEngine)
+    , m_phase(Phase::Idle)
+    , m_pTimer(new QTimer(this))
+    , m_windowBase()
+    , m_currentInterval(0)
+    , m_floorInterval(0)
+    , m_saturationInterval(0)
+    , m_applyToken(0)
+    , m_cleanWindows(0)
+    , m_holdWindows(0)
+{
+    m_pTimer->setSingleShot(true);
+    connect(m_pTimer, &QTimer::timeout, this, &IntervalController::OnTimeout);
+}
+
+bool IntervalController::Start(const std::vector<uint32_t> &slaveIds, const Config &config)
+{
+    if (IsRunning() || slaveIds.empty()) {
+        return false;
+    }
+    if (config.minIntervalMs == 0 || config.minIntervalMs > config.maxIntervalMs) {
+        return false;
+    }
+
+    m_config = config;
+    m_config.initialIntervalMs = std::clamp(config.initialIntervalMs, config.minIntervalMs, config.maxIntervalMs);
+
+    m_slaves.clear();
+    m_slaveIndex.clear();
+    for (uint32_t slaveId : slaveIds) {
+        if (m_slaveIndex.emplace(slaveId, m_slaves.size()).second) {
+            SlaveLoad load;
+            load.slaveId = slaveId;
+            m_slaves.push_back(load);
+        }
+    }
+
+    m_floorInterval = m_config.minIntervalMs;
+    m_saturationInterval = 0;
+    m_cleanWindows = 0;
+    m_holdWindows = 0;
+    m_lastReport = WindowReport();
+
+    Apply(m_config.initialIntervalMs);
+    return IsRunning();
+}
+
+void IntervalController::Stop()
+{
+    if (!IsRunning()) {
+        return;
+    }
+    Halt();
+    emit StatusChanged(QString("自适应已停止，当前间隔 %1 ms").arg(m_currentInterval));
+}
+
+void IntervalController::Halt()
+{
+    ++m_applyToken;
+    m_pTimer->stop();
+    m_phase = Phase::Idle;
+    emit Stopped();
+}
+
+void IntervalController::Apply(uint8_t intervalMs)
+{
+    m_phase = Phase::Applying;
+
+    auto intervalConfig = std::make_shared<WhtsProtocol::Backend2Master::IntervalConfigMessage>();
+    intervalConfig->intervalMs = intervalMs;
+    CommandEngine::Options options;
+    options.timeoutMs = m_config.responseTimeoutMs;
+    options.retries = MAX_APPLY_RETRIES;
+    emit StatusChanged(QString("设置采集间隔 %1 ms").arg(intervalMs));
+    uint64_t token = ++m_applyToken;
+    m_pCommandEngine->Send(intervalConfig, options).then(this, [this, token](const CommandResult &result) {
+        if (token == m_applyToken) {
+            OnApplyResult(result);
+        }
+    });
+}
+
+void IntervalController::OnApplyResult(const CommandResult &result)
+{
+    if (m_phase != Phase::Applying) {
+        return;
+    }
+
+    auto response = std::dynamic_pointer_cast<const WhtsProtocol::Master2Backend::IntervalConfigResponseMessage>(
+        result.response);
+    if (!result.Ok() || !response) {
+        emit StatusChanged(result.status == CommandResult::Status::Timeout ? "未收到间隔配置响应，自适应中止"
+                                                                           : "发送间隔配置失败，自适应中止");
+        Halt();
+        return;
+    }
+
+    if (response->status == 0) {
+        emit IntervalChanged(m_currentInterval);
+    } else if (m_currentInterval == 0) {
+        // 初始间隔就被拒绝，无法继续
+        emit StatusChanged(QString("主机拒绝间隔 %1 ms，自适应中止").arg(response->intervalMs));
+        Halt();
+        return;
+    } else {
+        // 主机不支持更短的间隔，以后不再尝试
+        if (response->intervalMs < m_currentInterval) {
+            m_floorInterval = std::max<uint8_t>(m_floorInterval, response->intervalMs + 1);
+        }
+        emit StatusChanged(QString("主机拒绝间隔 %1 ms，保持 %2 ms").arg(response->intervalMs).arg(m_currentInterval));
+    }
+    // 切换前后的数据混在一个窗口里没有意义，重新开始统计
+    BeginWindow();
+}
+
+void IntervalController::BeginWindow()
+{
+    m_phase = Phase::Measuring;
+    for (auto &slave : m_slaves) {
+        slave.frames = 0;
+    }
+    m_windowBase = m_pStats->snapshot();
+    m_windowTimer.start();
+
+    // 窗口至少覆盖 minCyclesPerWindow 个周期，避免长间隔下帧数太少、抖动过大
+    int windowMs = std::max(m_config.windowMs, m_config.minCyclesPerWindow * m_currentInterval);
+    m_pTimer->start(windowMs);
+}
+
+void IntervalController::OnIntervalConfigResponse(const WhtsProtocol::Master2Backend::IntervalConfigResponseMessage &message)
+{
+    // 自适应流程由命令结果驱动，这里只跟踪主机确认的间隔（含其他来源的配置）
+    if (message.status == 0) {
+        m_currentInterval = message.intervalMs;
+    }
+}
+
+void IntervalController::OnConductionFrame(uint32_t slaveId, uint32_t samples)
+{
+    if (m_phase != Phase::Measuring) {
+        return;
+    }
+    auto it = m_slaveIndex.find(slaveId);
+    if (it != m_slaveIndex.end()) {
+        m_slaves[it->second].frames += samples;
+    }
+}
+
+void IntervalController::OnTimeout()
+{
+    switch (m_phase) {
+    case Phase::Measuring:
+        EvaluateWindow();
+        break;
+    default:
+        break;
+    }
+}
+
+void IntervalController::EvaluateWindow()
+{
+    qint64 elapsedMs = std::max<qint64>(m_windowTimer.elapsed(), 1);
+    WhtsProtocol::ProtocolStatsSnapshot delta = m_pStats->snapshot().delta(m_windowBase);
+
+    WindowReport report;
+    report.intervalMs = m_currentInterval;
+    report.seconds = elapsedMs / 1000.0;
+    report.expiredFragments = delta.get(WhtsProtocol::StatCounter::EXPIRED_FRAGMENTS);
+    report.socketDrops = delta.get(WhtsProtocol::StatCounter::SOCKET_DROPS);
+    report.bufferOverflows = delta.get(WhtsProtocol::StatCounter::BUFFER_OVERFLOWS);
+
+    uint64_t totalFrames = 0;
+    for (auto &slave : m_slaves) {
+        totalFrames += slave.frames;
+        slave.framesPerSecond = slave.frames / report.seconds;
+        slave.framesPerCycle = static_cast<double>(slave.frames) * m_currentInterval / elapsedMs;
+
+        if (slave.frames == 0) {
+            ++slave.silentWindows;
+            // 刚开始没数据或已离线的从机不计入
+            slave.lossRatio = (slave.referencePerCycle > 0 && slave.silentWindows < SILENT_WINDOWS_BEFORE_IGNORE) ? 1.0 : 0.0;
+        } else {
+            slave.silentWindows = 0;
+            slave.lossRatio = slave.referencePerCycle > 0
+                                  ? std::max(0.0, 1.0 - slave.framesPerCycle / slave.referencePerCycle)
+                                  : 0.0;
+        }
+        if (slave.lossRatio > report.worstLoss) {
+            report.worstLoss = slave.lossRatio;
+            report.worstSlaveId = slave.slaveId;
+        }
+    }
+
+    if (totalFrames == 0) {
+        // 没有导通数据（采集未启动），无从判断，保持间隔
+        report.nextIntervalMs = m_currentInterval;
+        m_lastReport = report;
+        emit StatusChanged(QString("没有导通数据，保持 %1 ms").arg(m_currentInterval));
+        emit WindowEvaluated();
+        BeginWindow();
+        return;
+    }
+
+    bool transportLoss = report.expiredFragments || report.socketDrops || report.bufferOverflows;
+    report.congested = transportLoss || report.worstLoss > m_config.lossThreshold;
+    if (!report.congested) {
+        // 参考值只从干净窗口学习
+        for (auto &slave : m_slaves) {
+            slave.referencePerCycle = std::max(slave.referencePerCycle, slave.framesPerCycle);
+        }
+    }
+
+    report.nextIntervalMs = NextInterval(report.congested);
+    m_lastReport = report;
+    emit WindowEvaluated();
+
+    if (report.nextIntervalMs != m_currentInterval) {
+        Apply(report.nextIntervalMs);
+    } else {
+        emit StatusChanged(QString("%1 ms %2").arg(m_currentInterval).arg(report.congested ? "饱和" : "稳定"));
+        BeginWindow();
+    }
+}
+
+uint8_t IntervalController::NextInterval(bool congested)
+{
+    uint8_t current = m_currentInterval;
+    if (congested) {
+        // 乘性退避，记住饱和点，一段时间内只逼近不越过
+        m_saturationInterval = current;
+        m_holdWindows = m_config.probeHoldWindows;
+        m_cleanWindows = 0;
+        int next = std::max<int>(current + 1, static_cast<int>(std::ceil(current * m_config.backoffFactor)));
+        return static_cast<uint8_t>(std::min<int>(next, m_config.maxIntervalMs));
+    }
+
+    if (m_holdWindows > 0 && --m_holdWindows == 0) {
+        // 保持期结束，链路条件可能已变化，允许重新试探
+        m_saturationInterval = 0;
+    }
+    if (++m_cleanWindows < m_config.cleanWindowsBeforeStep) {
+        return current;
+    }
+    m_cleanWindows = 0;
+
+    int next = std::max<int>(current - m_config.stepMs, m_floorInterval);
+    if (m_saturationInterval && next <= m_saturationInterval) {
+        next = std::min<int>(m_saturationInterval + 1, current);
+    }
+    return static_cast<uint8_t>(next);
+}
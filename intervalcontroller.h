@@ -0,0 +1,131 @@
+#ifndef INTERVALCONTROLLER_H
+#define INTERVALCONTROLLER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "commandengine.h"
+#include "protocol/ProtocolStats.h"
+#include "protocol/messages/Master2Backend.h"
+
+// 采集间隔自适应：按窗口统计每个从机的导通帧速率和协议层丢失（重组超时、socket 丢包、
+// 缓冲区溢出），链路干净时逐步缩短 IntervalConfig 间隔，出现丢失时按比例退避，
+// 使间隔停在刚好不饱和的位置。间隔配置经 CommandEngine 发送并等待应答
+class IntervalController : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Config {
+        uint8_t minIntervalMs = 5;
+        uint8_t maxIntervalMs = 200;
+        uint8_t initialIntervalMs = 50;
+        int windowMs = 2000;              // 评估窗口的最短时长
+        int minCyclesPerWindow = 50;      // 窗口至少覆盖的采集周期数
+        double lossThreshold = 0.05;      // 最差从机丢失率超过该值视为饱和
+        uint8_t stepMs = 1;               // 链路干净时每次缩短的间隔
+        double backoffFactor = 1.25;      // 饱和时间隔放大倍数
+        int cleanWindowsBeforeStep = 2;   // 连续干净窗口数达到后才缩短
+        int probeHoldWindows = 15;        // 退避后不再试探饱和点的窗口数
+        int responseTimeoutMs = 2000;     // 等待 IntervalConfigResponse 的时间
+    };
+
+    // 单个从机在最近一个窗口内的负载
+    struct SlaveLoad {
+        uint32_t slaveId = 0;
+        uint64_t frames = 0;
+        double framesPerSecond = 0;
+        double framesPerCycle = 0;        // 帧数 × 间隔 / 窗口时长，链路不饱和时应保持不变
+        double referencePerCycle = 0;     // 干净窗口中观测到的最大每周期帧数
+        double lossRatio = 0;             // 1 - 每周期帧数 / 参考值
+        int silentWindows = 0;            // 连续没有数据的窗口数
+    };
+
+    struct WindowReport {
+        uint8_t intervalMs = 0;
+        double seconds = 0;
+        double worstLoss = 0;
+        uint32_t worstSlaveId = 0;
+        uint64_t expiredFragments = 0;
+        uint64_t socketDrops = 0;
+        uint64_t bufferOverflows = 0;
+        bool congested = false;
+        uint8_t nextIntervalMs = 0;
+    };
+
+    // 连续多少个窗口没有数据后，不再把该从机计入丢失（视为离线）
+    static constexpr int SILENT_WINDOWS_BEFORE_IGNORE = 3;
+    // 间隔配置未被确认时的重发次数
+    static constexpr int MAX_APPLY_RETRIES = 2;
+
+    IntervalController(const WhtsProtocol::ProtocolStats *pStats, CommandEngine *pCommandEngine,
+                       QObject *parent = nullptr);
+
+    bool Start(const std::vector<uint32_t> &slaveIds, const Config &config);
+    void Stop();
+    bool IsRunning() const { return m_phase != Phase::Idle; }
+
+    // 由 MainWindow 在收到任意 IntervalConfigResponse 时调用，只记录当前间隔
+    void OnIntervalConfigResponse(const WhtsProtocol::Master2Backend::IntervalConfigResponseMessage &message);
+    // 批量数据帧按采样数计入
+    void OnConductionFrame(uint32_t slaveId, uint32_t samples = 1);
+
+    // 主机确认的间隔，未知时为 0
+    uint8_t CurrentInterval() const { return m_currentInterval; }
+    // 最近一次出现饱和的间隔，没有时为 0
+    uint8_t SaturationInterval() const { return m_saturationInterval; }
+    const std::vector<SlaveLoad> &SlaveLoads() const { return m_slaves; }
+    const WindowReport &LastReport() const { return m_lastReport; }
+
+signals:
+    void WindowEvaluated();
+    void IntervalChanged(uint8_t intervalMs);
+    void StatusChanged(const QString &status);
+    void Stopped();
+
+private slots:
+    void OnTimeout();
+
+private:
+    enum class Phase {
+        Idle,
+        Applying,     // 已发送 IntervalConfig，等待响应
+        Measuring     // 统计当前窗口
+    };
+
+    // 停止但不覆盖状态文字（出错时使用）
+    void Halt();
+    void Apply(uint8_t intervalMs);
+    void OnApplyResult(const CommandResult &result);
+    void BeginWindow();
+    void EvaluateWindow();
+    uint8_t NextInterval(bool congested);
+
+private:
+    const WhtsProtocol::ProtocolStats *m_pStats;
+    CommandEngine *m_pCommandEngine;
+    Config m_config;
+
+    Phase m_phase;
+    QTimer *m_pTimer;
+    QElapsedTimer m_windowTimer;
+    WhtsProtocol::ProtocolStatsSnapshot m_windowBase;
+
+    std::vector<SlaveLoad> m_slaves;
+    std::unordered_map<uint32_t, size_t> m_slaveIndex;
+
+    uint8_t m_currentInterval;
+    uint8_t m_floorInterval;          // 主机拒绝过的最大间隔 + 1
+    uint8_t m_saturationInterval;
+    // 每次下发递增，丢弃已停止自适应迟到的命令结果
+    uint64_t m_applyToken;
+    int m_cleanWindows;
+    int m_holdWindows;
+    WindowReport m_lastReport;
+};
+
+#endif // INTERVALCONTROLLER_H
@@ -0,0 +1,68 @@
+#include "latencytracker.h"
+#include <chrono>
+
+LatencyTracker::LatencyTracker()
+    : m_slots(PACKET_TYPE_COUNT * MESSAGE_ID_COUNT)
+{
+    for (auto &slot : m_slots) {
+        slot.name = nullptr;
+    }
+}
+
+uint64_t LatencyTracker::NowNs()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::steady_clock::now().time_since_epoch())
+                                     .count());
+}
+
+void LatencyTracker::Record(LatencyStage stage, uint8_t packetId, uint8_t messageId,
+                            const char *name, uint64_t latencyNs)
+{
+    if (packetId >= PACKET_TYPE_COUNT || stage == LatencyStage::Count) {
+        return;
+    }
+
+    size_t key = packetId * MESSAGE_ID_COUNT + messageId;
+    Slot &slot = m_slots[key];
+    if (!slot.name) {
+        slot.name = name ? name : "Unknown";
+        m_activeKeys.push_back(static_cast<uint16_t>(key));
+    }
+
+    auto &histogram = slot.histograms[static_cast<int>(stage)];
+    if (!histogram) {
+        histogram = std::make_unique<WhtsProtocol::LatencyHistogram>();
+    }
+    histogram->record(latencyNs);
+}
+
+std::vector<LatencyTracker::Entry> LatencyTracker::Entries() const
+{
+    std::vector<Entry> entries;
+    entries.reserve(m_activeKeys.size());
+    for (uint16_t key : m_activeKeys) {
+        const Slot &slot = m_slots[key];
+        Entry entry;
+        entry.packetId = static_cast<uint8_t>(key / MESSAGE_ID_COUNT);
+        entry.messageId = static_cast<uint8_t>(key % MESSAGE_ID_COUNT);
+        entry.name = slot.name;
+        for (int i = 0; i < static_cast<int>(LatencyStage::Count); ++i) {
+            entry.histograms[i] = slot.histograms[i].get();
+        }
+        entries.push_back(entry);
+    }
+    return entries;
+}
+
+void LatencyTracker::Reset()
+{
+    // 保留已分配的直方图，只清空样本
+    for (uint16_t key : m_activeKeys) {
+        for (auto &histogram : m_slots[key].histograms) {
+            if (histogram) {
+                histogram->reset();
+            }
+        }
+    }
+}
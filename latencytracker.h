@@ -0,0 +1,56 @@
+#ifndef LATENCYTRACKER_H
+#define LATENCYTRACKER_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "protocol/utils/LatencyHistogram.h"
+
+// 延迟阶段
+enum class LatencyStage {
+    Decode = 0,   // 数据报到达 -> 消息解码完成
+    Display,      // 消息解码完成 -> 界面更新完成
+    Count
+};
+
+// 按 PacketId / 消息ID 分类的延迟直方图集合
+// 每个消息类型的直方图在首次记录时分配，之后内存固定，记录为 O(1)
+class LatencyTracker
+{
+public:
+    struct Entry {
+        uint8_t packetId;
+        uint8_t messageId;
+        const char *name;
+        const WhtsProtocol::LatencyHistogram *histograms[static_cast<int>(LatencyStage::Count)];
+    };
+
+    LatencyTracker();
+
+    // 单调时钟（纳秒）
+    static uint64_t NowNs();
+
+    // name 须为静态字符串（如 Message::getMessageTypeName() 的返回值）
+    void Record(LatencyStage stage, uint8_t packetId, uint8_t messageId,
+                const char *name, uint64_t latencyNs);
+
+    // 已有样本的消息类型，按首次出现顺序排列
+    std::vector<Entry> Entries() const;
+
+    void Reset();
+
+private:
+    struct Slot {
+        const char *name;
+        std::unique_ptr<WhtsProtocol::LatencyHistogram> histograms[static_cast<int>(LatencyStage::Count)];
+    };
+
+    static constexpr size_t PACKET_TYPE_COUNT = 5;
+    static constexpr size_t MESSAGE_ID_COUNT = 256;
+
+    std::vector<Slot> m_slots;            // 下标 = packetId * 256 + messageId
+    std::vector<uint16_t> m_activeKeys;   // 已使用的下标
+};
+
+#endif // LATENCYTRACKER_H
@@ -0,0 +1,586 @@
+#include "linkqualitywidget.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QGroupBox>
+#include <QMessageBox>
+
+namespace {
+enum PingColumn {
+    PING_COLUMN_SLAVE = 0,
+    PING_COLUMN_RUNS,
+    PING_COLUMN_TIMEOUTS,
+    PING_COLUMN_SENT,
+    PING_COLUMN_SUCCEEDED,
+    PING_COLUMN_RATIO,
+    PING_COLUMN_RECENT_RATIO,
+    PING_COLUMN_RTT_P50,
+    PING_COLUMN_RTT_P99,
+    PING_COLUMN_RTT_MAX,
+    PING_COLUMN_RUN_P50,
+    PING_COLUMN_GAPS,
+    PING_COLUMN_COUNT
+};
+
+enum SweepColumn {
+    SWEEP_COLUMN_CHANNEL = 0,
+    SWEEP_COLUMN_SWITCHED,
+    SWEEP_COLUMN_FRAME_RATE,
+    SWEEP_COLUMN_PING_RATIO,
+    SWEEP_COLUMN_RTT_P50,
+    SWEEP_COLUMN_RTT_P99,
+    SWEEP_COLUMN_BEST,
+    SWEEP_COLUMN_COUNT
+};
+
+enum IntervalColumn {
+    INTERVAL_COLUMN_SLAVE = 0,
+    INTERVAL_COLUMN_FRAME_RATE,
+    INTERVAL_COLUMN_PER_CYCLE,
+    INTERVAL_COLUMN_REFERENCE,
+    INTERVAL_COLUMN_LOSS,
+    INTERVAL_COLUMN_COUNT
+};
+
+// 全部从机
+constexpr int TARGET_ALL = -1;
+
+QString NsToMs(uint64_t ns)
+{
+    return QString::number(ns / 1000000.0, 'f', 2);
+}
+
+QString SlaveIdToString(uint32_t slaveId)
+{
+    return QString("0x%1").arg(slaveId, 8, 16, QChar('0')).toUpper();
+}
+}
+
+LinkQualityWidget::LinkQualityWidget(PingEngine *pPingEngine, ChannelSweeper *pChannelSweeper,
+                                     IntervalController *pIntervalController, QWidget *parent)
+    : QWidget(parent)
+    , m_pPingEngine(pPingEngine)
+    , m_pChannelSweeper(pChannelSweeper)
+    , m_pIntervalController(pIntervalController)
+    , m_pComboBoxTarget(nullptr)
+    , m_pSpinBoxCount(nullptr)
+    , m_pSpinBoxInterval(nullptr)
+    , m_pSpinBoxRounds(nullptr)
+    , m_pSpinBoxMode(nullptr)
+    , m_pPushButtonStart(nullptr)
+    , m_pPushButtonStop(nullptr)
+    , m_pPushButtonReset(nullptr)
+    , m_pLabelStatus(nullptr)
+    , m_pTableWidgetPing(nullptr)
+    , m_pSpinBoxFirstChannel(nullptr)
+    , m_pSpinBoxLastChannel(nullptr)
+    , m_pSpinBoxSettle(nullptr)
+    , m_pSpinBoxMeasure(nullptr)
+    , m_pCheckBoxApplyBest(nullptr)
+    , m_pPushButtonSweepStart(nullptr)
+    , m_pPushButtonSweepStop(nullptr)
+    , m_pLabelSweepStatus(nullptr)
+    , m_pTableWidgetSweep(nullptr)
+    , m_pSpinBoxMinInterval(nullptr)
+    , m_pSpinBoxMaxInterval(nullptr)
+    , m_pSpinBoxInitialInterval(nullptr)
+    , m_pSpinBoxLossThreshold(nullptr)
+    , m_pPushButtonIntervalStart(nullptr)
+    , m_pPushButtonIntervalStop(nullptr)
+    , m_pLabelInterval(nullptr)
+    , m_pLabelIntervalStatus(nullptr)
+    , m_pTableWidgetInterval(nullptr)
+{
+    InitializeUI();
+
+    connect(m_pPingEngine, &PingEngine::StatsChanged, this, &LinkQualityWidget::OnStatsChanged);
+    connect(m_pPingEngine, &PingEngine::Finished, this, &LinkQualityWidget::OnPingFinished);
+    connect(m_pPingEngine, &PingEngine::RunCompleted, this, [this](uint32_t slaveId, bool timedOut) {
+        m_pLabelStatus->setText(QString("%1 %2").arg(SlaveIdToString(slaveId), timedOut ? "超时" : "完成"));
+    });
+    connect(m_pChannelSweeper, &ChannelSweeper::ChannelMeasured, this, &LinkQualityWidget::OnChannelMeasured);
+    connect(m_pChannelSweeper, &ChannelSweeper::Finished, this, &LinkQualityWidget::OnSweepFinished);
+    connect(m_pChannelSweeper, &ChannelSweeper::StatusChanged, m_pLabelSweepStatus, &QLabel::setText);
+    connect(m_pIntervalController, &IntervalController::WindowEvaluated, this, &LinkQualityWidget::OnIntervalWindowEvaluated);
+    connect(m_pIntervalController, &IntervalController::StatusChanged, m_pLabelIntervalStatus, &QLabel::setText);
+    connect(m_pIntervalController, &IntervalController::IntervalChanged, this, [this](uint8_t intervalMs) {
+        m_pLabelInterval->setText(QString("当前间隔: %1 ms").arg(intervalMs));
+    });
+    connect(m_pIntervalController, &IntervalController::Stopped, this, &LinkQualityWidget::UpdateControls);
+
+    UpdateControls();
+}
+
+void LinkQualityWidget::InitializeUI()
+{
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+
+    // Ping 参数
+    QHBoxLayout *pingLayout = new QHBoxLayout();
+    m_pComboBoxTarget = new QComboBox(this);
+    m_pComboBoxTarget->setMinimumWidth(140);
+    m_pComboBoxTarget->addItem("全部从机", TARGET_ALL);
+
+    m_pSpinBoxCount = new QSpinBox(this);
+    m_pSpinBoxCount->setRange(1, 1000);
+    m_pSpinBoxCount->setValue(10);
+
+    m_pSpinBoxInterval = new QSpinBox(this);
+    m_pSpinBoxInterval->setRange(10, 10000);
+    m_pSpinBoxInterval->setValue(100);
+    m_pSpinBoxInterval->setSuffix(" ms");
+
+    m_pSpinBoxRounds = new QSpinBox(this);
+    m_pSpinBoxRounds->setRange(1, 10000);
+    m_pSpinBoxRounds->setValue(1);
+
+    m_pSpinBoxMode = new QSpinBox(this);
+    m_pSpinBoxMode->setRange(0, 255);
+
+    m_pPushButtonStart = new QPushButton("开始Ping", this);
+    m_pPushButtonStop = new QPushButton("停止", this);
+    m_pPushButtonReset = new QPushButton("清空统计", this);
+    m_pLabelStatus = new QLabel(this);
+
+    pingLayout->addWidget(new QLabel("目标:", this));
+    pingLayout->addWidget(m_pComboBoxTarget);
+    pingLayout->addWidget(new QLabel("次数:", this));
+    pingLayout->addWidget(m_pSpinBoxCount);
+    pingLayout->addWidget(new QLabel("间隔:", this));
+    pingLayout->addWidget(m_pSpinBoxInterval);
+    pingLayout->addWidget(new QLabel("轮数:", this));
+    pingLayout->addWidget(m_pSpinBoxRounds);
+    pingLayout->addWidget(new QLabel("模式:", this));
+    pingLayout->addWidget(m_pSpinBoxMode);
+    pingLayout->addWidget(m_pPushButtonStart);
+    pingLayout->addWidget(m_pPushButtonStop);
+    pingLayout->addWidget(m_pPushButtonReset);
+    pingLayout->addSpacing(20);
+    pingLayout->addWidget(m_pLabelStatus);
+    pingLayout->addStretch();
+    mainLayout->addLayout(pingLayout);
+
+    // 每个从机的统计
+    m_pTableWidgetPing = new QTableWidget(0, PING_COLUMN_COUNT, this);
+    QStringList headers;
+    headers << "从机ID" << "轮数" << "超时" << "发送" << "成功" << "成功率"
+            << "近期成功率" << "RTT p50 (ms)" << "RTT p99 (ms)" << "RTT max (ms)"
+            << "整轮耗时 p50 (ms)" << "序号缺口";
+    m_pTableWidgetPing->setHorizontalHeaderLabels(headers);
+    m_pTableWidgetPing->verticalHeader()->setVisible(false);
+    m_pTableWidgetPing->horizontalHeader()->setStretchLastSection(true);
+    m_pTableWidgetPing->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_pTableWidgetPing->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_pTableWidgetPing->setAlternatingRowColors(true);
+    mainLayout->addWidget(m_pTableWidgetPing, 3);
+
+    // UWB 信道扫描（Ping 参数沿用上方设置，每个信道 1 轮）
+    QGroupBox *sweepGroup = new QGroupBox("UWB信道扫描", this);
+    QVBoxLayout *sweepGroupLayout = new QVBoxLayout(sweepGroup);
+    QHBoxLayout *sweepLayout = new QHBoxLayout();
+
+    m_pSpinBoxFirstChannel = new QSpinBox(sweepGroup);
+    m_pSpinBoxFirstChannel->setRange(ChannelSweeper::MIN_CHANNEL, ChannelSweeper::MAX_CHANNEL);
+    m_pSpinBoxFirstChannel->setValue(ChannelSweeper::MIN_CHANNEL);
+    m_pSpinBoxLastChannel = new QSpinBox(sweepGroup);
+    m_pSpinBoxLastChannel->setRange(ChannelSweeper::MIN_CHANNEL, ChannelSweeper::MAX_CHANNEL);
+    m_pSpinBoxLastChannel->setValue(ChannelSweeper::MAX_CHANNEL);
+
+    m_pSpinBoxSettle = new QSpinBox(sweepGroup);
+    m_pSpinBoxSettle->setRange(0, 60000);
+    m_pSpinBoxSettle->setValue(1000);
+    m_pSpinBoxSettle->setSuffix(" ms");
+
+    m_pSpinBoxMeasure = new QSpinBox(sweepGroup);
+    m_pSpinBoxMeasure->setRange(1, 600);
+    m_pSpinBoxMeasure->setValue(5);
+    m_pSpinBoxMeasure->setSuffix(" s");
+
+    m_pCheckBoxApplyBest = new QCheckBox("完成后切换到最佳信道", sweepGroup);
+    m_pCheckBoxApplyBest->setChecked(true);
+    m_pCheckBoxApplyBest->setToolTip("不勾选时只给出推荐，并恢复扫描前的信道");
+
+    m_pPushButtonSweepStart = new QPushButton("开始扫描", sweepGroup);
+    m_pPushButtonSweepStop = new QPushButton("停止扫描", sweepGroup);
+    m_pLabelSweepStatus = new QLabel(sweepGroup);
+
+    sweepLayout->addWidget(new QLabel("信道:", sweepGroup));
+    sweepLayout->addWidget(m_pSpinBoxFirstChannel);
+    sweepLayout->addWidget(new QLabel("-", sweepGroup));
+    sweepLayout->addWidget(m_pSpinBoxLastChannel);
+    sweepLayout->addWidget(new QLabel("稳定:", sweepGroup));
+    sweepLayout->addWidget(m_pSpinBoxSettle);
+    sweepLayout->addWidget(new QLabel("测量:", sweepGroup));
+    sweepLayout->addWidget(m_pSpinBoxMeasure);
+    sweepLayout->addWidget(m_pCheckBoxApplyBest);
+    sweepLayout->addWidget(m_pPushButtonSweepStart);
+    sweepLayout->addWidget(m_pPushButtonSweepStop);
+    sweepLayout->addSpacing(20);
+    sweepLayout->addWidget(m_pLabelSweepStatus);
+    sweepLayout->addStretch();
+    sweepGroupLayout->addLayout(sweepLayout);
+
+    m_pTableWidgetSweep = new QTableWidget(0, SWEEP_COLUMN_COUNT, sweepGroup);
+    QStringList sweepHeaders;
+    sweepHeaders << "信道" << "切换" << "导通帧/s" << "Ping成功率" << "RTT p50 (ms)" << "RTT p99 (ms)" << "推荐";
+    m_pTableWidgetSweep->setHorizontalHeaderLabels(sweepHeaders);
+    m_pTableWidgetSweep->verticalHeader()->setVisible(false);
+    m_pTableWidgetSweep->horizontalHeader()->setStretchLastSection(true);
+    m_pTableWidgetSweep->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_pTableWidgetSweep->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_pTableWidgetSweep->setAlternatingRowColors(true);
+    sweepGroupLayout->addWidget(m_pTableWidgetSweep);
+    mainLayout->addWidget(sweepGroup, 2);
+
+    // 采集间隔自适应
+    QGroupBox *intervalGroup = new QGroupBox("采集间隔自适应", this);
+    QVBoxLayout *intervalGroupLayout = new QVBoxLayout(intervalGroup);
+    QHBoxLayout *intervalLayout = new QHBoxLayout();
+
+    IntervalController::Config defaults;
+    m_pSpinBoxMinInterval = new QSpinBox(intervalGroup);
+    m_pSpinBoxMinInterval->setRange(1, 255);
+    m_pSpinBoxMinInterval->setValue(defaults.minIntervalMs);
+    m_pSpinBoxMinInterval->setSuffix(" ms");
+    m_pSpinBoxMaxInterval = new QSpinBox(intervalGroup);
+    m_pSpinBoxMaxInterval->setRange(1, 255);
+    m_pSpinBoxMaxInterval->setValue(defaults.maxIntervalMs);
+    m_pSpinBoxMaxInterval->setSuffix(" ms");
+    m_pSpinBoxInitialInterval = new QSpinBox(intervalGroup);
+    m_pSpinBoxInitialInterval->setRange(1, 255);
+    m_pSpinBoxInitialInterval->setValue(defaults.initialIntervalMs);
+    m_pSpinBoxInitialInterval->setSuffix(" ms");
+
+    m_pSpinBoxLossThreshold = new QSpinBox(intervalGroup);
+    m_pSpinBoxLossThreshold->setRange(1, 50);
+    m_pSpinBoxLossThreshold->setValue(static_cast<int>(defaults.lossThreshold * 100));
+    m_pSpinBoxLossThreshold->setSuffix(" %");
+    m_pSpinBoxLossThreshold->setToolTip("任一从机的导通帧丢失率超过该值，或出现重组超时/socket丢包时退避");
+
+    m_pPushButtonIntervalStart = new QPushButton("开始自适应", intervalGroup);
+    m_pPushButtonIntervalStop = new QPushButton("停止自适应", intervalGroup);
+    m_pLabelInterval = new QLabel("当前间隔: -", intervalGroup);
+    m_pLabelIntervalStatus = new QLabel(intervalGroup);
+
+    intervalLayout->addWidget(new QLabel("范围:", intervalGroup));
+    intervalLayout->addWidget(m_pSpinBoxMinInterval);
+    intervalLayout->addWidget(new QLabel("-", intervalGroup));
+    intervalLayout->addWidget(m_pSpinBoxMaxInterval);
+    intervalLayout->addWidget(new QLabel("初始:", intervalGroup));
+    intervalLayout->addWidget(m_pSpinBoxInitialInterval);
+    intervalLayout->addWidget(new QLabel("丢失阈值:", intervalGroup));
+    intervalLayout->addWidget(m_pSpinBoxLossThreshold);
+    intervalLayout->addWidget(m_pPushButtonIntervalStart);
+    intervalLayout->addWidget(m_pPushButtonIntervalStop);
+    intervalLayout->addSpacing(20);
+    intervalLayout->addWidget(m_pLabelInterval);
+    intervalLayout->addSpacing(20);
+    intervalLayout->addWidget(m_pLabelIntervalStatus);
+    intervalLayout->addStretch();
+    intervalGroupLayout->addLayout(intervalLayout);
+
+    m_pTableWidgetInterval = new QTableWidget(0, INTERVAL_COLUMN_COUNT, intervalGroup);
+    QStringList intervalHeaders;
+    intervalHeaders << "从机ID" << "导通帧/s" << "每周期帧数" << "参考值" << "丢失率";
+    m_pTableWidgetInterval->setHorizontalHeaderLabels(intervalHeaders);
+    m_pTableWidgetInterval->verticalHeader()->setVisible(false);
+    m_pTableWidgetInterval->horizontalHeader()->setStretchLastSection(true);
+    m_pTableWidgetInterval->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_pTableWidgetInterval->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_pTableWidgetInterval->setAlternatingRowColors(true);
+    intervalGroupLayout->addWidget(m_pTableWidgetInterval);
+    mainLayout->addWidget(intervalGroup, 2);
+
+    connect(m_pPushButtonStart, &QPushButton::clicked, this, &LinkQualityWidget::OnStartClicked);
+    connect(m_pPushButtonStop, &QPushButton::clicked, this, &LinkQualityWidget::OnStopClicked);
+    connect(m_pPushButtonReset, &QPushButton::clicked, this, &LinkQualityWidget::OnResetClicked);
+    connect(m_pPushButtonSweepStart, &QPushButton::clicked, this, &LinkQualityWidget::OnSweepStartClicked);
+    connect(m_pPushButtonSweepStop, &QPushButton::clicked, this, &LinkQualityWidget::OnSweepStopClicked);
+    connect(m_pPushButtonIntervalStart, &QPushButton::clicked, this, &LinkQualityWidget::OnIntervalStartClicked);
+    connect(m_pPushButtonIntervalStop, &QPushButton::clicked, this, &LinkQualityWidget::OnIntervalStopClicked);
+}
+
+void LinkQualityWidget::SetSlaveIds(const QList<uint32_t> &slaveIds)
+{
+    if (slaveIds == m_slaveIds) {
+        return;
+    }
+    m_slaveIds = slaveIds;
+
+    QVariant current = m_pComboBoxTarget->currentData();
+    m_pComboBoxTarget->clear();
+    m_pComboBoxTarget->addItem("全部从机", TARGET_ALL);
+    for (uint32_t slaveId : slaveIds) {
+        m_pComboBoxTarget->addItem(SlaveIdToString(slaveId), QVariant::fromValue<qlonglong>(slaveId));
+    }
+    int index = m_pComboBoxTarget->findData(current);
+    m_pComboBoxTarget->setCurrentIndex(index >= 0 ? index : 0);
+}
+
+void LinkQualityWidget::UpdateControls()
+{
+    bool sweeping = m_pChannelSweeper->IsRunning();
+    bool busy = sweeping || m_pPingEngine->IsRunning();
+    bool adapting = m_pIntervalController->IsRunning();
+
+    m_pPushButtonStart->setEnabled(!busy);
+    m_pPushButtonStop->setEnabled(busy && !sweeping);
+    m_pComboBoxTarget->setEnabled(!busy);
+    m_pSpinBoxCount->setEnabled(!busy);
+    m_pSpinBoxInterval->setEnabled(!busy);
+    m_pSpinBoxRounds->setEnabled(!busy);
+    m_pSpinBoxMode->setEnabled(!busy);
+
+    // 信道扫描与间隔自适应都会改变链路，不同时进行
+    m_pPushButtonSweepStart->setEnabled(!busy && !adapting);
+    m_pPushButtonSweepStop->setEnabled(sweeping);
+    m_pSpinBoxFirstChannel->setEnabled(!busy);
+    m_pSpinBoxLastChannel->setEnabled(!busy);
+    m_pSpinBoxSettle->setEnabled(!busy);
+    m_pSpinBoxMeasure->setEnabled(!busy);
+    m_pCheckBoxApplyBest->setEnabled(!busy);
+
+    m_pPushButtonIntervalStart->setEnabled(!adapting && !sweeping);
+    m_pPushButtonIntervalStop->setEnabled(adapting);
+    m_pSpinBoxMinInterval->setEnabled(!adapting);
+    m_pSpinBoxMaxInterval->setEnabled(!adapting);
+    m_pSpinBoxInitialInterval->setEnabled(!adapting);
+    m_pSpinBoxLossThreshold->setEnabled(!adapting);
+}
+
+std::vector<uint32_t> LinkQualityWidget::SelectedTargets() const
+{
+    std::vector<uint32_t> targets;
+    qlonglong target = m_pComboBoxTarget->currentData().toLongLong();
+    if (target == TARGET_ALL) {
+        targets.assign(m_slaveIds.begin(), m_slaveIds.end());
+    } else {
+        targets.push_back(static_cast<uint32_t>(target));
+    }
+    return targets;
+}
+
+PingEngine::Config LinkQualityWidget::PingConfig() const
+{
+    PingEngine::Config config;
+    config.pingMode = static_cast<uint8_t>(m_pSpinBoxMode->value());
+    config.pingCount = static_cast<uint16_t>(m_pSpinBoxCount->value());
+    config.intervalMs = static_cast<uint16_t>(m_pSpinBoxInterval->value());
+    config.rounds = m_pSpinBoxRounds->value();
+    return config;
+}
+
+void LinkQualityWidget::OnStartClicked()
+{
+    std::vector<uint32_t> targets = SelectedTargets();
+    if (targets.empty()) {
+        QMessageBox::warning(this, "警告", "没有可Ping的从机，请先在设备管理中查询设备列表");
+        return;
+    }
+
+    if (!m_pPingEngine->Start(targets, PingConfig())) {
+        QMessageBox::warning(this, "警告", "Ping启动失败，请确认UDP已连接");
+        return;
+    }
+    m_pLabelStatus->setText(QString("正在Ping %1 个从机").arg(targets.size()));
+    UpdateControls();
+}
+
+void LinkQualityWidget::OnStopClicked()
+{
+    m_pPingEngine->Stop();
+}
+
+void LinkQualityWidget::OnResetClicked()
+{
+    m_pPingEngine->ResetStats();
+}
+
+void LinkQualityWidget::OnPingFinished()
+{
+    m_pLabelStatus->setText("Ping结束");
+    UpdateControls();
+}
+
+void LinkQualityWidget::OnStatsChanged()
+{
+    const auto allStats = m_pPingEngine->AllStats();
+    m_pTableWidgetPing->setRowCount(static_cast<int>(allStats.size()));
+
+    for (int row = 0; row < static_cast<int>(allStats.size()); ++row) {
+        const PingSlaveStats *stats = allStats[row];
+        QStringList cells;
+        cells << SlaveIdToString(stats->slaveId)
+              << QString::number(stats->runs)
+              << QString::number(stats->timeouts)
+              << QString::number(stats->sent)
+              << QString::number(stats->succeeded)
+              << QString("%1%").arg(stats->SuccessRatio() * 100.0, 0, 'f', 1)
+              << QString("%1%").arg(stats->RecentSuccessRatio() * 100.0, 0, 'f', 1)
+              << NsToMs(stats->rttNs.percentile(50.0))
+              << NsToMs(stats->rttNs.percentile(99.0))
+              << NsToMs(stats->rttNs.max())
+              << NsToMs(stats->runLatencyNs.percentile(50.0))
+              << QString::number(stats->sequenceGaps);
+
+        for (int column = 0; column < PING_COLUMN_COUNT; ++column) {
+            QTableWidgetItem *item = m_pTableWidgetPing->item(row, column);
+            if (!item) {
+                item = new QTableWidgetItem();
+                if (column > PING_COLUMN_SLAVE) {
+                    item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+                }
+                m_pTableWidgetPing->setItem(row, column, item);
+            }
+            item->setText(cells[column]);
+        }
+    }
+}
+
+void LinkQualityWidget::OnSweepStartClicked()
+{
+    if (m_slaveIds.isEmpty()) {
+        QMessageBox::warning(this, "警告", "没有在线从机，请先在设备管理中查询设备列表");
+        return;
+    }
+    if (m_pSpinBoxFirstChannel->value() > m_pSpinBoxLastChannel->value()) {
+        QMessageBox::warning(this, "警告", "起始信道不能大于结束信道");
+        return;
+    }
+
+    ChannelSweeper::Config config;
+    config.firstChannel = static_cast<uint8_t>(m_pSpinBoxFirstChannel->value());
+    config.lastChannel = static_cast<uint8_t>(m_pSpinBoxLastChannel->value());
+    config.settleMs = m_pSpinBoxSettle->value();
+    config.minMeasureMs = m_pSpinBoxMeasure->value() * 1000;
+    config.applyBest = m_pCheckBoxApplyBest->isChecked();
+    config.ping = PingConfig();
+    config.ping.rounds = 1;
+
+    // 始终对全部在线从机测量
+    std::vector<uint32_t> targets(m_slaveIds.begin(), m_slaveIds.end());
+    m_pTableWidgetSweep->setRowCount(0);
+    if (!m_pChannelSweeper->Start(targets, config)) {
+        QMessageBox::warning(this, "警告", "信道扫描启动失败，请确认UDP已连接且没有正在进行的Ping");
+        return;
+    }
+    UpdateControls();
+}
+
+void LinkQualityWidget::OnSweepStopClicked()
+{
+    m_pChannelSweeper->Stop();
+}
+
+void LinkQualityWidget::OnChannelMeasured(int index)
+{
+    const auto &results = m_pChannelSweeper->Results();
+    if (index < 0 || index >= static_cast<int>(results.size())) {
+        return;
+    }
+
+    const ChannelSweeper::ChannelResult &result = results[index];
+    m_pTableWidgetSweep->setRowCount(static_cast<int>(results.size()));
+
+    QStringList cells;
+    cells << QString::number(result.channel)
+          << (result.switched ? "成功" : "失败")
+          << QString::number(result.framesPerSecond, 'f', 1)
+          << (result.pingSent ? QString("%1%").arg((1.0 - result.LossRatio()) * 100.0, 0, 'f', 1) : QString("-"))
+          << NsToMs(result.rttNs.percentile(50.0))
+          << NsToMs(result.rttNs.percentile(99.0))
+          << QString();
+
+    for (int column = 0; column < SWEEP_COLUMN_COUNT; ++column) {
+        QTableWidgetItem *item = new QTableWidgetItem(cells[column]);
+        if (column > SWEEP_COLUMN_SWITCHED) {
+            item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+        }
+        m_pTableWidgetSweep->setItem(index, column, item);
+    }
+}
+
+void LinkQualityWidget::OnSweepFinished(bool completed, uint8_t bestChannel)
+{
+    Q_UNUSED(completed)
+
+    // 标记推荐信道
+    const auto &results = m_pChannelSweeper->Results();
+    for (int row = 0; row < m_pTableWidgetSweep->rowCount() && row < static_cast<int>(results.size()); ++row) {
+        QTableWidgetItem *item = m_pTableWidgetSweep->item(row, SWEEP_COLUMN_BEST);
+        if (item) {
+            item->setText(results[row].channel == bestChannel ? "★" : QString());
+        }
+    }
+    UpdateControls();
+}
+
+void LinkQualityWidget::OnIntervalStartClicked()
+{
+    if (m_slaveIds.isEmpty()) {
+        QMessageBox::warning(this, "警告", "没有在线从机，请先在设备管理中查询设备列表");
+        return;
+    }
+    if (m_pSpinBoxMinInterval->value() > m_pSpinBoxMaxInterval->value()) {
+        QMessageBox::warning(this, "警告", "最小间隔不能大于最大间隔");
+        return;
+    }
+
+    IntervalController::Config config;
+    config.minIntervalMs = static_cast<uint8_t>(m_pSpinBoxMinInterval->value());
+    config.maxIntervalMs = static_cast<uint8_t>(m_pSpinBoxMaxInterval->value());
+    config.initialIntervalMs = static_cast<uint8_t>(m_pSpinBoxInitialInterval->value());
+    config.lossThreshold = m_pSpinBoxLossThreshold->value() / 100.0;
+
+    std::vector<uint32_t> targets(m_slaveIds.begin(), m_slaveIds.end());
+    m_pTableWidgetInterval->setRowCount(0);
+    if (!m_pIntervalController->Start(targets, config)) {
+        QMessageBox::warning(this, "警告", "自适应启动失败，请确认UDP已连接");
+        return;
+    }
+    UpdateControls();
+}
+
+void LinkQualityWidget::OnIntervalStopClicked()
+{
+    m_pIntervalController->Stop();
+}
+
+void LinkQualityWidget::OnIntervalWindowEvaluated()
+{
+    const auto &slaves = m_pIntervalController->SlaveLoads();
+    m_pTableWidgetInterval->setRowCount(static_cast<int>(slaves.size()));
+
+    for (int row = 0; row < static_cast<int>(slaves.size()); ++row) {
+        const IntervalController::SlaveLoad &slave = slaves[row];
+        QStringList cells;
+        cells << SlaveIdToString(slave.slaveId)
+              << QString::number(slave.framesPerSecond, 'f', 1)
+              << QString::number(slave.framesPerCycle, 'f', 2)
+              << QString::number(slave.referencePerCycle, 'f', 2)
+              << QString("%1%").arg(slave.lossRatio * 100.0, 0, 'f', 1);
+
+        for (int column = 0; column < INTERVAL_COLUMN_COUNT; ++column) {
+            QTableWidgetItem *item = m_pTableWidgetInterval->item(row, column);
+            if (!item) {
+                item = new QTableWidgetItem();
+                if (column > INTERVAL_COLUMN_SLAVE) {
+                    item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+                }
+                m_pTableWidgetInterval->setItem(row, column, item);
+            }
+            item->setText(cells[column]);
+        }
+    }
+
+    const IntervalController::WindowReport &report = m_pIntervalController->LastReport();
+    QString saturation = m_pIntervalController->SaturationInterval()
+                             ? QString("，饱和点 %1 ms").arg(m_pIntervalController->SaturationInterval())
+                             : QString();
+    m_pLabelInterval->setText(QString("当前间隔: %1 ms%2").arg(report.intervalMs).arg(saturation));
+    m_pTableWidgetInterval->setToolTip(QString("上一窗口 %1 s：重组超时 %2，socket丢包 %3，缓冲区溢出 %4")
+                                           .arg(report.seconds, 0, 'f', 1)
+                                           .arg(report.expiredFragments)
+                                           .arg(report.socketDrops)
+                                           .arg(report.bufferOverflows));
+}
@@ -0,0 +1,90 @@
+#ifndef LINKQUALITYWIDGET_H
+#define LINKQUALITYWIDGET_H
+
+#include <QWidget>
+#include <QTableWidget>
+#include <QPushButton>
+#include <QComboBox>
+#include <QSpinBox>
+#include <QLabel>
+#include <QCheckBox>
+
+#include "pingengine.h"
+#include "channelsweeper.h"
+#include "intervalcontroller.h"
+
+// 链路质量面板：发起 Ping 测试并按从机显示成功率与 RTT 分布，
+// 以及 UWB 信道扫描和采集间隔自适应
+class LinkQualityWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    LinkQualityWidget(PingEngine *pPingEngine, ChannelSweeper *pChannelSweeper,
+                      IntervalController *pIntervalController, QWidget *parent = nullptr);
+
+public slots:
+    // 可选的 Ping 目标（通常来自设备列表中的在线从机）
+    void SetSlaveIds(const QList<uint32_t> &slaveIds);
+
+private slots:
+    void OnStartClicked();
+    void OnStopClicked();
+    void OnResetClicked();
+    void OnStatsChanged();
+    void OnPingFinished();
+    void OnSweepStartClicked();
+    void OnSweepStopClicked();
+    void OnChannelMeasured(int index);
+    void OnSweepFinished(bool completed, uint8_t bestChannel);
+    void OnIntervalStartClicked();
+    void OnIntervalStopClicked();
+    void OnIntervalWindowEvaluated();
+
+private:
+    void InitializeUI();
+    void UpdateControls();
+    std::vector<uint32_t> SelectedTargets() const;
+    PingEngine::Config PingConfig() const;
+
+private:
+    PingEngine *m_pPingEngine;
+    ChannelSweeper *m_pChannelSweeper;
+    IntervalController *m_pIntervalController;
+    QList<uint32_t> m_slaveIds;
+
+    QComboBox *m_pComboBoxTarget;
+    QSpinBox *m_pSpinBoxCount;
+    QSpinBox *m_pSpinBoxInterval;
+    QSpinBox *m_pSpinBoxRounds;
+    QSpinBox *m_pSpinBoxMode;
+    QPushButton *m_pPushButtonStart;
+    QPushButton *m_pPushButtonStop;
+    QPushButton *m_pPushButtonReset;
+    QLabel *m_pLabelStatus;
+    QTableWidget *m_pTableWidgetPing;
+
+    // 信道扫描
+    QSpinBox *m_pSpinBoxFirstChannel;
+    QSpinBox *m_pSpinBoxLastChannel;
+    QSpinBox *m_pSpinBoxSettle;
+    QSpinBox *m_pSpinBoxMeasure;
+    QCheckBox *m_pCheckBoxApplyBest;
+    QPushButton *m_pPushButtonSweepStart;
+    QPushButton *m_pPushButtonSweepStop;
+    QLabel *m_pLabelSweepStatus;
+    QTableWidget *m_pTableWidgetSweep;
+
+    // 采集间隔自适应
+    QSpinBox *m_pSpinBoxMinInterval;
+    QSpinBox *m_pSpinBoxMaxInterval;
+    QSpinBox *m_pSpinBoxInitialInterval;
+    QSpinBox *m_pSpinBoxLossThreshold;
+    QPushButton *m_pPushButtonIntervalStart;
+    QPushButton *m_pPushButtonIntervalStop;
+    QLabel *m_pLabelInterval;
+    QLabel *m_pLabelIntervalStatus;
+    QTableWidget *m_pTableWidgetInterval;
+};
+
+#endif // LINKQUALITYWIDGET_H
@@ -11,18 +11,194 @@ MainWindow::MainWindow(QWidget *parent)
     , m_pLogFile(nullptr)
     , m_pLogStream(nullptr)
     , m_pProtocolProcessor(nullptr)
+    , m_pReliableSender(nullptr)
+    , m_pReliableTimer(nullptr)
+    , m_pTransmitScheduler(nullptr)
+    , m_pTransmitTimer(nullptr)
+    , m_pCommandEngine(nullptr)
+    , m_pTestSequenceEngine(nullptr)
+    , m_pTestSequenceWidget(nullptr)
+    , m_pPipelineStatsWidget(nullptr)
+    , m_pLabelPipelineSummary(nullptr)
+    , m_pPingEngine(nullptr)
+    , m_pChannelSweeper(nullptr)
+    , m_pIntervalController(nullptr)
+    , m_pLinkQualityWidget(nullptr)
+    , m_pDeviceTableModel(nullptr)
+    , m_pDeviceRegistryTimer(nullptr)
+    , m_deviceRegistryVersion(0)
+    , m_pLabelFleetSummary(nullptr)
     , m_pSettings(nullptr)
+    , m_pAlarmWidget(nullptr)
+    , m_pPinFlipWidget(nullptr)
+    , m_pResistanceWidget(nullptr)
+    , m_pClipWidget(nullptr)
+    , m_pHistoryWidget(nullptr)
     , m_bDataViewRunning(false)
+    , m_bAcquisitionRunning(false)
+    , m_bStopPending(false)
 {
     ui->setupUi(this);
     InitializeUI();
+    WhtsProtocol::TraceRecorder::instance().setThreadName("GUI");
     
     // 创建协议处理器
     m_pProtocolProcessor = new WhtsProtocol::ProtocolProcessor();
     
+    // 控制命令的应答越过同一批收到的数据帧优先处理
+    m_pProtocolProcessor->setPriorityMessage(WhtsProtocol::PacketId::MASTER_TO_BACKEND,
+        static_cast<uint8_t>(WhtsProtocol::Master2BackendMessageId::CTRL_RSP_MSG));
+    m_pProtocolProcessor->setPriorityMessage(WhtsProtocol::PacketId::MASTER_TO_BACKEND,
+        static_cast<uint8_t>(WhtsProtocol::Master2BackendMessageId::RST_RSP_MSG));
+    
+    // 创建分通道发送调度: 控制命令严格优先, 配置和诊断流量限速
+    m_pTransmitScheduler = new WhtsProtocol::TransmitScheduler(
+        [this](const std::vector<uint8_t> &frame) { return WriteFrame(frame); });
+    m_pTransmitTimer = new QTimer(this);
+    m_pTransmitTimer->setSingleShot(true);
+    connect(m_pTransmitTimer, &QTimer::timeout, this, &MainWindow::OnTransmitTimer);
+    
+    // 创建可靠分片发送器, 有消息在途时由定时器驱动超时重传
+    // 分片走不限速的控制通道: 入队即写出, 发送端记录的轮次时间即实际发送时间,
+    // RTT/RTO 不含本地排队; 入队或写出失败都回报给发送端, 不当作网络丢包
+    m_pReliableSender = new WhtsProtocol::ReliableSender(*m_pProtocolProcessor,
+        [this](const std::vector<uint8_t> &frame) {
+            const auto lane = WhtsProtocol::TransmitLane::CONTROL;
+            uint64_t dropped = m_pTransmitScheduler->stats(lane).dropped;
+            return EnqueueFrames(lane, {frame}) && m_pTransmitScheduler->stats(lane).dropped == dropped;
+        });
+    m_pReliableSender->setCompletion([this](const WhtsProtocol::ReliableSender::Result &result) {
+        if (result.delivered) {
+            LogMessage(QString("可靠分片发送完成 (ID=%1): %2 个分片, 重传 %3 个, %4 轮, 耗时 %5 ms, RTO %6 ms")
+                      .arg(result.reliableId)
+                      .arg(result.fragments)
+                      .arg(result.retransmittedFragments)
+                      .arg(result.rounds)
+                      .arg(result.elapsedMs)
+                      .arg(m_pReliableSender->rtoMs()), "INFO");
+        } else {
+            LogMessage(QString("可靠分片发送失败 (ID=%1): %2 个分片, %3 轮后仍未确认")
+                      .arg(result.reliableId)
+                      .arg(result.fragments)
+                      .arg(result.rounds), "ERROR");
+        }
+    });
+    m_pReliableTimer = new QTimer(this);
+    m_pReliableTimer->setInterval(RELIABLE_POLL_INTERVAL_MS);
+    connect(m_pReliableTimer, &QTimer::timeout, this, &MainWindow::OnReliableTimer);
+    
+    // 创建管线统计面板
+    m_pPipelineStatsWidget = new PipelineStatsWidget(&m_pProtocolProcessor->getStats(), &m_latencyTracker,
+                                                     &m_sequenceTracker, this);
+    ui->tabWidget->addTab(m_pPipelineStatsWidget, "链路统计");
+    m_pLabelPipelineSummary = new QLabel(this);
+    statusBar()->addPermanentWidget(m_pLabelPipelineSummary);
+    connect(m_pPipelineStatsWidget, &PipelineStatsWidget::SummaryChanged,
+            m_pLabelPipelineSummary, &QLabel::setText);
+    
+    // 创建命令层（请求/应答匹配、超时重发）
+    m_pCommandEngine = new CommandEngine(this);
+    m_pCommandEngine->SetSender([this](const WhtsProtocol::Message &message) {
+        return SendBackend2MasterMessage(message);
+    });
+    connect(m_pCommandEngine, &CommandEngine::CommandFailed, this,
+            [this](const QString &messageType, const QString &reason, int attempts) {
+        LogMessage(QString("%1 %2 (发送 %3 次)").arg(messageType, reason).arg(attempts), "ERROR");
+    });
+    
+    // 创建Ping引擎和链路质量面板
+    m_pPingEngine = new PingEngine(this);
+    m_pPingEngine->SetSender([this](const WhtsProtocol::Message &message) {
+        return SendBackend2MasterMessage(message);
+    });
+    m_pChannelSweeper = new ChannelSweeper(m_pPingEngine, m_pCommandEngine, this);
+    m_pIntervalController = new IntervalController(&m_pProtocolProcessor->getStats(), m_pCommandEngine, this);
+    m_pLinkQualityWidget = new LinkQualityWidget(m_pPingEngine, m_pChannelSweeper, m_pIntervalController, this);
+    ui->tabWidget->addTab(m_pLinkQualityWidget, "链路质量");
+    
+    // 创建测试序列引擎和面板
+    m_pTestSequenceEngine = new TestSequenceEngine(m_pCommandEngine, this);
+    connect(m_pTestSequenceEngine, &TestSequenceEngine::Finished, this,
+            [this](bool passed, const QString &summary, qint64 elapsedMs) {
+        LogMessage(QString("测试序列 %1，总耗时 %2 ms").arg(summary).arg(elapsedMs), passed ? "INFO" : "ERROR");
+    });
+    connect(m_pTestSequenceEngine, &TestSequenceEngine::AcquisitionChanged, this, [this](bool running) {
+        SetAcquisitionRunning(running);
+        LogMessage(running ? "测试序列已启动采集" : "测试序列已停止采集", "INFO");
+    });
+    m_pTestSequenceWidget = new TestSequenceWidget(m_pTestSequenceEngine, &m_slaveConfigs, this);
+    ui->tabWidget->addTab(m_pTestSequenceWidget, "测试序列");
+    
+    // 设备注册表: 按数据帧和设备列表维护在线状态，定时推进时间轮并按需补发设备列表请求
+    m_deviceRegistry.setListener([this](const WhtsProtocol::DeviceRegistry::Record &record,
+                                        WhtsProtocol::DeviceLiveness previous) {
+        if (record.liveness == WhtsProtocol::DeviceLiveness::OFFLINE) {
+            LogMessage(QString("从机 0x%1 离线").arg(record.slaveId, 8, 16, QChar('0')).toUpper(), "WARN");
+        } else if (previous == WhtsProtocol::DeviceLiveness::OFFLINE &&
+                   record.liveness == WhtsProtocol::DeviceLiveness::ONLINE) {
+            LogMessage(QString("从机 0x%1 恢复在线").arg(record.slaveId, 8, 16, QChar('0')).toUpper(), "INFO");
+        }
+    });
+    m_pDeviceRegistryTimer = new QTimer(this);
+    m_pDeviceRegistryTimer->setInterval(DEVICE_REGISTRY_INTERVAL_MS);
+    connect(m_pDeviceRegistryTimer, &QTimer::timeout, this, &MainWindow::OnDeviceRegistryTimer);
+    m_pLabelFleetSummary = new QLabel(this);
+    statusBar()->addPermanentWidget(m_pLabelFleetSummary);
+    
+    // 状态位只在变化时记录日志和刷新数据查看表
+    m_deviceStatusTracker.subscribe([this](const WhtsProtocol::DeviceStatusEdge &edge) {
+        OnDeviceStatusEdge(edge);
+    });
+    
+    // 创建告警规则面板，规则要求时告警后停止采集
+    m_pAlarmWidget = new AlarmWidget(&m_ruleEngine, this);
+    ui->tabWidget->addTab(m_pAlarmWidget, "告警规则");
+    m_ruleEngine.setListener([this](const WhtsProtocol::RuleEngine::Alarm &alarm) {
+        const WhtsProtocol::RuleEngine::Rule &rule = m_ruleEngine.rules()[alarm.rule];
+        QString slave = QString("0x%1").arg(alarm.slaveId, 8, 16, QChar('0')).toUpper();
+        if (alarm.raised) {
+            LogMessage(QString("告警: %1 - 从机 %2, 导通不一致 %3 位")
+                      .arg(QString::fromStdString(rule.name), slave).arg(alarm.mismatch), "ERROR");
+        } else {
+            LogMessage(QString("告警解除: %1 - 从机 %2, 持续 %3 ms")
+                      .arg(QString::fromStdString(rule.name), slave).arg(alarm.nowMs - alarm.sinceMs), "INFO");
+        }
+        m_pAlarmWidget->OnAlarm(alarm);
+        // 按主机的采集状态判断（含测试序列启动的采集），同一批告警只下发一次停止
+        if (alarm.raised && rule.stop && m_bConnected && m_bAcquisitionRunning && !m_bStopPending) {
+            LogMessage(QString("告警 %1 触发停止采集").arg(QString::fromStdString(rule.name)), "WARN");
+            m_bStopPending = true;
+            // 先中止测试序列，避免后续步骤重新启动采集；没有收尾的序列在中止时已补发停止
+            m_pTestSequenceEngine->Abort();
+            if (m_bAcquisitionRunning) {
+                OnStopClicked();
+            }
+        }
+    });
+    
+    // 创建间歇故障面板
+    m_pPinFlipWidget = new PinFlipWidget(&m_pinFlipAccumulator, this);
+    ui->tabWidget->addTab(m_pPinFlipWidget, "间歇故障");
+    
     // 创建设置对象
     m_pSettings = new QSettings("WHT", "FactoryTool", this);
     
+    // 创建阻值数据面板（换算系数和上下限保存在设置中）
+    m_pResistanceWidget = new ResistanceWidget(&m_resistanceAccumulator, m_pSettings, this);
+    ui->tabWidget->addTab(m_pResistanceWidget, "阻值数据");
+    
+    // 创建卡钉检测面板
+    m_pClipWidget = new ClipWidget(&m_clipTracker, this);
+    ui->tabWidget->addTab(m_pClipWidget, "卡钉检测");
+    connect(m_pClipWidget, &ClipWidget::StationCompleted, this, [this](uint32_t slaveId, quint64 elapsedMs) {
+        LogMessage(QString("工位 0x%1 卡钉全部插入，耗时 %2 ms")
+                  .arg(slaveId, 8, 16, QChar('0')).toUpper().arg(elapsedMs), "INFO");
+    });
+    
+    // 创建历史数据面板（保留条数保存在设置中）
+    m_pHistoryWidget = new HistoryWidget(&m_sampleHistory, m_pSettings, this);
+    ui->tabWidget->addTab(m_pHistoryWidget, "历史数据");
+    
     // 创建日志文件
     QString logFileName = QString("udp_debug_%1.log").arg(QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss"));
     m_pLogFile = new QFile(logFileName, this);
@@ -43,6 +219,9 @@ MainWindow::~MainWindow()
         delete m_pUdpSocket;
     }
     
+    delete m_pReliableSender;
+    delete m_pTransmitScheduler;
+    
     if (m_pProtocolProcessor) {
         delete m_pProtocolProcessor;
     }
@@ -76,17 +255,21 @@ void MainWindow::InitializeUI()
     // 设置发送框回车键发送
     connect(ui->lineEditSendData, &QLineEdit::returnPressed, this, &MainWindow::OnSendClicked);
     
-    // 初始化设备表格
-    ui->tableWidgetDevices->setColumnWidth(0, 100); // 设备ID
-    ui->tableWidgetDevices->setColumnWidth(1, 80);  // 短ID
-    ui->tableWidgetDevices->setColumnWidth(2, 100); // 在线状态
-    ui->tableWidgetDevices->setColumnWidth(3, 120); // 版本
-    ui->tableWidgetDevices->setColumnWidth(4, 150); // 电池电量
+    // 初始化设备表格（模型按设备ID增量更新，电量列由委托绘制）
+    m_pDeviceTableModel = new DeviceTableModel(this);
+    ui->tableViewDevices->setModel(m_pDeviceTableModel);
+    ui->tableViewDevices->setItemDelegateForColumn(DeviceTableModel::COLUMN_BATTERY, new BatteryItemDelegate(this));
+    ui->tableViewDevices->verticalHeader()->setDefaultSectionSize(26);
+    ui->tableViewDevices->setColumnWidth(DeviceTableModel::COLUMN_DEVICE_ID, 100);
+    ui->tableViewDevices->setColumnWidth(DeviceTableModel::COLUMN_SHORT_ID, 80);
+    ui->tableViewDevices->setColumnWidth(DeviceTableModel::COLUMN_ONLINE, 100);
+    ui->tableViewDevices->setColumnWidth(DeviceTableModel::COLUMN_VERSION, 120);
+    ui->tableViewDevices->setColumnWidth(DeviceTableModel::COLUMN_BATTERY, 150);
     
     // 初始化从机配置表格
     ui->tableWidgetSlaveConfigs->setColumnWidth(0, 150); // 配置名称
     ui->tableWidgetSlaveConfigs->setColumnWidth(1, 200); // 配置信息
-    ui->tableWidgetSlaveConfigs->setColumnWidth(2, 250); // 操作（增加宽度以容纳4个按钮）
+    ui->tableWidgetSlaveConfigs->setColumnWidth(2, 300); // 操作（增加宽度以容纳5个按钮）
     
     // 初始化数据查看表格
     ui->tableWidgetDataView->setColumnWidth(0, 80);  // Slave ID
@@ -118,6 +301,11 @@ void MainWindow::OnConnectClicked()
     m_remoteAddress = QHostAddress(ui->lineEditRemoteIP->text());
     m_remotePort = ui->lineEditRemotePort->text().toUShort();
     
+    // 每次连接重新协商帧校验尾
+    static const WhtsProtocol::CrcMode crcModes[] = {WhtsProtocol::CrcMode::AUTO, WhtsProtocol::CrcMode::OFF,
+                                                     WhtsProtocol::CrcMode::ON};
+    m_pProtocolProcessor->setCrcMode(crcModes[ui->comboBoxFrameCrc->currentIndex()]);
+    
     // 创建UDP socket
     m_pUdpSocket = new QUdpSocket(this);
     
@@ -135,6 +323,28 @@ void MainWindow::OnConnectClicked()
                   .arg(m_localPort)
                   .arg(m_remoteAddress.toString())
                   .arg(m_remotePort));
+        
+        // 发送通道限速（字节/秒），控制通道不限速
+        WhtsProtocol::TransmitScheduler::LaneConfig configLane;
+        configLane.rateBytesPerSec = m_pSettings->value("Network/ConfigLaneBytesPerSec", DEFAULT_CONFIG_LANE_BYTES_PER_SEC).toUInt();
+        configLane.burstBytes = DEFAULT_LANE_BURST_BYTES;
+        m_pTransmitScheduler->setLaneConfig(WhtsProtocol::TransmitLane::CONFIG, configLane);
+        WhtsProtocol::TransmitScheduler::LaneConfig diagnosticsLane;
+        diagnosticsLane.rateBytesPerSec = m_pSettings->value("Network/DiagnosticsLaneBytesPerSec", DEFAULT_DIAGNOSTICS_LANE_BYTES_PER_SEC).toUInt();
+        diagnosticsLane.burstBytes = DEFAULT_LANE_BURST_BYTES;
+        m_pTransmitScheduler->setLaneConfig(WhtsProtocol::TransmitLane::DIAGNOSTICS, diagnosticsLane);
+        m_pDeviceRegistryTimer->start();
+        
+        // 内核接收时间戳、丢包计数和接收缓冲区
+        int receiveBufferBytes = m_pSettings->value("Network/ReceiveBufferBytes", DEFAULT_RECEIVE_BUFFER_BYTES).toInt();
+        if (m_socketRxProbe.Attach(m_pUdpSocket->socketDescriptor(), receiveBufferBytes)) {
+            LogMessage(QString("已启用内核接收时间戳, 接收缓冲区: 请求 %1 字节, 实际 %2 字节")
+                      .arg(receiveBufferBytes)
+                      .arg(m_socketRxProbe.EffectiveReceiveBuffer()));
+        } else {
+            LogMessage(QString("未启用内核接收时间戳: %1")
+                      .arg(QString::fromStdString(m_socketRxProbe.LastError())), "WARN");
+        }
     } else {
         LogMessage(QString("UDP连接失败: %1").arg(m_pUdpSocket->errorString()), "ERROR");
         delete m_pUdpSocket;
@@ -146,6 +356,26 @@ void MainWindow::OnConnectClicked()
 
 void MainWindow::OnDisconnectClicked()
 {
+    m_socketRxProbe.Detach();
+    m_pTestSequenceEngine->Abort();
+    m_pCommandEngine->CancelAll();
+    m_pReliableSender->clear();
+    m_pReliableTimer->stop();
+    m_pDeviceRegistryTimer->stop();
+    m_pTransmitScheduler->clear();
+    m_pTransmitTimer->stop();
+    for (size_t i = 0; i < WhtsProtocol::TRANSMIT_LANE_COUNT; ++i) {
+        auto lane = static_cast<WhtsProtocol::TransmitLane>(i);
+        const auto &laneStats = m_pTransmitScheduler->stats(lane);
+        if (laneStats.sent > 0) {
+            LogMessage(QString("发送通道 %1: 发送 %2 帧, 丢弃 %3 帧, 平均排队 %4 ms, 最大排队 %5 ms")
+                      .arg(WhtsProtocol::transmitLaneName(lane))
+                      .arg(laneStats.sent)
+                      .arg(laneStats.dropped)
+                      .arg(static_cast<double>(laneStats.totalQueueMs) / laneStats.sent, 0, 'f', 1)
+                      .arg(laneStats.maxQueueMs));
+        }
+    }
     if (m_pUdpSocket) {
         m_pUdpSocket->close();
         delete m_pUdpSocket;
@@ -153,6 +383,8 @@ void MainWindow::OnDisconnectClicked()
     }
     
     m_bConnected = false;
+    m_bAcquisitionRunning = false;
+    m_bStopPending = false;
     UpdateConnectionState(false);
     LogMessage("UDP连接已断开");
 }
@@ -202,28 +434,50 @@ void MainWindow::OnClearLogClicked()
 
 void MainWindow::OnReadyRead()
 {
+    WHTS_TRACE_SCOPE("OnReadyRead");
+    // 一批数据报先全部交给协议处理器再分发, 批内的控制应答越过数据帧优先处理
+    int batched = 0;
     while (m_pUdpSocket && m_pUdpSocket->hasPendingDatagrams()) {
         QByteArray datagram;
-        datagram.resize(m_pUdpSocket->pendingDatagramSize());
-        
         QHostAddress sender;
         quint16 senderPort;
+        qint64 bytesRead;
+        SocketRxInfo rxInfo;
+        {
+            WHTS_TRACE_SCOPE("readDatagram");
+            // 先取内核到达时间和丢包计数，再由 QUdpSocket 读取同一个数据报
+            rxInfo = m_socketRxProbe.PeekNext();
+            datagram.resize(m_pUdpSocket->pendingDatagramSize());
+            bytesRead = m_pUdpSocket->readDatagram(datagram.data(), datagram.size(), &sender, &senderPort);
+        }
         
-        qint64 bytesRead = m_pUdpSocket->readDatagram(datagram.data(), datagram.size(), &sender, &senderPort);
+        if (rxInfo.newDrops > 0) {
+            m_pProtocolProcessor->getStats().add(WhtsProtocol::StatCounter::SOCKET_DROPS, rxInfo.newDrops);
+            LogMessage(QString("内核接收队列溢出, 丢弃 %1 个数据报").arg(rxInfo.newDrops), "WARN");
+        }
         
         if (bytesRead > 0) {
             datagram.resize(bytesRead);
-            LogMessage(QString("接收数据 <- %1:%2 [%3] (%4 bytes)")
+            // 内核到达 -> 应用读取的排队时间
+            qint64 queueUs = (SocketRxProbe::RealtimeNowNs() - rxInfo.realtimeNs) / 1000;
+            LogMessage(QString("接收数据 <- %1:%2 [%3] (%4 bytes, 排队 %5 us)")
                       .arg(sender.toString())
                       .arg(senderPort)
                       .arg(ByteArrayToHexString(datagram))
-                      .arg(bytesRead), "RECV");
+                      .arg(bytesRead)
+                      .arg(queueUs), "RECV",
+                      QDateTime::fromMSecsSinceEpoch(rxInfo.realtimeNs / 1000000));
             
             // 处理协议消息
             std::vector<uint8_t> data(datagram.begin(), datagram.end());
-            ProcessProtocolMessage(data);
+            m_pProtocolProcessor->processReceivedData(data, rxInfo.steadyNs);
+            if (++batched >= RX_BATCH_DATAGRAMS) {
+                ProcessProtocolFrames();
+                batched = 0;
+            }
         }
     }
+    ProcessProtocolFrames();
 }
 
 void MainWindow::OnSocketError(QAbstractSocket::SocketError error)
@@ -234,16 +488,20 @@ void MainWindow::OnSocketError(QAbstractSocket::SocketError error)
     }
 }
 
-void MainWindow::LogMessage(const QString &message, const QString &type)
+void MainWindow::LogMessage(const QString &message, const QString &type, const QDateTime &timestamp)
 {
-    QString timestamp = QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss.zzz");
-    QString logEntry = QString("[%1] [%2] %3").arg(timestamp, type, message);
-    
-    // 显示在UI中
-    ui->textEditLog->append(logEntry);
-    
-    // 自动滚动到底部
-    ui->textEditLog->moveCursor(QTextCursor::End);
+    // 接收日志使用内核到达时间，其余使用当前时间
+    QDateTime logTime = timestamp.isValid() ? timestamp : QDateTime::currentDateTime();
+    QString logEntry = QString("[%1] [%2] %3").arg(logTime.toString("yyyy-MM-dd hh:mm:ss.zzz"), type, message);
+    
+    {
+        WHTS_TRACE_SCOPE("LogMessage.textEdit");
+        // 显示在UI中
+        ui->textEditLog->append(logEntry);
+        
+        // 自动滚动到底部
+        ui->textEditLog->moveCursor(QTextCursor::End);
+    }
     
     // 写入文件（根据内存要求）
     WriteLogToFile(logEntry);
@@ -251,6 +509,7 @@ void MainWindow::LogMessage(const QString &message, const QString &type)
 
 void MainWindow::WriteLogToFile(const QString &message)
 {
+    WHTS_TRACE_SCOPE("WriteLogToFile");
     if (m_pLogStream) {
         *m_pLogStream << message << Qt::endl;
         m_pLogStream->flush();
@@ -296,6 +555,8 @@ void MainWindow::UpdateConnectionState(bool connected)
 {
     ui->pushButtonConnect->setEnabled(!connected);
     ui->pushButtonDisconnect->setEnabled(connected);
+    ui->comboBoxFrameCrc->setEnabled(!connected);
+    ui->checkBoxReliableFragments->setEnabled(!connected);
     ui->pushButtonSend->setEnabled(connected);
     ui->pushButtonQueryDevices->setEnabled(connected);
     ui->pushButtonClearDevices->setEnabled(connected);
@@ -323,28 +584,17 @@ void MainWindow::OnQueryDevicesClicked()
 void MainWindow::SendDeviceListRequest()
 {
     // 创建设备列表请求消息
-    WhtsProtocol::Backend2Master::DeviceListReqMessage deviceListReq;
-    deviceListReq.reserve = 0; // 保留字段
-    
-    // 使用协议处理器打包消息
-    auto packets = m_pProtocolProcessor->packBackend2MasterMessage(deviceListReq);
-    
-    // 发送所有分片
-    for (const auto& packet : packets) {
-        QByteArray data(reinterpret_cast<const char*>(packet.data()), packet.size());
-        qint64 bytesWritten = m_pUdpSocket->writeDatagram(data, m_remoteAddress, m_remotePort);
-        
-        if (bytesWritten == -1) {
-            LogMessage(QString("发送设备列表请求失败: %1").arg(m_pUdpSocket->errorString()), "ERROR");
-            return;
-        } else {
-            LogMessage(QString("发送设备列表请求 -> %1:%2 [%3] (%4 bytes)")
-                      .arg(m_remoteAddress.toString())
-                      .arg(m_remotePort)
-                      .arg(ByteArrayToHexString(data))
-                      .arg(bytesWritten), "SEND");
+    auto deviceListReq = std::make_shared<WhtsProtocol::Backend2Master::DeviceListReqMessage>();
+    deviceListReq->reserve = 0; // 保留字段
+    
+    // 通过命令层发送，应答由 HandleDeviceListResponse 处理，超时重发
+    m_pCommandEngine->Send(deviceListReq).then(this, [this](const CommandResult &result) {
+        if (result.Ok()) {
+            LogMessage(QString("设备列表请求已应答 (%1 ms, 发送 %2 次)")
+                      .arg(result.latencyNs / 1000000.0, 0, 'f', 1)
+                      .arg(result.attempts), "INFO");
         }
-    }
+    });
 }
 
 void MainWindow::OnClearDevicesClicked()
@@ -363,162 +613,324 @@ void MainWindow::SendClearDeviceListRequest()
     // 创建设备列表请求消息
     WhtsProtocol::Backend2Master::ClearDeviceListMessage clearDeviceListReq;
     clearDeviceListReq.reserve = 0; // 保留字段
-
-        // 使用协议处理器打包消息
-        auto packets = m_pProtocolProcessor->packBackend2MasterMessage(clearDeviceListReq);
     
-        // 发送所有分片
-        for (const auto& packet : packets) {
-            QByteArray data(reinterpret_cast<const char*>(packet.data()), packet.size());
-            qint64 bytesWritten = m_pUdpSocket->writeDatagram(data, m_remoteAddress, m_remotePort);
-            
-            if (bytesWritten == -1) {
-                LogMessage(QString("发送设备列表请求失败: %1").arg(m_pUdpSocket->errorString()), "ERROR");
-                return;
-            } else {
-                LogMessage(QString("发送设备列表请求 -> %1:%2 [%3] (%4 bytes)")
-                          .arg(m_remoteAddress.toString())
-                          .arg(m_remotePort)
-                          .arg(ByteArrayToHexString(data))
-                          .arg(bytesWritten), "SEND");
-            }
-        }
+    SendBackend2MasterMessage(clearDeviceListReq);
 }
 
-void MainWindow::ProcessProtocolMessage(const std::vector<uint8_t> &data)
+void MainWindow::RecordLatency(LatencyStage stage, uint8_t packetId, const WhtsProtocol::Message &message, uint64_t startNs)
 {
-    // 将数据传递给协议处理器
-    m_pProtocolProcessor->processReceivedData(data);
-    
-    // 检查是否有完整的帧
+    uint64_t nowNs = LatencyTracker::NowNs();
+    m_latencyTracker.Record(stage, packetId, message.getMessageId(), message.getMessageTypeName(),
+                            nowNs > startNs ? nowNs - startNs : 0);
+}
+
+void MainWindow::ProcessProtocolFrames()
+{
+    // 检查是否有完整的帧（优先消息先出队）
     WhtsProtocol::Frame frame;
     while (m_pProtocolProcessor->getNextCompleteFrame(frame)) {
-        // 解析Master2Backend消息
-        std::unique_ptr<WhtsProtocol::Message> message;
-        if (m_pProtocolProcessor->parseMaster2BackendPacket(frame.payload, message)) {
+        switch (static_cast<WhtsProtocol::PacketId>(frame.packetId)) {
+        case WhtsProtocol::PacketId::MASTER_TO_BACKEND: {
+            // 解析Master2Backend消息
+            std::unique_ptr<WhtsProtocol::Message> message;
+            if (!m_pProtocolProcessor->parseMaster2BackendPacket(frame.payload, message)) {
+                break;
+            }
+            uint64_t decodedNs = LatencyTracker::NowNs();
+            RecordLatency(LatencyStage::Decode, frame.packetId, *message, frame.arrivalNs);
+            
             // 检查消息类型
             if (message->getMessageId() == static_cast<uint8_t>(WhtsProtocol::Master2BackendMessageId::DEVICE_LIST_RSP_MSG)) {
                 // 转换为设备列表响应消息
                 auto deviceListResponse = dynamic_cast<WhtsProtocol::Master2Backend::DeviceListResponseMessage*>(message.get());
                 if (deviceListResponse) {
                     HandleDeviceListResponse(*deviceListResponse);
+                    RecordLatency(LatencyStage::Display, frame.packetId, *message, decodedNs);
                 }
             }
             else if (message->getMessageId() == static_cast<uint8_t>(WhtsProtocol::Master2BackendMessageId::SLAVE_CFG_RSP_MSG)) {
                 // 转换为从机配置响应消息
                 auto slaveConfigResponse = dynamic_cast<WhtsProtocol::Master2Backend::SlaveConfigResponseMessage*>(message.get());
                 if (slaveConfigResponse) {
+                    // 该响应会弹出模态对话框，不计入显示延迟
                     HandleSlaveConfigResponse(*slaveConfigResponse);
                 }
             }
+            else if (message->getMessageId() == static_cast<uint8_t>(WhtsProtocol::Master2BackendMessageId::CTRL_RSP_MSG)) {
+                // 以主机应答的运行状态为准，包括测试序列和其它模块下发的控制命令
+                auto ctrlResponse = dynamic_cast<WhtsProtocol::Master2Backend::CtrlResponseMessage*>(message.get());
+                if (ctrlResponse) {
+                    m_bAcquisitionRunning = ctrlResponse->runningStatus != 0;
+                    if (!m_bAcquisitionRunning) {
+                        m_bStopPending = false;
+                    }
+                }
+            }
+            else if (message->getMessageId() == static_cast<uint8_t>(WhtsProtocol::Master2BackendMessageId::PING_RES_MSG)) {
+                // Ping结果交给Ping引擎统计
+                auto pingResponse = dynamic_cast<WhtsProtocol::Master2Backend::PingResponseMessage*>(message.get());
+                if (pingResponse) {
+                    m_pPingEngine->OnPingResponse(*pingResponse, frame.arrivalNs);
+                }
+            }
+            else if (message->getMessageId() == static_cast<uint8_t>(WhtsProtocol::Master2BackendMessageId::SET_UWB_CHAN_RSP_MSG)) {
+                // 记录主机确认的信道，切换结果由命令层交给信道扫描
+                auto setChannelResponse = dynamic_cast<WhtsProtocol::Master2Backend::SetUwbChannelResponseMessage*>(message.get());
+                if (setChannelResponse) {
+                    m_pChannelSweeper->OnSetChannelResponse(*setChannelResponse);
+                }
+            }
+            else if (message->getMessageId() == static_cast<uint8_t>(WhtsProtocol::Master2BackendMessageId::INTERVAL_CFG_RSP_MSG)) {
+                // 记录主机确认的间隔，配置结果由命令层交给间隔自适应
+                auto intervalConfigResponse = dynamic_cast<WhtsProtocol::Master2Backend::IntervalConfigResponseMessage*>(message.get());
+                if (intervalConfigResponse) {
+                    m_pIntervalController->OnIntervalConfigResponse(*intervalConfigResponse);
+                }
+            }
+            // 完成命令层中等待该应答的命令
+            m_pCommandEngine->OnResponse(std::shared_ptr<const WhtsProtocol::Message>(std::move(message)),
+                                         frame.arrivalNs);
+            break;
         }
-        
-        // 解析Slave2Backend消息
-        uint32_t slaveId;
-        WhtsProtocol::DeviceStatus deviceStatus;
-        std::unique_ptr<WhtsProtocol::Message> slave2BackendMessage;
-        if (m_pProtocolProcessor->parseSlave2BackendPacket(frame.payload, slaveId, deviceStatus, slave2BackendMessage)) {
+        case WhtsProtocol::PacketId::SLAVE_TO_BACKEND: {
+            // 解析Slave2Backend消息
+            uint32_t slaveId;
+            WhtsProtocol::DeviceStatus deviceStatus;
+            std::unique_ptr<WhtsProtocol::Message> slave2BackendMessage;
+            WhtsProtocol::Slave2BackendExtension extension;
+            if (!m_pProtocolProcessor->parseSlave2BackendPacket(frame.payload, slaveId, deviceStatus,
+                                                                slave2BackendMessage, extension)) {
+                break;
+            }
+            uint64_t arrivalMs = frame.arrivalNs / 1000000;
+            m_deviceRegistry.onTraffic(slaveId, arrivalMs);
+            auto dataBatchMessage = dynamic_cast<WhtsProtocol::Slave2Backend::DataBatchMessage*>(slave2BackendMessage.get());
+            // 批量帧在最后一个采样后发出，第 i 个采样的时间为
+            // arrivalMs - (采样数-1-i) × 采样间隔；不早于该从机上一帧，保证时间单调
+            uint64_t &lastSampleMs = m_lastSampleMs[slaveId];
+            uint64_t floorMs = lastSampleMs;
+            lastSampleMs = std::max(lastSampleMs, arrivalMs);
+            auto sampleMs = [dataBatchMessage, arrivalMs, floorMs](size_t i) {
+                uint64_t backMs = static_cast<uint64_t>(dataBatchMessage->sampleCount() - 1 - i) *
+                                  dataBatchMessage->sampleIntervalUs / 1000;
+                return backMs < arrivalMs ? std::max(floorMs, arrivalMs - backMs) : floorMs;
+            };
+            // 状态位边沿检测，批量帧按采样顺序逐个比较；告警规则只重新计算涉及变化位的规则；
+            // 状态历史只记录第一次收到和发生变化的状态
+            if (dataBatchMessage) {
+                for (size_t i = 0; i < dataBatchMessage->sampleCount(); ++i) {
+                    uint16_t status = dataBatchMessage->statuses[i];
+                    bool known = m_deviceStatusTracker.known(slaveId);
+                    uint16_t changed = m_deviceStatusTracker.update(slaveId, status);
+                    m_ruleEngine.onStatus(slaveId, status, changed, sampleMs(i));
+                    if (changed || !known) {
+                        m_sampleHistory.record(slaveId, WhtsProtocol::HistoryKind::STATUS, sampleMs(i), status);
+                    }
+                }
+            } else {
+                uint16_t status = deviceStatus.toUint16();
+                bool known = m_deviceStatusTracker.known(slaveId);
+                uint16_t changed = m_deviceStatusTracker.update(slaveId, status);
+                m_ruleEngine.onStatus(slaveId, status, changed, arrivalMs);
+                if (changed || !known) {
+                    m_sampleHistory.record(slaveId, WhtsProtocol::HistoryKind::STATUS, arrivalMs, status);
+                }
+            }
+            if (extension.present) {
+                // 带序号的从机数据，统计缺失/重复/乱序
+                if (dataBatchMessage) {
+                    // 批量帧的序号和时间戳对应第一个采样，其余采样依次递推
+                    for (size_t i = 0; i < dataBatchMessage->sampleCount(); ++i) {
+                        m_sequenceTracker.record(slaveId, static_cast<uint16_t>(extension.sequence + i),
+                                                 extension.timestampUs + static_cast<uint32_t>(i * dataBatchMessage->sampleIntervalUs),
+                                                 frame.arrivalNs);
+                    }
+                } else {
+                    m_sequenceTracker.record(slaveId, extension.sequence, extension.timestampUs, frame.arrivalNs);
+                }
+            }
+            uint64_t decodedNs = LatencyTracker::NowNs();
+            RecordLatency(LatencyStage::Decode, frame.packetId, *slave2BackendMessage, frame.arrivalNs);
+            
             // 检查消息类型
             if (slave2BackendMessage->getMessageId() == static_cast<uint8_t>(WhtsProtocol::Slave2BackendMessageId::CONDUCTION_DATA_MSG)) {
                 // 转换为导通数据消息
                 auto conductionDataMessage = dynamic_cast<WhtsProtocol::Slave2Backend::ConductionDataMessage*>(slave2BackendMessage.get());
+                // 信道扫描和间隔自适应按导通帧速率衡量吞吐，与界面是否显示无关
+                m_pChannelSweeper->OnConductionFrame();
+                m_pIntervalController->OnConductionFrame(slaveId);
+                m_pTestSequenceEngine->OnConductionSamples(slaveId);
+                if (conductionDataMessage) {
+                    AnalyzeConductionSample(slaveId, deviceStatus.toUint16(), conductionDataMessage->conductionData.data(),
+                                            conductionDataMessage->conductionData.size(), arrivalMs);
+                }
                 if (conductionDataMessage && m_bDataViewRunning) {
                     HandleConductionDataMessage(slaveId, deviceStatus, *conductionDataMessage);
+                    RecordLatency(LatencyStage::Display, frame.packetId, *slave2BackendMessage, decodedNs);
+                }
+            }
+            else if (slave2BackendMessage->getMessageId() == static_cast<uint8_t>(WhtsProtocol::Slave2BackendMessageId::CONDUCTION_BATCH_MSG)) {
+                auto conductionBatchMessage = dynamic_cast<WhtsProtocol::Slave2Backend::ConductionBatchMessage*>(slave2BackendMessage.get());
+                if (conductionBatchMessage && conductionBatchMessage->sampleCount() > 0) {
+                    uint32_t samples = static_cast<uint32_t>(conductionBatchMessage->sampleCount());
+                    m_pChannelSweeper->OnConductionFrame(samples);
+                    m_pIntervalController->OnConductionFrame(slaveId, samples);
+                    m_pTestSequenceEngine->OnConductionSamples(slaveId, samples);
+                    for (size_t i = 0; i < conductionBatchMessage->sampleCount(); ++i) {
+                        AnalyzeConductionSample(slaveId, conductionBatchMessage->statuses[i], conductionBatchMessage->sample(i),
+                                                conductionBatchMessage->sampleLength, sampleMs(i));
+                    }
+                    if (m_bDataViewRunning) {
+                        HandleConductionBatchMessage(slaveId, *conductionBatchMessage);
+                        RecordLatency(LatencyStage::Display, frame.packetId, *slave2BackendMessage, decodedNs);
+                    }
+                }
+            }
+            else if (slave2BackendMessage->getMessageId() == static_cast<uint8_t>(WhtsProtocol::Slave2BackendMessageId::RESISTANCE_DATA_MSG)) {
+                // 阻值数据与数据查看是否运行无关，持续统计
+                auto resistanceDataMessage = dynamic_cast<WhtsProtocol::Slave2Backend::ResistanceDataMessage*>(slave2BackendMessage.get());
+                if (resistanceDataMessage) {
+                    m_resistanceAccumulator.onResistance(slaveId, resistanceDataMessage->resistanceData.data(),
+                                                         resistanceDataMessage->resistanceData.size());
+                    m_sampleHistory.record(slaveId, WhtsProtocol::HistoryKind::RESISTANCE, arrivalMs, deviceStatus.toUint16(),
+                                           resistanceDataMessage->resistanceData.data(),
+                                           resistanceDataMessage->resistanceData.size());
                 }
             }
+            else if (slave2BackendMessage->getMessageId() == static_cast<uint8_t>(WhtsProtocol::Slave2BackendMessageId::RESISTANCE_BATCH_MSG)) {
+                auto resistanceBatchMessage = dynamic_cast<WhtsProtocol::Slave2Backend::ResistanceBatchMessage*>(slave2BackendMessage.get());
+                if (resistanceBatchMessage) {
+                    for (size_t i = 0; i < resistanceBatchMessage->sampleCount(); ++i) {
+                        m_resistanceAccumulator.onResistance(slaveId, resistanceBatchMessage->sample(i),
+                                                             resistanceBatchMessage->sampleLength);
+                        m_sampleHistory.record(slaveId, WhtsProtocol::HistoryKind::RESISTANCE, sampleMs(i),
+                                               resistanceBatchMessage->statuses[i], resistanceBatchMessage->sample(i),
+                                               resistanceBatchMessage->sampleLength);
+                    }
+                }
+            }
+            else if (slave2BackendMessage->getMessageId() == static_cast<uint8_t>(WhtsProtocol::Slave2BackendMessageId::CLIP_DATA_MSG)) {
+                // 每帧只做位比较，界面由卡钉检测面板定时刷新
+                auto clipDataMessage = dynamic_cast<WhtsProtocol::Slave2Backend::ClipDataMessage*>(slave2BackendMessage.get());
+                if (clipDataMessage) {
+                    m_clipTracker.onClipData(slaveId, clipDataMessage->clipData, arrivalMs);
+                }
+            }
+            else if (slave2BackendMessage->getMessageId() == static_cast<uint8_t>(WhtsProtocol::Slave2BackendMessageId::CONDUCTION_DELTA_MSG)) {
+                auto conductionDeltaMessage = dynamic_cast<WhtsProtocol::Slave2Backend::ConductionDeltaMessage*>(slave2BackendMessage.get());
+                if (conductionDeltaMessage) {
+                    m_pChannelSweeper->OnConductionFrame();
+                    m_pIntervalController->OnConductionFrame(slaveId);
+                    m_pTestSequenceEngine->OnConductionSamples(slaveId);
+                    // 差分帧还原为完整导通数据后按普通导通帧显示
+                    WhtsProtocol::Slave2Backend::ConductionDataMessage conductionDataMessage;
+                    auto result = m_conductionDeltaDecoder.decode(slaveId, *conductionDeltaMessage, conductionDataMessage.conductionData);
+                    if (result == WhtsProtocol::ConductionDeltaDecoder::Result::OK) {
+                        conductionDataMessage.conductionLength = static_cast<uint16_t>(conductionDataMessage.conductionData.size());
+                        AnalyzeConductionSample(slaveId, deviceStatus.toUint16(), conductionDataMessage.conductionData.data(),
+                                                conductionDataMessage.conductionData.size(), arrivalMs);
+                        if (m_bDataViewRunning) {
+                            HandleConductionDataMessage(slaveId, deviceStatus, conductionDataMessage);
+                            RecordLatency(LatencyStage::Display, frame.packetId, *slave2BackendMessage, decodedNs);
+                        }
+                    } else if (result == WhtsProtocol::ConductionDeltaDecoder::Result::REFERENCE_MISSING) {
+                        LogMessage(QString("从机 0x%1 导通差分帧的基准采样丢失，等待下一关键帧")
+                                  .arg(slaveId, 8, 16, QChar('0')).toUpper(), "WARN");
+                    } else if (result == WhtsProtocol::ConductionDeltaDecoder::Result::INVALID) {
+                        LogMessage(QString("从机 0x%1 导通差分帧数据无效，等待下一关键帧")
+                                  .arg(slaveId, 8, 16, QChar('0')).toUpper(), "ERROR");
+                    }
+                }
+            }
+            break;
+        }
+        case WhtsProtocol::PacketId::SLAVE_TO_MASTER: {
+            // 主机转发的从机应答（如逐次的PingRsp），用于计算单次往返时间
+            uint32_t slaveId;
+            std::unique_ptr<WhtsProtocol::Message> slave2MasterMessage;
+            if (!m_pProtocolProcessor->parseSlave2MasterPacket(frame.payload, slaveId, slave2MasterMessage)) {
+                break;
+            }
+            
+            if (slave2MasterMessage->getMessageId() == static_cast<uint8_t>(WhtsProtocol::Slave2MasterMessageId::PING_RSP_MSG)) {
+                auto pingRsp = dynamic_cast<WhtsProtocol::Slave2Master::PingRspMessage*>(slave2MasterMessage.get());
+                if (pingRsp) {
+                    m_pPingEngine->OnPingReply(slaveId, *pingRsp, frame.arrivalNs);
+                }
+            }
+            break;
+        }
+        case WhtsProtocol::PacketId::RELIABLE_ACK: {
+            // 主机对可靠分片的选择确认
+            WhtsProtocol::ReliableAck ack;
+            if (WhtsProtocol::ReliableAck::deserialize(frame.payload, ack)) {
+                m_pReliableSender->onAck(ack, frame.arrivalNs / 1000000);
+            }
+            break;
+        }
+        default:
+            // 其他方向的帧不应发往后端，忽略
+            break;
         }
     }
+    
+    // 主机发来的可靠分片需要回复确认
+    FlushProtocolOutgoing();
 }
 
 void MainWindow::HandleDeviceListResponse(const WhtsProtocol::Master2Backend::DeviceListResponseMessage &message)
 {
+    WHTS_TRACE_SCOPE("HandleDeviceListResponse");
     LogMessage(QString("收到设备列表响应，设备数量: %1").arg(message.deviceCount), "INFO");
     
-    // 更新设备表格
-    UpdateDeviceTable(message.devices);
+    m_deviceRegistry.onDeviceList(message.devices, LatencyTracker::NowNs() / 1000000);
+    UpdateDeviceTable();
 }
 
-void MainWindow::UpdateDeviceTable(const std::vector<WhtsProtocol::Master2Backend::DeviceListResponseMessage::DeviceInfo> &devices)
+void MainWindow::UpdateDeviceTable()
 {
-    // 清空表格
-    ui->tableWidgetDevices->setRowCount(0);
-    
-    // 添加设备信息
-    for (size_t i = 0; i < devices.size(); ++i) {
-        const auto& device = devices[i];
-        
-        ui->tableWidgetDevices->insertRow(i);
-        
-        // 设备ID (十六进制显示)
-        ui->tableWidgetDevices->setItem(i, 0, 
-            new QTableWidgetItem(QString("0x%1").arg(device.deviceId, 8, 16, QChar('0')).toUpper()));
-        
-        // 短ID
-        ui->tableWidgetDevices->setItem(i, 1, 
-            new QTableWidgetItem(QString::number(device.shortId)));
-        
-        // 在线状态
-        QString onlineStatus = device.online ? "在线" : "离线";
-        ui->tableWidgetDevices->setItem(i, 2, 
-            new QTableWidgetItem(onlineStatus));
-        
-        // 版本信息
-        QString version = QString("%1.%2.%3")
-            .arg(device.versionMajor)
-            .arg(device.versionMinor)
-            .arg(device.versionPatch);
-        ui->tableWidgetDevices->setItem(i, 3, 
-            new QTableWidgetItem(version));
-        
-        // 电池电量（使用自定义控件）
-        QWidget* batteryWidget = CreateBatteryWidget(device.batteryLevel);
-        ui->tableWidgetDevices->setCellWidget(i, 4, batteryWidget);
+    WHTS_TRACE_SCOPE("UpdateDeviceTable");
+    m_deviceRegistryVersion = m_deviceRegistry.version();
+    
+    // 只对新增、移除和字段变化的行刷新
+    std::vector<WhtsProtocol::Master2Backend::DeviceListResponseMessage::DeviceInfo> devices = m_deviceRegistry.toDeviceList();
+    m_pDeviceTableModel->Update(devices);
+    
+    // 在线从机作为Ping目标
+    QList<uint32_t> onlineSlaveIds;
+    for (const auto &device : devices) {
+        if (device.online) {
+            onlineSlaveIds.append(device.deviceId);
+        }
     }
+    m_pLinkQualityWidget->SetSlaveIds(onlineSlaveIds);
     
-    // 调整列宽
-    ui->tableWidgetDevices->resizeColumnsToContents();
+    m_pLabelFleetSummary->setText(QString("从机: 在线 %1 / 不活跃 %2 / 离线 %3")
+        .arg(m_deviceRegistry.count(WhtsProtocol::DeviceLiveness::ONLINE))
+        .arg(m_deviceRegistry.count(WhtsProtocol::DeviceLiveness::STALE))
+        .arg(m_deviceRegistry.count(WhtsProtocol::DeviceLiveness::OFFLINE)));
 }
 
-QWidget* MainWindow::CreateBatteryWidget(uint8_t batteryLevel)
+void MainWindow::OnDeviceRegistryTimer()
 {
-    // 创建容器widget
-    QWidget* container = new QWidget();
-    QHBoxLayout* layout = new QHBoxLayout(container);
-    layout->setContentsMargins(5, 2, 5, 2);
-    layout->setSpacing(5);
-    
-    // 创建进度条
-    QProgressBar* progressBar = new QProgressBar();
-    progressBar->setMinimum(0);
-    progressBar->setMaximum(100);
-    progressBar->setValue(batteryLevel);
-    progressBar->setFixedHeight(20);
-    progressBar->setTextVisible(false); // 不显示进度条自带的文本
-    
-    // 根据电量设置进度条颜色
-    QString styleSheet;
-    if (batteryLevel >= 60) {
-        // 电量充足 - 绿色
-        styleSheet = "QProgressBar::chunk { background-color: #4CAF50; }";
-    } else if (batteryLevel >= 30) {
-        // 电量中等 - 黄色
-        styleSheet = "QProgressBar::chunk { background-color: #FF9800; }";
-    } else {
-        // 电量不足 - 红色
-        styleSheet = "QProgressBar::chunk { background-color: #F44336; }";
+    uint64_t nowMs = LatencyTracker::NowNs() / 1000000;
+    m_deviceRegistry.advance(nowMs);
+    // 同一定时器检查告警规则的持续时间条件
+    m_ruleEngine.poll(nowMs);
+    
+    // 有从机不活跃或出现未知从机时补发设备列表请求，无应答时由注册表按最小间隔重发
+    if (m_bConnected && m_deviceRegistry.refreshDue(nowMs)) {
+        m_deviceRegistry.onRefreshRequested(nowMs);
+        auto deviceListReq = std::make_shared<WhtsProtocol::Backend2Master::DeviceListReqMessage>();
+        deviceListReq->reserve = 0;
+        CommandEngine::Options options;
+        options.retries = 0;
+        m_pCommandEngine->Send(deviceListReq, options);
     }
-    progressBar->setStyleSheet(styleSheet);
     
-    // 创建显示百分比的标签
-    QLabel* percentLabel = new QLabel(QString("%1%").arg(batteryLevel));
-    percentLabel->setFixedWidth(35);
-    percentLabel->setAlignment(Qt::AlignCenter);
-    
-    // 添加到布局
-    layout->addWidget(progressBar, 1); // 进度条占主要空间
-    layout->addWidget(percentLabel, 0); // 百分比标签固定宽度
-    
-    return container;
+    if (m_deviceRegistry.version() != m_deviceRegistryVersion) {
+        UpdateDeviceTable();
+    }
 }
 
 void MainWindow::OnAddSlaveConfigClicked()
@@ -652,26 +1064,32 @@ QWidget* MainWindow::CreateSlaveConfigActionWidget(int row)
     QPushButton* editButton = new QPushButton("编辑", container);
     QPushButton* copyButton = new QPushButton("复制", container);
     QPushButton* deleteButton = new QPushButton("删除", container);
+    QPushButton* planButton = new QPushButton("规划", container);
     
     sendButton->setProperty("row", row);
     editButton->setProperty("row", row);
     copyButton->setProperty("row", row);
     deleteButton->setProperty("row", row);
+    planButton->setProperty("row", row);
     
     sendButton->setFixedSize(45, 25);
     editButton->setFixedSize(45, 25);
     copyButton->setFixedSize(45, 25);
     deleteButton->setFixedSize(45, 25);
+    planButton->setFixedSize(45, 25);
+    planButton->setToolTip("计算时隙分配、建议采集间隔和每个从机的预测吞吐");
     
     connect(sendButton, &QPushButton::clicked, this, &MainWindow::OnSendSlaveConfigClicked);
     connect(editButton, &QPushButton::clicked, this, &MainWindow::OnEditSlaveConfigClicked);
     connect(copyButton, &QPushButton::clicked, this, &MainWindow::OnCopySlaveConfigClicked);
     connect(deleteButton, &QPushButton::clicked, this, &MainWindow::OnDeleteSlaveConfigClicked);
+    connect(planButton, &QPushButton::clicked, this, &MainWindow::OnPlanSlaveConfigClicked);
     
     layout->addWidget(sendButton);
     layout->addWidget(editButton);
     layout->addWidget(copyButton);
     layout->addWidget(deleteButton);
+    layout->addWidget(planButton);
     layout->addStretch();
     
     return container;
@@ -679,26 +1097,17 @@ QWidget* MainWindow::CreateSlaveConfigActionWidget(int row)
 
 void MainWindow::SendSlaveConfig(const SlaveConfigData& configData)
 {
-    // 使用协议处理器打包消息
-    auto packets = m_pProtocolProcessor->packBackend2MasterMessage(configData.config);
-    
-    // 发送所有分片
-    for (const auto& packet : packets) {
-        QByteArray data(reinterpret_cast<const char*>(packet.data()), packet.size());
-        qint64 bytesWritten = m_pUdpSocket->writeDatagram(data, m_remoteAddress, m_remotePort);
-        
-        if (bytesWritten == -1) {
-            LogMessage(QString("发送从机配置失败: %1").arg(m_pUdpSocket->errorString()), "ERROR");
-            return;
-        } else {
-            LogMessage(QString("发送从机配置 \"%1\" -> %2:%3 [%4] (%5 bytes)")
-                      .arg(configData.name)
-                      .arg(m_remoteAddress.toString())
-                      .arg(m_remotePort)
-                      .arg(ByteArrayToHexString(data))
-                      .arg(bytesWritten), "SEND");
+    // 通过命令层发送，应答由 HandleSlaveConfigResponse 显示，超时重发
+    auto request = std::make_shared<WhtsProtocol::Backend2Master::SlaveConfigMessage>(configData.config);
+    QString name = configData.name;
+    m_pCommandEngine->Send(request).then(this, [this, name](const CommandResult &result) {
+        if (result.Ok()) {
+            LogMessage(QString("从机配置 \"%1\" 已应答 (%2 ms, 发送 %3 次)")
+                      .arg(name)
+                      .arg(result.latencyNs / 1000000.0, 0, 'f', 1)
+                      .arg(result.attempts), "INFO");
         }
-    }
+    });
 }
 
 void MainWindow::HandleSlaveConfigResponse(const WhtsProtocol::Master2Backend::SlaveConfigResponseMessage &message)
@@ -708,17 +1117,39 @@ void MainWindow::HandleSlaveConfigResponse(const WhtsProtocol::Master2Backend::S
         statusText = "成功";
         LogMessage(QString("从机配置响应: 状态=%1, 从机数量=%2")
                   .arg(statusText).arg(message.slaveNum), "INFO");
+        // 阻值数据按主机确认的通道数解析，卡钉检测按确认的 clipStatus 判断
+        uint64_t nowMs = LatencyTracker::NowNs() / 1000000;
+        for (const auto &slave : message.slaves) {
+            m_resistanceAccumulator.setChannelCount(slave.id, slave.resistanceNum);
+            m_clipTracker.setExpectation(slave.id, slave.clipMode, slave.clipStatus, nowMs);
+        }
     } else {
         statusText = "失败";
         LogMessage(QString("从机配置响应: 状态=%1, 从机数量=%2")
                   .arg(statusText).arg(message.slaveNum), "ERROR");
     }
     
+    // 测试序列下发的配置由序列面板显示结果，不弹出模态对话框打断序列
+    if (m_pTestSequenceEngine->IsAwaiting(TestStep::Type::SlaveConfig)) {
+        return;
+    }
     QMessageBox::information(this, "从机配置响应", 
                            QString("配置结果: %1\n从机数量: %2")
                            .arg(statusText).arg(message.slaveNum));
 }
 
+void MainWindow::OnPlanSlaveConfigClicked()
+{
+    QPushButton* button = qobject_cast<QPushButton*>(sender());
+    if (!button) return;
+    
+    int row = button->property("row").toInt();
+    if (row >= 0 && row < m_slaveConfigs.size()) {
+        SlotPlanDialog dialog(m_slaveConfigs[row], this);
+        dialog.exec();
+    }
+}
+
 void MainWindow::OnCopySlaveConfigClicked()
 {
     QPushButton* button = qobject_cast<QPushButton*>(sender());
@@ -772,11 +1203,7 @@ void MainWindow::OnStartClicked()
     
     // 发送启动控制消息
     SendCtrlMessage(1); // 1表示启动
-    m_bDataViewRunning = true;
-    
-    // 更新按钮状态
-    ui->pushButtonStart->setEnabled(false);
-    ui->pushButtonStop->setEnabled(true);
+    SetAcquisitionRunning(true);
     
     LogMessage("发送启动控制消息", "INFO");
 }
@@ -790,45 +1217,62 @@ void MainWindow::OnStopClicked()
     
     // 发送停止控制消息
     SendCtrlMessage(0); // 0表示停止
-    m_bDataViewRunning = false;
-    
-    // 更新按钮状态
-    ui->pushButtonStart->setEnabled(true);
-    ui->pushButtonStop->setEnabled(false);
+    SetAcquisitionRunning(false);
     
     LogMessage("发送停止控制消息", "INFO");
 }
 
+void MainWindow::SetAcquisitionRunning(bool running)
+{
+    m_bDataViewRunning = running;
+    m_bAcquisitionRunning = running;
+    if (running) {
+        // 重新启动后新的告警可以再次停止采集
+        m_bStopPending = false;
+    }
+    
+    // 更新按钮状态
+    ui->pushButtonStart->setEnabled(m_bConnected && !running);
+    ui->pushButtonStop->setEnabled(m_bConnected && running);
+}
+
 void MainWindow::SendCtrlMessage(uint8_t runningStatus)
 {
     // 创建控制消息
-    WhtsProtocol::Backend2Master::CtrlMessage ctrlMsg;
-    ctrlMsg.runningStatus = runningStatus;
-    
-    // 使用协议处理器打包消息
-    auto packets = m_pProtocolProcessor->packBackend2MasterMessage(ctrlMsg);
-    
-    // 发送所有分片
-    for (const auto& packet : packets) {
-        QByteArray data(reinterpret_cast<const char*>(packet.data()), packet.size());
-        qint64 bytesWritten = m_pUdpSocket->writeDatagram(data, m_remoteAddress, m_remotePort);
-        
-        if (bytesWritten == -1) {
-            LogMessage(QString("发送控制消息失败: %1").arg(m_pUdpSocket->errorString()), "ERROR");
+    auto ctrlMsg = std::make_shared<WhtsProtocol::Backend2Master::CtrlMessage>();
+    ctrlMsg->runningStatus = runningStatus;
+    m_bAcquisitionRunning = runningStatus != 0;
+    
+    QFuture<CommandResult> future;
+    if (CommandEngine::IsUrgent(*ctrlMsg)) {
+        // 停止命令直接写入控制通道队首，命令层只等待应答（超时重发）
+        if (!SendBackend2MasterMessage(*ctrlMsg)) {
             return;
-        } else {
-            LogMessage(QString("发送控制消息 (状态=%1) -> %2:%3 [%4] (%5 bytes)")
-                      .arg(runningStatus)
-                      .arg(m_remoteAddress.toString())
-                      .arg(m_remotePort)
-                      .arg(ByteArrayToHexString(data))
-                      .arg(bytesWritten), "SEND");
         }
+        future = m_pCommandEngine->Track(ctrlMsg);
+    } else {
+        // 通过命令层发送，超时重发
+        future = m_pCommandEngine->Send(ctrlMsg);
     }
+    future.then(this, [this, runningStatus](const CommandResult &result) {
+        if (!result.Ok()) {
+            return;
+        }
+        auto response = std::dynamic_pointer_cast<const WhtsProtocol::Master2Backend::CtrlResponseMessage>(result.response);
+        if (response) {
+            LogMessage(QString("控制消息 (状态=%1) 已应答: 结果=%2, 运行状态=%3 (%4 ms, 发送 %5 次)")
+                      .arg(runningStatus)
+                      .arg(response->status)
+                      .arg(response->runningStatus)
+                      .arg(result.latencyNs / 1000000.0, 0, 'f', 1)
+                      .arg(result.attempts), response->status == 0 ? "INFO" : "WARN");
+        }
+    });
 }
 
 void MainWindow::HandleConductionDataMessage(uint32_t slaveId, const WhtsProtocol::DeviceStatus& deviceStatus, const WhtsProtocol::Slave2Backend::ConductionDataMessage& message)
 {
+    WHTS_TRACE_SCOPE("HandleConductionDataMessage");
     LogMessage(QString("收到导通数据消息 - 从机ID: 0x%1, 数据长度: %2")
               .arg(slaveId, 8, 16, QChar('0')).toUpper()
               .arg(message.conductionLength), "INFO");
@@ -837,21 +1281,27 @@ void MainWindow::HandleConductionDataMessage(uint32_t slaveId, const WhtsProtoco
     UpdateDataViewTable(slaveId, deviceStatus, message);
 }
 
+void MainWindow::HandleConductionBatchMessage(uint32_t slaveId, const WhtsProtocol::Slave2Backend::ConductionBatchMessage& message)
+{
+    WHTS_TRACE_SCOPE("HandleConductionBatchMessage");
+    LogMessage(QString("收到导通批量数据消息 - 从机ID: 0x%1, 采样数: %2, 每采样长度: %3")
+              .arg(slaveId, 8, 16, QChar('0')).toUpper()
+              .arg(message.sampleCount())
+              .arg(message.sampleLength), "INFO");
+
+    // 数据查看表每个从机只显示最新一次采样，批量帧只需刷新最后一个采样
+    size_t last = message.sampleCount() - 1;
+    WhtsProtocol::DeviceStatus deviceStatus;
+    deviceStatus.fromUint16(message.statuses[last]);
+    WhtsProtocol::Slave2Backend::ConductionDataMessage latest;
+    latest.conductionLength = message.sampleLength;
+    latest.conductionData = message.sampleData(last);
+    UpdateDataViewTable(slaveId, deviceStatus, latest);
+}
+
 void MainWindow::UpdateDataViewTable(uint32_t slaveId, const WhtsProtocol::DeviceStatus& deviceStatus, const WhtsProtocol::Slave2Backend::ConductionDataMessage& message)
 {
-    // 查找是否已存在该从机ID的行
-    int targetRow = -1;
-    for (int i = 0; i < ui->tableWidgetDataView->rowCount(); ++i) {
-        QTableWidgetItem* item = ui->tableWidgetDataView->item(i, 0);
-        if (item) {
-            bool ok;
-            uint32_t existingId = item->text().toUInt(&ok, 16);
-            if (ok && existingId == slaveId) {
-                targetRow = i;
-                break;
-            }
-        }
-    }
+    int targetRow = FindDataViewRow(slaveId);
     
     // 如果没有找到，创建新行
     if (targetRow == -1) {
@@ -861,19 +1311,15 @@ void MainWindow::UpdateDataViewTable(uint32_t slaveId, const WhtsProtocol::Devic
         // 设置从机ID
         ui->tableWidgetDataView->setItem(targetRow, 0, 
             new QTableWidgetItem(QString("0x%1").arg(slaveId, 8, 16, QChar('0')).toUpper()));
+        
+        // 设备状态列（CS, SL, EUB, BLA, PS, EL1, EL2, A1, A2）只在新建行时整行填写，之后由状态边沿更新
+        uint16_t status = deviceStatus.toUint16();
+        for (size_t bit = 0; bit < WhtsProtocol::DEVICE_STATUS_BIT_COUNT; ++bit) {
+            ui->tableWidgetDataView->setItem(targetRow, static_cast<int>(bit) + 1,
+                new QTableWidgetItem((status & (1u << bit)) ? "1" : "0"));
+        }
     }
     
-    // 更新设备状态列（CS, SL, EUB, BLA, PS, EL1, EL2, A1, A2）
-    ui->tableWidgetDataView->setItem(targetRow, 1, new QTableWidgetItem(deviceStatus.colorSensor ? "1" : "0"));
-    ui->tableWidgetDataView->setItem(targetRow, 2, new QTableWidgetItem(deviceStatus.sleeveLimit ? "1" : "0"));
-    ui->tableWidgetDataView->setItem(targetRow, 3, new QTableWidgetItem(deviceStatus.electromagnetUnlockButton ? "1" : "0"));
-    ui->tableWidgetDataView->setItem(targetRow, 4, new QTableWidgetItem(deviceStatus.batteryLowAlarm ? "1" : "0"));
-    ui->tableWidgetDataView->setItem(targetRow, 5, new QTableWidgetItem(deviceStatus.pressureSensor ? "1" : "0"));
-    ui->tableWidgetDataView->setItem(targetRow, 6, new QTableWidgetItem(deviceStatus.electromagneticLock1 ? "1" : "0"));
-    ui->tableWidgetDataView->setItem(targetRow, 7, new QTableWidgetItem(deviceStatus.electromagneticLock2 ? "1" : "0"));
-    ui->tableWidgetDataView->setItem(targetRow, 8, new QTableWidgetItem(deviceStatus.accessory1 ? "1" : "0"));
-    ui->tableWidgetDataView->setItem(targetRow, 9, new QTableWidgetItem(deviceStatus.accessory2 ? "1" : "0"));
-    
     // 更新导通数据列
     QString conductionDataStr = ConductionDataToString(message.conductionData);
     ui->tableWidgetDataView->setItem(targetRow, 10, new QTableWidgetItem(conductionDataStr));
@@ -882,6 +1328,45 @@ void MainWindow::UpdateDataViewTable(uint32_t slaveId, const WhtsProtocol::Devic
     ui->tableWidgetDataView->scrollToItem(ui->tableWidgetDataView->item(targetRow, 0));
 }
 
+int MainWindow::FindDataViewRow(uint32_t slaveId) const
+{
+    for (int i = 0; i < ui->tableWidgetDataView->rowCount(); ++i) {
+        QTableWidgetItem* item = ui->tableWidgetDataView->item(i, 0);
+        if (item) {
+            bool ok;
+            uint32_t existingId = item->text().toUInt(&ok, 16);
+            if (ok && existingId == slaveId) {
+                return i;
+            }
+        }
+    }
+    return -1;
+}
+
+void MainWindow::AnalyzeConductionSample(uint32_t slaveId, uint16_t status, const uint8_t *data, size_t length, uint64_t nowMs)
+{
+    m_sampleHistory.record(slaveId, WhtsProtocol::HistoryKind::CONDUCTION, nowMs, status, data, length);
+    m_pinFlipAccumulator.onConduction(slaveId, data, length, nowMs);
+    if (m_ruleEngine.usesConduction()) {
+        m_ruleEngine.onConduction(slaveId, data, length, nowMs);
+    }
+}
+
+void MainWindow::OnDeviceStatusEdge(const WhtsProtocol::DeviceStatusEdge &edge)
+{
+    LogMessage(QString("从机 0x%1 状态变化: %2 %3")
+              .arg(edge.slaveId, 8, 16, QChar('0')).toUpper()
+              .arg(WhtsProtocol::deviceStatusBitName(edge.bit))
+              .arg(edge.asserted ? "0 -> 1" : "1 -> 0"), "INFO");
+    
+    // 数据查看表中已有该从机时只改对应的状态单元格
+    int row = FindDataViewRow(edge.slaveId);
+    if (row >= 0) {
+        ui->tableWidgetDataView->setItem(row, static_cast<int>(edge.bit) + 1,
+            new QTableWidgetItem(edge.asserted ? "1" : "0"));
+    }
+}
+
 QString MainWindow::DeviceStatusToString(const WhtsProtocol::DeviceStatus& status)
 {
     QStringList statusList;
@@ -917,3 +1402,123 @@ void MainWindow::OnClearDataClicked()
     
     LogMessage("清除数据查看表格", "INFO");
 }
+
+bool MainWindow::SendBackend2MasterMessage(const WhtsProtocol::Message &message)
+{
+    if (!m_bConnected || !m_pUdpSocket) {
+        LogMessage(QString("发送%1失败: UDP未连接").arg(message.getMessageTypeName()), "ERROR");
+        return false;
+    }
+    
+    // 停止采集和复位不走可靠分片, 直接插到控制通道队首, 不受队列上限限制
+    bool urgent = CommandEngine::IsUrgent(message);
+    if (!urgent && SendReliableBackend2MasterMessage(message)) {
+        return true;
+    }
+    
+    // 使用协议处理器打包消息, 按消息类型进入发送通道
+    auto packets = m_pProtocolProcessor->packBackend2MasterMessage(message);
+    if (urgent) {
+        LogMessage(QString("立即发送%1 (%2 帧, Control 通道)")
+                  .arg(message.getMessageTypeName())
+                  .arg(packets.size()), "SEND");
+        uint64_t nowMs = LatencyTracker::NowNs() / 1000000;
+        m_pTransmitScheduler->enqueueUrgent(WhtsProtocol::TransmitLane::CONTROL, std::move(packets), nowMs);
+        ScheduleTransmit(m_pTransmitScheduler->poll(nowMs));
+        return true;
+    }
+    auto lane = WhtsProtocol::transmitLaneFor(message.getMessageId());
+    LogMessage(QString("发送%1 (%2 帧, %3 通道)")
+              .arg(message.getMessageTypeName())
+              .arg(packets.size())
+              .arg(WhtsProtocol::transmitLaneName(lane)), "SEND");
+    if (!EnqueueFrames(lane, std::move(packets))) {
+        LogMessage(QString("发送%1失败: 发送队列已满").arg(message.getMessageTypeName()), "ERROR");
+        return false;
+    }
+    return true;
+}
+
+bool MainWindow::SendReliableBackend2MasterMessage(const WhtsProtocol::Message &message)
+{
+    // 只有需要分片的消息走可靠分片, 单帧消息由各自的应答确认
+    if (!ui->checkBoxReliableFragments->isChecked()) {
+        return false;
+    }
+    auto frame = m_pProtocolProcessor->packBackend2MasterMessageSingle(message);
+    size_t frameLimit = m_pProtocolProcessor->getMTU();
+    if (m_pProtocolProcessor->isCrcActive()) {
+        frameLimit -= WhtsProtocol::FRAME_CRC_SIZE;
+    }
+    if (frame.size() <= frameLimit) {
+        return false;
+    }
+    
+    uint64_t nowMs = LatencyTracker::NowNs() / 1000000;
+    uint8_t reliableId = m_pReliableSender->send(frame, nowMs);
+    m_pReliableTimer->start();
+    LogMessage(QString("可靠分片发送%1 (ID=%2, %3 bytes) -> %4:%5")
+              .arg(message.getMessageTypeName())
+              .arg(reliableId)
+              .arg(frame.size())
+              .arg(m_remoteAddress.toString())
+              .arg(m_remotePort), "SEND");
+    return true;
+}
+
+bool MainWindow::WriteFrame(const std::vector<uint8_t> &frame)
+{
+    if (!m_pUdpSocket) {
+        return false;
+    }
+    QByteArray data(reinterpret_cast<const char*>(frame.data()), frame.size());
+    qint64 bytesWritten = m_pUdpSocket->writeDatagram(data, m_remoteAddress, m_remotePort);
+    if (bytesWritten == -1) {
+        LogMessage(QString("发送失败: %1").arg(m_pUdpSocket->errorString()), "ERROR");
+        return false;
+    }
+    LogMessage(QString("发送数据 -> %1:%2 [%3] (%4 bytes)")
+              .arg(m_remoteAddress.toString())
+              .arg(m_remotePort)
+              .arg(ByteArrayToHexString(data))
+              .arg(bytesWritten), "SEND");
+    return true;
+}
+
+bool MainWindow::EnqueueFrames(WhtsProtocol::TransmitLane lane, std::vector<std::vector<uint8_t>> frames)
+{
+    bool queued = m_pTransmitScheduler->enqueue(lane, std::move(frames), LatencyTracker::NowNs() / 1000000);
+    ScheduleTransmit(m_pTransmitScheduler->poll(LatencyTracker::NowNs() / 1000000));
+    return queued;
+}
+
+void MainWindow::ScheduleTransmit(int64_t waitMs)
+{
+    if (waitMs < 0) {
+        m_pTransmitTimer->stop();
+    } else if (!m_pTransmitTimer->isActive() || m_pTransmitTimer->remainingTime() > waitMs) {
+        m_pTransmitTimer->start(static_cast<int>(std::max<int64_t>(1, waitMs)));
+    }
+}
+
+void MainWindow::OnTransmitTimer()
+{
+    ScheduleTransmit(m_pTransmitScheduler->poll(LatencyTracker::NowNs() / 1000000));
+}
+
+void MainWindow::FlushProtocolOutgoing()
+{
+    // 可靠分片的确认帧走控制通道, 避免排在配置流量后面拉长对端的往返时间
+    std::vector<uint8_t> frame;
+    while (m_pProtocolProcessor->getNextOutgoingFrame(frame)) {
+        EnqueueFrames(WhtsProtocol::TransmitLane::CONTROL, {std::move(frame)});
+    }
+}
+
+void MainWindow::OnReliableTimer()
+{
+    m_pReliableSender->poll(LatencyTracker::NowNs() / 1000000);
+    if (!m_pReliableSender->busy()) {
+        m_pReliableTimer->stop();
+    }
+}
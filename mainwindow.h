@@ -20,14 +20,44 @@
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QHeaderView>
+#include <unordered_map>
 
 // Protocol相关头文件
 #include "protocol/ProtocolProcessor.h"
+#include "protocol/ConductionDelta.h"
+#include "protocol/ReliableTransport.h"
+#include "protocol/TransmitScheduler.h"
 #include "protocol/messages/Backend2Master.h"
 #include "protocol/messages/Master2Backend.h"
 #include "protocol/messages/Slave2Backend.h"
+#include "protocol/DeviceRegistry.h"
 #include "protocol/DeviceStatus.h"
+#include "protocol/DeviceStatusTracker.h"
+#include "protocol/RuleEngine.h"
+#include "protocol/PinFlipAccumulator.h"
+#include "protocol/ResistanceAccumulator.h"
+#include "protocol/ClipTracker.h"
+#include "protocol/SampleHistory.h"
+#include "protocol/utils/TraceRecorder.h"
 #include "slaveconfigdialog.h"
+#include "slotplandialog.h"
+#include "pipelinestatswidget.h"
+#include "latencytracker.h"
+#include "socketrxprobe.h"
+#include "pingengine.h"
+#include "linkqualitywidget.h"
+#include "channelsweeper.h"
+#include "intervalcontroller.h"
+#include "commandengine.h"
+#include "testsequence.h"
+#include "testsequencewidget.h"
+#include "devicetablemodel.h"
+#include "batteryitemdelegate.h"
+#include "alarmwidget.h"
+#include "pinflipwidget.h"
+#include "resistancewidget.h"
+#include "clipwidget.h"
+#include "historywidget.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui {
@@ -58,23 +88,27 @@ private slots:
     void OnDeleteSlaveConfigClicked();
     void OnSendSlaveConfigClicked();
     void OnCopySlaveConfigClicked();
+    void OnPlanSlaveConfigClicked();
     void OnStartClicked();
     void OnStopClicked();
     void OnClearDataClicked();
+    void OnReliableTimer();
+    void OnTransmitTimer();
+    void OnDeviceRegistryTimer();
 
 private:
     void InitializeUI();
-    void LogMessage(const QString &message, const QString &type = "INFO");
+    void LogMessage(const QString &message, const QString &type = "INFO", const QDateTime &timestamp = QDateTime());
     void WriteLogToFile(const QString &message);
     QByteArray HexStringToByteArray(const QString &hexString);
     QString ByteArrayToHexString(const QByteArray &data);
     void UpdateConnectionState(bool connected);
-    void ProcessProtocolMessage(const std::vector<uint8_t> &data);
+    void ProcessProtocolFrames();
+    void RecordLatency(LatencyStage stage, uint8_t packetId, const WhtsProtocol::Message &message, uint64_t startNs);
     void HandleDeviceListResponse(const WhtsProtocol::Master2Backend::DeviceListResponseMessage &message);
-    void UpdateDeviceTable(const std::vector<WhtsProtocol::Master2Backend::DeviceListResponseMessage::DeviceInfo> &devices);
+    void UpdateDeviceTable();
     void SendDeviceListRequest();
     void SendClearDeviceListRequest();
-    QWidget* CreateBatteryWidget(uint8_t batteryLevel);
     void HandleSlaveConfigResponse(const WhtsProtocol::Master2Backend::SlaveConfigResponseMessage &message);
     void LoadSlaveConfigs();
     void SaveSlaveConfigs();
@@ -82,14 +116,34 @@ private:
     QWidget* CreateSlaveConfigActionWidget(int row);
     void SendSlaveConfig(const SlaveConfigData& configData);
     void HandleConductionDataMessage(uint32_t slaveId, const WhtsProtocol::DeviceStatus& deviceStatus, const WhtsProtocol::Slave2Backend::ConductionDataMessage& message);
+    void HandleConductionBatchMessage(uint32_t slaveId, const WhtsProtocol::Slave2Backend::ConductionBatchMessage& message);
     void UpdateDataViewTable(uint32_t slaveId, const WhtsProtocol::DeviceStatus& deviceStatus, const WhtsProtocol::Slave2Backend::ConductionDataMessage& message);
+    int FindDataViewRow(uint32_t slaveId) const;
+    void OnDeviceStatusEdge(const WhtsProtocol::DeviceStatusEdge &edge);
+    // 每个导通采样（含批量帧中的每个采样和还原后的差分帧）都经过这里，与数据查看是否运行无关
+    void AnalyzeConductionSample(uint32_t slaveId, uint16_t status, const uint8_t *data, size_t length, uint64_t nowMs);
     void SendCtrlMessage(uint8_t runningStatus);
+    // 启动/停止按钮和测试序列的 ctrl 步骤都经过这里，同步数据查看和按钮状态
+    void SetAcquisitionRunning(bool running);
+    bool SendBackend2MasterMessage(const WhtsProtocol::Message &message);
+    // 启用可靠分片且消息需要分片时按可靠分片发送并返回 true, 否则不发送
+    bool SendReliableBackend2MasterMessage(const WhtsProtocol::Message &message);
+    bool WriteFrame(const std::vector<uint8_t> &frame);
+    // 帧经发送调度发出; 队列满时返回 false
+    bool EnqueueFrames(WhtsProtocol::TransmitLane lane, std::vector<std::vector<uint8_t>> frames);
+    void ScheduleTransmit(int64_t waitMs);
+    void FlushProtocolOutgoing();
     QString DeviceStatusToString(const WhtsProtocol::DeviceStatus& status);
     QString ConductionDataToString(const std::vector<uint8_t>& data);
 
 private:
     Ui::MainWindow *ui;
     QUdpSocket *m_pUdpSocket;
+    SocketRxProbe m_socketRxProbe;
+    // 默认接收缓冲区大小，可通过设置项 Network/ReceiveBufferBytes 修改
+    static constexpr int DEFAULT_RECEIVE_BUFFER_BYTES = 4 * 1024 * 1024;
+    // 每批读取的数据报数，批内的控制应答优先分发
+    static constexpr int RX_BATCH_DATAGRAMS = 64;
     QHostAddress m_localAddress;
     quint16 m_localPort;
     QHostAddress m_remoteAddress;
@@ -100,12 +154,81 @@ private:
     
     // Protocol处理器
     WhtsProtocol::ProtocolProcessor *m_pProtocolProcessor;
+    // 导通差分帧按从机还原为完整数据
+    WhtsProtocol::ConductionDeltaDecoder m_conductionDeltaDecoder;
+    // 可靠分片发送 (选择确认 + 自适应超时重传)
+    WhtsProtocol::ReliableSender *m_pReliableSender;
+    QTimer *m_pReliableTimer;
+    static constexpr int RELIABLE_POLL_INTERVAL_MS = 10;
+    // 分通道发送调度
+    WhtsProtocol::TransmitScheduler *m_pTransmitScheduler;
+    QTimer *m_pTransmitTimer;
+    // 默认限速，可通过设置项 Network/ConfigLaneBytesPerSec、Network/DiagnosticsLaneBytesPerSec 修改
+    static constexpr uint32_t DEFAULT_CONFIG_LANE_BYTES_PER_SEC = 32 * 1024;
+    static constexpr uint32_t DEFAULT_DIAGNOSTICS_LANE_BYTES_PER_SEC = 16 * 1024;
+    static constexpr uint32_t DEFAULT_LANE_BURST_BYTES = 1024;
+    // 命令层（下发命令与应答匹配）
+    CommandEngine *m_pCommandEngine;
+    // 自动测试序列
+    TestSequenceEngine *m_pTestSequenceEngine;
+    TestSequenceWidget *m_pTestSequenceWidget;
+    
+    // 管线统计面板
+    LatencyTracker m_latencyTracker;
+    WhtsProtocol::SequenceTracker m_sequenceTracker;
+    PipelineStatsWidget *m_pPipelineStatsWidget;
+    QLabel *m_pLabelPipelineSummary;
+    
+    // 链路质量（Ping）
+    PingEngine *m_pPingEngine;
+    ChannelSweeper *m_pChannelSweeper;
+    IntervalController *m_pIntervalController;
+    LinkQualityWidget *m_pLinkQualityWidget;
+    
+    // 设备列表（由设备注册表驱动，从机变为不活跃或出现新从机时自动补发设备列表请求）
+    DeviceTableModel *m_pDeviceTableModel;
+    WhtsProtocol::DeviceRegistry m_deviceRegistry;
+    QTimer *m_pDeviceRegistryTimer;
+    uint64_t m_deviceRegistryVersion;
+    QLabel *m_pLabelFleetSummary;
+    static constexpr int DEVICE_REGISTRY_INTERVAL_MS = 100;
     
     // 从机配置管理
     QList<SlaveConfigData> m_slaveConfigs;
     QSettings *m_pSettings;
     
+    // 设备状态位边沿检测（日志、数据查看表和规则订阅状态变化）
+    WhtsProtocol::DeviceStatusTracker m_deviceStatusTracker;
+    
+    // 告警规则（状态位变化和导通数据驱动，持续条件由设备注册表定时器检查）
+    WhtsProtocol::RuleEngine m_ruleEngine;
+    AlarmWidget *m_pAlarmWidget;
+    
+    // 导通数据间歇故障统计（每针脚翻转次数）
+    WhtsProtocol::PinFlipAccumulator m_pinFlipAccumulator;
+    PinFlipWidget *m_pPinFlipWidget;
+    
+    // 阻值数据统计（通道数取自主机确认的从机配置）
+    WhtsProtocol::ResistanceAccumulator m_resistanceAccumulator;
+    ResistanceWidget *m_pResistanceWidget;
+    
+    // 卡钉检测（期望取自主机确认的从机配置，插拔事件由面板定时取出）
+    WhtsProtocol::ClipTracker m_clipTracker;
+    ClipWidget *m_pClipWidget;
+    
+    // 每从机采样历史（固定内存的环形缓冲，状态只记录变化）
+    WhtsProtocol::SampleHistory m_sampleHistory;
+    HistoryWidget *m_pHistoryWidget;
+    
+    // 每从机最近一个采样的时间（毫秒），批量帧的采样时间按采样间隔倒推但不早于该值
+    std::unordered_map<uint32_t, uint64_t> m_lastSampleMs;
+    
     // 数据查看相关
     bool m_bDataViewRunning;
+    
+    // 主机的采集状态：每次下发 CtrlMessage 时按命令设置，收到 CtrlResponse 时按其 runningStatus 更新
+    bool m_bAcquisitionRunning;
+    // 告警已下发停止、主机尚未确认停止，同一批告警只下发一次
+    bool m_bStopPending;
 };
 #endif // MAINWINDOW_H
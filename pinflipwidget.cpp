@@ -0,0 +1,127 @@
+#include "pinflipwidget.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QColor>
+
+#include "latencytracker.h"
+
+namespace {
+// 刷新周期（毫秒）
+constexpr int PIN_FLIP_REFRESH_INTERVAL_MS = 1000;
+
+enum PinColumn {
+    PIN_COLUMN_SLAVE = 0,
+    PIN_COLUMN_PIN,
+    PIN_COLUMN_FLIPS,
+    PIN_COLUMN_MIN_DWELL,
+    PIN_COLUMN_FAULT_TIME,
+    PIN_COLUMN_STATE,
+    PIN_COLUMN_LAST_FLIP,
+    PIN_COLUMN_TOTAL
+};
+}
+
+PinFlipWidget::PinFlipWidget(WhtsProtocol::PinFlipAccumulator *pAccumulator, QWidget *parent)
+    : QWidget(parent)
+    , m_pAccumulator(pAccumulator)
+    , m_pSpinBoxTopN(nullptr)
+    , m_pPushButtonReset(nullptr)
+    , m_pLabelSummary(nullptr)
+    , m_pTableWidgetPins(nullptr)
+    , m_pRefreshTimer(nullptr)
+{
+    InitializeUI();
+
+    m_pRefreshTimer = new QTimer(this);
+    connect(m_pRefreshTimer, &QTimer::timeout, this, &PinFlipWidget::OnRefreshTimeout);
+    m_pRefreshTimer->start(PIN_FLIP_REFRESH_INTERVAL_MS);
+}
+
+void PinFlipWidget::InitializeUI()
+{
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+
+    QHBoxLayout *controlLayout = new QHBoxLayout();
+    controlLayout->addWidget(new QLabel("显示前", this));
+    m_pSpinBoxTopN = new QSpinBox(this);
+    m_pSpinBoxTopN->setRange(1, 500);
+    m_pSpinBoxTopN->setValue(20);
+    controlLayout->addWidget(m_pSpinBoxTopN);
+    controlLayout->addWidget(new QLabel("个针脚", this));
+    m_pPushButtonReset = new QPushButton("清零", this);
+    controlLayout->addWidget(m_pPushButtonReset);
+    m_pLabelSummary = new QLabel(this);
+    controlLayout->addWidget(m_pLabelSummary, 1);
+    mainLayout->addLayout(controlLayout);
+
+    m_pTableWidgetPins = new QTableWidget(0, PIN_COLUMN_TOTAL, this);
+    m_pTableWidgetPins->setHorizontalHeaderLabels(
+        {"从机", "针脚", "翻转次数", "最短稳定(ms)", "故障累计(ms)", "当前状态", "最近翻转(s前)"});
+    m_pTableWidgetPins->verticalHeader()->setVisible(false);
+    m_pTableWidgetPins->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_pTableWidgetPins->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    mainLayout->addWidget(m_pTableWidgetPins);
+
+    connect(m_pPushButtonReset, &QPushButton::clicked, this, &PinFlipWidget::OnResetClicked);
+}
+
+void PinFlipWidget::OnRefreshTimeout()
+{
+    // 面板不可见时不计算排序
+    if (!isVisible()) {
+        return;
+    }
+
+    uint64_t nowMs = LatencyTracker::NowNs() / 1000000;
+    const auto pins = m_pAccumulator->topN(static_cast<size_t>(m_pSpinBoxTopN->value()), nowMs);
+    m_pTableWidgetPins->setRowCount(static_cast<int>(pins.size()));
+
+    for (int row = 0; row < static_cast<int>(pins.size()); ++row) {
+        const WhtsProtocol::PinFlipStats &stats = pins[row];
+        QStringList cells;
+        cells << QString("0x%1").arg(stats.slaveId, 8, 16, QChar('0')).toUpper()
+              << QString::number(stats.pin)
+              << QString::number(stats.flips)
+              << (stats.flips > 1 ? QString::number(stats.minDwellMs) : QString("-"))
+              << QString::number(stats.faultMs)
+              << (stats.faulted ? "与首帧不同" : "与首帧相同")
+              << QString::number((nowMs - stats.lastFlipMs) / 1000.0, 'f', 1);
+
+        for (int column = 0; column < PIN_COLUMN_TOTAL; ++column) {
+            QTableWidgetItem *item = m_pTableWidgetPins->item(row, column);
+            if (!item) {
+                item = new QTableWidgetItem();
+                if (column > PIN_COLUMN_SLAVE) {
+                    item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+                }
+                m_pTableWidgetPins->setItem(row, column, item);
+            }
+            item->setText(cells[column]);
+            if (column == PIN_COLUMN_STATE) {
+                item->setForeground(stats.faulted ? QColor(220, 0, 0) : QColor(0, 160, 0));
+            }
+        }
+    }
+
+    const auto slaves = m_pAccumulator->slaves();
+    uint64_t flakyPins = 0;
+    for (const auto &slave : slaves) {
+        flakyPins += slave.flakyPins;
+    }
+    m_pLabelSummary->setText(QString("从机 %1，翻转总数 %2，翻转过的针脚 %3，内存 %4 KB%5")
+                                 .arg(slaves.size())
+                                 .arg(m_pAccumulator->totalFlips())
+                                 .arg(flakyPins)
+                                 .arg(m_pAccumulator->memoryBytes() / 1024)
+                                 .arg(m_pAccumulator->droppedFrames()
+                                          ? QString("，超出上限未统计 %1 帧").arg(m_pAccumulator->droppedFrames())
+                                          : QString()));
+}
+
+void PinFlipWidget::OnResetClicked()
+{
+    m_pAccumulator->reset();
+    m_pTableWidgetPins->setRowCount(0);
+    OnRefreshTimeout();
+}
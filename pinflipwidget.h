@@ -0,0 +1,38 @@
+#ifndef PINFLIPWIDGET_H
+#define PINFLIPWIDGET_H
+
+#include <QWidget>
+#include <QTableWidget>
+#include <QPushButton>
+#include <QSpinBox>
+#include <QLabel>
+#include <QTimer>
+
+#include "protocol/PinFlipAccumulator.h"
+
+// 间歇故障面板：定时显示导通数据中翻转次数最多的针脚（最不稳定的连接）
+class PinFlipWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    PinFlipWidget(WhtsProtocol::PinFlipAccumulator *pAccumulator, QWidget *parent = nullptr);
+
+private slots:
+    void OnRefreshTimeout();
+    void OnResetClicked();
+
+private:
+    void InitializeUI();
+
+private:
+    WhtsProtocol::PinFlipAccumulator *m_pAccumulator;
+
+    QSpinBox *m_pSpinBoxTopN;
+    QPushButton *m_pPushButtonReset;
+    QLabel *m_pLabelSummary;
+    QTableWidget *m_pTableWidgetPins;
+    QTimer *m_pRefreshTimer;
+};
+
+#endif // PINFLIPWIDGET_H
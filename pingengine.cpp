@@ -0,0 +1,249 @@
+#include "pingengine.h"
+#include "latencytracker.h"
+#include "protocol/messages/Backend2Master.h"
+
+double PingSlaveStats::SuccessRatio() const
+{
+    return sent ? static_cast<double>(succeeded) / static_cast<double>(sent) : 0.0;
+}
+
+double PingSlaveStats::RecentSuccessRatio() const
+{
+    uint64_t totalSent = 0;
+    uint64_t totalSucceeded = 0;
+    for (size_t i = 0; i < recentCount; ++i) {
+        totalSent += recentSent[i];
+        totalSucceeded += recentSucceeded[i];
+    }
+    return totalSent ? static_cast<double>(totalSucceeded) / static_cast<double>(totalSent) : 0.0;
+}
+
+void PingSlaveStats::AddRun(uint16_t runSent, uint16_t runSucceeded)
+{
+    recentSent[recentHead] = runSent;
+    recentSucceeded[recentHead] = runSucceeded;
+    recentHead = (recentHead + 1) % RECENT_RUN_COUNT;
+    if (recentCount < RECENT_RUN_COUNT) {
+        ++recentCount;
+    }
+}
+
+PingEngine::PingEngine(QObject *parent)
+    : QObject(parent)
+    , m_pTimeoutTimer(new QTimer(this))
+    , m_nextTarget(0)
+    , m_roundsLeft(0)
+    , m_bRunning(false)
+    , m_bAwaiting(false)
+    , m_currentTarget(0)
+    , m_sentNs(0)
+    , m_replySamples(0)
+    , m_replyRttSumNs(0)
+    , m_firstSequence(0)
+    , m_firstTimestamp(0)
+    , m_lastSequence(0)
+{
+    m_pTimeoutTimer->setSingleShot(true);
+    connect(m_pTimeoutTimer, &QTimer::timeout, this, &PingEngine::OnTimeout);
+}
+
+bool PingEngine::Start(const std::vector<uint32_t> &slaveIds, const Config &config)
+{
+    if (m_bRunning || slaveIds.empty() || !m_sender || config.pingCount == 0 || config.rounds <= 0) {
+        return false;
+    }
+
+    m_config = config;
+    m_targets = slaveIds;
+    m_nextTarget = 0;
+    m_roundsLeft = config.rounds;
+    m_bRunning = true;
+    IssueNext();
+    return true;
+}
+
+void PingEngine::Stop()
+{
+    if (!m_bRunning) {
+        return;
+    }
+    m_pTimeoutTimer->stop();
+    m_bAwaiting = false;
+    m_bRunning = false;
+    emit Finished();
+}
+
+void PingEngine::IssueNext()
+{
+    if (!m_bRunning) {
+        return;
+    }
+
+    if (m_nextTarget >= m_targets.size()) {
+        m_nextTarget = 0;
+        if (--m_roundsLeft <= 0) {
+            m_bRunning = false;
+            emit Finished();
+            return;
+        }
+    }
+
+    m_currentTarget = m_targets[m_nextTarget++];
+
+    WhtsProtocol::Backend2Master::PingCtrlMessage pingCtrl;
+    pingCtrl.pingMode = m_config.pingMode;
+    pingCtrl.pingCount = m_config.pingCount;
+    pingCtrl.interval = m_config.intervalMs;
+    pingCtrl.destinationId = m_currentTarget;
+
+    m_sentNs = LatencyTracker::NowNs();
+    m_replySamples = 0;
+    m_replyRttSumNs = 0;
+    if (!m_sender(pingCtrl)) {
+        // 链路不可用，结束本次测试
+        Stop();
+        return;
+    }
+
+    m_bAwaiting = true;
+    m_pTimeoutTimer->start(static_cast<int>(m_config.pingCount) * m_config.intervalMs + m_config.timeoutMarginMs);
+}
+
+void PingEngine::CompleteRun(bool timedOut)
+{
+    m_pTimeoutTimer->stop();
+    m_bAwaiting = false;
+
+    if (timedOut) {
+        PingSlaveStats *stats = StatsFor(m_currentTarget);
+        if (stats) {
+            ++stats->runs;
+            ++stats->timeouts;
+            stats->sent += m_config.pingCount;
+            stats->AddRun(m_config.pingCount, 0);
+        }
+        emit RunMeasured(m_currentTarget, m_config.pingCount, 0, 0);
+        emit StatsChanged();
+    }
+    emit RunCompleted(m_currentTarget, timedOut);
+}
+
+void PingEngine::OnTimeout()
+{
+    if (!m_bAwaiting) {
+        return;
+    }
+    CompleteRun(true);
+    IssueNext();
+}
+
+void PingEngine::OnPingResponse(const WhtsProtocol::Master2Backend::PingResponseMessage &message, uint64_t arrivalNs)
+{
+    if (!m_bAwaiting || message.destinationId != m_currentTarget) {
+        return;
+    }
+
+    uint64_t runNs = arrivalNs > m_sentNs ? arrivalNs - m_sentNs : 0;
+    uint64_t runRttNs = 0;
+    if (m_replySamples > 0) {
+        runRttNs = m_replyRttSumNs / m_replySamples;
+    } else if (message.successCount > 0) {
+        // 看不到逐次 PingRsp 时，扣除主机按间隔发送所用的时间，作为往返时间估算
+        uint64_t scheduledNs = static_cast<uint64_t>(message.totalCount > 0 ? message.totalCount - 1 : 0) *
+                               m_config.intervalMs * 1000000ULL;
+        runRttNs = runNs > scheduledNs ? runNs - scheduledNs : 0;
+    }
+
+    PingSlaveStats *stats = StatsFor(m_currentTarget);
+    if (stats) {
+        ++stats->runs;
+        stats->sent += message.totalCount;
+        stats->succeeded += message.successCount;
+        stats->runLatencyNs.record(runNs);
+        stats->AddRun(message.totalCount, message.successCount);
+        if (m_replySamples == 0 && message.successCount > 0) {
+            stats->rttNs.record(runRttNs);
+        }
+    }
+
+    emit RunMeasured(m_currentTarget, message.totalCount, message.successCount, runRttNs);
+    CompleteRun(false);
+    emit StatsChanged();
+    IssueNext();
+}
+
+void PingEngine::OnPingReply(uint32_t slaveId, const WhtsProtocol::Slave2Master::PingRspMessage &message, uint64_t arrivalNs)
+{
+    if (!m_bAwaiting || slaveId != m_currentTarget) {
+        return;
+    }
+
+    PingSlaveStats *stats = StatsFor(slaveId);
+    if (!stats) {
+        return;
+    }
+
+    if (m_replySamples == 0) {
+        m_firstSequence = message.sequenceNumber;
+        m_firstTimestamp = message.timestamp;
+    } else {
+        uint16_t expected = static_cast<uint16_t>(m_lastSequence + 1);
+        if (message.sequenceNumber != expected) {
+            stats->sequenceGaps += static_cast<uint16_t>(message.sequenceNumber - expected);
+        }
+    }
+    m_lastSequence = message.sequenceNumber;
+    ++m_replySamples;
+
+    // 该次 ping 的发出时刻：优先用回显的主机时间戳（微秒）相对本轮第一次的偏移，
+    // 没有时间戳时按序号和间隔推算。结果包含后端到主机的单程延迟
+    uint64_t offsetNs;
+    if (message.timestamp != 0 || m_firstTimestamp != 0) {
+        offsetNs = static_cast<uint64_t>(static_cast<uint32_t>(message.timestamp - m_firstTimestamp)) * 1000ULL;
+    } else {
+        offsetNs = static_cast<uint64_t>(static_cast<uint16_t>(message.sequenceNumber - m_firstSequence)) *
+                   m_config.intervalMs * 1000000ULL;
+    }
+    uint64_t expectedSendNs = m_sentNs + offsetNs;
+    uint64_t rttNs = arrivalNs > expectedSendNs ? arrivalNs - expectedSendNs : 0;
+    stats->rttNs.record(rttNs);
+    m_replyRttSumNs += rttNs;
+}
+
+PingSlaveStats *PingEngine::StatsFor(uint32_t slaveId)
+{
+    auto it = m_stats.find(slaveId);
+    if (it != m_stats.end()) {
+        return it->second.get();
+    }
+    if (m_stats.size() >= MAX_TRACKED_SLAVES) {
+        return nullptr;
+    }
+    auto stats = std::make_unique<PingSlaveStats>();
+    stats->slaveId = slaveId;
+    PingSlaveStats *pStats = stats.get();
+    m_stats.emplace(slaveId, std::move(stats));
+    return pStats;
+}
+
+std::vector<const PingSlaveStats *> PingEngine::AllStats() const
+{
+    std::vector<const PingSlaveStats *> result;
+    result.reserve(m_stats.size());
+    for (const auto &entry : m_stats) {
+        result.push_back(entry.second.get());
+    }
+    return result;
+}
+
+const PingSlaveStats *PingEngine::Stats(uint32_t slaveId) const
+{
+    auto it = m_stats.find(slaveId);
+    return it != m_stats.end() ? it->second.get() : nullptr;
+}
+
+void PingEngine::ResetStats()
+{
+    m_stats.clear();
+    emit StatsChanged();
+}
@@ -0,0 +1,121 @@
+#ifndef PINGENGINE_H
+#define PINGENGINE_H
+
+#include <QObject>
+#include <QTimer>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "protocol/messages/Master2Backend.h"
+#include "protocol/messages/Slave2Master.h"
+#include "protocol/utils/LatencyHistogram.h"
+
+// 单个从机的 Ping 统计，内存固定（直方图 + 最近若干轮的环形记录）
+struct PingSlaveStats {
+    static constexpr size_t RECENT_RUN_COUNT = 32;
+
+    uint32_t slaveId = 0;
+    uint32_t runs = 0;             // 完成的轮数（含超时）
+    uint32_t timeouts = 0;         // 未收到 PingResponse 的轮数
+    uint64_t sent = 0;             // 累计 ping 次数
+    uint64_t succeeded = 0;        // 累计成功次数
+    uint64_t sequenceGaps = 0;     // PingRsp 序号缺口（仅在能看到 PingRsp 时统计）
+
+    // 单次往返时间（纳秒）。能看到 Slave2Master PingRsp 时按序号/时间戳逐次计算，
+    // 否则每轮记录一个估算值：整轮耗时 - (次数 - 1) * 间隔
+    WhtsProtocol::LatencyHistogram rttNs;
+    // PingCtrl 发出 -> PingResponse 收到的整轮耗时（纳秒）
+    WhtsProtocol::LatencyHistogram runLatencyNs;
+
+    std::array<uint16_t, RECENT_RUN_COUNT> recentSent{};
+    std::array<uint16_t, RECENT_RUN_COUNT> recentSucceeded{};
+    size_t recentHead = 0;
+    size_t recentCount = 0;
+
+    double SuccessRatio() const;
+    // 最近 RECENT_RUN_COUNT 轮的成功率
+    double RecentSuccessRatio() const;
+    void AddRun(uint16_t runSent, uint16_t runSucceeded);
+};
+
+// Ping 引擎：按从机逐个下发 PingCtrlMessage，匹配 PingResponseMessage，
+// 累计每个从机的成功率与 RTT 分布。一次只有一个从机在测，响应可按 destinationId 唯一匹配
+class PingEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    using Sender = std::function<bool(const WhtsProtocol::Message &)>;
+
+    struct Config {
+        uint8_t pingMode = 0;
+        uint16_t pingCount = 10;       // 每轮 ping 次数
+        uint16_t intervalMs = 100;     // 每次 ping 的间隔
+        int rounds = 1;                // 对目标集合重复的轮数
+        int timeoutMarginMs = 2000;    // 在 pingCount * intervalMs 之外额外等待的时间
+    };
+
+    // 最多跟踪的从机数，超过后新从机不再统计
+    static constexpr size_t MAX_TRACKED_SLAVES = 256;
+
+    explicit PingEngine(QObject *parent = nullptr);
+
+    void SetSender(const Sender &sender) { m_sender = sender; }
+
+    bool Start(const std::vector<uint32_t> &slaveIds, const Config &config);
+    void Stop();
+    bool IsRunning() const { return m_bRunning; }
+    uint32_t CurrentTarget() const { return m_currentTarget; }
+
+    // 由 MainWindow 在解析到对应消息时调用，arrivalNs 为 Frame::arrivalNs
+    void OnPingResponse(const WhtsProtocol::Master2Backend::PingResponseMessage &message, uint64_t arrivalNs);
+    void OnPingReply(uint32_t slaveId, const WhtsProtocol::Slave2Master::PingRspMessage &message, uint64_t arrivalNs);
+
+    // 按从机ID排序
+    std::vector<const PingSlaveStats *> AllStats() const;
+    const PingSlaveStats *Stats(uint32_t slaveId) const;
+    void ResetStats();
+
+signals:
+    void RunCompleted(uint32_t slaveId, bool timedOut);
+    // 单轮结果，rttNs 为本轮 RTT 均值（逐次样本）或估算值，无成功时为 0
+    void RunMeasured(uint32_t slaveId, quint16 sent, quint16 succeeded, quint64 rttNs);
+    void Finished();
+    void StatsChanged();
+
+private slots:
+    void OnTimeout();
+
+private:
+    void IssueNext();
+    void CompleteRun(bool timedOut);
+    PingSlaveStats *StatsFor(uint32_t slaveId);
+
+private:
+    Sender m_sender;
+    Config m_config;
+    QTimer *m_pTimeoutTimer;
+
+    std::vector<uint32_t> m_targets;
+    size_t m_nextTarget;
+    int m_roundsLeft;
+    bool m_bRunning;
+
+    // 当前这一轮
+    bool m_bAwaiting;
+    uint32_t m_currentTarget;
+    uint64_t m_sentNs;
+    uint32_t m_replySamples;        // 本轮收到的 PingRsp 数
+    uint64_t m_replyRttSumNs;       // 本轮逐次 RTT 之和
+    uint16_t m_firstSequence;
+    uint32_t m_firstTimestamp;
+    uint16_t m_lastSequence;
+
+    std::map<uint32_t, std::unique_ptr<PingSlaveStats>> m_stats;
+};
+
+#endif // PINGENGINE_H
@@ -0,0 +1,518 @@
+#include "pipelinestatswidget.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QFileDialog>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QDateTime>
+#include <QMessageBox>
+
+#include "protocol/utils/TraceRecorder.h"
+
+namespace {
+// 刷新周期（毫秒）
+constexpr int STATS_REFRESH_INTERVAL_MS = 1000;
+
+// 表格行布局：先是各计数器，然后是按 PacketId 的帧数，最后是帧总数
+constexpr int PACKET_ROW_BASE = static_cast<int>(WhtsProtocol::STAT_COUNTER_COUNT);
+constexpr int TOTAL_FRAMES_ROW = PACKET_ROW_BASE + static_cast<int>(WhtsProtocol::STAT_PACKET_TYPE_COUNT);
+constexpr int ROW_COUNT = TOTAL_FRAMES_ROW + 1;
+
+// 延迟表列
+enum LatencyColumn {
+    LATENCY_COLUMN_TYPE = 0,
+    LATENCY_COLUMN_STAGE,
+    LATENCY_COLUMN_COUNT,
+    LATENCY_COLUMN_P50,
+    LATENCY_COLUMN_P99,
+    LATENCY_COLUMN_P999,
+    LATENCY_COLUMN_MAX,
+    LATENCY_COLUMN_TOTAL
+};
+
+// 数据完整性表列
+enum SequenceColumn {
+    SEQUENCE_COLUMN_SLAVE = 0,
+    SEQUENCE_COLUMN_RECEIVED,
+    SEQUENCE_COLUMN_EXPECTED,
+    SEQUENCE_COLUMN_LOST,
+    SEQUENCE_COLUMN_COMPLETENESS,
+    SEQUENCE_COLUMN_DUPLICATES,
+    SEQUENCE_COLUMN_REORDERED,
+    SEQUENCE_COLUMN_LATE,
+    SEQUENCE_COLUMN_MAX_GAP,
+    SEQUENCE_COLUMN_RESTARTS,
+    SEQUENCE_COLUMN_MEAN_DELAY,
+    SEQUENCE_COLUMN_MAX_DELAY,
+    SEQUENCE_COLUMN_TOTAL
+};
+
+QString SlaveIdToString(uint32_t slaveId)
+{
+    return QString("0x%1").arg(slaveId, 8, 16, QChar('0')).toUpper();
+}
+
+const char *StageName(LatencyStage stage)
+{
+    switch (stage) {
+    case LatencyStage::Decode:
+        return "到达->解码";
+    case LatencyStage::Display:
+        return "解码->显示";
+    default:
+        return "";
+    }
+}
+
+const char *StageKey(LatencyStage stage)
+{
+    switch (stage) {
+    case LatencyStage::Decode:
+        return "arrival_to_decoded";
+    case LatencyStage::Display:
+        return "decoded_to_displayed";
+    default:
+        return "";
+    }
+}
+
+double NsToUs(uint64_t ns)
+{
+    return ns / 1000.0;
+}
+}
+
+PipelineStatsWidget::PipelineStatsWidget(const WhtsProtocol::ProtocolStats *pStats,
+                                         LatencyTracker *pLatencyTracker,
+                                         WhtsProtocol::SequenceTracker *pSequenceTracker, QWidget *parent)
+    : QWidget(parent)
+    , m_pStats(pStats)
+    , m_pLatencyTracker(pLatencyTracker)
+    , m_pSequenceTracker(pSequenceTracker)
+    , m_pTableWidgetCounters(nullptr)
+    , m_pTableWidgetLatency(nullptr)
+    , m_pTableWidgetSequence(nullptr)
+    , m_pPushButtonReset(nullptr)
+    , m_pPushButtonExport(nullptr)
+    , m_pCheckBoxTrace(nullptr)
+    , m_pPushButtonExportTrace(nullptr)
+    , m_pLabelSummary(nullptr)
+    , m_pRefreshTimer(nullptr)
+    , m_baseline()
+    , m_lastSnapshot()
+    , m_currentSnapshot()
+    , m_counterRates()
+    , m_packetRates()
+{
+    InitializeUI();
+
+    m_baseline = m_pStats->snapshot();
+    m_lastSnapshot = m_baseline;
+    m_currentSnapshot = m_baseline;
+    m_rateTimer.start();
+
+    m_pRefreshTimer = new QTimer(this);
+    connect(m_pRefreshTimer, &QTimer::timeout, this, &PipelineStatsWidget::OnRefreshTimeout);
+    m_pRefreshTimer->start(STATS_REFRESH_INTERVAL_MS);
+
+    OnRefreshTimeout();
+}
+
+void PipelineStatsWidget::InitializeUI()
+{
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+
+    // 操作按钮
+    QHBoxLayout *buttonLayout = new QHBoxLayout();
+    m_pPushButtonReset = new QPushButton("重置", this);
+    m_pPushButtonExport = new QPushButton("导出", this);
+    m_pCheckBoxTrace = new QCheckBox("记录Trace", this);
+    m_pCheckBoxTrace->setToolTip("记录收包、解帧、重组、解码、界面更新和日志写入的耗时跨度");
+    m_pPushButtonExportTrace = new QPushButton("导出Trace", this);
+    m_pLabelSummary = new QLabel(this);
+
+    buttonLayout->addWidget(m_pPushButtonReset);
+    buttonLayout->addWidget(m_pPushButtonExport);
+    buttonLayout->addSpacing(20);
+    buttonLayout->addWidget(m_pCheckBoxTrace);
+    buttonLayout->addWidget(m_pPushButtonExportTrace);
+    buttonLayout->addSpacing(20);
+    buttonLayout->addWidget(m_pLabelSummary);
+    buttonLayout->addStretch();
+    mainLayout->addLayout(buttonLayout);
+
+    // 计数器表格
+    m_pTableWidgetCounters = new QTableWidget(ROW_COUNT, 3, this);
+    QStringList headers;
+    headers << "指标" << "累计" << "速率 (/s)";
+    m_pTableWidgetCounters->setHorizontalHeaderLabels(headers);
+    m_pTableWidgetCounters->verticalHeader()->setVisible(false);
+    m_pTableWidgetCounters->horizontalHeader()->setStretchLastSection(true);
+    m_pTableWidgetCounters->setColumnWidth(0, 220);
+    m_pTableWidgetCounters->setColumnWidth(1, 150);
+    m_pTableWidgetCounters->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_pTableWidgetCounters->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_pTableWidgetCounters->setAlternatingRowColors(true);
+
+    // 预先创建所有单元格，刷新时只修改文本
+    for (int row = 0; row < ROW_COUNT; ++row) {
+        for (int column = 0; column < 3; ++column) {
+            QTableWidgetItem *item = new QTableWidgetItem();
+            if (column > 0) {
+                item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+            }
+            m_pTableWidgetCounters->setItem(row, column, item);
+        }
+    }
+
+    mainLayout->addWidget(m_pTableWidgetCounters, 3);
+
+    // 延迟分位数表格（单位：微秒）
+    m_pTableWidgetLatency = new QTableWidget(0, LATENCY_COLUMN_TOTAL, this);
+    QStringList latencyHeaders;
+    latencyHeaders << "消息类型" << "阶段" << "样本数" << "p50 (us)" << "p99 (us)" << "p999 (us)" << "max (us)";
+    m_pTableWidgetLatency->setHorizontalHeaderLabels(latencyHeaders);
+    m_pTableWidgetLatency->verticalHeader()->setVisible(false);
+    m_pTableWidgetLatency->horizontalHeader()->setStretchLastSection(true);
+    m_pTableWidgetLatency->setColumnWidth(LATENCY_COLUMN_TYPE, 220);
+    m_pTableWidgetLatency->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_pTableWidgetLatency->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_pTableWidgetLatency->setAlternatingRowColors(true);
+    mainLayout->addWidget(m_pTableWidgetLatency, 2);
+
+    // 各从机数据完整性（需要从机发送带序号的扩展头）
+    m_pTableWidgetSequence = new QTableWidget(0, SEQUENCE_COLUMN_TOTAL, this);
+    QStringList sequenceHeaders;
+    sequenceHeaders << "从机ID" << "收到" << "应收" << "缺失" << "完整率" << "重复" << "乱序"
+                    << "迟到" << "最大缺口" << "重启" << "额外延迟均值 (us)" << "额外延迟max (us)";
+    m_pTableWidgetSequence->setHorizontalHeaderLabels(sequenceHeaders);
+    m_pTableWidgetSequence->verticalHeader()->setVisible(false);
+    m_pTableWidgetSequence->horizontalHeader()->setStretchLastSection(true);
+    m_pTableWidgetSequence->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_pTableWidgetSequence->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_pTableWidgetSequence->setAlternatingRowColors(true);
+    m_pTableWidgetSequence->setToolTip("额外延迟 = 到达时间 - 采样时间戳 - 最小值，用于区分数据是慢还是丢");
+    mainLayout->addWidget(m_pTableWidgetSequence, 2);
+
+    connect(m_pPushButtonReset, &QPushButton::clicked, this, &PipelineStatsWidget::OnResetClicked);
+    connect(m_pPushButtonExport, &QPushButton::clicked, this, &PipelineStatsWidget::OnExportClicked);
+    connect(m_pCheckBoxTrace, &QCheckBox::toggled, this, &PipelineStatsWidget::OnTraceToggled);
+    connect(m_pPushButtonExportTrace, &QPushButton::clicked, this, &PipelineStatsWidget::OnExportTraceClicked);
+
+#if !WHTS_ENABLE_TRACING
+    // 编译时未启用追踪
+    m_pCheckBoxTrace->setEnabled(false);
+    m_pPushButtonExportTrace->setEnabled(false);
+#endif
+}
+
+void PipelineStatsWidget::SetRow(int row, const QString &name, quint64 total, double rate)
+{
+    m_pTableWidgetCounters->item(row, 0)->setText(name);
+    m_pTableWidgetCounters->item(row, 1)->setText(QString::number(total));
+    m_pTableWidgetCounters->item(row, 2)->setText(QString::number(rate, 'f', 1));
+}
+
+void PipelineStatsWidget::OnRefreshTimeout()
+{
+    using namespace WhtsProtocol;
+
+    ProtocolStatsSnapshot snapshot = m_pStats->snapshot();
+    qint64 elapsedMs = m_rateTimer.restart();
+    double seconds = elapsedMs > 0 ? elapsedMs / 1000.0 : 1.0;
+
+    // 计算速率
+    ProtocolStatsSnapshot diff = snapshot.delta(m_lastSnapshot);
+    for (size_t i = 0; i < STAT_COUNTER_COUNT; ++i) {
+        m_counterRates[i] = diff.counters[i] / seconds;
+    }
+    for (size_t i = 0; i < STAT_PACKET_TYPE_COUNT; ++i) {
+        m_packetRates[i] = diff.framesByPacket[i] / seconds;
+    }
+    m_lastSnapshot = snapshot;
+    m_currentSnapshot = snapshot;
+
+    // 更新表格
+    ProtocolStatsSnapshot total = snapshot.delta(m_baseline);
+    for (size_t i = 0; i < STAT_COUNTER_COUNT; ++i) {
+        SetRow(static_cast<int>(i), ProtocolStats::counterName(static_cast<StatCounter>(i)),
+               total.counters[i], m_counterRates[i]);
+    }
+    double totalFrameRate = 0;
+    for (size_t i = 0; i < STAT_PACKET_TYPE_COUNT; ++i) {
+        SetRow(PACKET_ROW_BASE + static_cast<int>(i),
+               QString("Frames %1").arg(ProtocolStats::packetTypeName(i)),
+               total.framesByPacket[i], m_packetRates[i]);
+        totalFrameRate += m_packetRates[i];
+    }
+    SetRow(TOTAL_FRAMES_ROW, "Frames Decoded", total.totalFramesDecoded(), totalFrameRate);
+
+    UpdateLatencyTable();
+    UpdateSequenceTable();
+
+    // 简要信息
+    quint64 errors = total.get(StatCounter::FRAME_DECODE_ERRORS) +
+                     total.get(StatCounter::MESSAGE_DECODE_ERRORS) +
+                     total.get(StatCounter::UNKNOWN_MESSAGE_IDS) +
+                     total.get(StatCounter::CRC_ERRORS);
+    quint64 drops = total.get(StatCounter::SOCKET_DROPS) +
+                    total.get(StatCounter::BUFFER_OVERFLOWS) +
+                    total.get(StatCounter::ORPHANED_FRAGMENTS) +
+                    total.get(StatCounter::EXPIRED_FRAGMENTS);
+    QString summary = QString("帧/s: %1  错误: %2  丢弃: %3")
+                          .arg(totalFrameRate, 0, 'f', 1)
+                          .arg(errors)
+                          .arg(drops);
+    m_pLabelSummary->setText(summary);
+    emit SummaryChanged(summary);
+}
+
+void PipelineStatsWidget::SetLatencyCell(int row, int column, const QString &text)
+{
+    QTableWidgetItem *item = m_pTableWidgetLatency->item(row, column);
+    if (!item) {
+        item = new QTableWidgetItem();
+        if (column >= LATENCY_COLUMN_COUNT) {
+            item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+        }
+        m_pTableWidgetLatency->setItem(row, column, item);
+    }
+    item->setText(text);
+}
+
+void PipelineStatsWidget::UpdateLatencyTable()
+{
+    int row = 0;
+    const auto entries = m_pLatencyTracker->Entries();
+    for (const auto &entry : entries) {
+        for (int stage = 0; stage < static_cast<int>(LatencyStage::Count); ++stage) {
+            const WhtsProtocol::LatencyHistogram *pHistogram = entry.histograms[stage];
+            if (!pHistogram) {
+                continue;
+            }
+            if (row >= m_pTableWidgetLatency->rowCount()) {
+                m_pTableWidgetLatency->insertRow(row);
+            }
+            SetLatencyCell(row, LATENCY_COLUMN_TYPE, entry.name);
+            SetLatencyCell(row, LATENCY_COLUMN_STAGE, StageName(static_cast<LatencyStage>(stage)));
+            SetLatencyCell(row, LATENCY_COLUMN_COUNT, QString::number(pHistogram->count()));
+            SetLatencyCell(row, LATENCY_COLUMN_P50, QString::number(NsToUs(pHistogram->percentile(50.0)), 'f', 1));
+            SetLatencyCell(row, LATENCY_COLUMN_P99, QString::number(NsToUs(pHistogram->percentile(99.0)), 'f', 1));
+            SetLatencyCell(row, LATENCY_COLUMN_P999, QString::number(NsToUs(pHistogram->percentile(99.9)), 'f', 1));
+            SetLatencyCell(row, LATENCY_COLUMN_MAX, QString::number(NsToUs(pHistogram->max()), 'f', 1));
+            ++row;
+        }
+    }
+    m_pTableWidgetLatency->setRowCount(row);
+}
+
+void PipelineStatsWidget::UpdateSequenceTable()
+{
+    const auto allStats = m_pSequenceTracker->snapshot();
+    m_pTableWidgetSequence->setRowCount(static_cast<int>(allStats.size()));
+
+    for (int row = 0; row < static_cast<int>(allStats.size()); ++row) {
+        const WhtsProtocol::SequenceStats &stats = allStats[row];
+        QStringList cells;
+        cells << SlaveIdToString(stats.slaveId)
+              << QString::number(stats.received)
+              << QString::number(stats.expected)
+              << QString::number(stats.lost)
+              << QString("%1%").arg(stats.completeness() * 100.0, 0, 'f', 3)
+              << QString::number(stats.duplicates)
+              << QString::number(stats.reordered)
+              << QString::number(stats.late)
+              << QString::number(stats.maxGap)
+              << QString::number(stats.restarts)
+              << QString::number(stats.meanExtraDelayUs, 'f', 1)
+              << QString::number(stats.maxExtraDelayUs);
+
+        for (int column = 0; column < SEQUENCE_COLUMN_TOTAL; ++column) {
+            QTableWidgetItem *item = m_pTableWidgetSequence->item(row, column);
+            if (!item) {
+                item = new QTableWidgetItem();
+                if (column > SEQUENCE_COLUMN_SLAVE) {
+                    item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+                }
+                m_pTableWidgetSequence->setItem(row, column, item);
+            }
+            item->setText(cells[column]);
+        }
+    }
+}
+
+void PipelineStatsWidget::OnResetClicked()
+{
+    m_baseline = m_pStats->snapshot();
+    m_pLatencyTracker->Reset();
+    m_pSequenceTracker->reset();
+    OnRefreshTimeout();
+}
+
+QJsonObject PipelineStatsWidget::ToJson() const
+{
+    using namespace WhtsProtocol;
+
+    ProtocolStatsSnapshot total = m_currentSnapshot.delta(m_baseline);
+
+    QJsonArray counters;
+    for (size_t i = 0; i < STAT_COUNTER_COUNT; ++i) {
+        QJsonObject counter;
+        counter["name"] = ProtocolStats::counterName(static_cast<StatCounter>(i));
+        counter["total"] = static_cast<qint64>(total.counters[i]);
+        counter["rate"] = m_counterRates[i];
+        counters.append(counter);
+    }
+
+    QJsonArray frames;
+    for (size_t i = 0; i < STAT_PACKET_TYPE_COUNT; ++i) {
+        QJsonObject frame;
+        frame["packetType"] = ProtocolStats::packetTypeName(i);
+        frame["total"] = static_cast<qint64>(total.framesByPacket[i]);
+        frame["rate"] = m_packetRates[i];
+        frames.append(frame);
+    }
+
+    QJsonArray latency;
+    const auto entries = m_pLatencyTracker->Entries();
+    for (const auto &entry : entries) {
+        for (int stage = 0; stage < static_cast<int>(LatencyStage::Count); ++stage) {
+            const WhtsProtocol::LatencyHistogram *pHistogram = entry.histograms[stage];
+            if (!pHistogram) {
+                continue;
+            }
+            QJsonObject item;
+            item["packetId"] = entry.packetId;
+            item["messageId"] = entry.messageId;
+            item["messageType"] = entry.name;
+            item["stage"] = StageKey(static_cast<LatencyStage>(stage));
+            item["count"] = static_cast<qint64>(pHistogram->count());
+            item["meanUs"] = NsToUs(static_cast<uint64_t>(pHistogram->mean()));
+            item["p50Us"] = NsToUs(pHistogram->percentile(50.0));
+            item["p99Us"] = NsToUs(pHistogram->percentile(99.0));
+            item["p999Us"] = NsToUs(pHistogram->percentile(99.9));
+            item["maxUs"] = NsToUs(pHistogram->max());
+            latency.append(item);
+        }
+    }
+
+    QJsonArray sequence;
+    for (const auto &stats : m_pSequenceTracker->snapshot()) {
+        QJsonObject item;
+        item["slaveId"] = SlaveIdToString(stats.slaveId);
+        item["received"] = static_cast<qint64>(stats.received);
+        item["expected"] = static_cast<qint64>(stats.expected);
+        item["lost"] = static_cast<qint64>(stats.lost);
+        item["completeness"] = stats.completeness();
+        item["duplicates"] = static_cast<qint64>(stats.duplicates);
+        item["reordered"] = static_cast<qint64>(stats.reordered);
+        item["late"] = static_cast<qint64>(stats.late);
+        item["gapEvents"] = static_cast<qint64>(stats.gapEvents);
+        item["maxGap"] = static_cast<qint64>(stats.maxGap);
+        item["restarts"] = static_cast<qint64>(stats.restarts);
+        item["meanExtraDelayUs"] = stats.meanExtraDelayUs;
+        item["maxExtraDelayUs"] = static_cast<qint64>(stats.maxExtraDelayUs);
+        sequence.append(item);
+    }
+
+    QJsonObject root;
+    root["timestamp"] = QDateTime::currentDateTime().toString(Qt::ISODateWithMs);
+    root["counters"] = counters;
+    root["frames"] = frames;
+    root["latency"] = latency;
+    root["sequence"] = sequence;
+    return root;
+}
+
+bool PipelineStatsWidget::ExportCsv(const QString &fileName) const
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        return false;
+    }
+
+    QTextStream stream(&file);
+    stream << "metric,total,rate_per_s\n";
+    for (int row = 0; row < m_pTableWidgetCounters->rowCount(); ++row) {
+        stream << m_pTableWidgetCounters->item(row, 0)->text() << ","
+               << m_pTableWidgetCounters->item(row, 1)->text() << ","
+               << m_pTableWidgetCounters->item(row, 2)->text() << "\n";
+    }
+
+    stream << "\nmessage_type,stage,count,p50_us,p99_us,p999_us,max_us\n";
+    for (int row = 0; row < m_pTableWidgetLatency->rowCount(); ++row) {
+        QStringList cells;
+        for (int column = 0; column < LATENCY_COLUMN_TOTAL; ++column) {
+            QTableWidgetItem *item = m_pTableWidgetLatency->item(row, column);
+            cells << (item ? item->text() : QString());
+        }
+        stream << cells.join(",") << "\n";
+    }
+
+    stream << "\nslave_id,received,expected,lost,completeness,duplicates,reordered,late,max_gap,restarts,"
+              "mean_extra_delay_us,max_extra_delay_us\n";
+    for (int row = 0; row < m_pTableWidgetSequence->rowCount(); ++row) {
+        QStringList cells;
+        for (int column = 0; column < SEQUENCE_COLUMN_TOTAL; ++column) {
+            QTableWidgetItem *item = m_pTableWidgetSequence->item(row, column);
+            cells << (item ? item->text() : QString());
+        }
+        stream << cells.join(",") << "\n";
+    }
+    return true;
+}
+
+void PipelineStatsWidget::OnExportClicked()
+{
+    QString defaultName = QString("pipeline_stats_%1.json")
+                              .arg(QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss"));
+    QString fileName = QFileDialog::getSaveFileName(this, "导出统计", defaultName,
+                                                    "JSON (*.json);;CSV (*.csv)");
+    if (fileName.isEmpty()) {
+        return;
+    }
+
+    bool ok = false;
+    if (QFileInfo(fileName).suffix().compare("csv", Qt::CaseInsensitive) == 0) {
+        ok = ExportCsv(fileName);
+    } else {
+        QFile file(fileName);
+        if (file.open(QIODevice::WriteOnly)) {
+            file.write(QJsonDocument(ToJson()).toJson(QJsonDocument::Indented));
+            ok = true;
+        }
+    }
+
+    if (!ok) {
+        QMessageBox::warning(this, "警告", QString("导出失败: %1").arg(fileName));
+    }
+}
+
+void PipelineStatsWidget::OnTraceToggled(bool checked)
+{
+    auto &recorder = WhtsProtocol::TraceRecorder::instance();
+    if (checked) {
+        // 每次开始记录都从空缓冲区开始，便于复现"卡顿"时只抓取相关时段
+        recorder.clear();
+    }
+    recorder.setEnabled(checked);
+}
+
+void PipelineStatsWidget::OnExportTraceClicked()
+{
+    QString defaultName = QString("trace_%1.json")
+                              .arg(QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss"));
+    QString fileName = QFileDialog::getSaveFileName(this, "导出Trace", defaultName,
+                                                    "Chrome Trace (*.json)");
+    if (fileName.isEmpty()) {
+        return;
+    }
+
+    if (!WhtsProtocol::TraceRecorder::instance().writeJson(QFile::encodeName(fileName).toStdString())) {
+        QMessageBox::warning(this, "警告", QString("导出失败: %1").arg(fileName));
+    }
+}
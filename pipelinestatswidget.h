@@ -0,0 +1,73 @@
+#ifndef PIPELINESTATSWIDGET_H
+#define PIPELINESTATSWIDGET_H
+
+#include <QWidget>
+#include <QTableWidget>
+#include <QPushButton>
+#include <QLabel>
+#include <QCheckBox>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QJsonObject>
+
+#include "protocol/ProtocolStats.h"
+#include "protocol/SequenceTracker.h"
+#include "latencytracker.h"
+
+// 协议管线统计面板：显示 ProtocolProcessor 计数器的累计值与速率、
+// 各消息类型的延迟分位数、各从机的数据完整性，并支持导出
+class PipelineStatsWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    PipelineStatsWidget(const WhtsProtocol::ProtocolStats *pStats, LatencyTracker *pLatencyTracker,
+                        WhtsProtocol::SequenceTracker *pSequenceTracker, QWidget *parent = nullptr);
+
+    // 当前统计（累计值 + 速率 + 延迟分位数）的 JSON 表示，用于导出
+    QJsonObject ToJson() const;
+
+signals:
+    // 简要统计信息，供状态栏显示
+    void SummaryChanged(const QString &summary);
+
+private slots:
+    void OnRefreshTimeout();
+    void OnResetClicked();
+    void OnExportClicked();
+    void OnTraceToggled(bool checked);
+    void OnExportTraceClicked();
+
+private:
+    void InitializeUI();
+    void SetRow(int row, const QString &name, quint64 total, double rate);
+    void UpdateLatencyTable();
+    void SetLatencyCell(int row, int column, const QString &text);
+    void UpdateSequenceTable();
+    bool ExportCsv(const QString &fileName) const;
+
+private:
+    const WhtsProtocol::ProtocolStats *m_pStats;
+    LatencyTracker *m_pLatencyTracker;
+    WhtsProtocol::SequenceTracker *m_pSequenceTracker;
+
+    QTableWidget *m_pTableWidgetCounters;
+    QTableWidget *m_pTableWidgetLatency;
+    QTableWidget *m_pTableWidgetSequence;
+    QPushButton *m_pPushButtonReset;
+    QPushButton *m_pPushButtonExport;
+    QCheckBox *m_pCheckBoxTrace;
+    QPushButton *m_pPushButtonExportTrace;
+    QLabel *m_pLabelSummary;
+    QTimer *m_pRefreshTimer;
+
+    // 重置基准（计数器本身不清零，显示值为相对基准的增量）
+    WhtsProtocol::ProtocolStatsSnapshot m_baseline;
+    WhtsProtocol::ProtocolStatsSnapshot m_lastSnapshot;
+    WhtsProtocol::ProtocolStatsSnapshot m_currentSnapshot;
+    double m_counterRates[WhtsProtocol::STAT_COUNTER_COUNT];
+    double m_packetRates[WhtsProtocol::STAT_PACKET_TYPE_COUNT];
+    QElapsedTimer m_rateTimer;
+};
+
+#endif // PIPELINESTATSWIDGET_H
@@ -0,0 +1,176 @@
+#include "ClipTracker.h"
+
+#include <algorithm>
+
+namespace WhtsProtocol {
+
+ClipTracker::ClipTracker() : ClipTracker(Config()) {}
+
+ClipTracker::ClipTracker(const Config &config) : config_(config) {
+    ring_.resize(std::max<size_t>(1, config_.transitionCapacity));
+    slaves_.reserve(config_.maxSlaves);
+}
+
+ClipTracker::SlaveState *ClipTracker::slave(uint32_t slaveId) {
+    bool created = false;
+    uint32_t index = index_.add(slaveId, created, config_.maxSlaves);
+    if (index == SlaveIndex::NONE)
+        return nullptr;
+    if (!created)
+        return &slaves_[index];
+    slaves_.emplace_back();
+    slaves_.back().result.slaveId = slaveId;
+    return &slaves_.back();
+}
+
+void ClipTracker::setExpectation(uint32_t slaveId, uint8_t clipMode,
+                                 uint16_t clipStatus, uint64_t nowMs) {
+    SlaveState *state = slave(slaveId);
+    if (!state)
+        return;
+    ClipStationResult &result = state->result;
+    bool changed = !result.configured || result.clipMode != clipMode ||
+                   result.expected != clipStatus;
+    result.configured = true;
+    result.clipMode = clipMode;
+    result.expected = clipStatus;
+    if (changed)
+        restartStation(*state, nowMs);
+}
+
+uint16_t ClipTracker::onClipData(uint32_t slaveId, uint16_t clipData,
+                                 uint64_t nowMs) {
+    SlaveState *state = slave(slaveId);
+    if (!state) {
+        ++droppedFrames_;
+        return 0;
+    }
+    ClipStationResult &result = state->result;
+    ++result.frames;
+
+    if (!state->known) {
+        state->known = true;
+        result.current = clipData;
+        if (!state->started)
+            restartStation(*state, nowMs);
+        else
+            updateCompletion(*state, nowMs);
+        return 0;
+    }
+
+    uint16_t changed = static_cast<uint16_t>(clipData ^ result.current);
+    if (!changed)
+        return 0;
+    result.current = clipData;
+
+    for (uint16_t bits = changed; bits; bits &= static_cast<uint16_t>(bits - 1)) {
+        uint8_t clip = 0;
+        while (!((bits >> clip) & 1))
+            ++clip;
+        uint16_t mask = static_cast<uint16_t>(1u << clip);
+
+        ClipTransition transition;
+        transition.slaveId = slaveId;
+        transition.clip = clip;
+        transition.inserted = (clipData & mask) != 0;
+        transition.monitored = result.configured && (result.expected & mask);
+        transition.atMs = nowMs;
+        transition.previousMs = nowMs - state->lastChangeMs[clip];
+        transition.sinceStartMs = nowMs - state->startMs;
+        state->lastChangeMs[clip] = nowMs;
+        if (transition.inserted) {
+            ++result.inserts;
+            ++result.clipInserts[clip];
+        } else {
+            ++result.removes;
+            ++result.clipRemoves[clip];
+        }
+        pushTransition(transition);
+    }
+
+    updateCompletion(*state, nowMs);
+    return changed;
+}
+
+void ClipTracker::restartStation(SlaveState &state, uint64_t nowMs) {
+    ClipStationResult &result = state.result;
+    state.started = true;
+    state.startMs = nowMs;
+    std::fill(std::begin(state.lastChangeMs), std::end(state.lastChangeMs),
+              nowMs);
+    result.reachedComplete = false;
+    result.completeMs = 0;
+    result.inserts = 0;
+    result.removes = 0;
+    std::fill(std::begin(result.clipInserts), std::end(result.clipInserts), 0);
+    std::fill(std::begin(result.clipRemoves), std::end(result.clipRemoves), 0);
+    updateCompletion(state, nowMs);
+}
+
+void ClipTracker::updateCompletion(SlaveState &state, uint64_t nowMs) {
+    ClipStationResult &result = state.result;
+    if (!result.configured) {
+        result.missing = 0;
+        result.unexpected = 0;
+        result.complete = false;
+        return;
+    }
+    result.missing = static_cast<uint16_t>(result.expected & ~result.current);
+    result.unexpected = static_cast<uint16_t>(result.current & ~result.expected);
+    result.complete = state.known && result.expected != 0 && result.missing == 0;
+    // 只记录第一次全部插入的耗时
+    if (result.complete && !result.reachedComplete) {
+        result.reachedComplete = true;
+        result.completeMs = nowMs - state.startMs;
+    }
+}
+
+void ClipTracker::pushTransition(const ClipTransition &transition) {
+    if (ringCount_ == ring_.size()) {
+        ring_[ringHead_] = transition;
+        ringHead_ = (ringHead_ + 1) % ring_.size();
+        ++droppedTransitions_;
+        return;
+    }
+    ring_[(ringHead_ + ringCount_) % ring_.size()] = transition;
+    ++ringCount_;
+}
+
+size_t ClipTracker::takeTransitions(std::vector<ClipTransition> &out) {
+    size_t taken = ringCount_;
+    for (size_t i = 0; i < ringCount_; ++i)
+        out.push_back(ring_[(ringHead_ + i) % ring_.size()]);
+    ringHead_ = 0;
+    ringCount_ = 0;
+    return taken;
+}
+
+std::vector<ClipStationResult> ClipTracker::stations() const {
+    std::vector<ClipStationResult> result;
+    result.reserve(slaves_.size());
+    for (const SlaveState &state : slaves_)
+        result.push_back(state.result);
+    std::sort(result.begin(), result.end(),
+              [](const ClipStationResult &a, const ClipStationResult &b) {
+                  return a.slaveId < b.slaveId;
+              });
+    return result;
+}
+
+void ClipTracker::restart(uint64_t nowMs) {
+    for (SlaveState &state : slaves_)
+        restartStation(state, nowMs);
+    ringHead_ = 0;
+    ringCount_ = 0;
+}
+
+void ClipTracker::reset() {
+    slaves_.clear();
+    index_.clear();
+    ringHead_ = 0;
+    ringCount_ = 0;
+    droppedTransitions_ = 0;
+    droppedFrames_ = 0;
+}
+
+} // namespace WhtsProtocol
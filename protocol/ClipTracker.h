@@ -0,0 +1,102 @@
+#ifndef WHTS_PROTOCOL_CLIP_TRACKER_H
+#define WHTS_PROTOCOL_CLIP_TRACKER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "SlaveIndex.h"
+
+namespace WhtsProtocol {
+
+// 卡钉状态变化; clipData 中位为 1 表示卡钉已插入
+struct ClipTransition {
+    uint32_t slaveId = 0;
+    uint8_t clip = 0;          // 位序号 0..15
+    bool inserted = false;     // true: 插入, false: 拔出
+    bool monitored = false;    // 属于从机配置 clipStatus 中的检测卡钉
+    uint64_t atMs = 0;
+    uint64_t previousMs = 0;   // 变化前状态持续的时长
+    uint64_t sinceStartMs = 0; // 距该工位开始计时的时长
+};
+
+// 单个工位 (从机) 的检测结果
+struct ClipStationResult {
+    uint32_t slaveId = 0;
+    bool configured = false;   // 已收到从机配置
+    uint8_t clipMode = 0;
+    uint16_t expected = 0;     // clipStatus: 需要插入的卡钉
+    uint16_t current = 0;      // 最新 clipData
+    uint16_t missing = 0;      // 需要插入但未插入
+    uint16_t unexpected = 0;   // 不在检测范围但已插入
+    bool complete = false;     // 检测卡钉全部插入
+    bool reachedComplete = false; // 开始计时后曾经全部插入
+    uint64_t completeMs = 0;   // 从开始计时到第一次全部插入的时长
+    uint64_t frames = 0;
+    uint32_t inserts = 0;
+    uint32_t removes = 0;
+    uint32_t clipInserts[16] = {};
+    uint32_t clipRemoves[16] = {};
+};
+
+// 卡钉检测: 按从机保存 16 位卡钉位图, 每帧一次异或找出变化位, 记录插入/拔出及其时长。
+// 变化事件写入固定容量的环形队列, 由界面定时取出 (满时覆盖最旧的事件并计数);
+// 每从机状态大小固定, 从机数超过 maxSlaves 时不再统计新从机。
+class ClipTracker {
+  public:
+    static constexpr size_t CLIP_COUNT = 16;
+
+    struct Config {
+        size_t maxSlaves = 256;
+        size_t transitionCapacity = 4096;
+    };
+
+    ClipTracker();
+    explicit ClipTracker(const Config &config);
+
+    // 从机配置中的 clipMode/clipStatus; 期望变化时该工位重新计时
+    void setExpectation(uint32_t slaveId, uint8_t clipMode,
+                        uint16_t clipStatus, uint64_t nowMs);
+
+    // 返回变化的位 (从机的第一帧返回 0)
+    uint16_t onClipData(uint32_t slaveId, uint16_t clipData, uint64_t nowMs);
+
+    // 按发生顺序取出未读的变化事件, 返回取出的数量
+    size_t takeTransitions(std::vector<ClipTransition> &out);
+    uint64_t droppedTransitions() const { return droppedTransitions_; }
+    uint64_t droppedFrames() const { return droppedFrames_; }
+
+    // 按从机ID排序
+    std::vector<ClipStationResult> stations() const;
+
+    // 所有工位重新开始计时和计数 (保留期望和当前位图)
+    void restart(uint64_t nowMs);
+    void reset();
+
+  private:
+    struct SlaveState {
+        ClipStationResult result;
+        bool known = false;    // 已收到第一帧
+        bool started = false;  // 已开始计时 (收到配置或第一帧)
+        uint64_t startMs = 0;
+        uint64_t lastChangeMs[CLIP_COUNT] = {};
+    };
+
+    SlaveState *slave(uint32_t slaveId);
+    void restartStation(SlaveState &state, uint64_t nowMs);
+    void updateCompletion(SlaveState &state, uint64_t nowMs);
+    void pushTransition(const ClipTransition &transition);
+
+    Config config_;
+    std::vector<SlaveState> slaves_;
+    SlaveIndex index_;
+    std::vector<ClipTransition> ring_;
+    size_t ringHead_ = 0;  // 最旧事件的位置
+    size_t ringCount_ = 0;
+    uint64_t droppedTransitions_ = 0;
+    uint64_t droppedFrames_ = 0;
+};
+
+} // namespace WhtsProtocol
+
+#endif // WHTS_PROTOCOL_CLIP_TRACKER_H
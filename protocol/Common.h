@@ -1,6 +1,7 @@
 #ifndef WHTS_PROTOCOL_COMMON_H
 #define WHTS_PROTOCOL_COMMON_H
 
+#include <cstddef>
 #include <cstdint>
 
 namespace WhtsProtocol {
@@ -8,6 +9,18 @@ namespace WhtsProtocol {
 // 协议常量
 constexpr uint8_t FRAME_DELIMITER_1 = 0xAB;
 constexpr uint8_t FRAME_DELIMITER_2 = 0xCD;
+
+// 帧头第 5 字节 (moreFragmentsFlag) 的标志位
+constexpr uint8_t FRAME_FLAG_MORE_FRAGMENTS = 0x01;
+// 置位时帧尾追加 CRC-32C (uint32 LE), 覆盖帧头和载荷; 长度字段不含校验尾
+constexpr uint8_t FRAME_FLAG_CRC = 0x80;
+constexpr size_t FRAME_CRC_SIZE = 4;
+// 可靠分片: 载荷前附加 reliableId(1) + 分片总数(1) + 发送轮次(1),
+// 接收端按分片序号收集 (可乱序/重复), 并以 RELIABLE_ACK 回复接收位图
+constexpr uint8_t FRAME_FLAG_RELIABLE = 0x40;
+// 可靠分片: 要求接收端立即回复 RELIABLE_ACK (每轮发送的最后一个分片)
+constexpr uint8_t FRAME_FLAG_ACK_REQUEST = 0x20;
+constexpr size_t RELIABLE_PREFIX_SIZE = 3;
 constexpr uint32_t BROADCAST_ID = 0xFFFFFFFF;
 
 // Packet ID 枚举
@@ -16,7 +29,9 @@ enum class PacketId : uint8_t {
     SLAVE_TO_MASTER = 0x01,
     BACKEND_TO_MASTER = 0x02,
     MASTER_TO_BACKEND = 0x03,
-    SLAVE_TO_BACKEND = 0x04
+    SLAVE_TO_BACKEND = 0x04,
+    // 可靠分片的选择确认 (SACK), 载荷见 ReliableAck
+    RELIABLE_ACK = 0x05
 };
 
 // Master2Slave Message ID 枚举
@@ -64,7 +79,24 @@ enum class Master2BackendMessageId : uint8_t {
 enum class Slave2BackendMessageId : uint8_t {
     CONDUCTION_DATA_MSG = 0x00,
     RESISTANCE_DATA_MSG = 0x01,
-    CLIP_DATA_MSG = 0x02
+    CLIP_DATA_MSG = 0x02,
+    // 批量数据: 一帧携带同一从机连续多次采样
+    CONDUCTION_BATCH_MSG = 0x10,
+    RESISTANCE_BATCH_MSG = 0x11,
+    // 导通数据差分编码: 关键帧或相对上一采样的异或差异
+    CONDUCTION_DELTA_MSG = 0x12
+};
+
+// Slave2Backend 扩展头: Message ID 最高位置 1 时, DeviceStatus 之后紧跟
+// 序号 (uint16 LE) + 采样时间戳 (uint32 LE, 从机本地微秒, 回绕)
+constexpr uint8_t SLAVE2BACKEND_EXT_FLAG = 0x80;
+constexpr uint8_t SLAVE2BACKEND_MSG_ID_MASK = 0x7F;
+constexpr size_t SLAVE2BACKEND_EXT_SIZE = 6;
+
+struct Slave2BackendExtension {
+    bool present = false;
+    uint16_t sequence = 0;
+    uint32_t timestampUs = 0;
 };
 
 }    // namespace WhtsProtocol
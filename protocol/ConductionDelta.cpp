@@ -0,0 +1,212 @@
+#include "ConductionDelta.h"
+
+#include <cstring>
+
+namespace WhtsProtocol {
+
+namespace {
+// 稀疏编码每项: 索引(2) + 异或值(1)
+constexpr size_t SPARSE_ENTRY_SIZE = 3;
+// 游程编码每段: 零字节数(1) + 字面量字节数(1)
+constexpr size_t RUN_HEADER_SIZE = 2;
+constexpr size_t MAX_RUN = 255;
+// 字面量中不足该长度的零字节直接并入字面量, 比新开一段更短
+constexpr size_t MIN_ZERO_RUN = 3;
+
+void encodeSparse(const std::vector<uint8_t> &delta,
+                  std::vector<uint8_t> &out) {
+    out.clear();
+    for (size_t i = 0; i < delta.size(); ++i) {
+        if (delta[i] == 0)
+            continue;
+        out.push_back(static_cast<uint8_t>(i & 0xFF));
+        out.push_back(static_cast<uint8_t>((i >> 8) & 0xFF));
+        out.push_back(delta[i]);
+    }
+}
+
+void encodeRunLength(const std::vector<uint8_t> &delta,
+                     std::vector<uint8_t> &out) {
+    out.clear();
+    size_t end = delta.size();
+    while (end > 0 && delta[end - 1] == 0)
+        --end;
+
+    size_t i = 0;
+    while (i < end) {
+        size_t zeros = 0;
+        while (i < end && delta[i] == 0 && zeros < MAX_RUN) {
+            ++i;
+            ++zeros;
+        }
+        size_t start = i;
+        while (i < end && i - start < MAX_RUN) {
+            if (delta[i] == 0) {
+                size_t run = 0;
+                while (i + run < end && delta[i + run] == 0 &&
+                       run < MIN_ZERO_RUN)
+                    ++run;
+                if (run >= MIN_ZERO_RUN)
+                    break;
+            }
+            ++i;
+        }
+        out.push_back(static_cast<uint8_t>(zeros));
+        out.push_back(static_cast<uint8_t>(i - start));
+        out.insert(out.end(), delta.begin() + start, delta.begin() + i);
+    }
+}
+} // namespace
+
+void xorBytes(uint8_t *dst, const uint8_t *src, size_t length) {
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= length; i += sizeof(uint64_t)) {
+        uint64_t a;
+        uint64_t b;
+        std::memcpy(&a, dst + i, sizeof(a));
+        std::memcpy(&b, src + i, sizeof(b));
+        a ^= b;
+        std::memcpy(dst + i, &a, sizeof(a));
+    }
+    for (; i < length; ++i)
+        dst[i] ^= src[i];
+}
+
+// ConductionDeltaEncoder 实现
+ConductionDeltaEncoder::ConductionDeltaEncoder(uint32_t keyframeInterval)
+    : keyframeInterval_(keyframeInterval) {}
+
+void ConductionDeltaEncoder::encode(
+    const std::vector<uint8_t> &conductionData,
+    Slave2Backend::ConductionDeltaMessage &message) {
+    using Encoding = Slave2Backend::ConductionDeltaMessage::Encoding;
+
+    message.frameIndex = frameIndex_;
+    message.referenceIndex = static_cast<uint8_t>(frameIndex_ - 1);
+    message.conductionLength = static_cast<uint16_t>(conductionData.size());
+
+    bool keyframe = !hasPrevious_ ||
+                    previous_.size() != conductionData.size() ||
+                    (keyframeInterval_ > 0 &&
+                     sinceKeyframe_ + 1 >= keyframeInterval_);
+    if (!keyframe) {
+        delta_.assign(conductionData.begin(), conductionData.end());
+        xorBytes(delta_.data(), previous_.data(), delta_.size());
+
+        encodeSparse(delta_, message.encodedData);
+        encodeRunLength(delta_, runLength_);
+        message.encoding = Encoding::SPARSE;
+        if (runLength_.size() < message.encodedData.size()) {
+            message.encoding = Encoding::RUN_LENGTH;
+            message.encodedData.assign(runLength_.begin(), runLength_.end());
+        }
+        // 变化很多时差分不比完整数据短, 直接发关键帧
+        keyframe = message.encodedData.size() >= conductionData.size();
+    }
+
+    if (keyframe) {
+        message.encoding = Encoding::KEYFRAME;
+        message.encodedData.assign(conductionData.begin(), conductionData.end());
+        sinceKeyframe_ = 0;
+    } else {
+        ++sinceKeyframe_;
+    }
+
+    previous_.assign(conductionData.begin(), conductionData.end());
+    hasPrevious_ = true;
+    ++frameIndex_;
+}
+
+void ConductionDeltaEncoder::reset() {
+    hasPrevious_ = false;
+    sinceKeyframe_ = 0;
+    previous_.clear();
+}
+
+// ConductionDeltaDecoder 实现
+bool ConductionDeltaDecoder::applySparse(const std::vector<uint8_t> &encoded,
+                                         std::vector<uint8_t> &matrix) {
+    if (encoded.size() % SPARSE_ENTRY_SIZE != 0)
+        return false;
+    for (size_t i = 0; i < encoded.size(); i += SPARSE_ENTRY_SIZE) {
+        size_t index = encoded[i] | (encoded[i + 1] << 8);
+        if (index >= matrix.size())
+            return false;
+        matrix[index] ^= encoded[i + 2];
+    }
+    return true;
+}
+
+bool ConductionDeltaDecoder::applyRunLength(
+    const std::vector<uint8_t> &encoded, std::vector<uint8_t> &matrix) {
+    size_t position = 0;
+    size_t offset = 0;
+    while (offset < encoded.size()) {
+        if (offset + RUN_HEADER_SIZE > encoded.size())
+            return false;
+        position += encoded[offset];
+        size_t literals = encoded[offset + 1];
+        offset += RUN_HEADER_SIZE;
+        if (offset + literals > encoded.size() ||
+            position + literals > matrix.size())
+            return false;
+        xorBytes(matrix.data() + position, encoded.data() + offset, literals);
+        position += literals;
+        offset += literals;
+    }
+    return position <= matrix.size();
+}
+
+ConductionDeltaDecoder::Result ConductionDeltaDecoder::decode(
+    uint32_t slaveId, const Slave2Backend::ConductionDeltaMessage &message,
+    std::vector<uint8_t> &conductionData) {
+    using Encoding = Slave2Backend::ConductionDeltaMessage::Encoding;
+
+    SlaveState &state = slaves_[slaveId];
+    stats_.encodedBytes += message.encodedData.size();
+
+    if (message.encoding == Encoding::KEYFRAME) {
+        if (message.encodedData.size() != message.conductionLength) {
+            ++stats_.invalid;
+            state.valid = false;
+            return Result::INVALID;
+        }
+        state.matrix = message.encodedData;
+        ++stats_.keyframes;
+    } else {
+        if (!state.valid || state.frameIndex != message.referenceIndex ||
+            state.matrix.size() != message.conductionLength) {
+            ++stats_.referenceMisses;
+            bool first = !state.waitingKeyframe;
+            state.valid = false;
+            state.waitingKeyframe = true;
+            return first ? Result::REFERENCE_MISSING
+                         : Result::WAITING_KEYFRAME;
+        }
+        bool applied = message.encoding == Encoding::SPARSE
+                           ? applySparse(message.encodedData, state.matrix)
+                           : applyRunLength(message.encodedData, state.matrix);
+        if (!applied) {
+            // 矩阵可能已被部分修改, 等待下一关键帧
+            ++stats_.invalid;
+            state.valid = false;
+            state.waitingKeyframe = true;
+            return Result::INVALID;
+        }
+        ++stats_.deltas;
+    }
+
+    state.frameIndex = message.frameIndex;
+    state.valid = true;
+    state.waitingKeyframe = false;
+    stats_.decodedBytes += state.matrix.size();
+    conductionData = state.matrix;
+    return Result::OK;
+}
+
+void ConductionDeltaDecoder::reset() {
+    slaves_.clear();
+    stats_ = ConductionDeltaStats();
+}
+
+} // namespace WhtsProtocol
@@ -0,0 +1,86 @@
+#ifndef WHTS_PROTOCOL_CONDUCTION_DELTA_H
+#define WHTS_PROTOCOL_CONDUCTION_DELTA_H
+
+#include "messages/Slave2Backend.h"
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace WhtsProtocol {
+
+// dst[i] ^= src[i], 按 64 位字处理 (编译器可自动向量化)
+void xorBytes(uint8_t *dst, const uint8_t *src, size_t length);
+
+// 发送端: 对同一从机的连续导通数据选择最短的编码
+// 与上一采样长度不同、首个采样或到达关键帧间隔时发送关键帧;
+// 否则在关键帧、稀疏索引、游程编码中取编码结果最短者
+class ConductionDeltaEncoder {
+  public:
+    static constexpr uint32_t DEFAULT_KEYFRAME_INTERVAL = 32;
+
+    explicit ConductionDeltaEncoder(
+        uint32_t keyframeInterval = DEFAULT_KEYFRAME_INTERVAL);
+
+    void encode(const std::vector<uint8_t> &conductionData,
+                Slave2Backend::ConductionDeltaMessage &message);
+    // 下一次强制发送关键帧
+    void reset();
+
+  private:
+    uint32_t keyframeInterval_;
+    uint32_t sinceKeyframe_ = 0;
+    uint8_t frameIndex_ = 0;
+    bool hasPrevious_ = false;
+    std::vector<uint8_t> previous_;
+    std::vector<uint8_t> delta_;
+    std::vector<uint8_t> runLength_;
+};
+
+struct ConductionDeltaStats {
+    uint64_t keyframes = 0;
+    uint64_t deltas = 0;
+    uint64_t referenceMisses = 0;  // 差分基准不是上一个已还原采样, 丢弃直到下一关键帧
+    uint64_t invalid = 0;          // 编码数据越界或长度不符
+    uint64_t encodedBytes = 0;     // 收到的编码数据字节数
+    uint64_t decodedBytes = 0;     // 还原出的导通数据字节数
+};
+
+// 接收端: 按从机保存上一次还原的导通数据, 在原位异或还原差分帧
+class ConductionDeltaDecoder {
+  public:
+    enum class Result {
+        OK,
+        REFERENCE_MISSING,  // 首次发现基准缺失 (之前的采样丢失)
+        WAITING_KEYFRAME,   // 基准缺失后继续等待关键帧
+        INVALID
+    };
+
+    // 成功时 conductionData 为还原后的完整导通数据
+    Result decode(uint32_t slaveId,
+                  const Slave2Backend::ConductionDeltaMessage &message,
+                  std::vector<uint8_t> &conductionData);
+
+    const ConductionDeltaStats &stats() const { return stats_; }
+    void reset();
+
+  private:
+    struct SlaveState {
+        std::vector<uint8_t> matrix;
+        uint8_t frameIndex = 0;
+        bool valid = false;
+        bool waitingKeyframe = false;
+    };
+
+    static bool applySparse(const std::vector<uint8_t> &encoded,
+                            std::vector<uint8_t> &matrix);
+    static bool applyRunLength(const std::vector<uint8_t> &encoded,
+                               std::vector<uint8_t> &matrix);
+
+    std::unordered_map<uint32_t, SlaveState> slaves_;
+    ConductionDeltaStats stats_;
+};
+
+} // namespace WhtsProtocol
+
+#endif // WHTS_PROTOCOL_CONDUCTION_DELTA_H
@@ -0,0 +1,258 @@
+#include "DeviceRegistry.h"
+
+#include <algorithm>
+
+namespace WhtsProtocol {
+
+const char *deviceLivenessName(DeviceLiveness liveness) {
+    switch (liveness) {
+    case DeviceLiveness::ONLINE:
+        return "Online";
+    case DeviceLiveness::STALE:
+        return "Stale";
+    case DeviceLiveness::OFFLINE:
+        return "Offline";
+    default:
+        return "Unknown";
+    }
+}
+
+DeviceRegistry::DeviceRegistry() : DeviceRegistry(Config()) {}
+
+DeviceRegistry::DeviceRegistry(const Config &config) : config_(config) {
+    config_.tickMs = std::max<uint32_t>(1, config_.tickMs);
+    // 槽数向上取 2 的幂, 用掩码定位槽
+    size_t slots = 1;
+    while (slots < std::max<size_t>(2, config_.wheelSlots))
+        slots <<= 1;
+    config_.wheelSlots = slots;
+    wheel_.assign(slots, NONE);
+}
+
+void DeviceRegistry::start(uint64_t nowMs) {
+    if (!started_) {
+        started_ = true;
+        currentTick_ = nowMs / config_.tickMs;
+    }
+}
+
+void DeviceRegistry::onTraffic(uint32_t slaveId, uint64_t nowMs) {
+    start(nowMs);
+    bool created = false;
+    Record &record = findOrCreate(slaveId, nowMs, created);
+    uint32_t index = static_cast<uint32_t>(&record - records_.data());
+    if (created) {
+        // 未在设备列表中的从机, 补发一次请求获取短ID、版本和电量
+        refreshPending_ = true;
+    }
+
+    ++record.frames;
+    record.lastSeenMs = nowMs;
+    if (record.liveness != DeviceLiveness::ONLINE)
+        setLiveness(record, DeviceLiveness::ONLINE);
+    schedule(index, nowMs + config_.staleAfterMs);
+}
+
+void DeviceRegistry::onDeviceList(const std::vector<DeviceInfo> &devices,
+                                  uint64_t nowMs) {
+    start(nowMs);
+    for (Record &record : records_)
+        record.listed = false;
+
+    for (const DeviceInfo &device : devices) {
+        bool created = false;
+        Record &record = findOrCreate(device.deviceId, nowMs, created);
+        uint32_t index = static_cast<uint32_t>(&record - records_.data());
+        if (created || record.shortId != device.shortId ||
+            record.batteryLevel != device.batteryLevel ||
+            record.versionMajor != device.versionMajor ||
+            record.versionMinor != device.versionMinor ||
+            record.versionPatch != device.versionPatch) {
+            record.shortId = device.shortId;
+            record.batteryLevel = device.batteryLevel;
+            record.versionMajor = device.versionMajor;
+            record.versionMinor = device.versionMinor;
+            record.versionPatch = device.versionPatch;
+            ++version_;
+        }
+        record.listed = true;
+
+        if (device.online) {
+            // 主机刚确认在线, 视同收到一帧
+            record.lastSeenMs = std::max(record.lastSeenMs, nowMs);
+            if (record.liveness != DeviceLiveness::ONLINE)
+                setLiveness(record, DeviceLiveness::ONLINE);
+            schedule(index, std::max(record.lastSeenMs + config_.staleAfterMs,
+                                     nowMs + config_.listConfirmMs));
+        } else {
+            unschedule(index);
+            if (record.liveness != DeviceLiveness::OFFLINE)
+                setLiveness(record, DeviceLiveness::OFFLINE);
+        }
+    }
+
+    // 主机列表中已不存在的从机视为离线
+    for (uint32_t index = 0; index < records_.size(); ++index) {
+        Record &record = records_[index];
+        if (!record.listed && record.liveness != DeviceLiveness::OFFLINE) {
+            unschedule(index);
+            setLiveness(record, DeviceLiveness::OFFLINE);
+        }
+    }
+
+    refreshPending_ = false;
+    refreshRequested_ = false;
+}
+
+void DeviceRegistry::advance(uint64_t nowMs) {
+    start(nowMs);
+    uint64_t targetTick = nowMs / config_.tickMs;
+    if (targetTick <= currentTick_)
+        return;
+
+    // 超过一圈时每个槽只需扫描一次
+    uint64_t ticks = std::min<uint64_t>(targetTick - currentTick_,
+                                        config_.wheelSlots);
+    uint64_t mask = config_.wheelSlots - 1;
+    for (uint64_t i = 1; i <= ticks; ++i) {
+        uint64_t slot = (currentTick_ + i) & mask;
+        uint32_t index = wheel_[slot];
+        while (index != NONE) {
+            uint32_t next = records_[index].wheelNext;
+            // 截止时间在后几圈的记录留在槽中
+            if (records_[index].deadlineTick <= targetTick)
+                expire(index, records_[index].deadlineTick * config_.tickMs);
+            index = next;
+        }
+    }
+    currentTick_ = targetTick;
+}
+
+void DeviceRegistry::expire(uint32_t index, uint64_t nowMs) {
+    unschedule(index);
+    Record &record = records_[index];
+    if (record.liveness == DeviceLiveness::ONLINE) {
+        setLiveness(record, DeviceLiveness::STALE);
+        refreshPending_ = true;
+        // 至少留出 offlineAfterMs - staleAfterMs 等待设备列表确认
+        uint32_t grace = config_.offlineAfterMs > config_.staleAfterMs
+                             ? config_.offlineAfterMs - config_.staleAfterMs
+                             : 0;
+        schedule(index, std::max(record.lastSeenMs + config_.offlineAfterMs,
+                                 nowMs + grace));
+    } else if (record.liveness == DeviceLiveness::STALE) {
+        setLiveness(record, DeviceLiveness::OFFLINE);
+    }
+}
+
+bool DeviceRegistry::refreshDue(uint64_t nowMs) const {
+    if (!refreshPending_)
+        return false;
+    // 请求无应答时按最小间隔重发
+    return !refreshRequested_ ||
+           nowMs >= lastRefreshMs_ + config_.minRefreshIntervalMs;
+}
+
+void DeviceRegistry::onRefreshRequested(uint64_t nowMs) {
+    refreshRequested_ = true;
+    lastRefreshMs_ = nowMs;
+}
+
+const DeviceRegistry::Record *DeviceRegistry::find(uint32_t slaveId) const {
+    uint32_t index = index_.find(slaveId);
+    return index == SlaveIndex::NONE ? nullptr : &records_[index];
+}
+
+size_t DeviceRegistry::count(DeviceLiveness liveness) const {
+    return static_cast<size_t>(
+        std::count_if(records_.begin(), records_.end(),
+                      [liveness](const Record &record) {
+                          return record.liveness == liveness;
+                      }));
+}
+
+std::vector<DeviceRegistry::DeviceInfo> DeviceRegistry::toDeviceList() const {
+    std::vector<DeviceInfo> devices;
+    devices.reserve(records_.size());
+    for (const Record &record : records_) {
+        DeviceInfo device;
+        device.deviceId = record.slaveId;
+        device.shortId = record.shortId;
+        device.online = record.liveness != DeviceLiveness::OFFLINE;
+        device.versionMajor = record.versionMajor;
+        device.versionMinor = record.versionMinor;
+        device.versionPatch = record.versionPatch;
+        device.batteryLevel = record.batteryLevel;
+        devices.push_back(device);
+    }
+    return devices;
+}
+
+void DeviceRegistry::clear() {
+    records_.clear();
+    index_.clear();
+    std::fill(wheel_.begin(), wheel_.end(), NONE);
+    started_ = false;
+    refreshPending_ = false;
+    refreshRequested_ = false;
+    ++version_;
+}
+
+DeviceRegistry::Record &DeviceRegistry::findOrCreate(uint32_t slaveId,
+                                                     uint64_t nowMs,
+                                                     bool &created) {
+    uint32_t index = index_.add(slaveId, created);
+    if (!created)
+        return records_[index];
+    records_.emplace_back();
+    Record &record = records_.back();
+    record.slaveId = slaveId;
+    record.lastSeenMs = nowMs;
+    ++version_;
+    return record;
+}
+
+void DeviceRegistry::setLiveness(Record &record, DeviceLiveness liveness) {
+    DeviceLiveness previous = record.liveness;
+    record.liveness = liveness;
+    ++version_;
+    if (listener_)
+        listener_(record, previous);
+}
+
+void DeviceRegistry::schedule(uint32_t index, uint64_t deadlineMs) {
+    Record &record = records_[index];
+    // 向上取整到 tick, 且至少是下一个 tick
+    uint64_t tick = (deadlineMs + config_.tickMs - 1) / config_.tickMs;
+    tick = std::max(tick, currentTick_ + 1);
+    if (record.scheduled && record.deadlineTick == tick)
+        return;
+
+    unschedule(index);
+    uint32_t &head = wheel_[tick & (config_.wheelSlots - 1)];
+    record.deadlineTick = tick;
+    record.wheelPrev = NONE;
+    record.wheelNext = head;
+    if (head != NONE)
+        records_[head].wheelPrev = index;
+    head = index;
+    record.scheduled = true;
+}
+
+void DeviceRegistry::unschedule(uint32_t index) {
+    Record &record = records_[index];
+    if (!record.scheduled)
+        return;
+    if (record.wheelPrev != NONE)
+        records_[record.wheelPrev].wheelNext = record.wheelNext;
+    else
+        wheel_[record.deadlineTick & (config_.wheelSlots - 1)] =
+            record.wheelNext;
+    if (record.wheelNext != NONE)
+        records_[record.wheelNext].wheelPrev = record.wheelPrev;
+    record.wheelPrev = NONE;
+    record.wheelNext = NONE;
+    record.scheduled = false;
+}
+
+} // namespace WhtsProtocol
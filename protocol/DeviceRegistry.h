@@ -0,0 +1,121 @@
+#ifndef WHTS_PROTOCOL_DEVICE_REGISTRY_H
+#define WHTS_PROTOCOL_DEVICE_REGISTRY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "SlaveIndex.h"
+#include "messages/Master2Backend.h"
+
+namespace WhtsProtocol {
+
+// 设备在线状态
+enum class DeviceLiveness : uint8_t {
+    ONLINE = 0, // 最近收到过该从机的数据, 或主机设备列表报告在线
+    STALE,      // 超过 staleAfterMs 没有数据, 等待设备列表确认
+    OFFLINE     // 超过 offlineAfterMs 没有数据, 或主机报告离线
+};
+
+const char *deviceLivenessName(DeviceLiveness liveness);
+
+// 设备注册表: 由主机的设备列表应答和任意 Slave2Backend 数据帧维护每个从机的状态。
+// 在线检测用时间轮: 每帧只把记录挂到截止时间所在的槽, advance() 只扫描到期的槽,
+// 与从机数量无关。有从机变为 STALE 或出现未知从机时 refreshDue() 返回 true,
+// 由调用方补发一次设备列表请求, 代替定时全量查询。
+class DeviceRegistry {
+  public:
+    using DeviceInfo = Master2Backend::DeviceListResponseMessage::DeviceInfo;
+
+    struct Config {
+        uint32_t staleAfterMs = 3000;
+        uint32_t offlineAfterMs = 10000;
+        // 设备列表确认在线后保持 ONLINE 的时长 (未采集时从机没有数据帧)
+        uint32_t listConfirmMs = 30000;
+        uint32_t minRefreshIntervalMs = 2000; // 两次设备列表请求的最小间隔
+        uint32_t tickMs = 50;                 // 时间轮精度
+        size_t wheelSlots = 256;              // 取 2 的幂
+    };
+
+    // 单个从机一条记录, 按缓存行对齐, 每帧只改写这一行
+    struct alignas(64) Record {
+        uint32_t slaveId = 0;
+        DeviceLiveness liveness = DeviceLiveness::ONLINE;
+        bool listed = false; // 出现在最近一次设备列表中
+        uint8_t shortId = 0;
+        uint8_t batteryLevel = 0;
+        uint8_t versionMajor = 0;
+        uint8_t versionMinor = 0;
+        uint16_t versionPatch = 0;
+        uint64_t lastSeenMs = 0;
+        uint64_t frames = 0;
+
+        // 时间轮链表
+        uint64_t deadlineTick = 0;
+        uint32_t wheelPrev = NONE;
+        uint32_t wheelNext = NONE;
+        bool scheduled = false;
+    };
+
+    // 在线状态变化时回调
+    using Listener =
+        std::function<void(const Record &record, DeviceLiveness previous)>;
+
+    DeviceRegistry();
+    explicit DeviceRegistry(const Config &config);
+
+    void setListener(Listener listener) { listener_ = std::move(listener); }
+    const Config &config() const { return config_; }
+
+    // 收到该从机的任意数据帧
+    void onTraffic(uint32_t slaveId, uint64_t nowMs);
+    // 收到主机的设备列表应答 (全量)
+    void onDeviceList(const std::vector<DeviceInfo> &devices, uint64_t nowMs);
+    // 处理到期的在线检测
+    void advance(uint64_t nowMs);
+
+    // 是否需要补发设备列表请求; 发出后调用 onRefreshRequested
+    bool refreshDue(uint64_t nowMs) const;
+    void onRefreshRequested(uint64_t nowMs);
+
+    const Record *find(uint32_t slaveId) const;
+    // 按首次出现的顺序
+    const std::vector<Record> &records() const { return records_; }
+    size_t count(DeviceLiveness liveness) const;
+    // 以设备列表的格式导出, online 为非 OFFLINE
+    std::vector<DeviceInfo> toDeviceList() const;
+
+    // 记录或在线状态变化时递增, 调用方据此判断是否需要刷新界面
+    uint64_t version() const { return version_; }
+
+    void clear();
+
+  private:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    Record &findOrCreate(uint32_t slaveId, uint64_t nowMs, bool &created);
+    void setLiveness(Record &record, DeviceLiveness liveness);
+    void schedule(uint32_t index, uint64_t deadlineMs);
+    void unschedule(uint32_t index);
+    void expire(uint32_t index, uint64_t nowMs);
+    void start(uint64_t nowMs);
+
+    Config config_;
+    Listener listener_;
+    std::vector<Record> records_;
+    SlaveIndex index_;
+
+    std::vector<uint32_t> wheel_; // 每个槽的链表头
+    uint64_t currentTick_ = 0;    // 已处理到的 tick
+    bool started_ = false;
+
+    bool refreshPending_ = false;
+    bool refreshRequested_ = false;
+    uint64_t lastRefreshMs_ = 0;
+    uint64_t version_ = 0;
+};
+
+} // namespace WhtsProtocol
+
+#endif // WHTS_PROTOCOL_DEVICE_REGISTRY_H
@@ -0,0 +1,96 @@
+#include "DeviceStatusTracker.h"
+
+#include <algorithm>
+
+namespace WhtsProtocol {
+
+const char *deviceStatusBitName(DeviceStatusBit bit) {
+    switch (bit) {
+    case DeviceStatusBit::COLOR_SENSOR:
+        return "CS";
+    case DeviceStatusBit::SLEEVE_LIMIT:
+        return "SL";
+    case DeviceStatusBit::ELECTROMAGNET_UNLOCK_BUTTON:
+        return "EUB";
+    case DeviceStatusBit::BATTERY_LOW_ALARM:
+        return "BLA";
+    case DeviceStatusBit::PRESSURE_SENSOR:
+        return "PS";
+    case DeviceStatusBit::ELECTROMAGNETIC_LOCK1:
+        return "EL1";
+    case DeviceStatusBit::ELECTROMAGNETIC_LOCK2:
+        return "EL2";
+    case DeviceStatusBit::ACCESSORY1:
+        return "A1";
+    case DeviceStatusBit::ACCESSORY2:
+        return "A2";
+    default:
+        return "Unknown";
+    }
+}
+
+size_t DeviceStatusTracker::subscribe(Listener listener, uint16_t mask) {
+    size_t id = nextSubscriberId_++;
+    subscribers_.push_back({id, mask, std::move(listener)});
+    subscribedMask_ |= mask;
+    return id;
+}
+
+void DeviceStatusTracker::unsubscribe(size_t id) {
+    subscribers_.erase(std::remove_if(subscribers_.begin(), subscribers_.end(),
+                                      [id](const Subscriber &subscriber) {
+                                          return subscriber.id == id;
+                                      }),
+                       subscribers_.end());
+    subscribedMask_ = 0;
+    for (const Subscriber &subscriber : subscribers_)
+        subscribedMask_ |= subscriber.mask;
+}
+
+uint16_t DeviceStatusTracker::update(uint32_t slaveId, uint16_t status) {
+    bool created = false;
+    uint32_t index = index_.add(slaveId, created);
+    if (created) {
+        // 首帧作为基准
+        statuses_.push_back(status);
+        return 0;
+    }
+
+    uint16_t previous = statuses_[index];
+    uint16_t changed = static_cast<uint16_t>((previous ^ status) &
+                                             DEVICE_STATUS_ALL_BITS);
+    if (changed == 0)
+        return 0;
+    statuses_[index] = status;
+
+    uint16_t notify = changed & subscribedMask_;
+    for (size_t bit = 0; notify != 0; ++bit, notify >>= 1) {
+        if ((notify & 1) == 0)
+            continue;
+        ++edgeCount_;
+        DeviceStatusEdge edge{slaveId, static_cast<DeviceStatusBit>(bit),
+                              (status & (1u << bit)) != 0, previous, status};
+        uint16_t bitMask = static_cast<uint16_t>(1u << bit);
+        for (const Subscriber &subscriber : subscribers_) {
+            if (subscriber.mask & bitMask)
+                subscriber.listener(edge);
+        }
+    }
+    return changed;
+}
+
+bool DeviceStatusTracker::known(uint32_t slaveId) const {
+    return index_.contains(slaveId);
+}
+
+uint16_t DeviceStatusTracker::status(uint32_t slaveId) const {
+    uint32_t index = index_.find(slaveId);
+    return index == SlaveIndex::NONE ? 0 : statuses_[index];
+}
+
+void DeviceStatusTracker::reset() {
+    index_.clear();
+    statuses_.clear();
+}
+
+} // namespace WhtsProtocol
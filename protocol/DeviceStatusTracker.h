@@ -0,0 +1,86 @@
+#ifndef WHTS_PROTOCOL_DEVICE_STATUS_TRACKER_H
+#define WHTS_PROTOCOL_DEVICE_STATUS_TRACKER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "SlaveIndex.h"
+
+namespace WhtsProtocol {
+
+// DeviceStatus 的各状态位, 数值即 toUint16() 中的位号
+enum class DeviceStatusBit : uint8_t {
+    COLOR_SENSOR = 0,
+    SLEEVE_LIMIT,
+    ELECTROMAGNET_UNLOCK_BUTTON,
+    BATTERY_LOW_ALARM,
+    PRESSURE_SENSOR,
+    ELECTROMAGNETIC_LOCK1,
+    ELECTROMAGNETIC_LOCK2,
+    ACCESSORY1,
+    ACCESSORY2,
+    COUNT
+};
+
+constexpr size_t DEVICE_STATUS_BIT_COUNT =
+    static_cast<size_t>(DeviceStatusBit::COUNT);
+constexpr uint16_t DEVICE_STATUS_ALL_BITS =
+    static_cast<uint16_t>((1u << DEVICE_STATUS_BIT_COUNT) - 1);
+
+constexpr uint16_t deviceStatusMask(DeviceStatusBit bit) {
+    return static_cast<uint16_t>(1u << static_cast<unsigned>(bit));
+}
+
+// 简称, 与数据查看表的列名一致 (CS, SL, EUB, ...)
+const char *deviceStatusBitName(DeviceStatusBit bit);
+
+// 单个状态位的一次变化
+struct DeviceStatusEdge {
+    uint32_t slaveId;
+    DeviceStatusBit bit;
+    bool asserted;     // 0 -> 1
+    uint16_t previous; // 变化前的完整状态字
+    uint16_t current;
+};
+
+// 按从机保存上一帧的 16 位状态字 (紧凑数组), 新状态与之异或,
+// 只在状态位变化时向订阅者发出边沿事件。从机的第一帧只作为基准, 不产生边沿。
+class DeviceStatusTracker {
+  public:
+    using Listener = std::function<void(const DeviceStatusEdge &edge)>;
+
+    // mask 为关心的状态位, 返回订阅 ID
+    size_t subscribe(Listener listener, uint16_t mask = DEVICE_STATUS_ALL_BITS);
+    void unsubscribe(size_t id);
+
+    // 返回变化的状态位 (首帧返回 0)
+    uint16_t update(uint32_t slaveId, uint16_t status);
+
+    bool known(uint32_t slaveId) const;
+    uint16_t status(uint32_t slaveId) const;
+    uint64_t edgeCount() const { return edgeCount_; }
+
+    // 清除所有从机的基准状态, 订阅保留
+    void reset();
+
+  private:
+    struct Subscriber {
+        size_t id;
+        uint16_t mask;
+        Listener listener;
+    };
+
+    SlaveIndex index_;
+    std::vector<uint16_t> statuses_;
+
+    std::vector<Subscriber> subscribers_;
+    uint16_t subscribedMask_ = 0;
+    size_t nextSubscriberId_ = 1;
+    uint64_t edgeCount_ = 0;
+};
+
+} // namespace WhtsProtocol
+
+#endif // WHTS_PROTOCOL_DEVICE_STATUS_TRACKER_H
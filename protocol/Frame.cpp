@@ -5,7 +5,8 @@ namespace WhtsProtocol {
 
 Frame::Frame()
     : delimiter1(FRAME_DELIMITER_1), delimiter2(FRAME_DELIMITER_2), packetId(0),
-      fragmentsSequence(0), moreFragmentsFlag(0), packetLength(0) {}
+      fragmentsSequence(0), moreFragmentsFlag(0), packetLength(0),
+      arrivalNs(0) {}
 
 bool Frame::isValid() const {
     return delimiter1 == FRAME_DELIMITER_1 && delimiter2 == FRAME_DELIMITER_2;
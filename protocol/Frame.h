@@ -18,6 +18,10 @@ struct Frame {
     uint16_t packetLength;
     std::vector<uint8_t> payload;
 
+    // 接收时间 (steady_clock 纳秒), 仅本地使用, 不参与序列化;
+    // 重组帧取最后一个分片的到达时间
+    uint64_t arrivalNs;
+
     Frame();
     bool isValid() const;
     std::vector<uint8_t> serialize() const;
@@ -0,0 +1,252 @@
+#include "PinFlipAccumulator.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) ||                                   \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define WHTS_PIN_FLIP_SSE2 1
+#include <emmintrin.h>
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace WhtsProtocol {
+
+namespace {
+unsigned countTrailingZeros(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<unsigned>(__builtin_ctzll(value));
+#elif defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return static_cast<unsigned>(index);
+#else
+    unsigned index = 0;
+    while (!(value & 1)) {
+        value >>= 1;
+        ++index;
+    }
+    return index;
+#endif
+}
+
+// 按小端加载, 字中第 k 位对应第 k / 8 个字节的第 k % 8 位
+uint64_t loadWord(const uint8_t *p) {
+    uint64_t word;
+    std::memcpy(&word, p, sizeof(word));
+    return word;
+}
+} // namespace
+
+PinFlipAccumulator::PinFlipAccumulator() : PinFlipAccumulator(Config()) {}
+
+PinFlipAccumulator::PinFlipAccumulator(const Config &config)
+    : config_(config) {
+    config_.maxPins = std::max<size_t>(8, config_.maxPins / 8 * 8);
+}
+
+uint32_t PinFlipAccumulator::onConduction(uint32_t slaveId,
+                                          const uint8_t *data, size_t length,
+                                          uint64_t nowMs) {
+    length = std::min(length, config_.maxPins / 8);
+
+    bool created = false;
+    uint32_t slave = index_.add(slaveId, created, config_.maxSlaves);
+    if (slave == SlaveIndex::NONE) {
+        ++droppedFrames_;
+        return 0;
+    }
+    if (created) {
+        slaves_.emplace_back();
+        slaves_.back().slaveId = slaveId;
+        slaves_.back().summary.slaveId = slaveId;
+        rebaseline(slaves_.back(), data, length, nowMs);
+        ++slaves_.back().summary.frames;
+        return 0;
+    }
+
+    SlaveState &state = slaves_[slave];
+    if (length != state.previous.size()) {
+        // 采集配置变化, 旧计数不再对应同一针脚
+        flaky_.erase(std::remove_if(flaky_.begin(), flaky_.end(),
+                                    [slave](const FlakyPin &flaky) {
+                                        return flaky.slave == slave;
+                                    }),
+                     flaky_.end());
+        rebaseline(state, data, length, nowMs);
+        ++state.summary.rebaselines;
+        ++state.summary.frames;
+        return 0;
+    }
+    ++state.summary.frames;
+
+    uint32_t nowRelMs = static_cast<uint32_t>(nowMs - state.baseMs);
+    uint8_t *previous = state.previous.data();
+    uint32_t flipped = 0;
+    size_t i = 0;
+#if defined(WHTS_PIN_FLIP_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= length; i += 16) {
+        __m128i current =
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        __m128i changed = _mm_xor_si128(
+            current, _mm_loadu_si128(reinterpret_cast<const __m128i *>(previous + i)));
+        // 稳定的连接占绝大多数, 整块相同时只需一次比较
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(changed, zero)) == 0xFFFF)
+            continue;
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(previous + i), current);
+        alignas(16) uint64_t words[2];
+        _mm_store_si128(reinterpret_cast<__m128i *>(words), changed);
+        flipped += flipWord(state, slave, i * 8, words[0], nowRelMs);
+        flipped += flipWord(state, slave, i * 8 + 64, words[1], nowRelMs);
+    }
+#endif
+    for (; i + 8 <= length; i += 8) {
+        uint64_t current = loadWord(data + i);
+        uint64_t changed = current ^ loadWord(previous + i);
+        if (!changed)
+            continue;
+        std::memcpy(previous + i, &current, sizeof(current));
+        flipped += flipWord(state, slave, i * 8, changed, nowRelMs);
+    }
+    if (i < length) {
+        uint64_t changed = 0;
+        for (size_t j = i; j < length; ++j) {
+            changed |= static_cast<uint64_t>(data[j] ^ previous[j]) << ((j - i) * 8);
+            previous[j] = data[j];
+        }
+        flipped += flipWord(state, slave, i * 8, changed, nowRelMs);
+    }
+
+    state.summary.flips += flipped;
+    totalFlips_ += flipped;
+    return flipped;
+}
+
+void PinFlipAccumulator::rebaseline(SlaveState &state, const uint8_t *data,
+                                    size_t length, uint64_t nowMs) {
+    state.baseMs = nowMs;
+    state.previous.assign(data, data + length);
+    state.counters.assign(length * 8, PinCounter());
+    state.summary.pins = static_cast<uint32_t>(length * 8);
+    state.summary.flips = 0;
+    state.summary.flakyPins = 0;
+}
+
+uint32_t PinFlipAccumulator::flipWord(SlaveState &state, uint32_t slave,
+                                      size_t bitOffset, uint64_t changed,
+                                      uint32_t nowRelMs) {
+    uint32_t flipped = 0;
+    while (changed) {
+        uint32_t pin =
+            static_cast<uint32_t>(bitOffset + countTrailingZeros(changed));
+        changed &= changed - 1;
+        PinCounter &counter = state.counters[pin];
+        if (counter.flips == 0) {
+            flaky_.push_back({slave, pin});
+            ++state.summary.flakyPins;
+        } else {
+            uint32_t dwellMs = nowRelMs - counter.lastFlipMs;
+            if (counter.flips == 1 || dwellMs < counter.minDwellMs)
+                counter.minDwellMs = dwellMs;
+            // 奇数次翻转后处于故障状态, 本次翻转回到基准
+            if (counter.flips & 1)
+                counter.faultMs += dwellMs;
+        }
+        ++counter.flips;
+        counter.lastFlipMs = nowRelMs;
+        ++flipped;
+    }
+    return flipped;
+}
+
+PinFlipStats PinFlipAccumulator::makeStats(const SlaveState &state,
+                                           uint32_t pin,
+                                           uint64_t nowMs) const {
+    const PinCounter &counter = state.counters[pin];
+    PinFlipStats stats;
+    stats.slaveId = state.slaveId;
+    stats.pin = pin;
+    stats.flips = counter.flips;
+    stats.minDwellMs = counter.minDwellMs;
+    stats.lastFlipMs = state.baseMs + counter.lastFlipMs;
+    stats.faulted = (counter.flips & 1) != 0;
+    stats.faultMs = counter.faultMs;
+    if (stats.faulted && nowMs > stats.lastFlipMs)
+        stats.faultMs += nowMs - stats.lastFlipMs;
+    return stats;
+}
+
+std::vector<PinFlipStats> PinFlipAccumulator::topN(size_t n,
+                                                   uint64_t nowMs) const {
+    n = std::min(n, flaky_.size());
+    auto flakier = [this](const FlakyPin &a, const FlakyPin &b) {
+        const PinCounter &ca = slaves_[a.slave].counters[a.pin];
+        const PinCounter &cb = slaves_[b.slave].counters[b.pin];
+        if (ca.flips != cb.flips)
+            return ca.flips > cb.flips;
+        return ca.minDwellMs < cb.minDwellMs;
+    };
+    // 大小为 n 的堆, 堆顶为已选中的针脚中最不频繁的; 只分配 n 项, 不复制 flaky_
+    std::vector<FlakyPin> best;
+    best.reserve(n);
+    for (const FlakyPin &pin : flaky_) {
+        if (best.size() < n) {
+            best.push_back(pin);
+            std::push_heap(best.begin(), best.end(), flakier);
+        } else if (n > 0 && flakier(pin, best.front())) {
+            std::pop_heap(best.begin(), best.end(), flakier);
+            best.back() = pin;
+            std::push_heap(best.begin(), best.end(), flakier);
+        }
+    }
+    std::sort_heap(best.begin(), best.end(), flakier);
+
+    std::vector<PinFlipStats> result;
+    result.reserve(n);
+    for (const FlakyPin &pin : best)
+        result.push_back(makeStats(slaves_[pin.slave], pin.pin, nowMs));
+    return result;
+}
+
+bool PinFlipAccumulator::pinStats(uint32_t slaveId, uint32_t pin,
+                                  uint64_t nowMs, PinFlipStats &stats) const {
+    uint32_t slave = index_.find(slaveId);
+    if (slave == SlaveIndex::NONE || pin >= slaves_[slave].counters.size())
+        return false;
+    stats = makeStats(slaves_[slave], pin, nowMs);
+    return true;
+}
+
+std::vector<PinFlipSlaveSummary> PinFlipAccumulator::slaves() const {
+    std::vector<PinFlipSlaveSummary> result;
+    result.reserve(slaves_.size());
+    for (const SlaveState &state : slaves_)
+        result.push_back(state.summary);
+    std::sort(result.begin(), result.end(),
+              [](const PinFlipSlaveSummary &a, const PinFlipSlaveSummary &b) {
+                  return a.slaveId < b.slaveId;
+              });
+    return result;
+}
+
+size_t PinFlipAccumulator::memoryBytes() const {
+    size_t bytes = slaves_.capacity() * sizeof(SlaveState) +
+                   flaky_.capacity() * sizeof(FlakyPin);
+    for (const SlaveState &state : slaves_)
+        bytes += state.previous.capacity() +
+                 state.counters.capacity() * sizeof(PinCounter);
+    return bytes;
+}
+
+void PinFlipAccumulator::reset() {
+    slaves_.clear();
+    index_.clear();
+    flaky_.clear();
+    totalFlips_ = 0;
+    droppedFrames_ = 0;
+}
+
+} // namespace WhtsProtocol
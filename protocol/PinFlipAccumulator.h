@@ -0,0 +1,105 @@
+#ifndef WHTS_PROTOCOL_PIN_FLIP_ACCUMULATOR_H
+#define WHTS_PROTOCOL_PIN_FLIP_ACCUMULATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "SlaveIndex.h"
+
+namespace WhtsProtocol {
+
+// 单个针脚的间歇故障统计; 针脚号 = 字节序号 * 8 + 位序号 (低位在前)
+struct PinFlipStats {
+    uint32_t slaveId = 0;
+    uint32_t pin = 0;
+    uint32_t flips = 0;       // 相邻两帧该位不同的次数
+    uint32_t minDwellMs = 0;  // 两次翻转之间最短的稳定时间 (少于两次翻转时为 0)
+    uint64_t lastFlipMs = 0;
+    uint64_t faultMs = 0;     // 处于与首帧不同状态的累计时长
+    bool faulted = false;     // 当前与首帧不同
+};
+
+// 单个从机的汇总
+struct PinFlipSlaveSummary {
+    uint32_t slaveId = 0;
+    uint32_t pins = 0;
+    uint64_t frames = 0;
+    uint64_t flips = 0;
+    uint32_t flakyPins = 0;   // 翻转过的针脚数
+    uint32_t rebaselines = 0; // 导通数据长度变化, 统计重新开始的次数
+};
+
+// 导通数据间歇故障累加器: 按从机保存上一帧, 每帧与上一帧逐块比较 (SSE2 或 64 位字),
+// 无变化的块直接跳过, 只对变化的位更新针脚计数。以从机的第一帧为基准计算故障时长。
+// 内存上限约为 maxSlaves * maxPins * 24 字节: 每针脚计数 16 字节, 翻转过的针脚列表每项 8 字节
+// (默认配置约 8 MB + 4 MB); 超出的从机不统计, 超长的数据截断到 maxPins。
+class PinFlipAccumulator {
+  public:
+    struct Config {
+        size_t maxSlaves = 256;
+        size_t maxPins = 2048;
+    };
+
+    PinFlipAccumulator();
+    explicit PinFlipAccumulator(const Config &config);
+
+    // 返回本帧翻转的针脚数
+    uint32_t onConduction(uint32_t slaveId, const uint8_t *data, size_t length,
+                          uint64_t nowMs);
+
+    // 翻转次数最多的 n 个针脚, 次数相同时最短稳定时间短的在前;
+    // nowMs 用于计入当前仍处于故障状态的时长
+    std::vector<PinFlipStats> topN(size_t n, uint64_t nowMs) const;
+    bool pinStats(uint32_t slaveId, uint32_t pin, uint64_t nowMs,
+                  PinFlipStats &stats) const;
+    // 按从机ID排序
+    std::vector<PinFlipSlaveSummary> slaves() const;
+
+    uint64_t totalFlips() const { return totalFlips_; }
+    // 超出 maxSlaves 未统计的帧数
+    uint64_t droppedFrames() const { return droppedFrames_; }
+    size_t memoryBytes() const;
+    void reset();
+
+  private:
+    struct PinCounter {
+        uint32_t flips = 0;
+        uint32_t minDwellMs = 0;
+        uint32_t lastFlipMs = 0; // 相对 SlaveState::baseMs
+        uint32_t faultMs = 0;    // 不含当前这段故障
+    };
+    static_assert(sizeof(PinCounter) == 16, "PinCounter layout");
+
+    struct SlaveState {
+        uint32_t slaveId = 0;
+        uint64_t baseMs = 0;
+        std::vector<uint8_t> previous;
+        std::vector<PinCounter> counters;
+        PinFlipSlaveSummary summary;
+    };
+
+    struct FlakyPin {
+        uint32_t slave; // slaves_ 下标
+        uint32_t pin;
+    };
+
+    void rebaseline(SlaveState &state, const uint8_t *data, size_t length,
+                    uint64_t nowMs);
+    uint32_t flipWord(SlaveState &state, uint32_t slave, size_t bitOffset,
+                      uint64_t changed, uint32_t nowRelMs);
+    PinFlipStats makeStats(const SlaveState &state, uint32_t pin,
+                           uint64_t nowMs) const;
+
+    Config config_;
+    std::vector<SlaveState> slaves_;
+    SlaveIndex index_;
+    // 翻转过的针脚, 第一次翻转时加入, topN 只在其中选择
+    std::vector<FlakyPin> flaky_;
+    uint64_t totalFlips_ = 0;
+    uint64_t droppedFrames_ = 0;
+};
+
+} // namespace WhtsProtocol
+
+#endif // WHTS_PROTOCOL_PIN_FLIP_ACCUMULATOR_H
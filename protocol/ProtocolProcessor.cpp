@@ -1,6 +1,7 @@
 #include "ProtocolProcessor.h"
 
 #include <algorithm>
+#include <chrono>
 #include <cstring>
 
 #include "messages/Backend2Master.h"
@@ -8,13 +9,30 @@
 #include "messages/Master2Slave.h"
 #include "messages/Slave2Backend.h"
 #include "messages/Slave2Master.h"
+#include "utils/Crc32c.h"
+#include "utils/TraceRecorder.h"
 
 namespace WhtsProtocol {
 
 // ProtocolProcessor 实现
-ProtocolProcessor::ProtocolProcessor() : mtu_(DEFAULT_MTU) {}
+ProtocolProcessor::ProtocolProcessor()
+    : mtu_(DEFAULT_MTU), currentArrivalNs_(0), crcMode_(CrcMode::AUTO),
+      peerCrc_(false) {}
 ProtocolProcessor::~ProtocolProcessor() {}
 
+void ProtocolProcessor::setCrcMode(CrcMode mode) {
+    crcMode_ = mode;
+    peerCrc_ = false;
+}
+
+bool ProtocolProcessor::isCrcActive() const {
+    return crcMode_ == CrcMode::ON || (crcMode_ == CrcMode::AUTO && peerCrc_);
+}
+
+size_t ProtocolProcessor::frameLimit() const {
+    return isCrcActive() ? mtu_ - FRAME_CRC_SIZE : mtu_;
+}
+
 void ProtocolProcessor::writeUint16LE(std::vector<uint8_t> &buffer,
                                       uint16_t value) {
     buffer.push_back(value & 0xFF);
@@ -89,6 +107,15 @@ std::vector<uint8_t> ProtocolProcessor::packSlave2MasterMessageSingle(
 std::vector<uint8_t> ProtocolProcessor::packSlave2BackendMessageSingle(
     uint32_t slaveId, const DeviceStatus &deviceStatus, const Message &message,
     uint8_t fragmentsSequence, uint8_t moreFragmentsFlag) {
+    return packSlave2BackendMessageSingle(slaveId, deviceStatus, message,
+                                          Slave2BackendExtension(),
+                                          fragmentsSequence, moreFragmentsFlag);
+}
+
+std::vector<uint8_t> ProtocolProcessor::packSlave2BackendMessageSingle(
+    uint32_t slaveId, const DeviceStatus &deviceStatus, const Message &message,
+    const Slave2BackendExtension &extension, uint8_t fragmentsSequence,
+    uint8_t moreFragmentsFlag) {
     Frame frame;
     frame.packetId = static_cast<uint8_t>(PacketId::SLAVE_TO_BACKEND);
     frame.fragmentsSequence = fragmentsSequence;
@@ -96,9 +123,15 @@ std::vector<uint8_t> ProtocolProcessor::packSlave2BackendMessageSingle(
 
     // 构建载荷
     std::vector<uint8_t> payload;
-    payload.push_back(message.getMessageId());
+    payload.push_back(extension.present
+                          ? (message.getMessageId() | SLAVE2BACKEND_EXT_FLAG)
+                          : message.getMessageId());
     writeUint32LE(payload, slaveId);
     writeUint16LE(payload, deviceStatus.toUint16());
+    if (extension.present) {
+        writeUint16LE(payload, extension.sequence);
+        writeUint32LE(payload, extension.timestampUs);
+    }
 
     auto messageData = message.serialize();
     payload.insert(payload.end(), messageData.begin(), messageData.end());
@@ -201,6 +234,15 @@ std::unique_ptr<Message> ProtocolProcessor::createMessage(PacketId packetId,
                         Slave2Backend::ResistanceDataMessage>();
                 case Slave2BackendMessageId::CLIP_DATA_MSG:
                     return std::make_unique<Slave2Backend::ClipDataMessage>();
+                case Slave2BackendMessageId::CONDUCTION_BATCH_MSG:
+                    return std::make_unique<
+                        Slave2Backend::ConductionBatchMessage>();
+                case Slave2BackendMessageId::RESISTANCE_BATCH_MSG:
+                    return std::make_unique<
+                        Slave2Backend::ResistanceBatchMessage>();
+                case Slave2BackendMessageId::CONDUCTION_DELTA_MSG:
+                    return std::make_unique<
+                        Slave2Backend::ConductionDeltaMessage>();
             }
             break;
 
@@ -271,73 +313,151 @@ std::unique_ptr<Message> ProtocolProcessor::createMessage(PacketId packetId,
 bool ProtocolProcessor::parseMaster2SlavePacket(
     const std::vector<uint8_t> &payload, uint32_t &destinationId,
     std::unique_ptr<Message> &message) {
-    if (payload.size() < 5) return false;
+    WHTS_TRACE_SCOPE("parseMaster2SlavePacket");
+    if (payload.size() < 5) {
+        stats_.add(StatCounter::MESSAGE_DECODE_ERRORS);
+        return false;
+    }
 
     uint8_t messageId = payload[0];
     destinationId = readUint32LE(payload, 1);
 
     message = createMessage(PacketId::MASTER_TO_SLAVE, messageId);
-    if (!message) return false;
+    if (!message) {
+        stats_.add(StatCounter::UNKNOWN_MESSAGE_IDS);
+        return false;
+    }
 
     std::vector<uint8_t> messageData(payload.begin() + 5, payload.end());
-    return message->deserialize(messageData);
+    if (!message->deserialize(messageData)) {
+        stats_.add(StatCounter::MESSAGE_DECODE_ERRORS);
+        return false;
+    }
+    return true;
 }
 
 bool ProtocolProcessor::parseSlave2MasterPacket(
     const std::vector<uint8_t> &payload, uint32_t &slaveId,
     std::unique_ptr<Message> &message) {
-    if (payload.size() < 5) return false;
+    WHTS_TRACE_SCOPE("parseSlave2MasterPacket");
+    if (payload.size() < 5) {
+        stats_.add(StatCounter::MESSAGE_DECODE_ERRORS);
+        return false;
+    }
 
     uint8_t messageId = payload[0];
     slaveId = readUint32LE(payload, 1);
 
     message = createMessage(PacketId::SLAVE_TO_MASTER, messageId);
-    if (!message) return false;
+    if (!message) {
+        stats_.add(StatCounter::UNKNOWN_MESSAGE_IDS);
+        return false;
+    }
 
     std::vector<uint8_t> messageData(payload.begin() + 5, payload.end());
-    return message->deserialize(messageData);
+    if (!message->deserialize(messageData)) {
+        stats_.add(StatCounter::MESSAGE_DECODE_ERRORS);
+        return false;
+    }
+    return true;
 }
 
 bool ProtocolProcessor::parseSlave2BackendPacket(
     const std::vector<uint8_t> &payload, uint32_t &slaveId,
     DeviceStatus &deviceStatus, std::unique_ptr<Message> &message) {
-    if (payload.size() < 7) return false;
+    Slave2BackendExtension extension;
+    return parseSlave2BackendPacket(payload, slaveId, deviceStatus, message,
+                                    extension);
+}
 
-    uint8_t messageId = payload[0];
+bool ProtocolProcessor::parseSlave2BackendPacket(
+    const std::vector<uint8_t> &payload, uint32_t &slaveId,
+    DeviceStatus &deviceStatus, std::unique_ptr<Message> &message,
+    Slave2BackendExtension &extension) {
+    WHTS_TRACE_SCOPE("parseSlave2BackendPacket");
+    if (payload.size() < 7) {
+        stats_.add(StatCounter::MESSAGE_DECODE_ERRORS);
+        return false;
+    }
+
+    uint8_t messageId = payload[0] & SLAVE2BACKEND_MSG_ID_MASK;
     slaveId = readUint32LE(payload, 1);
     deviceStatus.fromUint16(readUint16LE(payload, 5));
 
+    // 扩展头 (旧固件不置位, 按原格式解析)
+    size_t headerSize = 7;
+    extension = Slave2BackendExtension();
+    if (payload[0] & SLAVE2BACKEND_EXT_FLAG) {
+        if (payload.size() < headerSize + SLAVE2BACKEND_EXT_SIZE) {
+            stats_.add(StatCounter::MESSAGE_DECODE_ERRORS);
+            return false;
+        }
+        extension.present = true;
+        extension.sequence = readUint16LE(payload, headerSize);
+        extension.timestampUs = readUint32LE(payload, headerSize + 2);
+        headerSize += SLAVE2BACKEND_EXT_SIZE;
+    }
+
     message = createMessage(PacketId::SLAVE_TO_BACKEND, messageId);
-    if (!message) return false;
+    if (!message) {
+        stats_.add(StatCounter::UNKNOWN_MESSAGE_IDS);
+        return false;
+    }
 
-    std::vector<uint8_t> messageData(payload.begin() + 7, payload.end());
-    return message->deserialize(messageData);
+    std::vector<uint8_t> messageData(payload.begin() + headerSize, payload.end());
+    if (!message->deserialize(messageData)) {
+        stats_.add(StatCounter::MESSAGE_DECODE_ERRORS);
+        return false;
+    }
+    return true;
 }
 
 bool ProtocolProcessor::parseBackend2MasterPacket(
     const std::vector<uint8_t> &payload, std::unique_ptr<Message> &message) {
-    if (payload.size() < 1) return false;
+    WHTS_TRACE_SCOPE("parseBackend2MasterPacket");
+    if (payload.size() < 1) {
+        stats_.add(StatCounter::MESSAGE_DECODE_ERRORS);
+        return false;
+    }
 
     uint8_t messageId = payload[0];
 
     message = createMessage(PacketId::BACKEND_TO_MASTER, messageId);
-    if (!message) return false;
+    if (!message) {
+        stats_.add(StatCounter::UNKNOWN_MESSAGE_IDS);
+        return false;
+    }
 
     std::vector<uint8_t> messageData(payload.begin() + 1, payload.end());
-    return message->deserialize(messageData);
+    if (!message->deserialize(messageData)) {
+        stats_.add(StatCounter::MESSAGE_DECODE_ERRORS);
+        return false;
+    }
+    return true;
 }
 
 bool ProtocolProcessor::parseMaster2BackendPacket(
     const std::vector<uint8_t> &payload, std::unique_ptr<Message> &message) {
-    if (payload.size() < 1) return false;
+    WHTS_TRACE_SCOPE("parseMaster2BackendPacket");
+    if (payload.size() < 1) {
+        stats_.add(StatCounter::MESSAGE_DECODE_ERRORS);
+        return false;
+    }
 
     uint8_t messageId = payload[0];
 
     message = createMessage(PacketId::MASTER_TO_BACKEND, messageId);
-    if (!message) return false;
+    if (!message) {
+        stats_.add(StatCounter::UNKNOWN_MESSAGE_IDS);
+        return false;
+    }
 
     std::vector<uint8_t> messageData(payload.begin() + 1, payload.end());
-    return message->deserialize(messageData);
+    if (!message->deserialize(messageData)) {
+        stats_.add(StatCounter::MESSAGE_DECODE_ERRORS);
+        return false;
+    }
+    return true;
 }
 
 // 支持自动分片的打包函数
@@ -347,14 +467,7 @@ std::vector<std::vector<uint8_t>> ProtocolProcessor::packMaster2SlaveMessage(
     auto completeFrame =
         packMaster2SlaveMessageSingle(destinationId, message, 0, 0);
 
-    // 检查是否需要分片
-    if (completeFrame.size() <= mtu_) {
-        // 不需要分片，直接返回
-        return {completeFrame};
-    }
-
-    // 需要分片
-    return fragmentFrame(completeFrame);
+    return finishFrames(std::move(completeFrame));
 }
 
 std::vector<std::vector<uint8_t>> ProtocolProcessor::packSlave2MasterMessage(
@@ -362,31 +475,24 @@ std::vector<std::vector<uint8_t>> ProtocolProcessor::packSlave2MasterMessage(
     // 首先生成单个完整帧
     auto completeFrame = packSlave2MasterMessageSingle(slaveId, message, 0, 0);
 
-    // 检查是否需要分片
-    if (completeFrame.size() <= mtu_) {
-        // 不需要分片，直接返回
-        return {completeFrame};
-    }
-
-    // 需要分片
-    return fragmentFrame(completeFrame);
+    return finishFrames(std::move(completeFrame));
 }
 
 std::vector<std::vector<uint8_t>> ProtocolProcessor::packSlave2BackendMessage(
     uint32_t slaveId, const DeviceStatus &deviceStatus,
     const Message &message) {
-    // 首先生成单个完整帧
-    auto completeFrame =
-        packSlave2BackendMessageSingle(slaveId, deviceStatus, message, 0, 0);
+    return packSlave2BackendMessage(slaveId, deviceStatus, message,
+                                    Slave2BackendExtension());
+}
 
-    // 检查是否需要分片
-    if (completeFrame.size() <= mtu_) {
-        // 不需要分片，直接返回
-        return {completeFrame};
-    }
+std::vector<std::vector<uint8_t>> ProtocolProcessor::packSlave2BackendMessage(
+    uint32_t slaveId, const DeviceStatus &deviceStatus, const Message &message,
+    const Slave2BackendExtension &extension) {
+    // 首先生成单个完整帧
+    auto completeFrame = packSlave2BackendMessageSingle(
+        slaveId, deviceStatus, message, extension, 0, 0);
 
-    // 需要分片
-    return fragmentFrame(completeFrame);
+    return finishFrames(std::move(completeFrame));
 }
 
 std::vector<std::vector<uint8_t>> ProtocolProcessor::packBackend2MasterMessage(
@@ -394,14 +500,7 @@ std::vector<std::vector<uint8_t>> ProtocolProcessor::packBackend2MasterMessage(
     // 首先生成单个完整帧
     auto completeFrame = packBackend2MasterMessageSingle(message, 0, 0);
 
-    // 检查是否需要分片
-    if (completeFrame.size() <= mtu_) {
-        // 不需要分片，直接返回
-        return {completeFrame};
-    }
-
-    // 需要分片
-    return fragmentFrame(completeFrame);
+    return finishFrames(std::move(completeFrame));
 }
 
 std::vector<std::vector<uint8_t>> ProtocolProcessor::packMaster2BackendMessage(
@@ -409,14 +508,28 @@ std::vector<std::vector<uint8_t>> ProtocolProcessor::packMaster2BackendMessage(
     // 首先生成单个完整帧
     auto completeFrame = packMaster2BackendMessageSingle(message, 0, 0);
 
-    // 检查是否需要分片
-    if (completeFrame.size() <= mtu_) {
-        // 不需要分片，直接返回
-        return {completeFrame};
+    return finishFrames(std::move(completeFrame));
+}
+
+std::vector<std::vector<uint8_t>>
+ProtocolProcessor::finishFrames(std::vector<uint8_t> completeFrame) {
+    std::vector<std::vector<uint8_t>> frames;
+    if (completeFrame.size() <= frameLimit()) {
+        // 不需要分片
+        frames.push_back(std::move(completeFrame));
+    } else {
+        frames = fragmentFrame(completeFrame);
     }
 
-    // 需要分片
-    return fragmentFrame(completeFrame);
+    if (isCrcActive()) {
+        for (auto &frame : frames) {
+            frame[4] |= FRAME_FLAG_CRC;
+            writeUint32LE(frame, Crc32c::compute(frame.data(), frame.size()));
+        }
+    }
+
+    recordPacked(frames);
+    return frames;
 }
 
 // 分片功能实现
@@ -435,8 +548,8 @@ std::vector<std::vector<uint8_t>> ProtocolProcessor::fragmentFrame(
     uint8_t packetId = frameData[2];
 
     // Calculate effective payload size per fragment (MTU - 7 bytes frame
-    // header)
-    size_t fragmentPayloadSize = mtu_ - 7;
+    // header, minus the CRC trailer when enabled)
+    size_t fragmentPayloadSize = frameLimit() - 7;
 
     // Get original payload (starting from 7th byte)
     std::vector<uint8_t> originalPayload(frameData.begin() + 7,
@@ -480,14 +593,94 @@ std::vector<std::vector<uint8_t>> ProtocolProcessor::fragmentFrame(
     return fragments;
 }
 
+std::vector<std::vector<uint8_t>>
+ProtocolProcessor::fragmentReliable(const std::vector<uint8_t> &completeFrame,
+                                    uint8_t reliableId) {
+    std::vector<std::vector<uint8_t>> fragments;
+    if (completeFrame.size() < 7) {
+        return fragments;
+    }
+
+    uint8_t packetId = completeFrame[2];
+    size_t payloadSize = completeFrame.size() - 7;
+    size_t chunkSize = mtu_ - 7 - RELIABLE_PREFIX_SIZE - FRAME_CRC_SIZE;
+    size_t total = std::max<size_t>(1, (payloadSize + chunkSize - 1) / chunkSize);
+    // 分片序号只有 8 位, 超出时无法可靠发送
+    if (total > 255) {
+        return fragments;
+    }
+
+    for (size_t i = 0; i < total; ++i) {
+        size_t startPos = 7 + i * chunkSize;
+        size_t endPos = std::min(startPos + chunkSize, completeFrame.size());
+        uint16_t length =
+            static_cast<uint16_t>(RELIABLE_PREFIX_SIZE + endPos - startPos);
+
+        std::vector<uint8_t> fragment;
+        fragment.reserve(7 + length + FRAME_CRC_SIZE);
+        fragment.push_back(FRAME_DELIMITER_1);
+        fragment.push_back(FRAME_DELIMITER_2);
+        fragment.push_back(packetId);
+        fragment.push_back(static_cast<uint8_t>(i));
+        fragment.push_back(FRAME_FLAG_RELIABLE |
+                           (i + 1 < total ? FRAME_FLAG_MORE_FRAGMENTS : 0));
+        writeUint16LE(fragment, length);
+        fragment.push_back(reliableId);
+        fragment.push_back(static_cast<uint8_t>(total));
+        fragment.push_back(0); // 发送轮次, 由 finishReliableFragment 填入
+        fragment.insert(fragment.end(), completeFrame.begin() + startPos,
+                        completeFrame.begin() + endPos);
+        fragments.push_back(std::move(fragment));
+    }
+    return fragments;
+}
+
+std::vector<uint8_t>
+ProtocolProcessor::finishReliableFragment(const std::vector<uint8_t> &fragment,
+                                          uint8_t round, bool ackRequest) {
+    std::vector<uint8_t> frame;
+    frame.reserve(fragment.size() + FRAME_CRC_SIZE);
+    frame = fragment;
+    frame[9] = round;
+    if (ackRequest) {
+        frame[4] |= FRAME_FLAG_ACK_REQUEST;
+    }
+    if (isCrcActive()) {
+        frame[4] |= FRAME_FLAG_CRC;
+        writeUint32LE(frame, Crc32c::compute(frame.data(), frame.size()));
+    }
+    stats_.add(StatCounter::FRAMES_OUT);
+    stats_.add(StatCounter::BYTES_OUT, frame.size());
+    return frame;
+}
+
+bool ProtocolProcessor::getNextOutgoingFrame(std::vector<uint8_t> &frame) {
+    if (outgoingFrames_.empty()) {
+        return false;
+    }
+    frame = std::move(outgoingFrames_.front());
+    outgoingFrames_.pop();
+    return true;
+}
+
 // Process received raw data (supports packet concatenation handling)
 void ProtocolProcessor::processReceivedData(const std::vector<uint8_t> &data) {
+    processReceivedData(data, nowNs());
+}
+
+void ProtocolProcessor::processReceivedData(const std::vector<uint8_t> &data,
+                                            uint64_t arrivalNs) {
+    WHTS_TRACE_SCOPE("processReceivedData");
+    currentArrivalNs_ = arrivalNs;
     // elog_v("ProtocolProcessor",
     //        "Received new data, size: %d bytes, prefix: %s", data.size(),
     //        bytesToHexString(data, 8).c_str());
+    stats_.add(StatCounter::BYTES_IN, data.size());
 
     // Prevent receive buffer from becoming too large
     if (receiveBuffer_.size() + data.size() > MAX_RECEIVE_BUFFER_SIZE) {
+        stats_.add(StatCounter::BUFFER_OVERFLOWS);
+        stats_.add(StatCounter::OVERFLOW_DROPPED_BYTES, receiveBuffer_.size());
         receiveBuffer_.clear();
     }
 
@@ -495,7 +688,7 @@ void ProtocolProcessor::processReceivedData(const std::vector<uint8_t> &data) {
     receiveBuffer_.insert(receiveBuffer_.end(), data.begin(), data.end());
 
     // Try to extract complete frames from buffer
-    bool framesExtracted = extractCompleteFrames();
+    extractCompleteFrames();
 
     // Clean up expired fragments
     cleanupExpiredFragments();
@@ -503,6 +696,7 @@ void ProtocolProcessor::processReceivedData(const std::vector<uint8_t> &data) {
 
 // Extract complete frames from receive buffer
 bool ProtocolProcessor::extractCompleteFrames() {
+    WHTS_TRACE_SCOPE("extractCompleteFrames");
     bool foundFrames = false;
     size_t pos = 0;
 
@@ -511,29 +705,63 @@ bool ProtocolProcessor::extractCompleteFrames() {
         // Find frame header
         size_t frameStart = findFrameHeader(receiveBuffer_, pos);
         if (frameStart == SIZE_MAX) {
+            // 没有帧头, 丢弃垃圾数据, 但保留最后一个可能是帧头前半部分的字节
+            size_t keepFrom = receiveBuffer_.size() - 1;
+            if (receiveBuffer_[keepFrom] != FRAME_DELIMITER_1)
+                keepFrom = receiveBuffer_.size();
+            if (keepFrom > pos) {
+                stats_.add(StatCounter::RESYNC_SKIPPED_BYTES, keepFrom - pos);
+                pos = keepFrom;
+            }
             break;    // No frame header found
         }
 
+        if (frameStart > pos) {
+            stats_.add(StatCounter::RESYNC_SKIPPED_BYTES, frameStart - pos);
+        }
 
         // Check if there's enough data to read frame length
         if (frameStart + 7 > receiveBuffer_.size()) {
+            pos = frameStart;
             break;    // Not enough data, wait for more
         }
 
         // 读取帧长度
         uint16_t frameLength = readUint16LE(receiveBuffer_, frameStart + 5);
-        size_t totalFrameSize = 7 + frameLength;
+        bool hasCrc = (receiveBuffer_[frameStart + 4] & FRAME_FLAG_CRC) != 0;
+        size_t frameSize = 7 + frameLength;
+        size_t totalFrameSize = frameSize + (hasCrc ? FRAME_CRC_SIZE : 0);
 
 
         // 检查是否有完整的帧
         if (frameStart + totalFrameSize > receiveBuffer_.size()) {
+            pos = frameStart;
             break;    // 帧不完整，等待更多数据
         }
 
-        // 提取完整帧数据
+        // 在接收缓冲区中原位校验; 失败时只跳过帧头重新同步,
+        // 避免被损坏的长度字段吞掉后面的帧
+        if (hasCrc) {
+            uint32_t expected =
+                readUint32LE(receiveBuffer_, frameStart + frameSize);
+            if (Crc32c::compute(receiveBuffer_.data() + frameStart,
+                                frameSize) != expected) {
+                stats_.add(StatCounter::CRC_ERRORS);
+                pos = frameStart + 1;
+                continue;
+            }
+            peerCrc_ = true;
+        } else if (isCrcActive()) {
+            // 协商后不带校验尾的帧同样丢弃, 否则一位标志错误即可绕过校验
+            stats_.add(StatCounter::CRC_ERRORS);
+            pos = frameStart + 1;
+            continue;
+        }
+
+        // 提取完整帧数据 (不含校验尾)
         std::vector<uint8_t> frameData(
             receiveBuffer_.begin() + frameStart,
-            receiveBuffer_.begin() + frameStart + totalFrameSize);
+            receiveBuffer_.begin() + frameStart + frameSize);
 
         // elog_v(
         //     "ProtocolProcessor",
@@ -543,27 +771,45 @@ bool ProtocolProcessor::extractCompleteFrames() {
         // 解析帧
         Frame frame;
         if (Frame::deserialize(frameData, frame)) {
-
-            // 检查是否是分片
-            if (frame.moreFragmentsFlag || frame.fragmentsSequence > 0) {
+            uint8_t flags = frame.moreFragmentsFlag;
+            frame.moreFragmentsFlag &= static_cast<uint8_t>(
+                ~(FRAME_FLAG_CRC | FRAME_FLAG_RELIABLE |
+                  FRAME_FLAG_ACK_REQUEST));
+
+            if (flags & FRAME_FLAG_RELIABLE) {
+                stats_.add(StatCounter::FRAGMENTS_RECEIVED);
+                if (handleReliableFragment(
+                        frame, (flags & FRAME_FLAG_ACK_REQUEST) != 0)) {
+                    foundFrames = true;
+                }
+            } else if (frame.moreFragmentsFlag ||
+                       frame.fragmentsSequence > 0) {
+                // 检查是否是分片
                 // 处理分片重组
+                stats_.add(StatCounter::FRAGMENTS_RECEIVED);
                 std::vector<uint8_t> completeFrame;
                 if (reassembleFragments(frame, completeFrame)) {
                     // 分片重组完成，解析完整帧
                     Frame completedFrame;
                     if (Frame::deserialize(completeFrame, completedFrame)) {
-                        completeFrames_.push(completedFrame);
+                        completedFrame.arrivalNs = currentArrivalNs_;
+                        stats_.add(StatCounter::FRAGMENTS_REASSEMBLED);
+                        stats_.recordFrame(completedFrame.packetId);
+                        pushCompleteFrame(std::move(completedFrame));
                         foundFrames = true;
                     } else {
+                        stats_.add(StatCounter::FRAME_DECODE_ERRORS);
                     }
-                } else {
                 }
             } else {
                 // 单个完整帧
-                completeFrames_.push(frame);
+                frame.arrivalNs = currentArrivalNs_;
+                stats_.recordFrame(frame.packetId);
+                pushCompleteFrame(std::move(frame));
                 foundFrames = true;
             }
         } else {
+            stats_.add(StatCounter::FRAME_DECODE_ERRORS);
         }
 
         // 移动到下一个位置
@@ -594,25 +840,40 @@ size_t ProtocolProcessor::findFrameHeader(const std::vector<uint8_t> &buffer,
 // 分片重组
 bool ProtocolProcessor::reassembleFragments(
     const Frame &frame, std::vector<uint8_t> &completeFrame) {
+    WHTS_TRACE_SCOPE("reassembleFragments");
 
-    // 从帧载荷中提取源ID (假设载荷格式为: MessageId + SourceId + ...)
-    if (frame.payload.size() < 5) {
-
-        return false;    // 载荷太小
-    }
-
-    uint8_t messageId = frame.payload[0];
-    uint32_t sourceId = readUint32LE(frame.payload, 1);    // 跳过MessageId
+    // 后续分片只携带原始载荷的延续部分 (不含 MessageId + SourceId),
+    // 因此只能按 Packet ID 区分正在重组的消息
     uint64_t fragmentId = generateFragmentId(frame.packetId);
-
+    auto existing = fragmentMap_.find(fragmentId);
+
+    if (frame.fragmentsSequence == 0) {
+        // 新的首片到达, 之前未完成的分片全部作废
+        if (existing != fragmentMap_.end()) {
+            stats_.add(StatCounter::ORPHANED_FRAGMENTS,
+                       existing->second.fragments.size());
+            fragmentMap_.erase(existing);
+        }
+    } else if (existing == fragmentMap_.end()) {
+        // 缺少首片的后续分片
+        stats_.add(StatCounter::ORPHANED_FRAGMENTS);
+        return false;
+    }
 
     // 查找或创建分片信息
     auto &fragmentInfo = fragmentMap_[fragmentId];
     fragmentInfo.packetId = frame.packetId;
-    // fragmentInfo.timestamp = hal_hptimer_get_us64();
+    fragmentInfo.timestamp = nowMs();
+    if (frame.fragmentsSequence == 0 && frame.payload.size() >= 5) {
+        fragmentInfo.sourceId = readUint32LE(frame.payload, 1);
+    }
 
-    // 存储分片数据
-    fragmentInfo.fragments[frame.fragmentsSequence] = frame.payload;
+    // 存储分片数据 (重复分片以最新的为准)
+    auto &slot = fragmentInfo.fragments[frame.fragmentsSequence];
+    if (!slot.empty()) {
+        stats_.add(StatCounter::ORPHANED_FRAGMENTS);
+    }
+    slot = frame.payload;
 
 
     // 如果这是最后一个分片，计算总分片数
@@ -625,59 +886,190 @@ bool ProtocolProcessor::reassembleFragments(
     if (fragmentInfo.totalFragments > 0 && fragmentInfo.isComplete()) {
 
 
-        // 重组完整载荷
+        // 按序号拼接所有分片的载荷
         std::vector<uint8_t> completePayload;
+        for (uint8_t i = 0; i < fragmentInfo.totalFragments; ++i) {
+            auto it = fragmentInfo.fragments.find(i);
+            if (it == fragmentInfo.fragments.end()) {
+                // 序号不连续, 整组丢弃
+                stats_.add(StatCounter::ORPHANED_FRAGMENTS,
+                           fragmentInfo.fragments.size());
+                fragmentMap_.erase(fragmentId);
+                return false;
+            }
+            completePayload.insert(completePayload.end(), it->second.begin(),
+                                   it->second.end());
+        }
 
-        // First add the complete payload of the first fragment
-        auto firstFragment = fragmentInfo.fragments.find(0);
-        if (firstFragment != fragmentInfo.fragments.end()) {
 
-        } else {
+        completeFrame = buildCompleteFrame(frame.packetId, completePayload);
 
-            return false;
-        }
+        // Clean up fragment information
+        fragmentMap_.erase(fragmentId);
 
-        // Then add the data portion of subsequent fragments
-        for (uint8_t i = 1; i < fragmentInfo.totalFragments; ++i) {
-            auto it = fragmentInfo.fragments.find(i);
-            if (it != fragmentInfo.fragments.end()) {
-                completePayload.insert(completePayload.end(),
-                                       it->second.begin(), it->second.end());
-            }
-        }
 
+        return true;
+    }
 
-        // Build complete frame
-        completeFrame.clear();
-        completeFrame.push_back(FRAME_DELIMITER_1);
-        completeFrame.push_back(FRAME_DELIMITER_2);
-        completeFrame.push_back(frame.packetId);
-        completeFrame.push_back(0);    // fragmentsSequence = 0
-        completeFrame.push_back(0);    // moreFragmentsFlag = 0
+    return false;    // Haven't collected all fragments yet
+}
 
-        // Add payload length
-        uint16_t payloadLength = static_cast<uint16_t>(completePayload.size());
-        completeFrame.push_back(payloadLength & 0xFF);
-        completeFrame.push_back((payloadLength >> 8) & 0xFF);
+std::vector<uint8_t>
+ProtocolProcessor::buildCompleteFrame(uint8_t packetId,
+                                      const std::vector<uint8_t> &payload) {
+    std::vector<uint8_t> completeFrame;
+    completeFrame.reserve(7 + payload.size());
+    completeFrame.push_back(FRAME_DELIMITER_1);
+    completeFrame.push_back(FRAME_DELIMITER_2);
+    completeFrame.push_back(packetId);
+    completeFrame.push_back(0);    // fragmentsSequence = 0
+    completeFrame.push_back(0);    // moreFragmentsFlag = 0
+    writeUint16LE(completeFrame, static_cast<uint16_t>(payload.size()));
+    completeFrame.insert(completeFrame.end(), payload.begin(), payload.end());
+    return completeFrame;
+}
 
+// 可靠分片接收: 按分片序号收集, 可乱序和重复; 收齐后交付并回复完整位图
+bool ProtocolProcessor::handleReliableFragment(const Frame &frame,
+                                               bool ackRequest) {
+    WHTS_TRACE_SCOPE("handleReliableFragment");
+    if (frame.payload.size() < RELIABLE_PREFIX_SIZE) {
+        stats_.add(StatCounter::FRAME_DECODE_ERRORS);
+        return false;
+    }
+    uint8_t reliableId = frame.payload[0];
+    uint8_t total = frame.payload[1];
+    uint8_t round = frame.payload[2];
+    uint8_t index = frame.fragmentsSequence;
+    if (total == 0 || index >= total) {
+        stats_.add(StatCounter::FRAME_DECODE_ERRORS);
+        return false;
+    }
 
+    auto existing = reliableInbound_.find(frame.packetId);
+    if (existing != reliableInbound_.end()) {
+        // 发送端收到完整确认后才发下一条, 迟到的旧分片只可能来自上一条;
+        // 其它不同的 ID 视为新消息 (包括发送端重启后重新编号)
+        if (static_cast<uint8_t>(existing->second.reliableId - reliableId) ==
+            1) {
+            stats_.add(StatCounter::ORPHANED_FRAGMENTS);
+            return false;
+        }
+        if (reliableId != existing->second.reliableId ||
+            existing->second.totalFragments != total) {
+            if (!existing->second.complete) {
+                stats_.add(StatCounter::ORPHANED_FRAGMENTS,
+                           existing->second.receivedCount);
+            }
+            reliableInbound_.erase(existing);
+            existing = reliableInbound_.end();
+        }
+    }
 
-        // Add payload
-        completeFrame.insert(completeFrame.end(), completePayload.begin(),
-                             completePayload.end());
+    ReliableInbound &inbound = reliableInbound_[frame.packetId];
+    if (existing == reliableInbound_.end()) {
+        inbound.reliableId = reliableId;
+        inbound.totalFragments = total;
+        inbound.fragments.assign(total, {});
+        inbound.bitmap.assign((total + 7) / 8, 0);
+    }
+    inbound.timestamp = nowMs();
+
+    uint8_t mask = static_cast<uint8_t>(1u << (index % 8));
+    if (inbound.bitmap[index / 8] & mask) {
+        // 重传的分片 (确认丢失), 只需再次确认
+        stats_.add(StatCounter::ORPHANED_FRAGMENTS);
+    } else {
+        inbound.bitmap[index / 8] |= mask;
+        inbound.fragments[index].assign(
+            frame.payload.begin() + RELIABLE_PREFIX_SIZE, frame.payload.end());
+        ++inbound.receivedCount;
+
+        if (inbound.receivedCount == inbound.totalFragments) {
+            std::vector<uint8_t> completePayload;
+            for (auto &fragment : inbound.fragments) {
+                completePayload.insert(completePayload.end(), fragment.begin(),
+                                       fragment.end());
+                std::vector<uint8_t>().swap(fragment);
+            }
+            inbound.complete = true;
+
+            Frame completedFrame;
+            bool delivered = Frame::deserialize(
+                buildCompleteFrame(frame.packetId, completePayload),
+                completedFrame);
+            if (delivered) {
+                completedFrame.arrivalNs = currentArrivalNs_;
+                stats_.add(StatCounter::FRAGMENTS_REASSEMBLED);
+                stats_.recordFrame(completedFrame.packetId);
+                pushCompleteFrame(std::move(completedFrame));
+            } else {
+                stats_.add(StatCounter::FRAME_DECODE_ERRORS);
+            }
+            // 收齐时立即确认, 发送端不必等到本轮的确认请求
+            queueReliableAck(frame.packetId, inbound, round);
+            return delivered;
+        }
+    }
 
-        // Clean up fragment information
-        fragmentMap_.erase(fragmentId);
+    if (ackRequest) {
+        queueReliableAck(frame.packetId, inbound, round);
+    }
+    return false;
+}
 
+void ProtocolProcessor::queueReliableAck(uint8_t packetId,
+                                         const ReliableInbound &inbound,
+                                         uint8_t round) {
+    std::vector<uint8_t> frame;
+    frame.reserve(7 + 4 + inbound.bitmap.size());
+    frame.push_back(FRAME_DELIMITER_1);
+    frame.push_back(FRAME_DELIMITER_2);
+    frame.push_back(static_cast<uint8_t>(PacketId::RELIABLE_ACK));
+    frame.push_back(0);
+    frame.push_back(0);
+    writeUint16LE(frame, static_cast<uint16_t>(4 + inbound.bitmap.size()));
+    frame.push_back(packetId);
+    frame.push_back(inbound.reliableId);
+    frame.push_back(round);
+    frame.push_back(inbound.totalFragments);
+    frame.insert(frame.end(), inbound.bitmap.begin(), inbound.bitmap.end());
+
+    for (auto &ack : finishFrames(std::move(frame))) {
+        outgoingFrames_.push(std::move(ack));
+    }
+}
 
-        return true;
+void ProtocolProcessor::setPriorityMessage(PacketId packetId,
+                                           uint8_t messageId, bool enabled) {
+    uint16_t key = static_cast<uint16_t>(
+        (static_cast<uint16_t>(packetId) << 8) | messageId);
+    if (enabled) {
+        priorityMessages_.insert(key);
+    } else {
+        priorityMessages_.erase(key);
     }
+}
 
-    return false;    // Haven't collected all fragments yet
+void ProtocolProcessor::pushCompleteFrame(Frame &&frame) {
+    // 载荷首字节为 Message ID
+    if (!priorityMessages_.empty() && !frame.payload.empty() &&
+        priorityMessages_.count(static_cast<uint16_t>(
+            (frame.packetId << 8) | frame.payload[0]))) {
+        stats_.add(StatCounter::PRIORITY_FRAMES);
+        priorityFrames_.push(std::move(frame));
+    } else {
+        completeFrames_.push(std::move(frame));
+    }
 }
 
 // Get next complete frame
 bool ProtocolProcessor::getNextCompleteFrame(Frame &frame) {
+    if (!priorityFrames_.empty()) {
+        frame = std::move(priorityFrames_.front());
+        priorityFrames_.pop();
+        return true;
+    }
     if (completeFrames_.empty()) {
         return false;
     }
@@ -693,7 +1085,14 @@ void ProtocolProcessor::clearReceiveBuffer() {
     while (!completeFrames_.empty()) {
         completeFrames_.pop();
     }
+    while (!priorityFrames_.empty()) {
+        priorityFrames_.pop();
+    }
     fragmentMap_.clear();
+    reliableInbound_.clear();
+    while (!outgoingFrames_.empty()) {
+        outgoingFrames_.pop();
+    }
 }
 
 // Generate fragment ID
@@ -703,9 +1102,53 @@ uint64_t ProtocolProcessor::generateFragmentId(uint8_t packetId) {
 
 // Clean up expired fragments
 void ProtocolProcessor::cleanupExpiredFragments() {
-    // Fragment timeout cleanup is currently disabled
-    // This function can be implemented to clean up expired fragments
-    // based on timestamp if needed in the future
+    if (fragmentMap_.empty() && reliableInbound_.empty()) {
+        return;
+    }
+
+    uint64_t now = nowMs();
+    for (auto it = reliableInbound_.begin(); it != reliableInbound_.end();) {
+        if (now - it->second.timestamp > FRAGMENT_TIMEOUT_MS) {
+            if (!it->second.complete) {
+                stats_.add(StatCounter::EXPIRED_FRAGMENTS,
+                           it->second.receivedCount);
+            }
+            it = reliableInbound_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    for (auto it = fragmentMap_.begin(); it != fragmentMap_.end();) {
+        if (now - it->second.timestamp > FRAGMENT_TIMEOUT_MS) {
+            stats_.add(StatCounter::EXPIRED_FRAGMENTS,
+                       it->second.fragments.size());
+            it = fragmentMap_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+uint64_t ProtocolProcessor::nowMs() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+}
+
+uint64_t ProtocolProcessor::nowNs() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+}
+
+void ProtocolProcessor::recordPacked(
+    const std::vector<std::vector<uint8_t>> &frames) {
+    stats_.add(StatCounter::FRAMES_OUT, frames.size());
+    for (const auto &frame : frames) {
+        stats_.add(StatCounter::BYTES_OUT, frame.size());
+    }
 }
 
 }    // namespace WhtsProtocol
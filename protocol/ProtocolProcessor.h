@@ -4,11 +4,13 @@
 #include "Common.h"
 #include "DeviceStatus.h"
 #include "Frame.h"
+#include "ProtocolStats.h"
 #include "messages/Message.h"
 #include <cstdint>
 #include <map>
 #include <memory>
 #include <queue>
+#include <set>
 #include <vector>
 
 namespace WhtsProtocol {
@@ -24,6 +26,24 @@ struct FragmentInfo {
     bool isComplete() const { return fragments.size() == totalFragments; }
 };
 
+// 可靠分片的接收状态 (每个 Packet ID 一条)
+struct ReliableInbound {
+    uint8_t reliableId = 0;
+    uint8_t totalFragments = 0;
+    std::vector<std::vector<uint8_t>> fragments; // 按分片序号
+    std::vector<uint8_t> bitmap;                 // 已收到的分片位图
+    uint8_t receivedCount = 0;
+    bool complete = false; // 已交付, 保留状态以回复重传和确认请求
+    uint64_t timestamp = 0;
+};
+
+// 帧校验尾 (CRC-32C) 模式, 接收端总是校验带校验尾的帧
+enum class CrcMode : uint8_t {
+    OFF = 0, // 不发送校验尾
+    AUTO,    // 收到对端带校验尾的有效帧后开始发送并丢弃不带校验尾的帧 (默认, 兼容不支持的对端)
+    ON       // 总是发送, 并丢弃不带校验尾的帧
+};
+
 // 协议处理器类
 class ProtocolProcessor {
   public:
@@ -34,6 +54,16 @@ class ProtocolProcessor {
     void setMTU(size_t mtu) { mtu_ = mtu; }
     size_t getMTU() const { return mtu_; }
 
+    // 每个处理器实例对应一条链路; 重新设置模式时清除对端协商状态
+    void setCrcMode(CrcMode mode);
+    CrcMode getCrcMode() const { return crcMode_; }
+    // 打包输出的帧当前是否附带校验尾
+    bool isCrcActive() const;
+
+    // 管线计数器 (无锁, 可在任意线程读取快照)
+    ProtocolStats &getStats() { return stats_; }
+    const ProtocolStats &getStats() const { return stats_; }
+
     // 打包Master2Slave消息 (支持自动分片)
     std::vector<std::vector<uint8_t>>
     packMaster2SlaveMessage(uint32_t destinationId, const Message &message);
@@ -47,6 +77,12 @@ class ProtocolProcessor {
     packSlave2BackendMessage(uint32_t slaveId, const DeviceStatus &deviceStatus,
                              const Message &message);
 
+    // 同上, extension.present 时附带序号/时间戳扩展头
+    std::vector<std::vector<uint8_t>>
+    packSlave2BackendMessage(uint32_t slaveId, const DeviceStatus &deviceStatus,
+                             const Message &message,
+                             const Slave2BackendExtension &extension);
+
     // 打包Backend2Master消息 (支持自动分片)
     std::vector<std::vector<uint8_t>>
     packBackend2MasterMessage(const Message &message);
@@ -55,7 +91,7 @@ class ProtocolProcessor {
     std::vector<std::vector<uint8_t>>
     packMaster2BackendMessage(const Message &message);
 
-    // 兼容旧接口 - 单帧打包
+    // 兼容旧接口 - 单帧打包 (不附带校验尾)
     std::vector<uint8_t> packMaster2SlaveMessageSingle(
         uint32_t destinationId, const Message &message,
         uint8_t fragmentsSequence = 0, uint8_t moreFragmentsFlag = 0);
@@ -70,6 +106,11 @@ class ProtocolProcessor {
         const Message &message, uint8_t fragmentsSequence = 0,
         uint8_t moreFragmentsFlag = 0);
 
+    std::vector<uint8_t> packSlave2BackendMessageSingle(
+        uint32_t slaveId, const DeviceStatus &deviceStatus,
+        const Message &message, const Slave2BackendExtension &extension,
+        uint8_t fragmentsSequence = 0, uint8_t moreFragmentsFlag = 0);
+
     std::vector<uint8_t>
     packBackend2MasterMessageSingle(const Message &message,
                                     uint8_t fragmentsSequence = 0,
@@ -80,16 +121,40 @@ class ProtocolProcessor {
                                     uint8_t fragmentsSequence = 0,
                                     uint8_t moreFragmentsFlag = 0);
 
-    // 处理接收到的原始数据 (支持粘包处理)
+    // 可靠分片 (见 ReliableSender): 将完整帧按 MTU 拆为带可靠前缀的分片模板,
+    // 总是预留校验尾空间, 使重传时 CRC 模式变化也不超出 MTU
+    std::vector<std::vector<uint8_t>>
+    fragmentReliable(const std::vector<uint8_t> &completeFrame,
+                     uint8_t reliableId);
+
+    // 填入发送轮次和确认请求标志, 按需附带校验尾, 并计入打包统计
+    std::vector<uint8_t>
+    finishReliableFragment(const std::vector<uint8_t> &fragment, uint8_t round,
+                           bool ackRequest);
+
+    // 获取接收处理过程中产生的待发送帧 (可靠分片的 RELIABLE_ACK)
+    bool getNextOutgoingFrame(std::vector<uint8_t> &frame);
+
+    // 处理接收到的原始数据 (支持粘包处理), 以当前时间作为到达时间
     void processReceivedData(const std::vector<uint8_t> &data);
 
-    // 获取完整的已解析帧
+    // 同上, arrivalNs 为数据报的到达时间 (steady_clock 纳秒, 如内核时间戳),
+    // 由此提取出的帧的 Frame::arrivalNs 均取该值
+    void processReceivedData(const std::vector<uint8_t> &data,
+                             uint64_t arrivalNs);
+
+    // 获取完整的已解析帧; 优先消息的帧先于其它已排队的帧返回
     bool getNextCompleteFrame(Frame &frame);
 
+    // 标记优先消息 (如 Master2Backend CtrlResponse), 一次接收处理中提取出的
+    // 优先帧越过普通数据帧先交给上层
+    void setPriorityMessage(PacketId packetId, uint8_t messageId,
+                            bool enabled = true);
+
     // 清空接收缓冲区
     void clearReceiveBuffer();
 
-    // 解析单个帧
+    // 解析单个帧 (不处理校验尾)
     bool parseFrame(const std::vector<uint8_t> &data, Frame &frame);
 
     // 根据Packet ID和Message ID创建对应的消息对象
@@ -111,6 +176,12 @@ class ProtocolProcessor {
                                   uint32_t &slaveId, DeviceStatus &deviceStatus,
                                   std::unique_ptr<Message> &message);
 
+    // 同上, 同时取出扩展头; 旧格式的包 extension.present 为 false
+    bool parseSlave2BackendPacket(const std::vector<uint8_t> &payload,
+                                  uint32_t &slaveId, DeviceStatus &deviceStatus,
+                                  std::unique_ptr<Message> &message,
+                                  Slave2BackendExtension &extension);
+
     // 解析Backend2Master包
     bool parseBackend2MasterPacket(const std::vector<uint8_t> &payload,
                                    std::unique_ptr<Message> &message);
@@ -123,6 +194,13 @@ class ProtocolProcessor {
     size_t findFrameHeader(const std::vector<uint8_t> &buffer, size_t startPos);
 
   private:
+    // 按 MTU 分片, 按需附带校验尾, 并计入打包统计
+    std::vector<std::vector<uint8_t>>
+    finishFrames(std::vector<uint8_t> completeFrame);
+
+    // 单帧允许的最大长度 (不含校验尾)
+    size_t frameLimit() const;
+
     // 帧分片
     std::vector<std::vector<uint8_t>>
     fragmentFrame(const std::vector<uint8_t> &frameData);
@@ -131,6 +209,18 @@ class ProtocolProcessor {
     bool reassembleFragments(const Frame &frame,
                              std::vector<uint8_t> &completeFrame);
 
+    // 按载荷构造未分片的完整帧
+    std::vector<uint8_t> buildCompleteFrame(uint8_t packetId,
+                                            const std::vector<uint8_t> &payload);
+
+    // 可靠分片的接收, 按需回复 RELIABLE_ACK; 交付了完整帧时返回 true
+    bool handleReliableFragment(const Frame &frame, bool ackRequest);
+
+    // 按优先消息分入对应的完整帧队列
+    void pushCompleteFrame(Frame &&frame);
+    void queueReliableAck(uint8_t packetId, const ReliableInbound &inbound,
+                          uint8_t round);
+
     // 从接收缓冲区中提取完整帧
     bool extractCompleteFrames();
 
@@ -146,11 +236,26 @@ class ProtocolProcessor {
     // 清理超时的分片
     void cleanupExpiredFragments();
 
+    // 单调时钟 (毫秒), 用于分片超时判断
+    static uint64_t nowMs();
+    static uint64_t nowNs();
+
+    // 统计打包输出
+    void recordPacked(const std::vector<std::vector<uint8_t>> &frames);
+
   private:
     size_t mtu_;                         // 最大传输单元大小，默认100字节
     std::vector<uint8_t> receiveBuffer_; // 接收缓冲区
     std::queue<Frame> completeFrames_;   // 完整帧队列
+    std::queue<Frame> priorityFrames_;   // 优先消息的完整帧队列
+    std::set<uint16_t> priorityMessages_; // (PacketId << 8) | MessageId
     std::map<uint64_t, FragmentInfo> fragmentMap_; // 分片重组映射
+    std::map<uint8_t, ReliableInbound> reliableInbound_; // 可靠分片接收状态
+    std::queue<std::vector<uint8_t>> outgoingFrames_;    // 待发送的确认帧
+    ProtocolStats stats_;                          // 管线计数器
+    uint64_t currentArrivalNs_;                    // 正在处理的数据报到达时间
+    CrcMode crcMode_;                              // 帧校验尾模式
+    bool peerCrc_;                                 // 已收到对端带校验尾的有效帧
 
     static constexpr uint32_t FRAGMENT_TIMEOUT_MS =
         5000;                                  // 分片超时时间（毫秒）
@@ -0,0 +1,111 @@
+#include "ProtocolStats.h"
+
+#include "Common.h"
+
+namespace WhtsProtocol {
+
+uint64_t ProtocolStatsSnapshot::totalFramesDecoded() const {
+    uint64_t total = 0;
+    for (size_t i = 0; i < STAT_PACKET_TYPE_COUNT; ++i)
+        total += framesByPacket[i];
+    return total;
+}
+
+ProtocolStatsSnapshot
+ProtocolStatsSnapshot::delta(const ProtocolStatsSnapshot &base) const {
+    ProtocolStatsSnapshot result{};
+    for (size_t i = 0; i < STAT_COUNTER_COUNT; ++i)
+        result.counters[i] = counters[i] - base.counters[i];
+    for (size_t i = 0; i < STAT_PACKET_TYPE_COUNT; ++i)
+        result.framesByPacket[i] = framesByPacket[i] - base.framesByPacket[i];
+    return result;
+}
+
+ProtocolStats::ProtocolStats() { reset(); }
+
+void ProtocolStats::recordFrame(uint8_t packetId) {
+    size_t index = packetId < STAT_PACKET_TYPE_COUNT - 1
+                       ? packetId
+                       : STAT_PACKET_TYPE_COUNT - 1;
+    framesByPacket_[index].fetch_add(1, std::memory_order_relaxed);
+}
+
+ProtocolStatsSnapshot ProtocolStats::snapshot() const {
+    ProtocolStatsSnapshot result{};
+    for (size_t i = 0; i < STAT_COUNTER_COUNT; ++i)
+        result.counters[i] = counters_[i].load(std::memory_order_relaxed);
+    for (size_t i = 0; i < STAT_PACKET_TYPE_COUNT; ++i)
+        result.framesByPacket[i] =
+            framesByPacket_[i].load(std::memory_order_relaxed);
+    return result;
+}
+
+void ProtocolStats::reset() {
+    for (auto &counter : counters_)
+        counter.store(0, std::memory_order_relaxed);
+    for (auto &counter : framesByPacket_)
+        counter.store(0, std::memory_order_relaxed);
+}
+
+const char *ProtocolStats::counterName(StatCounter counter) {
+    switch (counter) {
+        case StatCounter::BYTES_IN:
+            return "Bytes In";
+        case StatCounter::BYTES_OUT:
+            return "Bytes Out";
+        case StatCounter::FRAMES_OUT:
+            return "Frames Out";
+        case StatCounter::RESYNC_SKIPPED_BYTES:
+            return "Resync Skipped Bytes";
+        case StatCounter::BUFFER_OVERFLOWS:
+            return "Buffer Overflows";
+        case StatCounter::OVERFLOW_DROPPED_BYTES:
+            return "Overflow Dropped Bytes";
+        case StatCounter::FRAGMENTS_RECEIVED:
+            return "Fragments Received";
+        case StatCounter::FRAGMENTS_REASSEMBLED:
+            return "Fragments Reassembled";
+        case StatCounter::ORPHANED_FRAGMENTS:
+            return "Orphaned Fragments";
+        case StatCounter::EXPIRED_FRAGMENTS:
+            return "Expired Fragments";
+        case StatCounter::FRAME_DECODE_ERRORS:
+            return "Frame Decode Errors";
+        case StatCounter::MESSAGE_DECODE_ERRORS:
+            return "Message Decode Errors";
+        case StatCounter::UNKNOWN_MESSAGE_IDS:
+            return "Unknown Message IDs";
+        case StatCounter::SOCKET_DROPS:
+            return "Socket Drops";
+        case StatCounter::CRC_ERRORS:
+            return "CRC Errors";
+        case StatCounter::PRIORITY_FRAMES:
+            return "Priority Frames";
+        default:
+            break;
+    }
+    return "Unknown";
+}
+
+const char *ProtocolStats::packetTypeName(size_t index) {
+    if (index >= STAT_PACKET_TYPE_COUNT - 1)
+        return "Unknown";
+
+    switch (static_cast<PacketId>(index)) {
+        case PacketId::MASTER_TO_SLAVE:
+            return "Master2Slave";
+        case PacketId::SLAVE_TO_MASTER:
+            return "Slave2Master";
+        case PacketId::BACKEND_TO_MASTER:
+            return "Backend2Master";
+        case PacketId::MASTER_TO_BACKEND:
+            return "Master2Backend";
+        case PacketId::SLAVE_TO_BACKEND:
+            return "Slave2Backend";
+        case PacketId::RELIABLE_ACK:
+            return "Reliable ACK";
+    }
+    return "Unknown";
+}
+
+} // namespace WhtsProtocol
@@ -0,0 +1,78 @@
+#ifndef WHTS_PROTOCOL_STATS_H
+#define WHTS_PROTOCOL_STATS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace WhtsProtocol {
+
+// 协议管线计数器
+enum class StatCounter : uint8_t {
+    BYTES_IN = 0,           // 收到的原始字节数
+    BYTES_OUT,              // 打包输出的字节数
+    FRAMES_OUT,             // 打包输出的帧数 (含分片)
+    RESYNC_SKIPPED_BYTES,   // 重新同步帧头时跳过的字节数
+    BUFFER_OVERFLOWS,       // 接收缓冲区溢出次数
+    OVERFLOW_DROPPED_BYTES, // 缓冲区溢出时丢弃的字节数
+    FRAGMENTS_RECEIVED,     // 收到的分片数
+    FRAGMENTS_REASSEMBLED,  // 重组成功的完整帧数
+    ORPHANED_FRAGMENTS,     // 孤立分片 (缺少首片/被新首片覆盖/重复)
+    EXPIRED_FRAGMENTS,      // 超时丢弃的分片数
+    FRAME_DECODE_ERRORS,    // 帧解析失败
+    MESSAGE_DECODE_ERRORS,  // 消息体解析失败
+    UNKNOWN_MESSAGE_IDS,    // 未知的消息ID
+    SOCKET_DROPS,           // 内核 socket 接收队列溢出丢弃的数据报 (由接收端上报)
+    CRC_ERRORS,             // 帧校验尾不匹配, 或要求校验时缺少校验尾
+    PRIORITY_FRAMES,        // 越过普通帧优先交付的帧数 (见 setPriorityMessage)
+    COUNT
+};
+
+constexpr size_t STAT_COUNTER_COUNT = static_cast<size_t>(StatCounter::COUNT);
+
+// 按 PacketId 统计的帧数, 最后一项为未知 PacketId
+constexpr size_t STAT_PACKET_TYPE_COUNT = 7;
+
+// 计数器快照 (普通数据, 可自由拷贝)
+struct ProtocolStatsSnapshot {
+    uint64_t counters[STAT_COUNTER_COUNT];
+    uint64_t framesByPacket[STAT_PACKET_TYPE_COUNT];
+
+    uint64_t get(StatCounter counter) const {
+        return counters[static_cast<size_t>(counter)];
+    }
+    uint64_t totalFramesDecoded() const;
+
+    // 计算相对于基准快照的增量
+    ProtocolStatsSnapshot delta(const ProtocolStatsSnapshot &base) const;
+};
+
+// 无锁计数器块
+// 写入端 (协议处理线程) 使用 relaxed 原子累加, 读取端随时可取快照,
+// 计数器之间不保证一致性, 仅用于监控与统计。
+class ProtocolStats {
+  public:
+    ProtocolStats();
+
+    void add(StatCounter counter, uint64_t value = 1) {
+        counters_[static_cast<size_t>(counter)].fetch_add(
+            value, std::memory_order_relaxed);
+    }
+
+    // 记录一个解码完成的帧
+    void recordFrame(uint8_t packetId);
+
+    ProtocolStatsSnapshot snapshot() const;
+    void reset();
+
+    static const char *counterName(StatCounter counter);
+    static const char *packetTypeName(size_t index);
+
+  private:
+    alignas(64) std::atomic<uint64_t> counters_[STAT_COUNTER_COUNT];
+    alignas(64) std::atomic<uint64_t> framesByPacket_[STAT_PACKET_TYPE_COUNT];
+};
+
+} // namespace WhtsProtocol
+
+#endif // WHTS_PROTOCOL_STATS_H
@@ -0,0 +1,270 @@
+#include "ReliableTransport.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "ProtocolProcessor.h"
+
+namespace WhtsProtocol {
+
+namespace {
+// 原 PacketId + reliableId + 轮次 + 分片总数
+constexpr size_t ACK_HEADER_SIZE = 4;
+// RFC 6298: RTO = SRTT + max(G, 4 * RTTVAR), 时钟粒度 G 取 1 ms
+constexpr double CLOCK_GRANULARITY_MS = 1.0;
+constexpr uint8_t MAX_ROUND = 255;
+} // namespace
+
+// ReliableAck 实现
+bool ReliableAck::received(size_t index) const {
+    return index / 8 < bitmap.size() && (bitmap[index / 8] >> (index % 8)) & 1;
+}
+
+bool ReliableAck::complete() const {
+    if (totalFragments == 0)
+        return false;
+    for (size_t i = 0; i < totalFragments; ++i) {
+        if (!received(i))
+            return false;
+    }
+    return true;
+}
+
+std::vector<uint8_t> ReliableAck::serialize() const {
+    std::vector<uint8_t> result;
+    result.reserve(ACK_HEADER_SIZE + bitmap.size());
+    result.push_back(packetId);
+    result.push_back(reliableId);
+    result.push_back(round);
+    result.push_back(totalFragments);
+    result.insert(result.end(), bitmap.begin(), bitmap.end());
+    return result;
+}
+
+bool ReliableAck::deserialize(const std::vector<uint8_t> &payload,
+                              ReliableAck &ack) {
+    if (payload.size() < ACK_HEADER_SIZE)
+        return false;
+    size_t bitmapSize = (payload[3] + 7) / 8;
+    if (payload.size() < ACK_HEADER_SIZE + bitmapSize)
+        return false;
+    ack.packetId = payload[0];
+    ack.reliableId = payload[1];
+    ack.round = payload[2];
+    ack.totalFragments = payload[3];
+    ack.bitmap.assign(payload.begin() + ACK_HEADER_SIZE,
+                      payload.begin() + ACK_HEADER_SIZE + bitmapSize);
+    return true;
+}
+
+// ReliableSender 实现
+ReliableSender::ReliableSender(ProtocolProcessor &processor,
+                               Transmit transmit)
+    : processor_(processor), transmit_(std::move(transmit)),
+      rtoMs_(config_.initialRtoMs) {}
+
+void ReliableSender::setConfig(const Config &config) {
+    config_ = config;
+    if (srttMs_ == 0)
+        rtoMs_ = config_.initialRtoMs;
+}
+
+void ReliableSender::setCompletion(Completion completion) {
+    completion_ = std::move(completion);
+}
+
+uint8_t ReliableSender::send(const std::vector<uint8_t> &completeFrame,
+                             uint64_t nowMs) {
+    Outgoing outgoing;
+    outgoing.reliableId = nextReliableId_++;
+    outgoing.fragments =
+        processor_.fragmentReliable(completeFrame, outgoing.reliableId);
+    outgoing.packetId = completeFrame.size() > 2 ? completeFrame[2] : 0;
+    outgoing.acknowledged.assign(outgoing.fragments.size(), false);
+    ++stats_.messages;
+
+    // 帧头不完整或超过 255 个分片
+    if (outgoing.fragments.empty()) {
+        ++stats_.failed;
+        if (completion_) {
+            Result result;
+            result.packetId = outgoing.packetId;
+            result.reliableId = outgoing.reliableId;
+            completion_(result);
+        }
+        return outgoing.reliableId;
+    }
+
+    auto &queue = channels_[outgoing.packetId];
+    queue.push_back(std::move(outgoing));
+    if (queue.size() == 1)
+        start(queue.front(), nowMs);
+    return queue.back().reliableId;
+}
+
+void ReliableSender::start(Outgoing &outgoing, uint64_t nowMs) {
+    outgoing.startMs = nowMs;
+    std::vector<size_t> indices(outgoing.fragments.size());
+    for (size_t i = 0; i < indices.size(); ++i)
+        indices[i] = i;
+    transmitRound(outgoing, indices, nowMs);
+}
+
+void ReliableSender::transmitRound(Outgoing &outgoing,
+                                   const std::vector<size_t> &indices,
+                                   uint64_t nowMs) {
+    size_t sent = 0;
+    outgoing.blocked = false;
+    for (size_t i = 0; i < indices.size(); ++i) {
+        bool last = i + 1 == indices.size();
+        if (!transmit_(processor_.finishReliableFragment(
+                outgoing.fragments[indices[i]], outgoing.round, last))) {
+            // 后续分片大概率同样发不出, 且确认请求在末片上, 整轮稍后重发
+            outgoing.blocked = true;
+            ++stats_.transmitFailures;
+            break;
+        }
+        ++sent;
+    }
+    stats_.fragmentsSent += sent;
+    if (outgoing.round > 0) {
+        stats_.fragmentsRetransmitted += sent;
+        outgoing.retransmitted += sent;
+    }
+    outgoing.roundSentMs.resize(outgoing.round + 1);
+    outgoing.roundSentMs[outgoing.round] = nowMs;
+    outgoing.deadlineMs =
+        nowMs + (outgoing.blocked ? config_.minRtoMs : rtoMs_);
+}
+
+void ReliableSender::onAck(const ReliableAck &ack, uint64_t nowMs) {
+    auto it = channels_.find(ack.packetId);
+    if (it == channels_.end() || it->second.empty())
+        return;
+    Outgoing &outgoing = it->second.front();
+    if (ack.reliableId != outgoing.reliableId ||
+        ack.totalFragments != outgoing.fragments.size() ||
+        ack.round > outgoing.round)
+        return;
+
+    // 每轮有独立的发送时间, 重传不会造成 RTT 歧义
+    sampleRtt(nowMs - outgoing.roundSentMs[ack.round]);
+
+    for (size_t i = 0; i < outgoing.fragments.size(); ++i) {
+        if (!outgoing.acknowledged[i] && ack.received(i)) {
+            outgoing.acknowledged[i] = true;
+            ++outgoing.acknowledgedCount;
+        }
+    }
+    if (outgoing.acknowledgedCount == outgoing.fragments.size()) {
+        finish(ack.packetId, true, nowMs);
+        return;
+    }
+
+    // 更早轮次的确认可能还没看到本轮的分片, 等待本轮的确认
+    if (ack.round != outgoing.round)
+        return;
+    if (outgoing.round == MAX_ROUND) {
+        finish(ack.packetId, false, nowMs);
+        return;
+    }
+    std::vector<size_t> missing;
+    for (size_t i = 0; i < outgoing.fragments.size(); ++i) {
+        if (!outgoing.acknowledged[i])
+            missing.push_back(i);
+    }
+    outgoing.timeouts = 0;
+    ++outgoing.round;
+    transmitRound(outgoing, missing, nowMs);
+}
+
+void ReliableSender::poll(uint64_t nowMs) {
+    std::vector<uint8_t> failed;
+    for (auto &channel : channels_) {
+        if (channel.second.empty())
+            continue;
+        Outgoing &outgoing = channel.second.front();
+        if (nowMs < outgoing.deadlineMs)
+            continue;
+
+        if (!outgoing.blocked)
+            ++stats_.timeouts;
+        if (++outgoing.timeouts > config_.maxTimeouts ||
+            outgoing.round == MAX_ROUND) {
+            failed.push_back(channel.first);
+            continue;
+        }
+        std::vector<size_t> indices;
+        if (outgoing.blocked) {
+            // 上一轮没有完整发出, 不是网络丢包: 重发全部未确认分片, RTO 不变
+            for (size_t i = 0; i < outgoing.fragments.size(); ++i) {
+                if (!outgoing.acknowledged[i])
+                    indices.push_back(i);
+            }
+        } else {
+            rtoMs_ = std::min(rtoMs_ * 2, config_.maxRtoMs);
+            // 数据和确认都可能丢失, 只重发最后一个未确认分片, 由其确认得到缺失列表
+            size_t probe = outgoing.fragments.size() - 1;
+            while (outgoing.acknowledged[probe])
+                --probe;
+            indices.push_back(probe);
+        }
+        ++outgoing.round;
+        transmitRound(outgoing, indices, nowMs);
+    }
+    for (uint8_t packetId : failed)
+        finish(packetId, false, nowMs);
+}
+
+void ReliableSender::finish(uint8_t packetId, bool delivered,
+                            uint64_t nowMs) {
+    auto &queue = channels_[packetId];
+    Outgoing &outgoing = queue.front();
+
+    Result result;
+    result.packetId = outgoing.packetId;
+    result.reliableId = outgoing.reliableId;
+    result.delivered = delivered;
+    result.fragments = outgoing.fragments.size();
+    result.retransmittedFragments = outgoing.retransmitted;
+    result.rounds = static_cast<uint32_t>(outgoing.round) + 1;
+    result.elapsedMs = nowMs - outgoing.startMs;
+    if (delivered)
+        ++stats_.delivered;
+    else
+        ++stats_.failed;
+
+    queue.pop_front();
+    if (!queue.empty())
+        start(queue.front(), nowMs);
+    if (completion_)
+        completion_(result);
+}
+
+void ReliableSender::sampleRtt(uint64_t rttMs) {
+    double sample = static_cast<double>(rttMs);
+    if (stats_.rttSamples == 0) {
+        srttMs_ = sample;
+        rttVarMs_ = sample / 2;
+    } else {
+        rttVarMs_ = 0.75 * rttVarMs_ + 0.25 * std::fabs(srttMs_ - sample);
+        srttMs_ = 0.875 * srttMs_ + 0.125 * sample;
+    }
+    ++stats_.rttSamples;
+    double rto = srttMs_ + std::max(CLOCK_GRANULARITY_MS, 4 * rttVarMs_);
+    rtoMs_ = static_cast<uint32_t>(std::clamp(
+        std::ceil(rto), static_cast<double>(config_.minRtoMs),
+        static_cast<double>(config_.maxRtoMs)));
+}
+
+void ReliableSender::clear() { channels_.clear(); }
+
+bool ReliableSender::busy() const {
+    for (const auto &channel : channels_) {
+        if (!channel.second.empty())
+            return true;
+    }
+    return false;
+}
+
+} // namespace WhtsProtocol
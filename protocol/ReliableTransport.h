@@ -0,0 +1,129 @@
+#ifndef WHTS_PROTOCOL_RELIABLE_TRANSPORT_H
+#define WHTS_PROTOCOL_RELIABLE_TRANSPORT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <vector>
+
+namespace WhtsProtocol {
+
+class ProtocolProcessor;
+
+// RELIABLE_ACK 载荷: 原 PacketId(1) + reliableId(1) + 轮次(1) + 分片总数(1)
+//                 + 接收位图(ceil(分片总数/8), bit i 对应分片序号 i)
+// 轮次取触发该确认的分片中的轮次, 发送端据此计算 RTT 并忽略过期的确认
+struct ReliableAck {
+    uint8_t packetId = 0;
+    uint8_t reliableId = 0;
+    uint8_t round = 0;
+    uint8_t totalFragments = 0;
+    std::vector<uint8_t> bitmap;
+
+    bool received(size_t index) const;
+    bool complete() const;
+
+    std::vector<uint8_t> serialize() const;
+    static bool deserialize(const std::vector<uint8_t> &payload,
+                            ReliableAck &ack);
+};
+
+// 可靠分片发送端: 每条消息分配 reliableId, 每轮发送的最后一个分片请求确认,
+// 收到选择确认后只重传缺失的分片; 超时后只重发一个未确认分片作为探测。
+// RTO 按 RFC 6298 由每轮的往返时间估计, 超时指数退避。
+// 同一 PacketId 同时只有一条消息在途, 其余排队。
+class ReliableSender {
+  public:
+    // 返回 false 表示本地未能发出 (如发送队列满), 不计为网络丢包:
+    // 本轮停止发送, 经 minRtoMs 后重发未确认分片, 不退避 RTO
+    using Transmit = std::function<bool(const std::vector<uint8_t> &frame)>;
+
+    struct Config {
+        uint32_t initialRtoMs = 200;
+        uint32_t minRtoMs = 20;
+        uint32_t maxRtoMs = 3000;
+        uint32_t maxTimeouts = 6; // 连续超时 (含本地发送失败) 次数上限, 超过后放弃
+    };
+
+    struct Result {
+        uint8_t packetId = 0;
+        uint8_t reliableId = 0;
+        bool delivered = false;
+        size_t fragments = 0;
+        size_t retransmittedFragments = 0;
+        uint32_t rounds = 0;
+        uint64_t elapsedMs = 0;
+    };
+    using Completion = std::function<void(const Result &result)>;
+
+    struct Stats {
+        uint64_t messages = 0;
+        uint64_t delivered = 0;
+        uint64_t failed = 0;
+        uint64_t fragmentsSent = 0;
+        uint64_t fragmentsRetransmitted = 0;
+        uint64_t timeouts = 0;
+        uint64_t transmitFailures = 0;
+        uint64_t rttSamples = 0;
+    };
+
+    ReliableSender(ProtocolProcessor &processor, Transmit transmit);
+
+    void setConfig(const Config &config);
+    void setCompletion(Completion completion);
+
+    // completeFrame 为 packXxxMessageSingle 的输出, 返回分配的 reliableId
+    uint8_t send(const std::vector<uint8_t> &completeFrame, uint64_t nowMs);
+    void onAck(const ReliableAck &ack, uint64_t nowMs);
+    // 处理超时重传, 有消息在途时由调用方周期调用
+    void poll(uint64_t nowMs);
+    // 放弃全部在途和排队的消息 (不回调)
+    void clear();
+
+    bool busy() const;
+    uint32_t rtoMs() const { return rtoMs_; }
+    // 尚无样本时为 0
+    double srttMs() const { return srttMs_; }
+    const Stats &stats() const { return stats_; }
+
+  private:
+    struct Outgoing {
+        uint8_t packetId = 0;
+        uint8_t reliableId = 0;
+        std::vector<std::vector<uint8_t>> fragments;
+        std::vector<bool> acknowledged;
+        size_t acknowledgedCount = 0;
+        uint8_t round = 0;
+        std::vector<uint64_t> roundSentMs;
+        uint64_t startMs = 0;
+        uint64_t deadlineMs = 0;
+        uint32_t timeouts = 0;
+        size_t retransmitted = 0;
+        bool blocked = false; // 本轮有分片未能发出, 到期后重发而非探测
+    };
+
+    void start(Outgoing &outgoing, uint64_t nowMs);
+    void transmitRound(Outgoing &outgoing, const std::vector<size_t> &indices,
+                       uint64_t nowMs);
+    void finish(uint8_t packetId, bool delivered, uint64_t nowMs);
+    void sampleRtt(uint64_t rttMs);
+
+    ProtocolProcessor &processor_;
+    Transmit transmit_;
+    Completion completion_;
+    Config config_;
+    Stats stats_;
+    uint8_t nextReliableId_ = 0;
+    // 按 PacketId 排队, 队首为在途消息
+    std::map<uint8_t, std::deque<Outgoing>> channels_;
+
+    uint32_t rtoMs_;
+    double srttMs_ = 0;
+    double rttVarMs_ = 0;
+};
+
+} // namespace WhtsProtocol
+
+#endif // WHTS_PROTOCOL_RELIABLE_TRANSPORT_H
@@ -0,0 +1,187 @@
+#include "ResistanceAccumulator.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) ||                                   \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define WHTS_RESISTANCE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace WhtsProtocol {
+
+ResistanceAccumulator::ResistanceAccumulator()
+    : ResistanceAccumulator(Config()) {}
+
+ResistanceAccumulator::ResistanceAccumulator(const Config &config)
+    : config_(config) {}
+
+void ResistanceAccumulator::setConfig(const Config &config) {
+    bool rescaled = config.ohmsPerLsb != config_.ohmsPerLsb;
+    config_ = config;
+    if (rescaled)
+        clearStats();
+}
+
+void ResistanceAccumulator::setChannelCount(uint32_t slaveId,
+                                            uint32_t channels) {
+    SlaveState &state = slave(slaveId);
+    state.summary.configured = true;
+    if (channels != state.summary.channels) {
+        resize(state, channels);
+        state.summary.invalidFrames = 0;
+    }
+}
+
+ResistanceAccumulator::SlaveState &
+ResistanceAccumulator::slave(uint32_t slaveId) {
+    auto it = slaves_.find(slaveId);
+    if (it != slaves_.end())
+        return it->second;
+    SlaveState &state = slaves_[slaveId];
+    state.summary.slaveId = slaveId;
+    return state;
+}
+
+void ResistanceAccumulator::resize(SlaveState &state, uint32_t channels) {
+    state.summary.channels = channels;
+    state.summary.samples = 0;
+    state.summary.failingChannels = 0;
+    state.last.assign(channels, 0);
+    state.min.assign(channels, std::numeric_limits<double>::infinity());
+    state.max.assign(channels, -std::numeric_limits<double>::infinity());
+    state.mean.assign(channels, 0);
+    state.m2.assign(channels, 0);
+    state.outOfLimit.assign(channels, 0);
+}
+
+uint32_t ResistanceAccumulator::onResistance(uint32_t slaveId,
+                                             const uint8_t *data,
+                                             size_t length) {
+    SlaveState &state = slave(slaveId);
+    if (!state.summary.configured) {
+        // 未收到从机配置时按数据长度推断通道数
+        uint32_t inferred = static_cast<uint32_t>(length / BYTES_PER_CHANNEL);
+        if (inferred != state.summary.channels)
+            resize(state, inferred);
+    }
+    const size_t channels = state.summary.channels;
+    if (channels == 0 || length < channels * BYTES_PER_CHANNEL) {
+        ++state.summary.invalidFrames;
+        return 0;
+    }
+
+    values_.resize(channels);
+    double *values = values_.data();
+    const double scale = config_.ohmsPerLsb;
+    for (size_t c = 0; c < channels; ++c) {
+        uint32_t raw = static_cast<uint32_t>(data[2 * c]) |
+                       (static_cast<uint32_t>(data[2 * c + 1]) << 8);
+        values[c] = raw * scale;
+    }
+
+    // 所有通道同时更新, 共用一个样本数
+    const double inverseCount = 1.0 / static_cast<double>(++state.summary.samples);
+    const double lower = config_.lowerLimitOhms;
+    const double upper = config_.upperLimitOhms;
+    double *last = state.last.data();
+    double *min = state.min.data();
+    double *max = state.max.data();
+    double *mean = state.mean.data();
+    double *m2 = state.m2.data();
+    uint64_t *outOfLimit = state.outOfLimit.data();
+    uint32_t failing = 0;
+    size_t c = 0;
+#if defined(WHTS_RESISTANCE_SSE2)
+    // 每次处理两个通道, 与下面的标量循环逐项对应
+    const __m128d inverseCount2 = _mm_set1_pd(inverseCount);
+    const __m128d lower2 = _mm_set1_pd(lower);
+    const __m128d upper2 = _mm_set1_pd(upper);
+    for (; c + 2 <= channels; c += 2) {
+        __m128d x = _mm_loadu_pd(values + c);
+        __m128d oldMean = _mm_loadu_pd(mean + c);
+        __m128d delta = _mm_sub_pd(x, oldMean);
+        __m128d newMean = _mm_add_pd(oldMean, _mm_mul_pd(delta, inverseCount2));
+        _mm_storeu_pd(mean + c, newMean);
+        _mm_storeu_pd(m2 + c, _mm_add_pd(_mm_loadu_pd(m2 + c),
+                                         _mm_mul_pd(delta, _mm_sub_pd(x, newMean))));
+        _mm_storeu_pd(min + c, _mm_min_pd(x, _mm_loadu_pd(min + c)));
+        _mm_storeu_pd(max + c, _mm_max_pd(x, _mm_loadu_pd(max + c)));
+        _mm_storeu_pd(last + c, x);
+        int out = _mm_movemask_pd(
+            _mm_or_pd(_mm_cmplt_pd(x, lower2), _mm_cmpgt_pd(x, upper2)));
+        outOfLimit[c] += static_cast<uint32_t>(out & 1);
+        outOfLimit[c + 1] += static_cast<uint32_t>((out >> 1) & 1);
+        failing += static_cast<uint32_t>((out & 1) + ((out >> 1) & 1));
+    }
+#endif
+    for (; c < channels; ++c) {
+        double x = values[c];
+        double delta = x - mean[c];
+        mean[c] += delta * inverseCount;
+        m2[c] += delta * (x - mean[c]);
+        min[c] = x < min[c] ? x : min[c];
+        max[c] = x > max[c] ? x : max[c];
+        last[c] = x;
+        uint32_t out = static_cast<uint32_t>(x < lower) |
+                       static_cast<uint32_t>(x > upper);
+        outOfLimit[c] += out;
+        failing += out;
+    }
+    state.summary.failingChannels = failing;
+    return failing;
+}
+
+std::vector<ResistanceSlaveSummary> ResistanceAccumulator::slaves() const {
+    std::vector<ResistanceSlaveSummary> result;
+    result.reserve(slaves_.size());
+    for (const auto &entry : slaves_)
+        result.push_back(entry.second.summary);
+    std::sort(result.begin(), result.end(),
+              [](const ResistanceSlaveSummary &a,
+                 const ResistanceSlaveSummary &b) {
+                  return a.slaveId < b.slaveId;
+              });
+    return result;
+}
+
+std::vector<ResistanceChannelStats>
+ResistanceAccumulator::channels(uint32_t slaveId) const {
+    std::vector<ResistanceChannelStats> result;
+    auto it = slaves_.find(slaveId);
+    if (it == slaves_.end())
+        return result;
+
+    const SlaveState &state = it->second;
+    const uint64_t count = state.summary.samples;
+    result.resize(state.summary.channels);
+    for (uint32_t c = 0; c < state.summary.channels; ++c) {
+        ResistanceChannelStats &stats = result[c];
+        stats.slaveId = slaveId;
+        stats.channel = c;
+        stats.count = count;
+        stats.outOfLimit = state.outOfLimit[c];
+        if (count == 0)
+            continue;
+        stats.last = state.last[c];
+        stats.min = state.min[c];
+        stats.max = state.max[c];
+        stats.mean = state.mean[c];
+        stats.stddev =
+            count > 1 ? std::sqrt(state.m2[c] / static_cast<double>(count - 1))
+                      : 0;
+        stats.lastInLimit = stats.last >= config_.lowerLimitOhms &&
+                            stats.last <= config_.upperLimitOhms;
+    }
+    return result;
+}
+
+void ResistanceAccumulator::clearStats() {
+    for (auto &entry : slaves_) {
+        resize(entry.second, entry.second.summary.channels);
+        entry.second.summary.invalidFrames = 0;
+    }
+}
+
+} // namespace WhtsProtocol
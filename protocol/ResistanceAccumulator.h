@@ -0,0 +1,91 @@
+#ifndef WHTS_PROTOCOL_RESISTANCE_ACCUMULATOR_H
+#define WHTS_PROTOCOL_RESISTANCE_ACCUMULATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+namespace WhtsProtocol {
+
+// 单个阻值通道的统计 (单位: 欧姆)
+struct ResistanceChannelStats {
+    uint32_t slaveId = 0;
+    uint32_t channel = 0;
+    uint64_t count = 0;
+    double last = 0;
+    double min = 0;
+    double max = 0;
+    double mean = 0;
+    double stddev = 0;      // 样本标准差 (count < 2 时为 0)
+    uint64_t outOfLimit = 0; // 超出上下限的采样数
+    bool lastInLimit = true;
+};
+
+// 单个从机的汇总
+struct ResistanceSlaveSummary {
+    uint32_t slaveId = 0;
+    uint32_t channels = 0;
+    bool configured = false;   // 通道数来自从机配置 (否则由数据长度推断)
+    uint64_t samples = 0;
+    uint64_t invalidFrames = 0; // 数据长度小于通道数 * 2
+    uint32_t failingChannels = 0; // 最新采样超限的通道数
+};
+
+// 阻值数据统计: resistanceData 为每通道 uint16 LE 定点数, 阻值 = 原始值 * ohmsPerLsb。
+// 按从机以 SoA 数组保存每通道的 min/max/均值/M2 (Welford 在线算法) 和超限计数,
+// 每个采样在所有通道上做同一组无分支运算 (SSE2 每次两个通道)。
+class ResistanceAccumulator {
+  public:
+    static constexpr size_t BYTES_PER_CHANNEL = 2;
+
+    struct Config {
+        double ohmsPerLsb = 0.1;
+        double lowerLimitOhms = 0;
+        double upperLimitOhms = std::numeric_limits<double>::infinity();
+    };
+
+    ResistanceAccumulator();
+    explicit ResistanceAccumulator(const Config &config);
+
+    // 修改换算系数时清空统计; 只修改上下限时保留统计, 超限计数从此刻按新限值累计
+    void setConfig(const Config &config);
+    const Config &config() const { return config_; }
+
+    // 从机配置中的 resistanceNum; 通道数变化时清空该从机统计
+    void setChannelCount(uint32_t slaveId, uint32_t channels);
+
+    // 返回本采样超限的通道数; 数据长度不足时计为无效帧并返回 0
+    uint32_t onResistance(uint32_t slaveId, const uint8_t *data, size_t length);
+
+    // 按从机ID排序
+    std::vector<ResistanceSlaveSummary> slaves() const;
+    std::vector<ResistanceChannelStats> channels(uint32_t slaveId) const;
+
+    // 清空统计, 保留已配置的通道数
+    void clearStats();
+
+  private:
+    // SoA: 每个数组的下标为通道号
+    struct SlaveState {
+        ResistanceSlaveSummary summary;
+        std::vector<double> last;
+        std::vector<double> min;
+        std::vector<double> max;
+        std::vector<double> mean;
+        std::vector<double> m2;
+        std::vector<uint64_t> outOfLimit;
+    };
+
+    SlaveState &slave(uint32_t slaveId);
+    static void resize(SlaveState &state, uint32_t channels);
+
+    Config config_;
+    std::unordered_map<uint32_t, SlaveState> slaves_;
+    std::vector<double> values_; // 当前采样换算后的阻值
+};
+
+} // namespace WhtsProtocol
+
+#endif // WHTS_PROTOCOL_RESISTANCE_ACCUMULATOR_H
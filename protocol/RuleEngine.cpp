@@ -0,0 +1,205 @@
+#include "RuleEngine.h"
+
+#include <algorithm>
+
+namespace WhtsProtocol {
+
+namespace {
+uint32_t popcount8(uint8_t value) {
+    uint32_t count = 0;
+    while (value) {
+        value &= static_cast<uint8_t>(value - 1);
+        ++count;
+    }
+    return count;
+}
+} // namespace
+
+void RuleEngine::setRules(std::vector<Rule> rules) {
+    rules_ = std::move(rules);
+    statusRules_.clear();
+    conductionRules_.clear();
+    for (size_t i = 0; i < rules_.size(); ++i) {
+        rules_[i].statusValue &= rules_[i].statusMask;
+        if (rules_[i].statusMask != 0)
+            statusRules_.push_back(i);
+        if (rules_[i].mismatchAbove >= 0)
+            conductionRules_.push_back(i);
+    }
+    raisedCount_.assign(rules_.size(), 0);
+    reset();
+}
+
+void RuleEngine::reset() {
+    slaves_.clear();
+    pending_.clear();
+}
+
+RuleEngine::SlaveState &RuleEngine::slave(uint32_t slaveId) {
+    SlaveState &state = slaves_[slaveId];
+    if (state.slots.size() != rules_.size()) {
+        state.slots.assign(rules_.size(), Slot());
+        state.ruleMismatch.assign(rules_.size(), 0);
+    }
+    return state;
+}
+
+void RuleEngine::onStatus(uint32_t slaveId, uint16_t status,
+                          uint16_t changedMask, uint64_t nowMs) {
+    if (statusRules_.empty())
+        return;
+    ++stats_.statusUpdates;
+    SlaveState &state = slave(slaveId);
+    if (!state.statusKnown) {
+        state.statusKnown = true;
+        changedMask = 0xFFFF;
+    }
+    state.status = status;
+    for (size_t rule : statusRules_) {
+        if ((rules_[rule].statusMask & changedMask) && applies(rules_[rule], slaveId))
+            evaluate(rule, slaveId, state, nowMs);
+    }
+}
+
+void RuleEngine::onConduction(uint32_t slaveId, const uint8_t *data,
+                              size_t length, uint64_t nowMs) {
+    if (conductionRules_.empty())
+        return;
+    ++stats_.conductionUpdates;
+    SlaveState &state = slave(slaveId);
+    bool first = !state.conductionKnown;
+    if (first) {
+        state.conductionKnown = true;
+        state.baseline.assign(data, data + length);
+    }
+
+    uint32_t mismatch = countMismatch(data, length, state.baseline);
+    bool baselineChanged = first || mismatch != state.mismatch;
+    state.mismatch = mismatch;
+
+    for (size_t rule : conductionRules_) {
+        if (!applies(rules_[rule], slaveId))
+            continue;
+        bool changed = baselineChanged;
+        if (!rules_[rule].expected.empty()) {
+            uint32_t ruleMismatch =
+                countMismatch(data, length, rules_[rule].expected);
+            changed = first || ruleMismatch != state.ruleMismatch[rule];
+            state.ruleMismatch[rule] = ruleMismatch;
+        }
+        // 不一致位数不变时结论不变
+        if (changed)
+            evaluate(rule, slaveId, state, nowMs);
+    }
+}
+
+uint32_t RuleEngine::mismatchFor(size_t rule, const SlaveState &state) const {
+    return rules_[rule].expected.empty() ? state.mismatch
+                                         : state.ruleMismatch[rule];
+}
+
+void RuleEngine::evaluate(size_t rule, uint32_t slaveId, SlaveState &state,
+                          uint64_t nowMs) {
+    ++stats_.evaluations;
+    const Rule &definition = rules_[rule];
+    // 所有输入都已收到才判断
+    bool holds = true;
+    if (definition.statusMask != 0)
+        holds = state.statusKnown &&
+                (state.status & definition.statusMask) == definition.statusValue;
+    if (holds && definition.mismatchAbove >= 0)
+        holds = state.conductionKnown &&
+                static_cast<int64_t>(mismatchFor(rule, state)) >
+                    definition.mismatchAbove;
+
+    Slot &slot = state.slots[rule];
+    if (holds == slot.holding)
+        return;
+    slot.holding = holds;
+
+    if (holds) {
+        slot.sinceMs = nowMs;
+        if (definition.holdMs == 0)
+            raise(rule, slaveId, state, nowMs);
+        else
+            pending_.push_back({rule, slaveId});
+        return;
+    }
+
+    removePending(rule, slaveId);
+    if (slot.raised) {
+        slot.raised = false;
+        if (listener_)
+            listener_({rule, slaveId, false, slot.sinceMs, nowMs,
+                       mismatchFor(rule, state)});
+    }
+}
+
+void RuleEngine::raise(size_t rule, uint32_t slaveId, SlaveState &state,
+                       uint64_t nowMs) {
+    Slot &slot = state.slots[rule];
+    slot.raised = true;
+    ++raisedCount_[rule];
+    ++stats_.raised;
+    if (listener_)
+        listener_({rule, slaveId, true, slot.sinceMs, nowMs,
+                   mismatchFor(rule, state)});
+}
+
+void RuleEngine::poll(uint64_t nowMs) {
+    for (size_t i = 0; i < pending_.size();) {
+        PendingHold hold = pending_[i];
+        SlaveState &state = slaves_[hold.slaveId];
+        const Slot &slot = state.slots[hold.rule];
+        if (nowMs >= slot.sinceMs + rules_[hold.rule].holdMs) {
+            pending_[i] = pending_.back();
+            pending_.pop_back();
+            raise(hold.rule, hold.slaveId, state, nowMs);
+        } else {
+            ++i;
+        }
+    }
+}
+
+void RuleEngine::removePending(size_t rule, uint32_t slaveId) {
+    for (size_t i = 0; i < pending_.size(); ++i) {
+        if (pending_[i].rule == rule && pending_[i].slaveId == slaveId) {
+            pending_[i] = pending_.back();
+            pending_.pop_back();
+            return;
+        }
+    }
+}
+
+bool RuleEngine::active(size_t rule, uint32_t slaveId) const {
+    auto it = slaves_.find(slaveId);
+    return it != slaves_.end() && rule < it->second.slots.size() &&
+           it->second.slots[rule].raised;
+}
+
+size_t RuleEngine::activeCount() const {
+    size_t count = 0;
+    for (const auto &entry : slaves_) {
+        for (const Slot &slot : entry.second.slots)
+            count += slot.raised ? 1 : 0;
+    }
+    return count;
+}
+
+uint64_t RuleEngine::raisedCount(size_t rule) const {
+    return rule < raisedCount_.size() ? raisedCount_[rule] : 0;
+}
+
+uint32_t RuleEngine::countMismatch(const uint8_t *data, size_t length,
+                                   const std::vector<uint8_t> &expected) {
+    size_t common = std::min(length, expected.size());
+    uint32_t mismatch = 0;
+    for (size_t i = 0; i < common; ++i)
+        mismatch += popcount8(static_cast<uint8_t>(data[i] ^ expected[i]));
+    // 长度不一致的部分按全部位不一致计
+    mismatch += static_cast<uint32_t>(
+        (std::max(length, expected.size()) - common) * 8);
+    return mismatch;
+}
+
+} // namespace WhtsProtocol
@@ -0,0 +1,118 @@
+#ifndef WHTS_PROTOCOL_RULE_ENGINE_H
+#define WHTS_PROTOCOL_RULE_ENGINE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace WhtsProtocol {
+
+// 告警规则引擎: 每条规则编译为 "状态字掩码比较 + 导通不一致位数阈值" 的合取,
+// 按从机独立判断。状态变化时只重新计算掩码与变化位相交的规则,
+// 导通数据只在不一致位数变化时计算相关规则; 持续时间条件由 poll() 检查待定列表。
+class RuleEngine {
+  public:
+    struct Rule {
+        std::string name;
+        int64_t slaveId = -1;      // -1 表示任意从机 (每个从机分别告警)
+        uint16_t statusMask = 0;   // (status & statusMask) == statusValue
+        uint16_t statusValue = 0;
+        int64_t mismatchAbove = -1; // 导通不一致位数 > 该值, -1 表示不检查
+        // 导通数据期望值; 为空时以规则加载后从机的第一帧作为基准
+        std::vector<uint8_t> expected;
+        uint32_t holdMs = 0;       // 条件持续超过该时长才告警
+        bool stop = false;         // 告警时停止采集
+    };
+
+    struct Alarm {
+        size_t rule;
+        uint32_t slaveId;
+        bool raised;        // false 表示条件解除
+        uint64_t sinceMs;   // 条件开始成立的时间
+        uint64_t nowMs;
+        uint32_t mismatch;  // 当时的导通不一致位数
+    };
+
+    struct Stats {
+        uint64_t statusUpdates = 0;
+        uint64_t conductionUpdates = 0;
+        uint64_t evaluations = 0; // 实际计算的 (规则, 从机) 次数
+        uint64_t raised = 0;
+    };
+
+    using Listener = std::function<void(const Alarm &alarm)>;
+
+    // 替换规则并清空所有从机状态
+    void setRules(std::vector<Rule> rules);
+    const std::vector<Rule> &rules() const { return rules_; }
+    void setListener(Listener listener) { listener_ = std::move(listener); }
+
+    // changedMask 为变化的状态位, 从机的第一帧按全部位变化处理
+    void onStatus(uint32_t slaveId, uint16_t status, uint16_t changedMask,
+                  uint64_t nowMs);
+    void onConduction(uint32_t slaveId, const uint8_t *data, size_t length,
+                      uint64_t nowMs);
+    // 检查持续时间条件
+    void poll(uint64_t nowMs);
+
+    bool usesConduction() const { return !conductionRules_.empty(); }
+    bool active(size_t rule, uint32_t slaveId) const;
+    size_t activeCount() const;
+    // 每条规则累计告警次数
+    uint64_t raisedCount(size_t rule) const;
+    const Stats &stats() const { return stats_; }
+
+    // 清空从机状态 (规则保留), 已告警的不再发出解除事件
+    void reset();
+
+  private:
+    struct Slot {
+        bool holding = false; // 条件成立
+        bool raised = false;
+        uint64_t sinceMs = 0;
+    };
+
+    struct SlaveState {
+        uint16_t status = 0;
+        bool statusKnown = false;
+        bool conductionKnown = false;
+        std::vector<uint8_t> baseline;  // 学习到的导通基准
+        uint32_t mismatch = 0;          // 相对基准的不一致位数
+        std::vector<uint32_t> ruleMismatch; // 按规则的期望值计算 (无期望值时不用)
+        std::vector<Slot> slots;        // 每条规则一个
+    };
+
+    struct PendingHold {
+        size_t rule;
+        uint32_t slaveId;
+    };
+
+    SlaveState &slave(uint32_t slaveId);
+    bool applies(const Rule &rule, uint32_t slaveId) const {
+        return rule.slaveId < 0 || static_cast<uint32_t>(rule.slaveId) == slaveId;
+    }
+    void evaluate(size_t rule, uint32_t slaveId, SlaveState &state,
+                  uint64_t nowMs);
+    void raise(size_t rule, uint32_t slaveId, SlaveState &state,
+               uint64_t nowMs);
+    void removePending(size_t rule, uint32_t slaveId);
+    uint32_t mismatchFor(size_t rule, const SlaveState &state) const;
+    static uint32_t countMismatch(const uint8_t *data, size_t length,
+                                  const std::vector<uint8_t> &expected);
+
+    std::vector<Rule> rules_;
+    std::vector<size_t> statusRules_;     // 有状态条件的规则
+    std::vector<size_t> conductionRules_; // 有导通条件的规则
+    std::vector<uint64_t> raisedCount_;
+    std::unordered_map<uint32_t, SlaveState> slaves_;
+    std::vector<PendingHold> pending_;
+    Listener listener_;
+    Stats stats_;
+};
+
+} // namespace WhtsProtocol
+
+#endif // WHTS_PROTOCOL_RULE_ENGINE_H
@@ -0,0 +1,183 @@
+#include "SampleHistory.h"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+namespace WhtsProtocol {
+
+const char *historyKindName(HistoryKind kind) {
+    switch (kind) {
+    case HistoryKind::STATUS:
+        return "Status";
+    case HistoryKind::CONDUCTION:
+        return "Conduction";
+    case HistoryKind::RESISTANCE:
+        return "Resistance";
+    default:
+        return "Unknown";
+    }
+}
+
+SampleHistory::SampleHistory() : SampleHistory(Config()) {}
+
+SampleHistory::SampleHistory(const Config &config) {
+    if (!configure(config)) {
+        // 没有可用的存储, 不记录任何从机
+        config_.maxSlaves = 0;
+    }
+}
+
+bool SampleHistory::configure(const Config &config) {
+    Config next = config;
+    next.depth = std::max<size_t>(1, next.depth);
+    const size_t entries = next.maxSlaves * next.depth;
+    const size_t maxBytes[HISTORY_KIND_COUNT] = {
+        0, next.conductionMaxBytes, next.resistanceMaxBytes};
+
+    // 先分配新存储, 失败时原存储不受影响。不初始化只省去清零的时间,
+    // 内存是否立即提交取决于系统 (Windows 下立即提交), 总量由调用方按预算限制
+    Arena arenas[HISTORY_KIND_COUNT];
+    for (size_t kind = 0; kind < HISTORY_KIND_COUNT; ++kind) {
+        Arena &arena = arenas[kind];
+        arena.maxBytes = maxBytes[kind];
+        arena.timestamps.reset(new (std::nothrow) uint64_t[entries]);
+        arena.statuses.reset(new (std::nothrow) uint16_t[entries]);
+        arena.lengths.reset(new (std::nothrow) uint16_t[entries]);
+        if (arena.maxBytes)
+            arena.data.reset(new (std::nothrow)
+                                 uint8_t[entries * arena.maxBytes]);
+        if (!arena.timestamps || !arena.statuses || !arena.lengths ||
+            (arena.maxBytes && !arena.data))
+            return false;
+    }
+
+    config_ = next;
+    for (size_t kind = 0; kind < HISTORY_KIND_COUNT; ++kind)
+        arenas_[kind] = std::move(arenas[kind]);
+    clear();
+    return true;
+}
+
+void SampleHistory::record(uint32_t slaveId, HistoryKind kind,
+                           uint64_t timestampMs, uint16_t status,
+                           const uint8_t *data, size_t length) {
+    bool created = false;
+    uint32_t slot = index_.add(slaveId, created, config_.maxSlaves);
+    if (slot == SlaveIndex::NONE) {
+        ++stats_.droppedSlaves;
+        return;
+    }
+    if (created)
+        slaves_.emplace_back();
+
+    Arena &arena = arenas_[static_cast<size_t>(kind)];
+    Ring &ring = slaves_[slot].rings[static_cast<size_t>(kind)];
+    size_t position;
+    if (ring.count < config_.depth) {
+        position = (ring.head + ring.count) % config_.depth;
+        ++ring.count;
+    } else {
+        position = ring.head;
+        ring.head = (ring.head + 1) % config_.depth;
+        ++stats_.overwritten;
+    }
+
+    size_t index = slot * config_.depth + position;
+    if (length > arena.maxBytes) {
+        length = arena.maxBytes;
+        ++stats_.truncated;
+    }
+    arena.timestamps[index] = timestampMs;
+    arena.statuses[index] = status;
+    arena.lengths[index] = static_cast<uint16_t>(length);
+    if (length)
+        std::memcpy(&arena.data[index * arena.maxBytes], data, length);
+    ++stats_.recorded;
+}
+
+const SampleHistory::Ring *SampleHistory::findRing(uint32_t slaveId,
+                                                   HistoryKind kind,
+                                                   uint32_t &slot) const {
+    slot = index_.find(slaveId);
+    if (slot == SlaveIndex::NONE)
+        return nullptr;
+    return &slaves_[slot].rings[static_cast<size_t>(kind)];
+}
+
+size_t SampleHistory::query(uint32_t slaveId, HistoryKind kind,
+                            uint64_t fromMs, uint64_t toMs,
+                            const Visitor &visitor,
+                            size_t maxSamples) const {
+    uint32_t slot = 0;
+    const Ring *ring = findRing(slaveId, kind, slot);
+    if (!ring || ring->count == 0 || fromMs > toMs)
+        return 0;
+
+    const Arena &arena = arenas_[static_cast<size_t>(kind)];
+    const size_t base = slot * config_.depth;
+    auto indexOf = [&](size_t logical) {
+        return base + (ring->head + logical) % config_.depth;
+    };
+    // 时间戳单调不减, 按逻辑顺序二分查找范围边界
+    auto lowerBound = [&](uint64_t timestampMs) {
+        size_t low = 0;
+        size_t high = ring->count;
+        while (low < high) {
+            size_t middle = (low + high) / 2;
+            if (arena.timestamps[indexOf(middle)] < timestampMs)
+                low = middle + 1;
+            else
+                high = middle;
+        }
+        return low;
+    };
+    size_t first = lowerBound(fromMs);
+    size_t last = toMs == UINT64_MAX ? ring->count : lowerBound(toMs + 1);
+    if (maxSamples && last - first > maxSamples)
+        first = last - maxSamples;
+
+    for (size_t logical = first; logical < last; ++logical) {
+        size_t index = indexOf(logical);
+        visitor(arena.timestamps[index], arena.statuses[index],
+                arena.maxBytes ? &arena.data[index * arena.maxBytes] : nullptr,
+                arena.lengths[index]);
+    }
+    return last - first;
+}
+
+size_t SampleHistory::count(uint32_t slaveId, HistoryKind kind) const {
+    uint32_t slot = 0;
+    const Ring *ring = findRing(slaveId, kind, slot);
+    return ring ? ring->count : 0;
+}
+
+std::vector<uint32_t> SampleHistory::slaves() const {
+    std::vector<uint32_t> result = index_.ids();
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+size_t SampleHistory::capacityBytes() const { return capacityBytes(config_); }
+
+size_t SampleHistory::capacityBytes(const Config &config) {
+    const size_t perEntry =
+        HISTORY_KIND_COUNT * (sizeof(uint64_t) + 2 * sizeof(uint16_t)) +
+        config.conductionMaxBytes + config.resistanceMaxBytes;
+    return config.maxSlaves * std::max<size_t>(1, config.depth) * perEntry;
+}
+
+size_t SampleHistory::maxDepth(const Config &config, size_t budgetBytes) {
+    Config unit = config;
+    unit.depth = 1;
+    const size_t perDepth = capacityBytes(unit);
+    return perDepth ? std::max<size_t>(1, budgetBytes / perDepth) : 1;
+}
+
+void SampleHistory::clear() {
+    index_.clear();
+    slaves_.clear();
+    stats_ = Stats();
+}
+
+} // namespace WhtsProtocol
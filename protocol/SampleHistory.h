@@ -0,0 +1,110 @@
+#ifndef WHTS_PROTOCOL_SAMPLE_HISTORY_H
+#define WHTS_PROTOCOL_SAMPLE_HISTORY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "SlaveIndex.h"
+
+namespace WhtsProtocol {
+
+enum class HistoryKind : uint8_t {
+    STATUS = 0,  // 设备状态 (只记录变化)
+    CONDUCTION,
+    RESISTANCE
+};
+
+constexpr size_t HISTORY_KIND_COUNT = 3;
+
+const char *historyKindName(HistoryKind kind);
+
+// 按从机保存带时间戳的采样历史, 每类采样一个固定深度的环形缓冲, 满时覆盖最旧的采样。
+// 存储为结构数组: 每类采样的时间戳、状态、长度、数据各占一块预先分配的内存,
+// 从机第一次出现时分得其中一段, 总内存 = maxSlaves * depth * 每采样字节数, 运行中不再分配。
+// 超过 maxBytes 的采样数据截断。每个从机的时间戳须单调不减
+class SampleHistory {
+  public:
+    struct Config {
+        size_t maxSlaves = 64;
+        size_t depth = 1024;                // 每个从机每类采样保留的条数
+        size_t conductionMaxBytes = 256;
+        size_t resistanceMaxBytes = 128;
+    };
+
+    struct Stats {
+        uint64_t recorded = 0;
+        uint64_t overwritten = 0;     // 被新采样覆盖的条数
+        uint64_t truncated = 0;       // 数据超过 maxBytes 被截断的条数
+        uint64_t droppedSlaves = 0;   // 超过 maxSlaves 未记录的采样数
+    };
+
+    // 依次为时间戳、设备状态、数据 (STATUS 类为空)
+    using Visitor = std::function<void(uint64_t timestampMs, uint16_t status,
+                                       const uint8_t *data, size_t length)>;
+
+    SampleHistory();
+    explicit SampleHistory(const Config &config);
+
+    // 重新分配存储, 清空所有历史; 分配失败时返回 false, 保留原有的存储和历史
+    bool configure(const Config &config);
+    const Config &config() const { return config_; }
+
+    void record(uint32_t slaveId, HistoryKind kind, uint64_t timestampMs,
+                uint16_t status, const uint8_t *data = nullptr,
+                size_t length = 0);
+
+    // 按时间顺序访问 [fromMs, toMs] 内的采样, 最多 maxSamples 条 (0 表示不限),
+    // 超出时保留最新的部分; 返回访问的条数
+    size_t query(uint32_t slaveId, HistoryKind kind, uint64_t fromMs,
+                 uint64_t toMs, const Visitor &visitor,
+                 size_t maxSamples = 0) const;
+
+    // 当前保存的条数
+    size_t count(uint32_t slaveId, HistoryKind kind) const;
+    // 按从机ID排序
+    std::vector<uint32_t> slaves() const;
+    const Stats &stats() const { return stats_; }
+    // 预先分配的总字节数
+    size_t capacityBytes() const;
+    // 按 config 分配所需的字节数
+    static size_t capacityBytes(const Config &config);
+    // 总内存不超过 budgetBytes 时允许的最大 depth (至少为 1)
+    static size_t maxDepth(const Config &config, size_t budgetBytes);
+    void clear();
+
+  private:
+    // 一类采样的存储, 第 s 个从机占用下标 [s * depth, (s + 1) * depth)
+    struct Arena {
+        size_t maxBytes = 0;
+        std::unique_ptr<uint64_t[]> timestamps;
+        std::unique_ptr<uint16_t[]> statuses;
+        std::unique_ptr<uint16_t[]> lengths;
+        std::unique_ptr<uint8_t[]> data;
+    };
+
+    struct Ring {
+        size_t head = 0;  // 最旧采样的位置
+        size_t count = 0;
+    };
+
+    // 下标即从机在 SlaveIndex 中的下标, 也是其在存储中的段号
+    struct SlaveRings {
+        Ring rings[HISTORY_KIND_COUNT];
+    };
+
+    const Ring *findRing(uint32_t slaveId, HistoryKind kind,
+                         uint32_t &slot) const;
+
+    Config config_;
+    Arena arenas_[HISTORY_KIND_COUNT];
+    SlaveIndex index_;
+    std::vector<SlaveRings> slaves_;
+    Stats stats_;
+};
+
+} // namespace WhtsProtocol
+
+#endif // WHTS_PROTOCOL_SAMPLE_HISTORY_H
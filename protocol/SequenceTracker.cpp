@@ -0,0 +1,142 @@
+#include "SequenceTracker.h"
+
+#include <algorithm>
+
+namespace WhtsProtocol {
+
+namespace {
+// 展开序号的起点, 避免乱序帧计算 highest - behind 时下溢
+constexpr uint64_t SEQUENCE_BASE = 1ULL << 32;
+} // namespace
+
+double SequenceStats::completeness() const {
+    if (expected == 0)
+        return 1.0;
+    uint64_t missing = std::min(lost, expected);
+    return static_cast<double>(expected - missing) /
+           static_cast<double>(expected);
+}
+
+void SequenceTracker::restart(SlaveState &state, uint16_t sequence) {
+    state.highest = SEQUENCE_BASE + sequence;
+    state.firstSequence = state.highest;
+    state.window = 1;
+    state.expectedBase = state.stats.expected;
+    state.stats.expected = state.expectedBase + 1;
+    state.timingValid = false;
+}
+
+void SequenceTracker::recordDelay(SlaveState &state, int64_t timestampUs,
+                                  uint64_t arrivalNs) {
+    if (arrivalNs == 0)
+        return;
+
+    // 两端时钟不同源, 只看偏移相对最小值的增量; 时钟漂移会使该值缓慢变化
+    int64_t offsetUs = static_cast<int64_t>(arrivalNs / 1000) - timestampUs;
+    if (!state.timingValid || offsetUs < state.minOffsetUs) {
+        state.minOffsetUs = offsetUs;
+        state.timingValid = true;
+    }
+    uint64_t extraUs = static_cast<uint64_t>(offsetUs - state.minOffsetUs);
+
+    SequenceStats &stats = state.stats;
+    ++stats.delaySamples;
+    stats.meanExtraDelayUs +=
+        (static_cast<double>(extraUs) - stats.meanExtraDelayUs) /
+        static_cast<double>(stats.delaySamples);
+    stats.maxExtraDelayUs = std::max(stats.maxExtraDelayUs, extraUs);
+}
+
+void SequenceTracker::record(uint32_t slaveId, uint16_t sequence,
+                             uint32_t timestampUs, uint64_t arrivalNs) {
+    auto result = slaves_.try_emplace(slaveId);
+    SlaveState &state = result.first->second;
+    SequenceStats &stats = state.stats;
+    ++stats.received;
+
+    if (result.second) {
+        stats.slaveId = slaveId;
+        restart(state, sequence);
+        state.lastTimestampUs = timestampUs;
+        state.timestampUs = timestampUs;
+        recordDelay(state, state.timestampUs, arrivalNs);
+        return;
+    }
+
+    // 16 位序号按最近距离展开
+    int16_t diff = static_cast<int16_t>(
+        static_cast<uint16_t>(sequence - static_cast<uint16_t>(state.highest)));
+    // 32 位时间戳同理, 相对最高序号那一帧展开
+    int64_t sampleUs =
+        state.timestampUs +
+        static_cast<int32_t>(timestampUs - state.lastTimestampUs);
+
+    if (diff > 0) {
+        uint32_t step = static_cast<uint32_t>(diff);
+        uint32_t gap = step - 1;
+        if (gap > 0) {
+            stats.lost += gap;
+            ++stats.gapEvents;
+            stats.maxGap = std::max(stats.maxGap, gap);
+        }
+        state.window = step >= WINDOW_SIZE ? 0 : state.window << step;
+        state.window |= 1;
+        state.highest += step;
+        stats.expected =
+            state.expectedBase + (state.highest - state.firstSequence + 1);
+
+        state.lastTimestampUs = timestampUs;
+        state.timestampUs = sampleUs;
+        recordDelay(state, sampleUs, arrivalNs);
+        return;
+    }
+
+    uint32_t behind = static_cast<uint32_t>(-diff);
+    if (behind >= RESTART_THRESHOLD) {
+        ++stats.restarts;
+        restart(state, sequence);
+        state.lastTimestampUs = timestampUs;
+        state.timestampUs = timestampUs;
+        recordDelay(state, state.timestampUs, arrivalNs);
+        return;
+    }
+
+    if (behind >= WINDOW_SIZE || state.highest - behind < state.firstSequence) {
+        ++stats.late;
+        return;
+    }
+
+    uint64_t bit = 1ULL << behind;
+    if (state.window & bit) {
+        ++stats.duplicates;
+        return;
+    }
+
+    // 之前记为缺失的序号迟到补齐
+    state.window |= bit;
+    ++stats.reordered;
+    if (stats.lost > 0)
+        --stats.lost;
+    recordDelay(state, sampleUs, arrivalNs);
+}
+
+std::vector<SequenceStats> SequenceTracker::snapshot() const {
+    std::vector<SequenceStats> result;
+    result.reserve(slaves_.size());
+    for (const auto &entry : slaves_)
+        result.push_back(entry.second.stats);
+    std::sort(result.begin(), result.end(),
+              [](const SequenceStats &a, const SequenceStats &b) {
+                  return a.slaveId < b.slaveId;
+              });
+    return result;
+}
+
+const SequenceStats *SequenceTracker::stats(uint32_t slaveId) const {
+    auto it = slaves_.find(slaveId);
+    return it != slaves_.end() ? &it->second.stats : nullptr;
+}
+
+void SequenceTracker::reset() { slaves_.clear(); }
+
+} // namespace WhtsProtocol
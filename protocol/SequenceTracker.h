@@ -0,0 +1,71 @@
+#ifndef WHTS_PROTOCOL_SEQUENCE_TRACKER_H
+#define WHTS_PROTOCOL_SEQUENCE_TRACKER_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace WhtsProtocol {
+
+// 单个从机的数据完整性统计
+struct SequenceStats {
+    uint32_t slaveId = 0;
+    uint64_t received = 0;      // 收到的帧 (含重复)
+    uint64_t expected = 0;      // 首个序号到最新序号的跨度
+    uint64_t lost = 0;          // 仍缺失的序号数 (迟到补齐后扣除)
+    uint64_t duplicates = 0;    // 窗口内重复的序号
+    uint64_t reordered = 0;     // 乱序到达但在窗口内补齐
+    uint64_t late = 0;          // 落后超过窗口, 无法判断是否重复
+    uint64_t gapEvents = 0;     // 出现缺口的次数
+    uint32_t maxGap = 0;        // 最大一次缺口的序号数
+    uint64_t restarts = 0;      // 序号大幅回退 (从机重启) 的次数
+
+    // 相对最快一帧的额外传输延迟 (到达时间 - 采样时间戳 - 最小值), 用于区分"慢"和"丢"
+    uint64_t delaySamples = 0;
+    double meanExtraDelayUs = 0;
+    uint64_t maxExtraDelayUs = 0;
+
+    // 完整率 = (应收 - 缺失) / 应收
+    double completeness() const;
+};
+
+// 按从机跟踪 Slave2Backend 扩展头中的序号和时间戳
+// 每帧 O(1): 记录最高序号和其后 WINDOW_SIZE 个序号的接收位图 (同抗重放窗口)。
+class SequenceTracker {
+  public:
+    static constexpr uint32_t WINDOW_SIZE = 64;
+    // 落后最高序号超过该值视为从机重启, 重新开始跟踪
+    static constexpr uint32_t RESTART_THRESHOLD = 1024;
+
+    void record(uint32_t slaveId, uint16_t sequence, uint32_t timestampUs,
+                uint64_t arrivalNs);
+
+    // 按从机ID排序
+    std::vector<SequenceStats> snapshot() const;
+    const SequenceStats *stats(uint32_t slaveId) const;
+    void reset();
+
+  private:
+    struct SlaveState {
+        SequenceStats stats;
+        uint64_t highest = 0;       // 展开后的最高序号
+        uint64_t window = 0;        // bit i: highest - i 已收到
+        uint64_t firstSequence = 0; // 展开后的首个序号 (重启后重新计)
+        uint64_t expectedBase = 0;  // 重启前累计的应收数
+
+        uint32_t lastTimestampUs = 0;
+        int64_t timestampUs = 0;    // 展开后的最高序号对应的时间戳
+        int64_t minOffsetUs = 0;    // 到达时间 - 时间戳 的最小值
+        bool timingValid = false;
+    };
+
+    void restart(SlaveState &state, uint16_t sequence);
+    void recordDelay(SlaveState &state, int64_t timestampUs,
+                     uint64_t arrivalNs);
+
+    std::unordered_map<uint32_t, SlaveState> slaves_;
+};
+
+} // namespace WhtsProtocol
+
+#endif // WHTS_PROTOCOL_SEQUENCE_TRACKER_H
@@ -0,0 +1,68 @@
+#ifndef WHTS_PROTOCOL_SLAVE_INDEX_H
+#define WHTS_PROTOCOL_SLAVE_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace WhtsProtocol {
+
+// 从机ID到紧凑下标的映射: 下标按首次出现的顺序分配 (0, 1, 2, ...),
+// 调用方用它索引自己按从机保存的状态数组。
+// 同一从机的数据通常连续到达, add() 缓存上一次查找, 命中时不查哈希表。
+class SlaveIndex {
+  public:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    // 未知从机返回 NONE
+    uint32_t find(uint32_t slaveId) const {
+        if (lastIndex_ != NONE && lastSlaveId_ == slaveId)
+            return lastIndex_;
+        auto it = indexById_.find(slaveId);
+        return it == indexById_.end() ? NONE : it->second;
+    }
+
+    // 未知从机在 size() < limit 时分配下一个下标并置 created, 否则返回 NONE
+    uint32_t add(uint32_t slaveId, bool &created, size_t limit = SIZE_MAX) {
+        created = false;
+        if (lastIndex_ != NONE && lastSlaveId_ == slaveId)
+            return lastIndex_;
+        uint32_t index;
+        auto it = indexById_.find(slaveId);
+        if (it != indexById_.end()) {
+            index = it->second;
+        } else {
+            if (ids_.size() >= limit)
+                return NONE;
+            index = static_cast<uint32_t>(ids_.size());
+            indexById_.emplace(slaveId, index);
+            ids_.push_back(slaveId);
+            created = true;
+        }
+        lastSlaveId_ = slaveId;
+        lastIndex_ = index;
+        return index;
+    }
+
+    bool contains(uint32_t slaveId) const { return find(slaveId) != NONE; }
+    size_t size() const { return ids_.size(); }
+    // 按下标排列的从机ID
+    const std::vector<uint32_t> &ids() const { return ids_; }
+
+    void clear() {
+        indexById_.clear();
+        ids_.clear();
+        lastIndex_ = NONE;
+    }
+
+  private:
+    std::unordered_map<uint32_t, uint32_t> indexById_;
+    std::vector<uint32_t> ids_;
+    uint32_t lastSlaveId_ = 0;
+    uint32_t lastIndex_ = NONE;
+};
+
+} // namespace WhtsProtocol
+
+#endif // WHTS_PROTOCOL_SLAVE_INDEX_H
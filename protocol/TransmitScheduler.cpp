@@ -0,0 +1,185 @@
+#include "TransmitScheduler.h"
+
+#include <algorithm>
+
+#include "Common.h"
+
+namespace WhtsProtocol {
+
+const char *transmitLaneName(TransmitLane lane) {
+    switch (lane) {
+    case TransmitLane::CONTROL:
+        return "Control";
+    case TransmitLane::CONFIG:
+        return "Config";
+    case TransmitLane::DIAGNOSTICS:
+        return "Diagnostics";
+    default:
+        return "Unknown";
+    }
+}
+
+TransmitLane transmitLaneFor(uint8_t backend2MasterMessageId) {
+    switch (static_cast<Backend2MasterMessageId>(backend2MasterMessageId)) {
+    case Backend2MasterMessageId::CTRL_MSG:
+    case Backend2MasterMessageId::SLAVE_RST_MSG:
+        return TransmitLane::CONTROL;
+    case Backend2MasterMessageId::SLAVE_CFG_MSG:
+    case Backend2MasterMessageId::MODE_CFG_MSG:
+    case Backend2MasterMessageId::INTERVAL_CFG_MSG:
+    case Backend2MasterMessageId::SET_UWB_CHAN_MSG:
+        return TransmitLane::CONFIG;
+    default:
+        return TransmitLane::DIAGNOSTICS;
+    }
+}
+
+TransmitScheduler::TransmitScheduler(Transmit transmit)
+    : transmit_(std::move(transmit)) {}
+
+void TransmitScheduler::setLaneConfig(TransmitLane lane,
+                                      const LaneConfig &config) {
+    Lane &target = lanes_[static_cast<size_t>(lane)];
+    target.config = config;
+    // 新配置从满桶开始
+    target.tokensMilli = static_cast<uint64_t>(config.burstBytes) * 1000;
+    target.refillStarted = false;
+}
+
+const TransmitScheduler::LaneConfig &
+TransmitScheduler::laneConfig(TransmitLane lane) const {
+    return lanes_[static_cast<size_t>(lane)].config;
+}
+
+bool TransmitScheduler::enqueue(TransmitLane lane, std::vector<uint8_t> frame,
+                                uint64_t nowMs) {
+    Lane &target = lanes_[static_cast<size_t>(lane)];
+    if (target.queue.size() >= target.config.maxQueuedFrames) {
+        ++target.stats.dropped;
+        return false;
+    }
+    ++target.stats.enqueued;
+    target.queue.push_back({std::move(frame), nowMs});
+    poll(nowMs);
+    return true;
+}
+
+bool TransmitScheduler::enqueue(TransmitLane lane,
+                                std::vector<std::vector<uint8_t>> frames,
+                                uint64_t nowMs) {
+    Lane &target = lanes_[static_cast<size_t>(lane)];
+    // 一条消息的分片整体入队或整体丢弃
+    if (target.queue.size() + frames.size() > target.config.maxQueuedFrames) {
+        target.stats.dropped += frames.size();
+        return false;
+    }
+    target.stats.enqueued += frames.size();
+    for (auto &frame : frames)
+        target.queue.push_back({std::move(frame), nowMs});
+    poll(nowMs);
+    return true;
+}
+
+void TransmitScheduler::enqueueUrgent(TransmitLane lane,
+                                      std::vector<std::vector<uint8_t>> frames,
+                                      uint64_t nowMs) {
+    Lane &target = lanes_[static_cast<size_t>(lane)];
+    target.stats.enqueued += frames.size();
+    // 逆序插入队首, 保持分片顺序
+    for (auto it = frames.rbegin(); it != frames.rend(); ++it)
+        target.queue.push_front({std::move(*it), nowMs});
+    poll(nowMs);
+}
+
+void TransmitScheduler::refill(Lane &lane, uint64_t nowMs) {
+    if (lane.config.rateBytesPerSec == 0)
+        return;
+    if (!lane.refillStarted) {
+        lane.refillStarted = true;
+        lane.refillMs = nowMs;
+        return;
+    }
+    if (nowMs <= lane.refillMs)
+        return;
+    // 字节/秒 * 毫秒 = 千分之一字节
+    uint64_t capacity = static_cast<uint64_t>(lane.config.burstBytes) * 1000;
+    lane.tokensMilli = std::min(
+        capacity, lane.tokensMilli + (nowMs - lane.refillMs) *
+                                         lane.config.rateBytesPerSec);
+    lane.refillMs = nowMs;
+}
+
+bool TransmitScheduler::admit(const Lane &lane, size_t frameSize) const {
+    if (lane.config.rateBytesPerSec == 0)
+        return true;
+    uint64_t capacity = static_cast<uint64_t>(lane.config.burstBytes) * 1000;
+    return lane.tokensMilli >= frameSize * 1000 ||
+           lane.tokensMilli >= capacity;
+}
+
+int64_t TransmitScheduler::waitMs(const Lane &lane) const {
+    uint64_t capacity = static_cast<uint64_t>(lane.config.burstBytes) * 1000;
+    uint64_t needed =
+        std::min<uint64_t>(lane.queue.front().frame.size() * 1000, capacity);
+    if (lane.tokensMilli >= needed)
+        return 0;
+    uint64_t rate = lane.config.rateBytesPerSec;
+    return static_cast<int64_t>((needed - lane.tokensMilli + rate - 1) / rate);
+}
+
+int64_t TransmitScheduler::poll(uint64_t nowMs) {
+    int64_t nextMs = -1;
+    for (Lane &lane : lanes_) {
+        refill(lane, nowMs);
+        while (!lane.queue.empty() &&
+               admit(lane, lane.queue.front().frame.size())) {
+            Queued &head = lane.queue.front();
+            size_t size = head.frame.size();
+            if (lane.config.rateBytesPerSec > 0)
+                lane.tokensMilli -= std::min<uint64_t>(lane.tokensMilli,
+                                                       size * 1000);
+
+            uint64_t queueMs = nowMs > head.enqueuedMs
+                                   ? nowMs - head.enqueuedMs
+                                   : 0;
+            if (transmit_(head.frame)) {
+                ++lane.stats.sent;
+                lane.stats.bytesSent += size;
+                lane.stats.totalQueueMs += queueMs;
+                lane.stats.maxQueueMs = std::max(lane.stats.maxQueueMs, queueMs);
+            } else {
+                ++lane.stats.dropped;
+            }
+            lane.queue.pop_front();
+        }
+        if (!lane.queue.empty()) {
+            int64_t wait = waitMs(lane);
+            nextMs = nextMs < 0 ? wait : std::min(nextMs, wait);
+        }
+    }
+    return nextMs;
+}
+
+bool TransmitScheduler::empty() const {
+    for (const Lane &lane : lanes_) {
+        if (!lane.queue.empty())
+            return false;
+    }
+    return true;
+}
+
+size_t TransmitScheduler::queued(TransmitLane lane) const {
+    return lanes_[static_cast<size_t>(lane)].queue.size();
+}
+
+const TransmitScheduler::LaneStats &
+TransmitScheduler::stats(TransmitLane lane) const {
+    return lanes_[static_cast<size_t>(lane)].stats;
+}
+
+void TransmitScheduler::clear() {
+    for (Lane &lane : lanes_)
+        lane.queue.clear();
+}
+
+} // namespace WhtsProtocol
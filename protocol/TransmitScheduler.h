@@ -0,0 +1,100 @@
+#ifndef WHTS_PROTOCOL_TRANSMIT_SCHEDULER_H
+#define WHTS_PROTOCOL_TRANSMIT_SCHEDULER_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <vector>
+
+namespace WhtsProtocol {
+
+// 发送通道, 数值越小优先级越高
+enum class TransmitLane : uint8_t {
+    CONTROL = 0, // 启停/复位等控制命令及确认帧, 不限速
+    CONFIG,      // 配置类命令及其分片
+    DIAGNOSTICS, // 设备列表、Ping 等诊断流量
+    COUNT
+};
+
+constexpr size_t TRANSMIT_LANE_COUNT = static_cast<size_t>(TransmitLane::COUNT);
+
+const char *transmitLaneName(TransmitLane lane);
+
+// Backend2Master 消息所属的发送通道
+TransmitLane transmitLaneFor(uint8_t backend2MasterMessageId);
+
+// 分通道发送调度: 严格优先级, 高优先级通道有帧可发时低优先级通道等待;
+// 每个通道可配置令牌桶限速, 限速中的通道不阻塞低优先级通道。
+// 帧按整帧调度, 因此控制帧可以插在其它消息的分片之间。
+class TransmitScheduler {
+  public:
+    using Transmit = std::function<bool(const std::vector<uint8_t> &frame)>;
+
+    struct LaneConfig {
+        uint32_t rateBytesPerSec = 0; // 0 表示不限速
+        uint32_t burstBytes = 0;      // 令牌桶容量, 大于桶容量的帧在桶满时发送
+        size_t maxQueuedFrames = 1024; // 队列满时丢弃新帧
+    };
+
+    struct LaneStats {
+        uint64_t enqueued = 0;
+        uint64_t sent = 0;
+        uint64_t dropped = 0;       // 队列满或发送失败
+        uint64_t bytesSent = 0;
+        uint64_t totalQueueMs = 0;  // 入队到发出的累计排队时间
+        uint64_t maxQueueMs = 0;
+    };
+
+    explicit TransmitScheduler(Transmit transmit);
+
+    void setLaneConfig(TransmitLane lane, const LaneConfig &config);
+    const LaneConfig &laneConfig(TransmitLane lane) const;
+
+    // 入队后立即尝试发送; 队列满时返回 false
+    bool enqueue(TransmitLane lane, std::vector<uint8_t> frame, uint64_t nowMs);
+    bool enqueue(TransmitLane lane, std::vector<std::vector<uint8_t>> frames,
+                 uint64_t nowMs);
+    // 急停/复位: 插到通道队首并立即尝试发送, 不受 maxQueuedFrames 限制
+    void enqueueUrgent(TransmitLane lane,
+                       std::vector<std::vector<uint8_t>> frames,
+                       uint64_t nowMs);
+
+    // 发送当前允许发送的帧, 返回距离下次可发送的毫秒数; 队列全空时返回 -1
+    int64_t poll(uint64_t nowMs);
+
+    bool empty() const;
+    size_t queued(TransmitLane lane) const;
+    const LaneStats &stats(TransmitLane lane) const;
+
+    // 丢弃所有排队的帧 (不计入 dropped)
+    void clear();
+
+  private:
+    struct Queued {
+        std::vector<uint8_t> frame;
+        uint64_t enqueuedMs;
+    };
+
+    struct Lane {
+        LaneConfig config;
+        LaneStats stats;
+        std::deque<Queued> queue;
+        uint64_t tokensMilli = 0; // 令牌 (字节 * 1000)
+        uint64_t refillMs = 0;
+        bool refillStarted = false;
+    };
+
+    void refill(Lane &lane, uint64_t nowMs);
+    bool admit(const Lane &lane, size_t frameSize) const;
+    // 令牌足够发送下一帧还需等待的毫秒数
+    int64_t waitMs(const Lane &lane) const;
+
+    Transmit transmit_;
+    std::array<Lane, TRANSMIT_LANE_COUNT> lanes_;
+};
+
+} // namespace WhtsProtocol
+
+#endif // WHTS_PROTOCOL_TRANSMIT_SCHEDULER_H
@@ -2,10 +2,23 @@
 #define WHTS_PROTOCOL_H
 
 // 包含所有子模块
+#include "ClipTracker.h"
 #include "Common.h"
+#include "ConductionDelta.h"
+#include "DeviceRegistry.h"
 #include "DeviceStatus.h"
+#include "DeviceStatusTracker.h"
 #include "Frame.h"
+#include "PinFlipAccumulator.h"
 #include "ProtocolProcessor.h"
+#include "ProtocolStats.h"
+#include "ReliableTransport.h"
+#include "ResistanceAccumulator.h"
+#include "RuleEngine.h"
+#include "SampleHistory.h"
+#include "SequenceTracker.h"
+#include "SlaveIndex.h"
+#include "TransmitScheduler.h"
 
 // 消息模块
 #include "messages/Backend2Master.h"
@@ -18,6 +31,9 @@
 
 // 工具模块
 #include "utils/ByteUtils.h"
+#include "utils/Crc32c.h"
+#include "utils/LatencyHistogram.h"
+#include "utils/TraceRecorder.h"
 
 // 标准库依赖
 #include <map>
@@ -25,6 +41,12 @@
 #include <queue>
 #include <vector>
 
+// 线程与时间约定:
+// 除 ProtocolStats 的计数器 (可在任意线程读取快照) 和 TraceRecorder 外, 协议库中
+// 的有状态组件 (ProtocolProcessor、各 Tracker/Accumulator、DeviceRegistry、
+// RuleEngine、SampleHistory、ReliableSender、TransmitScheduler 等) 都不是线程安全的,
+// 由处理接收数据的线程调用。这些组件不读取时钟, 时间参数 (nowMs、timestampMs 等)
+// 由调用方传入, 取单调时钟的毫秒值。
 namespace WhtsProtocol {
 }
 
@@ -0,0 +1,993 @@
+// WHTS 协议库微基准测试
+//
+// 用法: ProtocolBenchmark [过滤子串] [--min-time-ms N]
+//
+// 每个用例输出 ns/frame、MB/s 以及 allocs/frame。allocs 通过替换全局
+// operator new 统计, 因此只计入堆分配次数, 不含栈上对象。
+
+#include "ClipTracker.h"
+#include "ConductionDelta.h"
+#include "DeviceRegistry.h"
+#include "DeviceStatusTracker.h"
+#include "PinFlipAccumulator.h"
+#include "ProtocolProcessor.h"
+#include "ReliableTransport.h"
+#include "ResistanceAccumulator.h"
+#include "RuleEngine.h"
+#include "SampleHistory.h"
+#include "TransmitScheduler.h"
+#include "messages/Backend2Master.h"
+#include "messages/Master2Backend.h"
+#include "messages/Master2Slave.h"
+#include "messages/Slave2Backend.h"
+#include "messages/Slave2Master.h"
+#include "utils/Crc32c.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+// 全局分配计数
+static std::atomic<uint64_t> g_allocCount{0};
+
+void *operator new(std::size_t size) {
+    g_allocCount.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+
+using namespace WhtsProtocol;
+
+namespace {
+
+// 防止编译器把被测代码优化掉
+volatile uint64_t g_sink = 0;
+
+struct BenchResult {
+    std::string name;
+    double nsPerFrame;
+    double bytesPerSec;
+    double allocsPerFrame;
+    double framesOutPerIter;
+};
+
+struct BenchConfig {
+    std::string filter;
+    double minTimeMs = 200.0;
+};
+
+BenchConfig g_config;
+std::vector<BenchResult> g_results;
+
+// 运行单个用例
+// framesPerIter: 每次迭代处理的帧数 (用于 ns/frame)
+// bytesPerIter:  每次迭代处理的字节数 (用于 MB/s)
+// fn:            被测函数, 返回本次迭代产出的帧/消息数 (用于结果校验)
+void runBenchmark(const std::string &name, size_t framesPerIter,
+                  size_t bytesPerIter, const std::function<size_t()> &fn) {
+    if (!g_config.filter.empty() &&
+        name.find(g_config.filter) == std::string::npos)
+        return;
+
+    using Clock = std::chrono::steady_clock;
+
+    // 预热
+    size_t framesOut = fn();
+
+    // 校准迭代次数, 直到单轮耗时超过最小测量时间
+    uint64_t iterations = 1;
+    double elapsedNs = 0;
+    uint64_t allocs = 0;
+    while (true) {
+        uint64_t allocBefore = g_allocCount.load(std::memory_order_relaxed);
+        auto start = Clock::now();
+        for (uint64_t i = 0; i < iterations; ++i) {
+            g_sink = g_sink + fn();
+        }
+        auto end = Clock::now();
+        allocs = g_allocCount.load(std::memory_order_relaxed) - allocBefore;
+        elapsedNs = static_cast<double>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+                .count());
+        if (elapsedNs >= g_config.minTimeMs * 1e6 || iterations >= (1ull << 30))
+            break;
+        iterations *= 2;
+    }
+
+    double totalFrames = static_cast<double>(iterations) *
+                         static_cast<double>(framesPerIter ? framesPerIter : 1);
+    BenchResult result;
+    result.name = name;
+    result.nsPerFrame = elapsedNs / totalFrames;
+    result.bytesPerSec = static_cast<double>(bytesPerIter) *
+                         static_cast<double>(iterations) / (elapsedNs / 1e9);
+    result.allocsPerFrame = static_cast<double>(allocs) / totalFrames;
+    result.framesOutPerIter = static_cast<double>(framesOut);
+    g_results.push_back(result);
+
+    std::printf("%-60s %12.1f %12.2f %12.2f %10.0f\n", result.name.c_str(),
+                result.nsPerFrame, result.bytesPerSec / 1e6,
+                result.allocsPerFrame, result.framesOutPerIter);
+    std::fflush(stdout);
+}
+
+size_t totalSize(const std::vector<std::vector<uint8_t>> &packets) {
+    size_t size = 0;
+    for (const auto &packet : packets)
+        size += packet.size();
+    return size;
+}
+
+// ---------------------------------------------------------------------------
+// 样本消息
+// ---------------------------------------------------------------------------
+
+Master2Slave::SyncMessage makeSyncMessage(size_t slaveCount) {
+    Master2Slave::SyncMessage msg;
+    msg.mode = 0;
+    msg.interval = 20;
+    msg.currentTime = 0x0123456789ABCDEFull;
+    msg.startTime = 0x0123456789ABD000ull;
+    for (size_t i = 0; i < slaveCount; ++i) {
+        msg.slaveConfigs.emplace_back(static_cast<uint32_t>(0x10000000 + i),
+                                      static_cast<uint8_t>(i), 0, 16);
+    }
+    return msg;
+}
+
+Slave2Master::PingRspMessage makePingRspMessage() {
+    Slave2Master::PingRspMessage msg;
+    msg.sequenceNumber = 42;
+    msg.timestamp = 123456789;
+    return msg;
+}
+
+Slave2Backend::ConductionDataMessage makeConductionMessage(size_t length) {
+    Slave2Backend::ConductionDataMessage msg;
+    msg.conductionLength = static_cast<uint16_t>(length);
+    msg.conductionData.resize(length);
+    for (size_t i = 0; i < length; ++i)
+        msg.conductionData[i] = static_cast<uint8_t>(i * 37 + 11);
+    return msg;
+}
+
+Slave2Backend::ConductionBatchMessage makeConductionBatch(size_t samples,
+                                                          size_t length) {
+    Slave2Backend::ConductionBatchMessage msg;
+    msg.sampleIntervalUs = 5000;
+    auto sample = makeConductionMessage(length).conductionData;
+    for (size_t i = 0; i < samples; ++i) {
+        sample[i % length] ^= 0x01;
+        // 状态偶尔变化, 与实际采集接近
+        msg.append(i % 4 == 0 ? 0x0065 : 0x0067, sample);
+    }
+    return msg;
+}
+
+Backend2Master::SlaveConfigMessage makeSlaveConfigMessage(size_t slaveCount) {
+    Backend2Master::SlaveConfigMessage msg;
+    msg.slaveNum = static_cast<uint8_t>(slaveCount);
+    for (size_t i = 0; i < slaveCount; ++i) {
+        Backend2Master::SlaveConfigMessage::SlaveInfo slave;
+        slave.id = static_cast<uint32_t>(0x10000000 + i);
+        slave.conductionNum = 16;
+        slave.resistanceNum = 4;
+        slave.clipMode = 0;
+        slave.clipStatus = 0x00FF;
+        msg.slaves.push_back(slave);
+    }
+    return msg;
+}
+
+Master2Backend::DeviceListResponseMessage makeDeviceListMessage(size_t count) {
+    Master2Backend::DeviceListResponseMessage msg;
+    msg.deviceCount = static_cast<uint8_t>(count);
+    for (size_t i = 0; i < count; ++i) {
+        Master2Backend::DeviceListResponseMessage::DeviceInfo device;
+        device.deviceId = static_cast<uint32_t>(0x10000000 + i);
+        device.shortId = static_cast<uint8_t>(i + 1);
+        device.online = 1;
+        device.versionMajor = 1;
+        device.versionMinor = 2;
+        device.versionPatch = 3;
+        device.batteryLevel = static_cast<uint8_t>(50 + i % 50);
+        msg.devices.push_back(device);
+    }
+    return msg;
+}
+
+DeviceStatus makeDeviceStatus() {
+    DeviceStatus status;
+    status.fromUint16(0x0065);
+    return status;
+}
+
+// ---------------------------------------------------------------------------
+// Frame
+// ---------------------------------------------------------------------------
+
+void benchCrc32c() {
+    std::vector<uint8_t> data = makeConductionMessage(1024).conductionData;
+    for (size_t length : {size_t(32), size_t(100), size_t(1024)}) {
+        std::string suffix = "/" + std::to_string(length);
+        runBenchmark(std::string("Crc32c::compute") +
+                         (Crc32c::hardwareAccelerated() ? "(hw)" : "(sw)") +
+                         suffix,
+                     1, length, [&]() {
+                         return size_t(Crc32c::compute(data.data(), length) & 1);
+                     });
+        runBenchmark("Crc32c::computePortable" + suffix, 1, length, [&]() {
+            return size_t(Crc32c::computePortable(data.data(), length) & 1);
+        });
+    }
+}
+
+void benchFrame() {
+    for (size_t payloadSize : {16u, 256u, 1024u}) {
+        Frame frame;
+        frame.packetId = static_cast<uint8_t>(PacketId::SLAVE_TO_BACKEND);
+        frame.payload.assign(payloadSize, 0x5A);
+        frame.packetLength = static_cast<uint16_t>(payloadSize);
+        auto bytes = frame.serialize();
+
+        std::string suffix = "/" + std::to_string(payloadSize) + "B";
+        runBenchmark("Frame::serialize" + suffix, 1, bytes.size(), [&]() {
+            return frame.serialize().size() ? size_t(1) : size_t(0);
+        });
+
+        Frame decoded;
+        runBenchmark("Frame::deserialize" + suffix, 1, bytes.size(), [&]() {
+            return Frame::deserialize(bytes, decoded) ? size_t(1) : size_t(0);
+        });
+    }
+}
+
+// ---------------------------------------------------------------------------
+// packXxxMessage
+// ---------------------------------------------------------------------------
+
+void benchPack() {
+    ProtocolProcessor processor;
+    const DeviceStatus status = makeDeviceStatus();
+
+    struct PackCase {
+        std::string name;
+        size_t mtu;
+        std::function<std::vector<std::vector<uint8_t>>()> pack;
+    };
+
+    auto syncSmall = makeSyncMessage(4);
+    auto syncLarge = makeSyncMessage(40);
+    auto pingRsp = makePingRspMessage();
+    auto conductionSmall = makeConductionMessage(8);
+    auto conductionLarge = makeConductionMessage(512);
+    auto conductionBatch = makeConductionBatch(8, 8);
+    auto configSmall = makeSlaveConfigMessage(4);
+    auto configLarge = makeSlaveConfigMessage(40);
+    auto deviceListSmall = makeDeviceListMessage(4);
+    auto deviceListLarge = makeDeviceListMessage(40);
+
+    // Slave2Master 没有天然的大消息, 分片用例通过缩小 MTU 强制分片
+    std::vector<PackCase> cases = {
+        {"packMaster2SlaveMessage/single", 100,
+         [&]() { return processor.packMaster2SlaveMessage(1, syncSmall); }},
+        {"packMaster2SlaveMessage/fragmented", 100,
+         [&]() { return processor.packMaster2SlaveMessage(1, syncLarge); }},
+        {"packSlave2MasterMessage/single", 100,
+         [&]() { return processor.packSlave2MasterMessage(1, pingRsp); }},
+        {"packSlave2MasterMessage/fragmented", 12,
+         [&]() { return processor.packSlave2MasterMessage(1, pingRsp); }},
+        {"packSlave2BackendMessage/single", 100,
+         [&]() {
+             return processor.packSlave2BackendMessage(1, status,
+                                                       conductionSmall);
+         }},
+        {"packSlave2BackendMessage/fragmented", 100,
+         [&]() {
+             return processor.packSlave2BackendMessage(1, status,
+                                                       conductionLarge);
+         }},
+        // 与 single 对比: 同样 8 次 8 字节采样合成一帧
+        {"packSlave2BackendMessage/batch8", 100,
+         [&]() {
+             return processor.packSlave2BackendMessage(1, status,
+                                                       conductionBatch);
+         }},
+        {"packBackend2MasterMessage/single", 100,
+         [&]() { return processor.packBackend2MasterMessage(configSmall); }},
+        {"packBackend2MasterMessage/fragmented", 100,
+         [&]() { return processor.packBackend2MasterMessage(configLarge); }},
+        {"packMaster2BackendMessage/single", 100,
+         [&]() { return processor.packMaster2BackendMessage(deviceListSmall); }},
+        {"packMaster2BackendMessage/fragmented", 100,
+         [&]() { return processor.packMaster2BackendMessage(deviceListLarge); }},
+    };
+
+    for (const auto &benchCase : cases) {
+        processor.setMTU(benchCase.mtu);
+        auto sample = benchCase.pack();
+        runBenchmark(benchCase.name, sample.size(), totalSize(sample),
+                     [&]() { return benchCase.pack().size(); });
+    }
+    processor.setMTU(100);
+}
+
+// ---------------------------------------------------------------------------
+// processReceivedData
+// ---------------------------------------------------------------------------
+
+// 接收端: 喂入所有数据报并取出全部完整帧, 返回取到的帧数
+size_t feedAndDrain(ProtocolProcessor &processor,
+                    const std::vector<std::vector<uint8_t>> &datagrams) {
+    size_t frames = 0;
+    Frame frame;
+    for (const auto &datagram : datagrams) {
+        processor.processReceivedData(datagram);
+        while (processor.getNextCompleteFrame(frame))
+            ++frames;
+    }
+    return frames;
+}
+
+// 生成不含帧头 (AB CD) 的噪声字节
+std::vector<uint8_t> makeNoise(std::mt19937 &rng, size_t length) {
+    std::uniform_int_distribution<int> dist(0, 255);
+    std::vector<uint8_t> noise;
+    noise.reserve(length);
+    while (noise.size() < length) {
+        uint8_t byte = static_cast<uint8_t>(dist(rng));
+        if (!noise.empty() && noise.back() == FRAME_DELIMITER_1 &&
+            byte == FRAME_DELIMITER_2)
+            continue;
+        noise.push_back(byte);
+    }
+    // 结尾的 AB 会和下一帧的 AB CD 拼成假帧头, 避免之
+    if (!noise.empty() && noise.back() == FRAME_DELIMITER_1)
+        noise.back() = 0x00;
+    return noise;
+}
+
+void benchReceive() {
+    ProtocolProcessor sender;
+    const DeviceStatus status = makeDeviceStatus();
+    const size_t frameCount = 64;
+
+    std::vector<std::vector<uint8_t>> frames;
+    for (size_t i = 0; i < frameCount; ++i) {
+        auto msg = makeConductionMessage(16);
+        auto packets = sender.packSlave2BackendMessage(
+            static_cast<uint32_t>(i), status, msg);
+        frames.push_back(packets.front());
+    }
+
+    // 干净流: 每个数据报一帧
+    {
+        ProtocolProcessor receiver;
+        runBenchmark("processReceivedData/clean/1-frame-per-datagram",
+                     frameCount, totalSize(frames),
+                     [&]() { return feedAndDrain(receiver, frames); });
+    }
+
+    // 干净流, 每帧附带 CRC-32C 校验尾 (与上一项对比校验开销)
+    {
+        ProtocolProcessor crcSender;
+        crcSender.setCrcMode(CrcMode::ON);
+        std::vector<std::vector<uint8_t>> crcFrames;
+        for (size_t i = 0; i < frameCount; ++i) {
+            auto msg = makeConductionMessage(16);
+            crcFrames.push_back(crcSender
+                                    .packSlave2BackendMessage(
+                                        static_cast<uint32_t>(i), status, msg)
+                                    .front());
+        }
+        ProtocolProcessor receiver;
+        runBenchmark("processReceivedData/clean-crc/1-frame-per-datagram",
+                     frameCount, totalSize(crcFrames),
+                     [&]() { return feedAndDrain(receiver, crcFrames); });
+    }
+
+    // 干净流: 8 帧粘包为一个数据报
+    {
+        std::vector<std::vector<uint8_t>> datagrams;
+        for (size_t i = 0; i < frames.size(); i += 8) {
+            std::vector<uint8_t> datagram;
+            for (size_t j = i; j < i + 8 && j < frames.size(); ++j)
+                datagram.insert(datagram.end(), frames[j].begin(),
+                                frames[j].end());
+            datagrams.push_back(datagram);
+        }
+        ProtocolProcessor receiver;
+        runBenchmark("processReceivedData/clean/8-frames-per-datagram",
+                     frameCount, totalSize(datagrams),
+                     [&]() { return feedAndDrain(receiver, datagrams); });
+    }
+
+    // 噪声流: 帧间夹杂随机字节, 并把部分帧切断在两个数据报之间
+    {
+        std::mt19937 rng(12345);
+        std::vector<uint8_t> stream;
+        for (const auto &frame : frames) {
+            auto noise = makeNoise(rng, 3 + rng() % 24);
+            stream.insert(stream.end(), noise.begin(), noise.end());
+            stream.insert(stream.end(), frame.begin(), frame.end());
+        }
+        std::vector<std::vector<uint8_t>> datagrams;
+        size_t pos = 0;
+        while (pos < stream.size()) {
+            size_t chunk = std::min<size_t>(stream.size() - pos,
+                                            48 + rng() % 96);
+            datagrams.emplace_back(stream.begin() + pos,
+                                   stream.begin() + pos + chunk);
+            pos += chunk;
+        }
+        ProtocolProcessor receiver;
+        runBenchmark("processReceivedData/noisy", frameCount,
+                     totalSize(datagrams),
+                     [&]() { return feedAndDrain(receiver, datagrams); });
+    }
+}
+
+// ---------------------------------------------------------------------------
+// 分片重组 (经由 processReceivedData 触发 reassembleFragments)
+// ---------------------------------------------------------------------------
+
+void benchReassembly() {
+    ProtocolProcessor sender;
+    const DeviceStatus status = makeDeviceStatus();
+    auto msg = makeConductionMessage(512);
+
+    const size_t sourceCount = 4;
+    std::vector<std::vector<std::vector<uint8_t>>> perSource;
+    for (size_t s = 0; s < sourceCount; ++s) {
+        perSource.push_back(sender.packSlave2BackendMessage(
+            static_cast<uint32_t>(0x20000000 + s), status, msg));
+    }
+    const size_t fragmentsPerSource = perSource.front().size();
+
+    // 顺序到达: 源之间不交错
+    {
+        std::vector<std::vector<uint8_t>> datagrams;
+        for (const auto &fragments : perSource)
+            datagrams.insert(datagrams.end(), fragments.begin(),
+                             fragments.end());
+        ProtocolProcessor receiver;
+        runBenchmark("reassembleFragments/sequential", sourceCount,
+                     totalSize(datagrams),
+                     [&]() { return feedAndDrain(receiver, datagrams); });
+    }
+
+    // 交错到达: 多个源的分片轮流到达
+    {
+        std::vector<std::vector<uint8_t>> datagrams;
+        for (size_t f = 0; f < fragmentsPerSource; ++f)
+            for (size_t s = 0; s < sourceCount; ++s)
+                datagrams.push_back(perSource[s][f]);
+        ProtocolProcessor receiver;
+        runBenchmark("reassembleFragments/interleaved", sourceCount,
+                     totalSize(datagrams),
+                     [&]() { return feedAndDrain(receiver, datagrams); });
+    }
+}
+
+// 可靠分片: 接收端收集并回复确认; 发送端一轮发送并处理确认 (无丢包)
+void benchReliable() {
+    ProtocolProcessor packer;
+    const DeviceStatus status = makeDeviceStatus();
+    auto frame = packer.packSlave2BackendMessageSingle(
+        0x20000000, status, makeConductionMessage(512));
+
+    // reliableId 循环使用, 每个 ID 都是新消息
+    const size_t messageCount = 256;
+    std::vector<std::vector<uint8_t>> datagrams;
+    for (size_t id = 0; id < messageCount; ++id) {
+        auto fragments =
+            packer.fragmentReliable(frame, static_cast<uint8_t>(id));
+        for (size_t i = 0; i < fragments.size(); ++i)
+            datagrams.push_back(packer.finishReliableFragment(
+                fragments[i], 0, i + 1 == fragments.size()));
+    }
+
+    {
+        ProtocolProcessor receiver;
+        std::vector<uint8_t> ack;
+        runBenchmark("reliable/receive", messageCount, totalSize(datagrams),
+                     [&]() {
+                         size_t frames = feedAndDrain(receiver, datagrams);
+                         while (receiver.getNextOutgoingFrame(ack))
+                             ++frames;
+                         return frames;
+                     });
+    }
+
+    {
+        ProtocolProcessor sender;
+        ProtocolProcessor receiver;
+        std::vector<std::vector<uint8_t>> inFlight;
+        ReliableSender reliable(sender, [&](const std::vector<uint8_t> &f) {
+            inFlight.push_back(f);
+            return true;
+        });
+        uint64_t now = 0;
+        runBenchmark("reliable/roundtrip", 1, frame.size(), [&]() {
+            reliable.send(frame, ++now);
+            size_t frames = feedAndDrain(receiver, inFlight);
+            inFlight.clear();
+            std::vector<uint8_t> ackFrame;
+            Frame decoded;
+            ReliableAck ack;
+            while (receiver.getNextOutgoingFrame(ackFrame)) {
+                sender.processReceivedData(ackFrame);
+                while (sender.getNextCompleteFrame(decoded))
+                    if (ReliableAck::deserialize(decoded.payload, ack))
+                        reliable.onAck(ack, now);
+            }
+            return frames;
+        });
+    }
+}
+
+// 发送调度: 配置通道积压时控制帧插队, 每次迭代 16 个配置帧 + 1 个控制帧
+void benchTransmitScheduler() {
+    size_t sent = 0;
+    TransmitScheduler scheduler([&](const std::vector<uint8_t> &) {
+        ++sent;
+        return true;
+    });
+    TransmitScheduler::LaneConfig config;
+    config.rateBytesPerSec = 100 * 1000;
+    config.burstBytes = 400;
+    scheduler.setLaneConfig(TransmitLane::CONFIG, config);
+
+    const std::vector<uint8_t> configFrame(100, 0x11);
+    const std::vector<uint8_t> controlFrame(10, 0x22);
+    uint64_t now = 0;
+    runBenchmark("TransmitScheduler/config+control", 17, 16 * 100 + 10, [&]() {
+        size_t before = sent;
+        for (int i = 0; i < 16; ++i)
+            scheduler.enqueue(TransmitLane::CONFIG, configFrame, now);
+        scheduler.enqueue(TransmitLane::CONTROL, controlFrame, now);
+        // 推进时间直到配置通道排空 (每毫秒补充 100 字节令牌)
+        while (!scheduler.empty())
+            scheduler.poll(++now);
+        return sent - before;
+    });
+}
+
+// 设备注册表: 256 个从机交替上报, 每次迭代每个从机 1 帧并推进 1 ms 时间轮
+void benchDeviceRegistry() {
+    DeviceRegistry registry;
+    constexpr uint32_t SLAVES = 256;
+    uint64_t now = 0;
+    for (uint32_t id = 1; id <= SLAVES; ++id)
+        registry.onTraffic(id, now);
+    runBenchmark("DeviceRegistry/onTraffic x256", SLAVES, 0, [&]() {
+        ++now;
+        for (uint32_t id = 1; id <= SLAVES; ++id)
+            registry.onTraffic(id, now);
+        registry.advance(now);
+        return registry.count(DeviceLiveness::ONLINE);
+    });
+}
+
+// 状态边沿检测: 256 个从机, 稳定状态 (无边沿) 与每帧翻转一位两种情况
+void benchDeviceStatusTracker() {
+    constexpr uint32_t SLAVES = 256;
+    DeviceStatusTracker tracker;
+    size_t edges = 0;
+    tracker.subscribe([&](const DeviceStatusEdge &) { ++edges; });
+    for (uint32_t id = 1; id <= SLAVES; ++id)
+        tracker.update(id, 0x0021);
+
+    runBenchmark("DeviceStatusTracker/steady x256", SLAVES, SLAVES * 2, [&]() {
+        for (uint32_t id = 1; id <= SLAVES; ++id)
+            tracker.update(id, 0x0021);
+        return edges;
+    });
+    uint16_t status = 0x0021;
+    runBenchmark("DeviceStatusTracker/toggle x256", SLAVES, SLAVES * 2, [&]() {
+        size_t before = edges;
+        status ^= deviceStatusMask(DeviceStatusBit::PRESSURE_SENSOR);
+        for (uint32_t id = 1; id <= SLAVES; ++id)
+            tracker.update(id, status);
+        return edges - before;
+    });
+}
+
+// 告警规则: 32 条状态规则各关心一位, 每帧只翻转 PS 一位, 只有 4 条规则需要重新计算
+void benchRuleEngine() {
+    constexpr uint32_t SLAVES = 256;
+    RuleEngine engine;
+    std::vector<RuleEngine::Rule> rules(32);
+    for (size_t i = 0; i < rules.size(); ++i) {
+        rules[i].statusMask = static_cast<uint16_t>(1u << (i % DEVICE_STATUS_BIT_COUNT));
+        rules[i].statusValue = rules[i].statusMask;
+    }
+    engine.setRules(rules);
+    for (uint32_t id = 1; id <= SLAVES; ++id)
+        engine.onStatus(id, 0, 0xFFFF, 0);
+
+    uint16_t status = 0;
+    uint64_t now = 0;
+    runBenchmark("RuleEngine/status edge x256 (32 rules)", SLAVES, 0, [&]() {
+        uint64_t before = engine.stats().evaluations;
+        status ^= deviceStatusMask(DeviceStatusBit::PRESSURE_SENSOR);
+        ++now;
+        for (uint32_t id = 1; id <= SLAVES; ++id)
+            engine.onStatus(id, status, deviceStatusMask(DeviceStatusBit::PRESSURE_SENSOR), now);
+        return engine.stats().evaluations - before;
+    });
+}
+
+// 间歇故障累加: 64 个从机各 256 字节导通数据, 每帧随机翻转 2 位
+void benchPinFlipAccumulator() {
+    constexpr uint32_t SLAVES = 64;
+    constexpr size_t LENGTH = 256;
+    std::mt19937 rng(11);
+    PinFlipAccumulator accumulator;
+    std::vector<std::vector<uint8_t>> matrices(
+        SLAVES, makeConductionMessage(LENGTH).conductionData);
+    for (uint32_t id = 0; id < SLAVES; ++id)
+        accumulator.onConduction(id + 1, matrices[id].data(), LENGTH, 0);
+
+    uint64_t now = 0;
+    runBenchmark("PinFlipAccumulator/256B x64 (2 flips)", SLAVES,
+                 SLAVES * LENGTH, [&]() {
+        size_t flips = 0;
+        ++now;
+        for (uint32_t id = 0; id < SLAVES; ++id) {
+            std::vector<uint8_t> &matrix = matrices[id];
+            for (int flip = 0; flip < 2; ++flip)
+                matrix[rng() % LENGTH] ^= static_cast<uint8_t>(1u << (rng() % 8));
+            flips += accumulator.onConduction(id + 1, matrix.data(), LENGTH, now);
+        }
+        return flips;
+    });
+    runBenchmark("PinFlipAccumulator::topN/10", 1, 0, [&]() {
+        return accumulator.topN(10, now).size();
+    });
+}
+
+// 阻值统计: 32 个从机各 64 通道, 每帧更新全部通道的 Welford 统计和限值检查
+void benchResistanceAccumulator() {
+    constexpr uint32_t SLAVES = 32;
+    constexpr uint32_t CHANNELS = 64;
+    std::mt19937 rng(13);
+    ResistanceAccumulator::Config config;
+    config.lowerLimitOhms = 1.0;
+    config.upperLimitOhms = 100.0;
+    ResistanceAccumulator accumulator(config);
+    std::vector<uint8_t> sample(CHANNELS * ResistanceAccumulator::BYTES_PER_CHANNEL);
+    for (uint8_t &byte : sample)
+        byte = static_cast<uint8_t>(rng());
+    for (uint32_t id = 1; id <= SLAVES; ++id)
+        accumulator.setChannelCount(id, CHANNELS);
+
+    runBenchmark("ResistanceAccumulator/64ch x32", SLAVES,
+                 SLAVES * sample.size(), [&]() {
+        size_t failing = 0;
+        sample[rng() % sample.size()] ^= 1;
+        for (uint32_t id = 1; id <= SLAVES; ++id)
+            failing += accumulator.onResistance(id, sample.data(), sample.size());
+        return failing;
+    });
+}
+
+// 卡钉检测: 256 个工位, 每轮 1/8 的工位有卡钉插拔, 每轮取出事件
+void benchClipTracker() {
+    constexpr uint32_t SLAVES = 256;
+    ClipTracker tracker;
+    for (uint32_t id = 1; id <= SLAVES; ++id) {
+        tracker.setExpectation(id, 0, 0x00FF, 0);
+        tracker.onClipData(id, 0x000F, 0);
+    }
+
+    std::vector<ClipTransition> transitions;
+    uint64_t now = 0;
+    uint32_t round = 0;
+    runBenchmark("ClipTracker/256 stations (1/8 changing)", SLAVES, SLAVES * 2, [&]() {
+        ++now;
+        ++round;
+        for (uint32_t id = 1; id <= SLAVES; ++id) {
+            uint16_t clipData = (id % 8 == round % 8) ? static_cast<uint16_t>(0x000F ^ (1u << (round % 8)))
+                                                      : static_cast<uint16_t>(0x000F);
+            tracker.onClipData(id, clipData, now);
+        }
+        transitions.clear();
+        return tracker.takeTransitions(transitions);
+    });
+}
+
+// 采样历史: 64 个从机各记录一帧 256 字节导通数据; 查询单个从机最近 1 秒 (约 100 条)
+void benchSampleHistory() {
+    constexpr uint32_t SLAVES = 64;
+    constexpr size_t LENGTH = 256;
+    SampleHistory history;
+    std::vector<uint8_t> sample = makeConductionMessage(LENGTH).conductionData;
+    uint64_t now = 0;
+    runBenchmark("SampleHistory::record/256B x64", SLAVES, SLAVES * LENGTH, [&]() {
+        now += 10;
+        for (uint32_t id = 1; id <= SLAVES; ++id)
+            history.record(id, HistoryKind::CONDUCTION, now, 0, sample.data(), sample.size());
+        return static_cast<size_t>(SLAVES);
+    });
+    runBenchmark("SampleHistory::query/1s", 1, 0, [&]() {
+        size_t bytes = 0;
+        history.query(1, HistoryKind::CONDUCTION, now - 1000, now,
+                      [&](uint64_t, uint16_t, const uint8_t *, size_t length) { bytes += length; });
+        return bytes / LENGTH;
+    });
+}
+
+// ---------------------------------------------------------------------------
+// 导通数据差分编码: 512 字节矩阵, 相邻采样翻转少量位
+// ---------------------------------------------------------------------------
+
+void benchConductionDelta() {
+    const size_t sampleCount = 64;
+    std::mt19937 rng(7);
+    std::vector<std::vector<uint8_t>> samples;
+    std::vector<uint8_t> matrix = makeConductionMessage(512).conductionData;
+    for (size_t i = 0; i < sampleCount; ++i) {
+        for (int flip = 0; flip < 4; ++flip)
+            matrix[rng() % matrix.size()] ^=
+                static_cast<uint8_t>(1u << (rng() % 8));
+        samples.push_back(matrix);
+    }
+    size_t rawBytes = sampleCount * matrix.size();
+
+    std::vector<Slave2Backend::ConductionDeltaMessage> messages(sampleCount);
+    {
+        ConductionDeltaEncoder encoder;
+        runBenchmark("ConductionDeltaEncoder::encode/512", sampleCount,
+                     rawBytes, [&]() {
+                         encoder.reset();
+                         for (size_t i = 0; i < sampleCount; ++i)
+                             encoder.encode(samples[i], messages[i]);
+                         return sampleCount;
+                     });
+    }
+    {
+        ConductionDeltaDecoder decoder;
+        std::vector<uint8_t> out;
+        runBenchmark("ConductionDeltaDecoder::decode/512", sampleCount,
+                     rawBytes, [&]() {
+                         size_t decoded = 0;
+                         for (const auto &message : messages)
+                             decoded += decoder.decode(1, message, out) ==
+                                        ConductionDeltaDecoder::Result::OK;
+                         return decoded;
+                     });
+    }
+    {
+        std::vector<uint8_t> dst(matrix);
+        runBenchmark("xorBytes/512", 1, matrix.size(), [&]() {
+            xorBytes(dst.data(), samples[0].data(), dst.size());
+            return size_t(1);
+        });
+    }
+}
+
+// ---------------------------------------------------------------------------
+// 各消息 deserialize
+// ---------------------------------------------------------------------------
+
+template <typename T>
+void benchDeserialize(const std::string &name, const T &sample) {
+    auto bytes = sample.serialize();
+    T decoded;
+    runBenchmark("deserialize/" + name, 1, bytes.size(), [&]() {
+        return decoded.deserialize(bytes) ? size_t(1) : size_t(0);
+    });
+}
+
+void benchMessages() {
+    // Master2Slave
+    benchDeserialize("Master2Slave::SyncMessage/40", makeSyncMessage(40));
+    {
+        Master2Slave::PingReqMessage msg;
+        msg.sequenceNumber = 1;
+        msg.timestamp = 2;
+        benchDeserialize("Master2Slave::PingReqMessage", msg);
+    }
+    {
+        Master2Slave::ShortIdAssignMessage msg;
+        msg.shortId = 3;
+        benchDeserialize("Master2Slave::ShortIdAssignMessage", msg);
+    }
+
+    // Slave2Master
+    {
+        Slave2Master::RstResponseMessage msg;
+        msg.status = 0;
+        benchDeserialize("Slave2Master::RstResponseMessage", msg);
+    }
+    benchDeserialize("Slave2Master::PingRspMessage", makePingRspMessage());
+    {
+        Slave2Master::JoinRequestMessage msg;
+        msg.deviceId = 0x12345678;
+        msg.versionMajor = 1;
+        msg.versionMinor = 0;
+        msg.versionPatch = 7;
+        benchDeserialize("Slave2Master::JoinRequestMessage", msg);
+    }
+    {
+        Slave2Master::ShortIdConfirmMessage msg;
+        msg.status = 0;
+        msg.shortId = 5;
+        benchDeserialize("Slave2Master::ShortIdConfirmMessage", msg);
+    }
+    {
+        Slave2Master::HeartbeatMessage msg;
+        msg.batteryLevel = 80;
+        benchDeserialize("Slave2Master::HeartbeatMessage", msg);
+    }
+
+    // Backend2Master
+    benchDeserialize("Backend2Master::SlaveConfigMessage/40",
+                     makeSlaveConfigMessage(40));
+    {
+        Backend2Master::ModeConfigMessage msg;
+        msg.mode = 1;
+        benchDeserialize("Backend2Master::ModeConfigMessage", msg);
+    }
+    {
+        Backend2Master::RstMessage msg;
+        msg.slaveNum = 8;
+        for (uint32_t i = 0; i < 8; ++i)
+            msg.slaves.push_back({0x10000000 + i, 1, 0x00FF});
+        benchDeserialize("Backend2Master::RstMessage/8", msg);
+    }
+    {
+        Backend2Master::CtrlMessage msg;
+        msg.runningStatus = 1;
+        benchDeserialize("Backend2Master::CtrlMessage", msg);
+    }
+    {
+        Backend2Master::PingCtrlMessage msg;
+        msg.pingMode = 0;
+        msg.pingCount = 10;
+        msg.interval = 100;
+        msg.destinationId = 0x10000000;
+        benchDeserialize("Backend2Master::PingCtrlMessage", msg);
+    }
+    {
+        Backend2Master::IntervalConfigMessage msg;
+        msg.intervalMs = 20;
+        benchDeserialize("Backend2Master::IntervalConfigMessage", msg);
+    }
+    {
+        Backend2Master::DeviceListReqMessage msg;
+        msg.reserve = 0;
+        benchDeserialize("Backend2Master::DeviceListReqMessage", msg);
+    }
+    {
+        Backend2Master::ClearDeviceListMessage msg;
+        msg.reserve = 0;
+        benchDeserialize("Backend2Master::ClearDeviceListMessage", msg);
+    }
+    {
+        Backend2Master::SetUwbChannelMessage msg;
+        msg.channel = 5;
+        benchDeserialize("Backend2Master::SetUwbChannelMessage", msg);
+    }
+
+    // Master2Backend
+    {
+        Master2Backend::SlaveConfigResponseMessage msg;
+        auto config = makeSlaveConfigMessage(40);
+        msg.status = 0;
+        msg.slaveNum = config.slaveNum;
+        for (const auto &slave : config.slaves)
+            msg.slaves.push_back({slave.id, slave.conductionNum,
+                                  slave.resistanceNum, slave.clipMode,
+                                  slave.clipStatus});
+        benchDeserialize("Master2Backend::SlaveConfigResponseMessage/40", msg);
+    }
+    {
+        Master2Backend::ModeConfigResponseMessage msg;
+        msg.status = 0;
+        msg.mode = 1;
+        benchDeserialize("Master2Backend::ModeConfigResponseMessage", msg);
+    }
+    {
+        Master2Backend::RstResponseMessage msg;
+        msg.status = 0;
+        msg.slaveNum = 8;
+        for (uint32_t i = 0; i < 8; ++i)
+            msg.slaves.push_back({0x10000000 + i, 1, 0x00FF});
+        benchDeserialize("Master2Backend::RstResponseMessage/8", msg);
+    }
+    {
+        Master2Backend::CtrlResponseMessage msg;
+        msg.status = 0;
+        msg.runningStatus = 1;
+        benchDeserialize("Master2Backend::CtrlResponseMessage", msg);
+    }
+    {
+        Master2Backend::PingResponseMessage msg;
+        msg.pingMode = 0;
+        msg.totalCount = 10;
+        msg.successCount = 9;
+        msg.destinationId = 0x10000000;
+        benchDeserialize("Master2Backend::PingResponseMessage", msg);
+    }
+    {
+        Master2Backend::IntervalConfigResponseMessage msg;
+        msg.status = 0;
+        msg.intervalMs = 20;
+        benchDeserialize("Master2Backend::IntervalConfigResponseMessage", msg);
+    }
+    benchDeserialize("Master2Backend::DeviceListResponseMessage/40",
+                     makeDeviceListMessage(40));
+    {
+        Master2Backend::SetUwbChannelResponseMessage msg;
+        msg.status = 0;
+        msg.channel = 5;
+        benchDeserialize("Master2Backend::SetUwbChannelResponseMessage", msg);
+    }
+
+    // Slave2Backend
+    benchDeserialize("Slave2Backend::ConductionDataMessage/64",
+                     makeConductionMessage(64));
+    {
+        Slave2Backend::ResistanceDataMessage msg;
+        msg.resistanceLength = 32;
+        msg.resistanceData.assign(32, 0x11);
+        benchDeserialize("Slave2Backend::ResistanceDataMessage/32", msg);
+    }
+    benchDeserialize("Slave2Backend::ConductionBatchMessage/8x8",
+                     makeConductionBatch(8, 8));
+    {
+        Slave2Backend::ClipDataMessage msg;
+        msg.clipData = 0x00FF;
+        benchDeserialize("Slave2Backend::ClipDataMessage", msg);
+    }
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--min-time-ms") == 0 && i + 1 < argc) {
+            g_config.minTimeMs = std::atof(argv[++i]);
+        } else {
+            g_config.filter = argv[i];
+        }
+    }
+
+    std::printf("%-60s %12s %12s %12s %10s\n", "benchmark", "ns/frame",
+                "MB/s", "allocs/frame", "out/iter");
+    std::printf("%s\n", std::string(110, '-').c_str());
+
+    benchFrame();
+    benchCrc32c();
+    benchPack();
+    benchReceive();
+    benchReassembly();
+    benchReliable();
+    benchTransmitScheduler();
+    benchDeviceRegistry();
+    benchDeviceStatusTracker();
+    benchRuleEngine();
+    benchPinFlipAccumulator();
+    benchResistanceAccumulator();
+    benchClipTracker();
+    benchSampleHistory();
+    benchConductionDelta();
+    benchMessages();
+
+    return 0;
+}
@@ -1,4 +1,5 @@
 #include "Slave2Backend.h"
+#include "../utils/ByteUtils.h"
 
 namespace WhtsProtocol {
 namespace Slave2Backend {
@@ -58,5 +59,135 @@ bool ClipDataMessage::deserialize(const std::vector<uint8_t> &data) {
     return true;
 }
 
+// ConductionDeltaMessage 实现
+std::vector<uint8_t> ConductionDeltaMessage::serialize() const {
+    std::vector<uint8_t> result;
+    result.reserve(HEADER_SIZE + encodedData.size());
+    result.push_back(static_cast<uint8_t>(encoding));
+    result.push_back(frameIndex);
+    result.push_back(referenceIndex);
+    ByteUtils::writeUint16LE(result, conductionLength);
+    ByteUtils::writeUint16LE(result, static_cast<uint16_t>(encodedData.size()));
+    result.insert(result.end(), encodedData.begin(), encodedData.end());
+    return result;
+}
+
+bool ConductionDeltaMessage::deserialize(const std::vector<uint8_t> &data) {
+    if (data.size() < HEADER_SIZE)
+        return false;
+    if (data[0] > static_cast<uint8_t>(Encoding::RUN_LENGTH))
+        return false;
+    uint16_t encodedLength = ByteUtils::readUint16LE(data, 5);
+    if (data.size() < HEADER_SIZE + encodedLength)
+        return false;
+    encoding = static_cast<Encoding>(data[0]);
+    frameIndex = data[1];
+    referenceIndex = data[2];
+    conductionLength = ByteUtils::readUint16LE(data, 3);
+    encodedData.assign(data.begin() + HEADER_SIZE,
+                       data.begin() + HEADER_SIZE + encodedLength);
+    return true;
+}
+
+// DataBatchMessage 实现
+std::vector<uint8_t> DataBatchMessage::sampleData(size_t index) const {
+    const uint8_t *begin = sample(index);
+    return std::vector<uint8_t>(begin, begin + sampleLength);
+}
+
+bool DataBatchMessage::append(uint16_t status,
+                              const std::vector<uint8_t> &sampleData) {
+    if (statuses.size() >= MAX_SAMPLES)
+        return false;
+    if (statuses.empty()) {
+        if (sampleData.size() > 0xFFFF)
+            return false;
+        sampleLength = static_cast<uint16_t>(sampleData.size());
+    } else if (sampleData.size() != sampleLength) {
+        return false;
+    }
+    statuses.push_back(status);
+    data.insert(data.end(), sampleData.begin(), sampleData.end());
+    return true;
+}
+
+void DataBatchMessage::clear() {
+    sampleLength = 0;
+    statuses.clear();
+    data.clear();
+}
+
+size_t DataBatchMessage::serializedSize() const {
+    size_t count = statuses.size();
+    size_t changed = 0;
+    uint16_t previous = 0;
+    for (uint16_t status : statuses) {
+        if (status != previous)
+            ++changed;
+        previous = status;
+    }
+    return HEADER_SIZE + (count + 7) / 8 + changed * 2 + count * sampleLength;
+}
+
+std::vector<uint8_t> DataBatchMessage::serialize() const {
+    size_t count = statuses.size();
+    std::vector<uint8_t> result;
+    result.reserve(serializedSize());
+    result.push_back(static_cast<uint8_t>(count));
+    ByteUtils::writeUint16LE(result, sampleLength);
+    ByteUtils::writeUint32LE(result, sampleIntervalUs);
+
+    size_t bitmapOffset = result.size();
+    result.resize(bitmapOffset + (count + 7) / 8, 0);
+    uint16_t previous = 0;
+    for (size_t i = 0; i < count; ++i) {
+        uint16_t delta = statuses[i] ^ previous;
+        previous = statuses[i];
+        if (delta == 0)
+            continue;
+        result[bitmapOffset + i / 8] |= static_cast<uint8_t>(1u << (i % 8));
+        ByteUtils::writeUint16LE(result, delta);
+    }
+
+    result.insert(result.end(), data.begin(),
+                  data.begin() + count * sampleLength);
+    return result;
+}
+
+bool DataBatchMessage::deserialize(const std::vector<uint8_t> &data) {
+    if (data.size() < HEADER_SIZE)
+        return false;
+    size_t count = data[0];
+    uint16_t length = ByteUtils::readUint16LE(data, 1);
+    uint32_t intervalUs = ByteUtils::readUint32LE(data, 3);
+
+    size_t bitmapOffset = HEADER_SIZE;
+    size_t offset = bitmapOffset + (count + 7) / 8;
+    if (data.size() < offset)
+        return false;
+
+    std::vector<uint16_t> decodedStatuses(count);
+    uint16_t previous = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (data[bitmapOffset + i / 8] & (1u << (i % 8))) {
+            if (data.size() < offset + 2)
+                return false;
+            previous ^= ByteUtils::readUint16LE(data, offset);
+            offset += 2;
+        }
+        decodedStatuses[i] = previous;
+    }
+
+    size_t dataSize = count * length;
+    if (data.size() < offset + dataSize)
+        return false;
+
+    sampleLength = length;
+    sampleIntervalUs = intervalUs;
+    statuses.swap(decodedStatuses);
+    this->data.assign(data.begin() + offset, data.begin() + offset + dataSize);
+    return true;
+}
+
 } // namespace Slave2Backend
 } // namespace WhtsProtocol
\ No newline at end of file
@@ -53,6 +53,94 @@ class ClipDataMessage : public Message {
     }
 };
 
+// 导通数据差分编码消息: 关键帧携带完整导通数据, 差分帧携带与 referenceIndex
+// 对应采样的异或差异 (稀疏索引或游程编码), 由 ConductionDeltaDecoder 还原
+// 消息体: encoding(1) + frameIndex(1) + referenceIndex(1)
+//       + conductionLength(uint16 LE) + encodedLength(uint16 LE) + encodedData
+class ConductionDeltaMessage : public Message {
+  public:
+    enum class Encoding : uint8_t {
+        KEYFRAME = 0,   // encodedData 为完整导通数据
+        SPARSE = 1,     // 若干 (字节索引 uint16 LE + 异或值) 三元组, 索引递增
+        RUN_LENGTH = 2  // 若干 (零字节数 + 字面量字节数 + 字面量); 末尾零可省略
+    };
+    static constexpr size_t HEADER_SIZE = 7;
+
+    Encoding encoding = Encoding::KEYFRAME;
+    uint8_t frameIndex = 0;       // 每个采样递增 (回绕)
+    uint8_t referenceIndex = 0;   // 差分基准采样的 frameIndex, 关键帧忽略
+    uint16_t conductionLength = 0; // 还原后的导通数据长度
+    std::vector<uint8_t> encodedData;
+
+    std::vector<uint8_t> serialize() const override;
+    bool deserialize(const std::vector<uint8_t> &data) override;
+    uint8_t getMessageId() const override {
+        return static_cast<uint8_t>(
+            Slave2BackendMessageId::CONDUCTION_DELTA_MSG);
+    }
+    const char* getMessageTypeName() const override {
+        return "Conduction Delta";
+    }
+};
+
+// 批量数据消息: 一帧携带同一从机连续多次等长采样, 省去每次采样的帧头和载荷头
+// 消息体: 采样数(1) + 采样长度(uint16 LE) + 采样间隔us(uint32 LE)
+//       + 状态变化位图(ceil(采样数/8), bit i 对应第 i 个采样)
+//       + 变化采样的状态差异(uint16 LE, 与前一采样状态异或, 首个采样相对 0)
+//       + 采样数据(采样数 * 采样长度, 连续存放)
+// 载荷头中的 DeviceStatus 为最后一个采样的状态; 带扩展头时序号和时间戳
+// 对应第一个采样, 第 i 个采样为 sequence + i, timestampUs + i * sampleIntervalUs
+class DataBatchMessage : public Message {
+  public:
+    static constexpr size_t MAX_SAMPLES = 255;
+    // 采样数 + 采样长度 + 采样间隔
+    static constexpr size_t HEADER_SIZE = 7;
+
+    uint16_t sampleLength = 0;
+    uint32_t sampleIntervalUs = 0;
+    // 每个采样的完整状态, 差异编码只发生在线上格式中
+    std::vector<uint16_t> statuses;
+    std::vector<uint8_t> data;
+
+    size_t sampleCount() const { return statuses.size(); }
+    const uint8_t *sample(size_t index) const {
+        return data.data() + index * sampleLength;
+    }
+    std::vector<uint8_t> sampleData(size_t index) const;
+
+    // 首个采样决定采样长度; 长度不一致或已满时返回 false
+    bool append(uint16_t status, const std::vector<uint8_t> &sampleData);
+    void clear();
+
+    // 序列化后的消息体长度, 用于发送端在 MTU 内决定批量大小
+    size_t serializedSize() const;
+
+    std::vector<uint8_t> serialize() const override;
+    bool deserialize(const std::vector<uint8_t> &data) override;
+};
+
+class ConductionBatchMessage : public DataBatchMessage {
+  public:
+    uint8_t getMessageId() const override {
+        return static_cast<uint8_t>(
+            Slave2BackendMessageId::CONDUCTION_BATCH_MSG);
+    }
+    const char* getMessageTypeName() const override {
+        return "Conduction Batch";
+    }
+};
+
+class ResistanceBatchMessage : public DataBatchMessage {
+  public:
+    uint8_t getMessageId() const override {
+        return static_cast<uint8_t>(
+            Slave2BackendMessageId::RESISTANCE_BATCH_MSG);
+    }
+    const char* getMessageTypeName() const override {
+        return "Resistance Batch";
+    }
+};
+
 } // namespace Slave2Backend
 } // namespace WhtsProtocol
 
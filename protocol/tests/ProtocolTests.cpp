@@ -0,0 +1,518 @@
+// WHTS 协议库回归测试
+//
+// 用法: ProtocolTests [过滤子串]
+//
+// 自包含, 无第三方依赖。每个用例失败时打印位置和表达式, 有失败时退出码非 0。
+
+#include "ConductionDelta.h"
+#include "ProtocolProcessor.h"
+#include "ReliableTransport.h"
+#include "messages/Slave2Backend.h"
+#include "utils/Crc32c.h"
+
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace WhtsProtocol;
+
+namespace {
+
+int g_failures = 0;
+
+#define CHECK(expr)                                                          \
+    do {                                                                     \
+        if (!(expr)) {                                                       \
+            std::printf("  %s:%d: CHECK(%s) failed\n", __FILE__, __LINE__,   \
+                        #expr);                                              \
+            ++g_failures;                                                    \
+        }                                                                    \
+    } while (0)
+
+// ---------------------------------------------------------------------------
+// 辅助函数
+// ---------------------------------------------------------------------------
+
+DeviceStatus makeDeviceStatus(uint16_t value = 0x0065) {
+    DeviceStatus status;
+    status.fromUint16(value);
+    return status;
+}
+
+Slave2Backend::ConductionDataMessage makeConductionMessage(size_t length,
+                                                           uint8_t seed = 11) {
+    Slave2Backend::ConductionDataMessage msg;
+    msg.conductionLength = static_cast<uint16_t>(length);
+    msg.conductionData.resize(length);
+    for (size_t i = 0; i < length; ++i)
+        msg.conductionData[i] = static_cast<uint8_t>(i * 37 + seed);
+    return msg;
+}
+
+std::vector<uint8_t> concat(const std::vector<std::vector<uint8_t>> &frames) {
+    std::vector<uint8_t> stream;
+    for (const auto &frame : frames)
+        stream.insert(stream.end(), frame.begin(), frame.end());
+    return stream;
+}
+
+std::vector<Frame> drain(ProtocolProcessor &processor) {
+    std::vector<Frame> frames;
+    Frame frame;
+    while (processor.getNextCompleteFrame(frame))
+        frames.push_back(frame);
+    return frames;
+}
+
+uint64_t crcErrors(const ProtocolProcessor &processor) {
+    return processor.getStats().snapshot().get(StatCounter::CRC_ERRORS);
+}
+
+// 打包一条导通数据消息并在接收端解析, 返回解析出的消息 (失败时为空)
+std::unique_ptr<Message>
+roundTrip(ProtocolProcessor &sender, ProtocolProcessor &receiver,
+          const Message &msg, const Slave2BackendExtension &extension,
+          uint32_t &slaveId, DeviceStatus &status,
+          Slave2BackendExtension &parsedExtension) {
+    receiver.processReceivedData(concat(sender.packSlave2BackendMessage(
+        0x20000001, makeDeviceStatus(), msg, extension)));
+    auto frames = drain(receiver);
+    std::unique_ptr<Message> parsed;
+    if (frames.size() != 1 ||
+        frames[0].packetId != static_cast<uint8_t>(PacketId::SLAVE_TO_BACKEND))
+        return parsed;
+    if (!receiver.parseSlave2BackendPacket(frames[0].payload, slaveId, status,
+                                           parsed, parsedExtension))
+        parsed.reset();
+    return parsed;
+}
+
+// ---------------------------------------------------------------------------
+// 用例
+// ---------------------------------------------------------------------------
+
+// 导通数据打包/解析往返, 带与不带扩展头, 单帧与分片
+void testSlave2BackendRoundTrip() {
+    for (size_t length : {16u, 700u}) {
+        for (bool withExtension : {false, true}) {
+            ProtocolProcessor sender;
+            ProtocolProcessor receiver;
+            auto msg = makeConductionMessage(length);
+            Slave2BackendExtension extension;
+            extension.present = withExtension;
+            extension.sequence = 0xBEEF;
+            extension.timestampUs = 0x12345678;
+
+            uint32_t slaveId = 0;
+            DeviceStatus status;
+            Slave2BackendExtension parsedExtension;
+            parsedExtension.present = !withExtension;
+            auto parsed = roundTrip(sender, receiver, msg, extension, slaveId,
+                                    status, parsedExtension);
+            CHECK(parsed != nullptr);
+            if (!parsed)
+                continue;
+            auto *conduction =
+                dynamic_cast<Slave2Backend::ConductionDataMessage *>(
+                    parsed.get());
+            CHECK(conduction != nullptr);
+            if (conduction)
+                CHECK(conduction->conductionData == msg.conductionData);
+            CHECK(slaveId == 0x20000001);
+            CHECK(status.toUint16() == 0x0065);
+            CHECK(parsedExtension.present == withExtension);
+            if (withExtension) {
+                CHECK(parsedExtension.sequence == 0xBEEF);
+                CHECK(parsedExtension.timestampUs == 0x12345678);
+            }
+        }
+    }
+}
+
+// 批量消息往返: 每个采样的状态和数据都应还原
+void testConductionBatchRoundTrip() {
+    Slave2Backend::ConductionBatchMessage batch;
+    batch.sampleIntervalUs = 5000;
+    auto sample = makeConductionMessage(24).conductionData;
+    for (size_t i = 0; i < 8; ++i) {
+        sample[i] ^= 0x01;
+        CHECK(batch.append(i % 3 == 0 ? 0x0065 : 0x0067, sample));
+    }
+    // 长度不一致的采样应被拒绝
+    CHECK(!batch.append(0x0065, std::vector<uint8_t>(23)));
+
+    ProtocolProcessor sender;
+    ProtocolProcessor receiver;
+    Slave2BackendExtension extension;
+    extension.present = true;
+    extension.sequence = 7;
+    uint32_t slaveId = 0;
+    DeviceStatus status;
+    Slave2BackendExtension parsedExtension;
+    auto parsed = roundTrip(sender, receiver, batch, extension, slaveId,
+                            status, parsedExtension);
+    auto *decoded =
+        dynamic_cast<Slave2Backend::ConductionBatchMessage *>(parsed.get());
+    CHECK(decoded != nullptr);
+    if (!decoded)
+        return;
+    CHECK(decoded->sampleIntervalUs == 5000);
+    CHECK(decoded->sampleCount() == batch.sampleCount());
+    CHECK(decoded->statuses == batch.statuses);
+    CHECK(decoded->data == batch.data);
+    CHECK(parsedExtension.sequence == 7);
+}
+
+// 差分编码: 无丢失时逐帧还原; 丢失后报告 REFERENCE_MISSING,
+// 之后等待关键帧, 收到关键帧后恢复
+void testConductionDelta() {
+    const size_t length = 64;
+    const size_t count = 40;
+    std::vector<std::vector<uint8_t>> samples;
+    auto sample = makeConductionMessage(length).conductionData;
+    for (size_t i = 0; i < count; ++i) {
+        sample[(i * 7) % length] ^= 0x10;
+        samples.push_back(sample);
+    }
+
+    ConductionDeltaEncoder encoder(8);
+    std::vector<Slave2Backend::ConductionDeltaMessage> encoded(count);
+    for (size_t i = 0; i < count; ++i)
+        encoder.encode(samples[i], encoded[i]);
+    CHECK(encoded[0].encoding ==
+          Slave2Backend::ConductionDeltaMessage::Encoding::KEYFRAME);
+    size_t deltas = 0;
+    for (const auto &msg : encoded)
+        if (msg.encoding !=
+            Slave2Backend::ConductionDeltaMessage::Encoding::KEYFRAME)
+            ++deltas;
+    CHECK(deltas > 0);
+
+    // 经过序列化往返后逐帧还原
+    {
+        ConductionDeltaDecoder decoder;
+        std::vector<uint8_t> out;
+        for (size_t i = 0; i < count; ++i) {
+            Slave2Backend::ConductionDeltaMessage wire;
+            CHECK(wire.deserialize(encoded[i].serialize()));
+            CHECK(decoder.decode(1, wire, out) ==
+                  ConductionDeltaDecoder::Result::OK);
+            CHECK(out == samples[i]);
+        }
+    }
+
+    // 丢失一个差分采样
+    size_t dropped = 0;
+    for (size_t i = 1; i < count; ++i) {
+        if (encoded[i].encoding !=
+                Slave2Backend::ConductionDeltaMessage::Encoding::KEYFRAME &&
+            i + 1 < count &&
+            encoded[i + 1].encoding !=
+                Slave2Backend::ConductionDeltaMessage::Encoding::KEYFRAME) {
+            dropped = i;
+            break;
+        }
+    }
+    CHECK(dropped > 0);
+    if (dropped == 0)
+        return;
+
+    ConductionDeltaDecoder decoder;
+    std::vector<uint8_t> out;
+    bool reported = false;
+    bool recovered = false;
+    for (size_t i = 0; i < count; ++i) {
+        if (i == dropped)
+            continue;
+        auto result = decoder.decode(1, encoded[i], out);
+        if (i < dropped) {
+            CHECK(result == ConductionDeltaDecoder::Result::OK);
+        } else if (!recovered &&
+                   encoded[i].encoding == Slave2Backend::ConductionDeltaMessage::
+                                              Encoding::KEYFRAME) {
+            CHECK(result == ConductionDeltaDecoder::Result::OK);
+            CHECK(out == samples[i]);
+            recovered = true;
+        } else if (!recovered) {
+            CHECK(result == (reported
+                                 ? ConductionDeltaDecoder::Result::WAITING_KEYFRAME
+                                 : ConductionDeltaDecoder::Result::
+                                       REFERENCE_MISSING));
+            reported = true;
+        } else {
+            CHECK(result == ConductionDeltaDecoder::Result::OK);
+            CHECK(out == samples[i]);
+        }
+    }
+    CHECK(reported);
+    CHECK(recovered);
+
+    // 其它从机的状态互不影响
+    CHECK(decoder.decode(2, encoded[1], out) ==
+          ConductionDeltaDecoder::Result::REFERENCE_MISSING);
+}
+
+// CRC-32C 标准测试向量, 硬件实现与查表实现一致
+void testCrc32c() {
+    const char *check = "123456789";
+    const auto *data = reinterpret_cast<const uint8_t *>(check);
+    CHECK(Crc32c::compute(data, 9) == 0xE3069283u);
+    CHECK(Crc32c::computePortable(data, 9) == 0xE3069283u);
+    // 分段计算与一次计算相同
+    CHECK(Crc32c::compute(data + 4, 5, Crc32c::compute(data, 4)) ==
+          0xE3069283u);
+
+    std::vector<uint8_t> buffer(1031);
+    for (size_t i = 0; i < buffer.size(); ++i)
+        buffer[i] = static_cast<uint8_t>(i * 131 + 7);
+    for (size_t offset = 0; offset < 8; ++offset) {
+        for (size_t length : {0u, 1u, 7u, 8u, 15u, 64u, 1023u}) {
+            CHECK(Crc32c::compute(buffer.data() + offset, length) ==
+                  Crc32c::computePortable(buffer.data() + offset, length));
+        }
+    }
+}
+
+// 校验失败的帧被丢弃, 接收端重新同步到下一个帧头
+void testCrcResync() {
+    ProtocolProcessor sender;
+    sender.setCrcMode(CrcMode::ON);
+    std::vector<std::vector<uint8_t>> frames;
+    for (uint8_t seed : {1, 2, 3}) {
+        auto packed = sender.packSlave2BackendMessage(
+            0x20000001, makeDeviceStatus(), makeConductionMessage(32, seed));
+        CHECK(packed.size() == 1);
+        frames.push_back(packed.front());
+    }
+    // 损坏中间一帧的载荷
+    frames[1][frames[1].size() / 2] ^= 0x5A;
+
+    std::vector<uint8_t> stream = {0x00, 0x13, 0x37};
+    auto body = concat(frames);
+    stream.insert(stream.end(), body.begin(), body.end());
+
+    ProtocolProcessor receiver;
+    receiver.processReceivedData(stream);
+    auto decoded = drain(receiver);
+    CHECK(decoded.size() == 2);
+    CHECK(crcErrors(receiver) == 1);
+    if (decoded.size() != 2)
+        return;
+
+    const uint8_t expectedSeeds[] = {1, 3};
+    for (size_t i = 0; i < decoded.size(); ++i) {
+        uint32_t slaveId = 0;
+        DeviceStatus status;
+        std::unique_ptr<Message> msg;
+        CHECK(receiver.parseSlave2BackendPacket(decoded[i].payload, slaveId,
+                                                status, msg));
+        auto *conduction =
+            dynamic_cast<Slave2Backend::ConductionDataMessage *>(msg.get());
+        CHECK(conduction != nullptr);
+        if (conduction)
+            CHECK(conduction->conductionData ==
+                  makeConductionMessage(32, expectedSeeds[i]).conductionData);
+    }
+}
+
+// AUTO 模式: 协商前接受不带校验尾的帧, 收到有效校验帧后开始校验并拒绝
+void testCrcAutoRejectsUntrailed() {
+    ProtocolProcessor plain;
+    plain.setCrcMode(CrcMode::OFF);
+    ProtocolProcessor checked;
+    checked.setCrcMode(CrcMode::ON);
+    const auto msg = makeConductionMessage(32);
+
+    ProtocolProcessor receiver;
+    receiver.setCrcMode(CrcMode::AUTO);
+    CHECK(!receiver.isCrcActive());
+
+    receiver.processReceivedData(concat(
+        plain.packSlave2BackendMessage(0x20000001, makeDeviceStatus(), msg)));
+    CHECK(drain(receiver).size() == 1);
+    CHECK(!receiver.isCrcActive());
+
+    receiver.processReceivedData(concat(
+        checked.packSlave2BackendMessage(0x20000001, makeDeviceStatus(), msg)));
+    CHECK(drain(receiver).size() == 1);
+    CHECK(receiver.isCrcActive());
+
+    receiver.processReceivedData(concat(
+        plain.packSlave2BackendMessage(0x20000001, makeDeviceStatus(), msg)));
+    CHECK(drain(receiver).empty());
+    CHECK(crcErrors(receiver) == 1);
+
+    // 重新设置模式清除协商状态
+    receiver.setCrcMode(CrcMode::AUTO);
+    CHECK(!receiver.isCrcActive());
+}
+
+// 模拟丢包 (双向) 下的可靠分片: 每条消息恰好交付一次且内容完整
+void testReliableUnderLoss() {
+    for (double loss : {0.1, 0.3, 0.5}) {
+        std::mt19937 rng(static_cast<uint32_t>(loss * 1000));
+        std::bernoulli_distribution drop(loss);
+
+        ProtocolProcessor sender;
+        ProtocolProcessor receiver;
+        std::vector<std::vector<uint8_t>> toReceiver;
+        ReliableSender reliable(sender, [&](const std::vector<uint8_t> &f) {
+            if (!drop(rng))
+                toReceiver.push_back(f);
+            return true;
+        });
+        ReliableSender::Config config;
+        config.maxTimeouts = 64;
+        reliable.setConfig(config);
+
+        size_t completed = 0;
+        size_t delivered = 0;
+        reliable.setCompletion([&](const ReliableSender::Result &result) {
+            ++completed;
+            if (result.delivered)
+                ++delivered;
+        });
+
+        const size_t messageCount = 8;
+        std::vector<std::vector<uint8_t>> expected;
+        uint64_t now = 0;
+        for (size_t i = 0; i < messageCount; ++i) {
+            auto frame = sender.packSlave2BackendMessageSingle(
+                0x20000001, makeDeviceStatus(),
+                makeConductionMessage(600, static_cast<uint8_t>(i)));
+            reliable.send(frame, now);
+            expected.push_back(frame);
+        }
+
+        std::vector<Frame> received;
+        std::vector<uint8_t> ackFrame;
+        Frame decoded;
+        ReliableAck ack;
+        while (reliable.busy() && now < 600000) {
+            now += 5;
+            for (const auto &datagram : toReceiver)
+                receiver.processReceivedData(datagram);
+            toReceiver.clear();
+            Frame frame;
+            while (receiver.getNextCompleteFrame(frame))
+                received.push_back(frame);
+            while (receiver.getNextOutgoingFrame(ackFrame)) {
+                if (drop(rng))
+                    continue;
+                sender.processReceivedData(ackFrame);
+                while (sender.getNextCompleteFrame(decoded))
+                    if (ReliableAck::deserialize(decoded.payload, ack))
+                        reliable.onAck(ack, now);
+            }
+            reliable.poll(now);
+        }
+
+        CHECK(!reliable.busy());
+        CHECK(completed == messageCount);
+        CHECK(delivered == messageCount);
+        CHECK(reliable.stats().fragmentsRetransmitted > 0);
+        CHECK(received.size() == messageCount);
+        for (size_t i = 0; i < received.size() && i < messageCount; ++i) {
+            Frame original;
+            CHECK(receiver.parseFrame(expected[i], original));
+            CHECK(received[i].payload == original.payload);
+        }
+    }
+}
+
+// 本地发送失败不计为丢包: 不退避 RTO, 恢复后重发整轮并交付
+void testReliableTransmitFailure() {
+    ProtocolProcessor sender;
+    ProtocolProcessor receiver;
+    bool writable = false;
+    size_t attempts = 0;
+    std::vector<std::vector<uint8_t>> toReceiver;
+    ReliableSender reliable(sender, [&](const std::vector<uint8_t> &f) {
+        ++attempts;
+        if (!writable)
+            return false;
+        toReceiver.push_back(f);
+        return true;
+    });
+    bool delivered = false;
+    reliable.setCompletion([&](const ReliableSender::Result &result) {
+        delivered = result.delivered;
+    });
+
+    const uint32_t initialRto = reliable.rtoMs();
+    auto frame = sender.packSlave2BackendMessageSingle(
+        0x20000001, makeDeviceStatus(), makeConductionMessage(600));
+    uint64_t now = 0;
+    reliable.send(frame, now);
+    // 首个分片失败后本轮不再继续尝试
+    CHECK(attempts == 1);
+    CHECK(reliable.stats().transmitFailures == 1);
+    CHECK(reliable.stats().fragmentsSent == 0);
+
+    now += ReliableSender::Config().minRtoMs;
+    reliable.poll(now);
+    CHECK(attempts == 2);
+    CHECK(reliable.rtoMs() == initialRto);
+    CHECK(reliable.stats().timeouts == 0);
+
+    writable = true;
+    now += ReliableSender::Config().minRtoMs;
+    reliable.poll(now);
+    CHECK(toReceiver.size() > 1);
+    for (const auto &datagram : toReceiver)
+        receiver.processReceivedData(datagram);
+    CHECK(drain(receiver).size() == 1);
+    std::vector<uint8_t> ackFrame;
+    Frame decoded;
+    ReliableAck ack;
+    while (receiver.getNextOutgoingFrame(ackFrame)) {
+        sender.processReceivedData(ackFrame);
+        while (sender.getNextCompleteFrame(decoded))
+            if (ReliableAck::deserialize(decoded.payload, ack))
+                reliable.onAck(ack, now);
+    }
+    CHECK(delivered);
+    CHECK(!reliable.busy());
+}
+
+struct TestCase {
+    const char *name;
+    void (*fn)();
+};
+
+const TestCase g_tests[] = {
+    {"slave2backend/roundtrip", testSlave2BackendRoundTrip},
+    {"batch/roundtrip", testConductionBatchRoundTrip},
+    {"delta/decode", testConductionDelta},
+    {"crc/vector", testCrc32c},
+    {"crc/resync", testCrcResync},
+    {"crc/auto", testCrcAutoRejectsUntrailed},
+    {"reliable/loss", testReliableUnderLoss},
+    {"reliable/transmit-failure", testReliableTransmitFailure},
+};
+
+} // namespace
+
+int main(int argc, char **argv) {
+    const std::string filter = argc > 1 ? argv[1] : "";
+    int failedTests = 0;
+    int ran = 0;
+    for (const auto &test : g_tests) {
+        if (!filter.empty() && std::string(test.name).find(filter) ==
+                                   std::string::npos)
+            continue;
+        const int before = g_failures;
+        test.fn();
+        ++ran;
+        const bool ok = g_failures == before;
+        if (!ok)
+            ++failedTests;
+        std::printf("[%s] %s\n", ok ? " OK " : "FAIL", test.name);
+    }
+    std::printf("%d/%d passed\n", ran - failedTests, ran);
+    return failedTests == 0 ? 0 : 1;
+}
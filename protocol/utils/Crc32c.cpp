@@ -0,0 +1,151 @@
+#include "Crc32c.h"
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) ||            \
+    defined(_M_IX86)
+#define WHTS_CRC32C_X86 1
+#include <nmmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#elif defined(__ARM_FEATURE_CRC32)
+#define WHTS_CRC32C_ARM 1
+#include <arm_acle.h>
+#endif
+
+namespace WhtsProtocol {
+
+namespace {
+constexpr uint32_t POLYNOMIAL = 0x82F63B78;
+
+struct SlicingTables {
+    uint32_t table[8][256];
+
+    SlicingTables() {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; ++bit)
+                crc = (crc >> 1) ^ ((crc & 1) ? POLYNOMIAL : 0);
+            table[0][i] = crc;
+        }
+        for (uint32_t i = 0; i < 256; ++i) {
+            for (int k = 1; k < 8; ++k) {
+                uint32_t previous = table[k - 1][i];
+                table[k][i] = (previous >> 8) ^ table[0][previous & 0xFF];
+            }
+        }
+    }
+};
+
+const SlicingTables &slicingTables() {
+    static const SlicingTables tables;
+    return tables;
+}
+
+uint32_t readUint32LE(const uint8_t *p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) |
+           (static_cast<uint32_t>(p[3]) << 24);
+}
+
+// crc 为取反后的中间值
+uint32_t updatePortable(uint32_t crc, const uint8_t *data, size_t length) {
+    const auto &t = slicingTables().table;
+    while (length >= 8) {
+        uint32_t low = crc ^ readUint32LE(data);
+        uint32_t high = readUint32LE(data + 4);
+        crc = t[7][low & 0xFF] ^ t[6][(low >> 8) & 0xFF] ^
+              t[5][(low >> 16) & 0xFF] ^ t[4][low >> 24] ^
+              t[3][high & 0xFF] ^ t[2][(high >> 8) & 0xFF] ^
+              t[1][(high >> 16) & 0xFF] ^ t[0][high >> 24];
+        data += 8;
+        length -= 8;
+    }
+    while (length--)
+        crc = t[0][(crc ^ *data++) & 0xFF] ^ (crc >> 8);
+    return crc;
+}
+
+#if defined(WHTS_CRC32C_X86)
+#if defined(__GNUC__) || defined(__clang__)
+__attribute__((target("sse4.2")))
+#endif
+uint32_t updateHardware(uint32_t crc, const uint8_t *data, size_t length) {
+#if defined(__x86_64__) || defined(_M_X64)
+    uint64_t crc64 = crc;
+    while (length >= 8) {
+        uint64_t word;
+        std::memcpy(&word, data, sizeof(word));
+        crc64 = _mm_crc32_u64(crc64, word);
+        data += 8;
+        length -= 8;
+    }
+    crc = static_cast<uint32_t>(crc64);
+#endif
+    while (length >= 4) {
+        uint32_t word;
+        std::memcpy(&word, data, sizeof(word));
+        crc = _mm_crc32_u32(crc, word);
+        data += 4;
+        length -= 4;
+    }
+    while (length--)
+        crc = _mm_crc32_u8(crc, *data++);
+    return crc;
+}
+
+bool cpuSupportsSse42() {
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 20)) != 0;
+#else
+    return __builtin_cpu_supports("sse4.2");
+#endif
+}
+#elif defined(WHTS_CRC32C_ARM)
+uint32_t updateHardware(uint32_t crc, const uint8_t *data, size_t length) {
+    while (length >= 8) {
+        uint64_t word;
+        std::memcpy(&word, data, sizeof(word));
+        crc = __crc32cd(crc, word);
+        data += 8;
+        length -= 8;
+    }
+    while (length--)
+        crc = __crc32cb(crc, *data++);
+    return crc;
+}
+#endif
+
+using UpdateFunction = uint32_t (*)(uint32_t, const uint8_t *, size_t);
+
+UpdateFunction selectUpdate() {
+#if defined(WHTS_CRC32C_X86)
+    if (cpuSupportsSse42())
+        return updateHardware;
+#elif defined(WHTS_CRC32C_ARM)
+    return updateHardware;
+#endif
+    return updatePortable;
+}
+
+UpdateFunction activeUpdate() {
+    static const UpdateFunction update = selectUpdate();
+    return update;
+}
+} // namespace
+
+uint32_t Crc32c::compute(const uint8_t *data, size_t length, uint32_t crc) {
+    return ~activeUpdate()(~crc, data, length);
+}
+
+uint32_t Crc32c::computePortable(const uint8_t *data, size_t length,
+                                 uint32_t crc) {
+    return ~updatePortable(~crc, data, length);
+}
+
+bool Crc32c::hardwareAccelerated() { return activeUpdate() != updatePortable; }
+
+} // namespace WhtsProtocol
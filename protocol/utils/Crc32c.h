@@ -0,0 +1,25 @@
+#ifndef WHTS_PROTOCOL_CRC32C_H
+#define WHTS_PROTOCOL_CRC32C_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace WhtsProtocol {
+
+// CRC-32C (Castagnoli, 反射多项式 0x82F63B78, 初值和结果取反)
+// x86 CPU 支持 SSE4.2 时使用 crc32 指令 (运行时检测), ARMv8 带 CRC 扩展时
+// 使用 __crc32c* (编译期), 否则使用 slicing-by-8 查表
+class Crc32c {
+  public:
+    // crc 为上一段的结果, 用于分段计算
+    static uint32_t compute(const uint8_t *data, size_t length,
+                            uint32_t crc = 0);
+    // 查表实现, 结果与 compute 相同 (用于对比测试)
+    static uint32_t computePortable(const uint8_t *data, size_t length,
+                                    uint32_t crc = 0);
+    static bool hardwareAccelerated();
+};
+
+} // namespace WhtsProtocol
+
+#endif // WHTS_PROTOCOL_CRC32C_H
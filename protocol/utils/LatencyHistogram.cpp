@@ -0,0 +1,127 @@
+#include "LatencyHistogram.h"
+
+#include <cmath>
+
+namespace WhtsProtocol {
+
+namespace {
+
+// 最高有效位的位置 (value != 0), 固定 6 步二分, 不依赖编译器内建函数
+unsigned highestBit(uint64_t value) {
+    unsigned bit = 0;
+    if (value >> 32) {
+        value >>= 32;
+        bit += 32;
+    }
+    if (value >> 16) {
+        value >>= 16;
+        bit += 16;
+    }
+    if (value >> 8) {
+        value >>= 8;
+        bit += 8;
+    }
+    if (value >> 4) {
+        value >>= 4;
+        bit += 4;
+    }
+    if (value >> 2) {
+        value >>= 2;
+        bit += 2;
+    }
+    if (value >> 1) {
+        bit += 1;
+    }
+    return bit;
+}
+
+} // namespace
+
+LatencyHistogram::LatencyHistogram() { reset(); }
+
+void LatencyHistogram::reset() {
+    counts_.fill(0);
+    count_ = 0;
+    sum_ = 0;
+    min_ = UINT64_MAX;
+    max_ = 0;
+}
+
+// 桶布局:
+//   [0, SUB_BUCKET_COUNT)            线性桶, 每个值一个桶
+//   之后每个 2 的幂区间再细分为 SUB_BUCKET_COUNT 个等宽桶
+size_t LatencyHistogram::bucketIndex(uint64_t value) {
+    if (value < SUB_BUCKET_COUNT)
+        return static_cast<size_t>(value);
+    if (value > MAX_VALUE)
+        value = MAX_VALUE;
+
+    unsigned exponent = highestBit(value) - SUB_BUCKET_BITS;
+    size_t subBucket =
+        static_cast<size_t>(value >> exponent) - SUB_BUCKET_COUNT;
+    return SUB_BUCKET_COUNT + exponent * SUB_BUCKET_COUNT + subBucket;
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(size_t index) {
+    if (index < SUB_BUCKET_COUNT)
+        return index;
+
+    size_t offset = index - SUB_BUCKET_COUNT;
+    unsigned exponent = static_cast<unsigned>(offset / SUB_BUCKET_COUNT);
+    uint64_t subBucket = offset % SUB_BUCKET_COUNT;
+    uint64_t lower = (SUB_BUCKET_COUNT + subBucket) << exponent;
+    return lower + (1ull << exponent) - 1;
+}
+
+void LatencyHistogram::record(uint64_t value) {
+    ++counts_[bucketIndex(value)];
+    ++count_;
+    sum_ += value;
+    if (value < min_)
+        min_ = value;
+    if (value > max_)
+        max_ = value;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram &other) {
+    for (size_t i = 0; i < BUCKET_COUNT; ++i)
+        counts_[i] += other.counts_[i];
+    count_ += other.count_;
+    sum_ += other.sum_;
+    if (other.count_ && other.min_ < min_)
+        min_ = other.min_;
+    if (other.max_ > max_)
+        max_ = other.max_;
+}
+
+double LatencyHistogram::mean() const {
+    return count_ ? static_cast<double>(sum_) / static_cast<double>(count_)
+                  : 0.0;
+}
+
+uint64_t LatencyHistogram::percentile(double p) const {
+    if (count_ == 0)
+        return 0;
+    if (p <= 0)
+        return min_;
+    if (p >= 100)
+        return max_;
+
+    // 目标样本序号 (向上取整, 至少为 1)
+    uint64_t target =
+        static_cast<uint64_t>(std::ceil(p / 100.0 * static_cast<double>(count_)));
+    if (target == 0)
+        target = 1;
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+        seen += counts_[i];
+        if (seen >= target) {
+            uint64_t upper = bucketUpperBound(i);
+            return upper < max_ ? upper : max_;
+        }
+    }
+    return max_;
+}
+
+} // namespace WhtsProtocol
@@ -0,0 +1,51 @@
+#ifndef WHTS_PROTOCOL_LATENCY_HISTOGRAM_H
+#define WHTS_PROTOCOL_LATENCY_HISTOGRAM_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace WhtsProtocol {
+
+// HDR 风格的对数-线性直方图
+// - 固定内存: 所有桶在对象内部, 不做动态分配
+// - O(1) 记录: 桶下标由最高有效位和其后 SUB_BUCKET_BITS 位直接算出
+// - 相对误差 <= 1 / 2^SUB_BUCKET_BITS (约 3%)
+// 数值单位由调用方决定 (通常为纳秒), 超过上限的值按上限计入。
+class LatencyHistogram {
+  public:
+    static constexpr unsigned SUB_BUCKET_BITS = 5;
+    static constexpr unsigned SUB_BUCKET_COUNT = 1u << SUB_BUCKET_BITS;
+    static constexpr unsigned MAX_VALUE_BITS = 37; // 约 137 秒 (纳秒单位)
+    static constexpr uint64_t MAX_VALUE = (1ull << MAX_VALUE_BITS) - 1;
+    static constexpr size_t BUCKET_COUNT =
+        (MAX_VALUE_BITS - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT;
+
+    LatencyHistogram();
+
+    void record(uint64_t value);
+    void reset();
+    void merge(const LatencyHistogram &other);
+
+    uint64_t count() const { return count_; }
+    uint64_t min() const { return count_ ? min_ : 0; }
+    uint64_t max() const { return max_; }
+    double mean() const;
+
+    // 返回第 p 百分位 (0-100) 的值, 取所在桶的上界
+    uint64_t percentile(double p) const;
+
+  private:
+    static size_t bucketIndex(uint64_t value);
+    static uint64_t bucketUpperBound(size_t index);
+
+    std::array<uint32_t, BUCKET_COUNT> counts_;
+    uint64_t count_;
+    uint64_t sum_;
+    uint64_t min_;
+    uint64_t max_;
+};
+
+} // namespace WhtsProtocol
+
+#endif // WHTS_PROTOCOL_LATENCY_HISTOGRAM_H
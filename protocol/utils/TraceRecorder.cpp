@@ -0,0 +1,165 @@
+#include "TraceRecorder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+
+namespace WhtsProtocol {
+
+namespace {
+
+// JSON 字符串转义 (跨度名和线程名通常是纯 ASCII 字面量)
+void appendEscaped(std::string &out, const std::string &text) {
+    for (char c : text) {
+        switch (c) {
+        case '"':
+            out += "\\\"";
+            break;
+        case '\\':
+            out += "\\\\";
+            break;
+        case '\n':
+            out += "\\n";
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                out += escaped;
+            } else {
+                out += c;
+            }
+            break;
+        }
+    }
+}
+
+// 纳秒 -> 微秒字符串, 保留 3 位小数
+void appendMicros(std::string &out, uint64_t ns) {
+    char text[32];
+    std::snprintf(text, sizeof(text), "%llu.%03llu",
+                  static_cast<unsigned long long>(ns / 1000),
+                  static_cast<unsigned long long>(ns % 1000));
+    out += text;
+}
+
+} // namespace
+
+TraceRecorder &TraceRecorder::instance() {
+    static TraceRecorder recorder;
+    return recorder;
+}
+
+uint64_t TraceRecorder::nowNs() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+}
+
+TraceRecorder::ThreadBuffer &TraceRecorder::localBuffer() {
+    // 缓冲区由注册表共同持有, 线程退出后其事件仍可导出
+    thread_local std::shared_ptr<ThreadBuffer> buffer;
+    if (!buffer) {
+        buffer = std::make_shared<ThreadBuffer>();
+        buffer->events.resize(EVENTS_PER_THREAD);
+        std::lock_guard<std::mutex> lock(registryMutex_);
+        buffer->tid = static_cast<uint32_t>(buffers_.size() + 1);
+        buffers_.push_back(buffer);
+    }
+    return *buffer;
+}
+
+void TraceRecorder::setThreadName(const char *name) {
+    ThreadBuffer &buffer = localBuffer();
+    std::lock_guard<std::mutex> lock(registryMutex_);
+    buffer.threadName = name ? name : "";
+}
+
+void TraceRecorder::record(const char *name, uint64_t startNs,
+                           uint64_t endNs) {
+    ThreadBuffer &buffer = localBuffer();
+    uint64_t index = buffer.written.load(std::memory_order_relaxed);
+    TraceEvent &event = buffer.events[index % EVENTS_PER_THREAD];
+    event.name = name;
+    event.startNs = startNs;
+    event.durationNs = endNs > startNs ? endNs - startNs : 0;
+    buffer.written.store(index + 1, std::memory_order_release);
+}
+
+void TraceRecorder::clear() {
+    std::lock_guard<std::mutex> lock(registryMutex_);
+    for (auto &buffer : buffers_)
+        buffer->written.store(0, std::memory_order_release);
+}
+
+// 导出时不暂停记录: 其他线程正在覆盖的最旧几个槽位可能不一致,
+// 对诊断用途可以接受
+std::string TraceRecorder::toJson() const {
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex_);
+        buffers = buffers_;
+    }
+
+    std::string out;
+    out.reserve(1024 + buffers.size() * 4096);
+    out += "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first = true;
+    auto separator = [&]() {
+        if (!first)
+            out += ",\n";
+        first = false;
+    };
+
+    for (const auto &buffer : buffers) {
+        std::string threadName;
+        {
+            std::lock_guard<std::mutex> lock(registryMutex_);
+            threadName = buffer->threadName;
+        }
+        if (threadName.empty())
+            threadName = "thread-" + std::to_string(buffer->tid);
+
+        separator();
+        out += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":";
+        out += std::to_string(buffer->tid);
+        out += ",\"args\":{\"name\":\"";
+        appendEscaped(out, threadName);
+        out += "\"}}";
+
+        uint64_t written = buffer->written.load(std::memory_order_acquire);
+        uint64_t count =
+            std::min<uint64_t>(written, static_cast<uint64_t>(EVENTS_PER_THREAD));
+        for (uint64_t i = written - count; i < written; ++i) {
+            const TraceEvent &event = buffer->events[i % EVENTS_PER_THREAD];
+            if (!event.name)
+                continue;
+            separator();
+            out += "{\"name\":\"";
+            appendEscaped(out, event.name);
+            out += "\",\"ph\":\"X\",\"pid\":1,\"tid\":";
+            out += std::to_string(buffer->tid);
+            out += ",\"ts\":";
+            appendMicros(out, event.startNs);
+            out += ",\"dur\":";
+            appendMicros(out, event.durationNs);
+            out += "}";
+        }
+    }
+
+    out += "]}\n";
+    return out;
+}
+
+bool TraceRecorder::writeJson(const std::string &fileName) const {
+    std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+    if (!file)
+        return false;
+    std::string json = toJson();
+    file.write(json.data(), static_cast<std::streamsize>(json.size()));
+    return static_cast<bool>(file);
+}
+
+} // namespace WhtsProtocol
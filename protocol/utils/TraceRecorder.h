@@ -0,0 +1,106 @@
+#ifndef WHTS_PROTOCOL_TRACE_RECORDER_H
+#define WHTS_PROTOCOL_TRACE_RECORDER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// 编译期开关: 由 CMake 选项 WHTS_ENABLE_TRACING 控制,
+// 关闭时 WHTS_TRACE_SCOPE 展开为空语句, 不产生任何代码
+#ifndef WHTS_ENABLE_TRACING
+#define WHTS_ENABLE_TRACING 0
+#endif
+
+namespace WhtsProtocol {
+
+// 一个已结束的跨度 (span)
+struct TraceEvent {
+    const char *name; // 须为静态字符串
+    uint64_t startNs;
+    uint64_t durationNs;
+};
+
+// 跨度记录器
+// - 每个线程一个固定容量的环形缓冲区, 记录时无锁、无分配
+// - 运行期开关关闭时, 记录路径只有一次 relaxed 原子读
+// - 按需导出为 Chrome / Perfetto 可加载的 trace-event JSON
+class TraceRecorder {
+  public:
+    static constexpr size_t EVENTS_PER_THREAD = 1u << 16;
+
+    static TraceRecorder &instance();
+
+    // 单调时钟 (纳秒), 与 steady_clock 一致
+    static uint64_t nowNs();
+
+    void setEnabled(bool enabled) {
+        enabled_.store(enabled, std::memory_order_relaxed);
+    }
+    bool isEnabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    // 为当前线程命名, 显示在 trace 查看器的线程轨道上
+    void setThreadName(const char *name);
+
+    void record(const char *name, uint64_t startNs, uint64_t endNs);
+
+    // 清空所有线程的缓冲区
+    void clear();
+
+    // 导出: {"traceEvents":[...]} 格式, 时间单位为微秒
+    std::string toJson() const;
+    bool writeJson(const std::string &fileName) const;
+
+  private:
+    struct ThreadBuffer {
+        uint32_t tid;
+        std::string threadName;
+        std::vector<TraceEvent> events;
+        std::atomic<uint64_t> written{0}; // 累计写入数, 环形覆盖
+    };
+
+    TraceRecorder() = default;
+    ThreadBuffer &localBuffer();
+
+    std::atomic<bool> enabled_{false};
+    mutable std::mutex registryMutex_; // 仅在线程首次记录和导出时加锁
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers_;
+};
+
+// RAII 跨度: 构造时取起始时间, 析构时写入当前线程缓冲区
+class TraceSpan {
+  public:
+    explicit TraceSpan(const char *name)
+        : name_(TraceRecorder::instance().isEnabled() ? name : nullptr),
+          startNs_(name_ ? TraceRecorder::nowNs() : 0) {}
+
+    ~TraceSpan() {
+        if (name_)
+            TraceRecorder::instance().record(name_, startNs_,
+                                             TraceRecorder::nowNs());
+    }
+
+    TraceSpan(const TraceSpan &) = delete;
+    TraceSpan &operator=(const TraceSpan &) = delete;
+
+  private:
+    const char *name_;
+    uint64_t startNs_;
+};
+
+} // namespace WhtsProtocol
+
+#define WHTS_TRACE_CONCAT_INNER(a, b) a##b
+#define WHTS_TRACE_CONCAT(a, b) WHTS_TRACE_CONCAT_INNER(a, b)
+
+#if WHTS_ENABLE_TRACING
+#define WHTS_TRACE_SCOPE(name)                                                 \
+    ::WhtsProtocol::TraceSpan WHTS_TRACE_CONCAT(whtsTraceSpan_, __LINE__)(name)
+#else
+#define WHTS_TRACE_SCOPE(name) ((void)0)
+#endif
+
+#endif // WHTS_PROTOCOL_TRACE_RECORDER_H
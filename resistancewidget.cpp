@@ -0,0 +1,184 @@
+#include "resistancewidget.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QColor>
+
+namespace {
+// 刷新周期（毫秒）
+constexpr int RESISTANCE_REFRESH_INTERVAL_MS = 1000;
+
+enum ChannelColumn {
+    CHANNEL_COLUMN_SLAVE = 0,
+    CHANNEL_COLUMN_CHANNEL,
+    CHANNEL_COLUMN_LAST,
+    CHANNEL_COLUMN_MIN,
+    CHANNEL_COLUMN_MAX,
+    CHANNEL_COLUMN_MEAN,
+    CHANNEL_COLUMN_STDDEV,
+    CHANNEL_COLUMN_COUNT,
+    CHANNEL_COLUMN_OUT_OF_LIMIT,
+    CHANNEL_COLUMN_TOTAL
+};
+
+QString OhmsToString(double ohms)
+{
+    return QString::number(ohms, 'f', 2);
+}
+}
+
+ResistanceWidget::ResistanceWidget(WhtsProtocol::ResistanceAccumulator *pAccumulator, QSettings *pSettings,
+                                   QWidget *parent)
+    : QWidget(parent)
+    , m_pAccumulator(pAccumulator)
+    , m_pSettings(pSettings)
+    , m_pSpinBoxScale(nullptr)
+    , m_pSpinBoxLowerLimit(nullptr)
+    , m_pSpinBoxUpperLimit(nullptr)
+    , m_pPushButtonReset(nullptr)
+    , m_pLabelSummary(nullptr)
+    , m_pTableWidgetChannels(nullptr)
+    , m_pRefreshTimer(nullptr)
+{
+    InitializeUI();
+    LoadSettings();
+
+    m_pRefreshTimer = new QTimer(this);
+    connect(m_pRefreshTimer, &QTimer::timeout, this, &ResistanceWidget::OnRefreshTimeout);
+    m_pRefreshTimer->start(RESISTANCE_REFRESH_INTERVAL_MS);
+}
+
+void ResistanceWidget::InitializeUI()
+{
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+
+    QHBoxLayout *controlLayout = new QHBoxLayout();
+    controlLayout->addWidget(new QLabel("换算系数(Ω/LSB):", this));
+    m_pSpinBoxScale = new QDoubleSpinBox(this);
+    m_pSpinBoxScale->setDecimals(4);
+    m_pSpinBoxScale->setRange(0.0001, 100.0);
+    controlLayout->addWidget(m_pSpinBoxScale);
+    controlLayout->addWidget(new QLabel("下限(Ω):", this));
+    m_pSpinBoxLowerLimit = new QDoubleSpinBox(this);
+    m_pSpinBoxLowerLimit->setDecimals(2);
+    m_pSpinBoxLowerLimit->setRange(0, 1000000.0);
+    controlLayout->addWidget(m_pSpinBoxLowerLimit);
+    controlLayout->addWidget(new QLabel("上限(Ω):", this));
+    m_pSpinBoxUpperLimit = new QDoubleSpinBox(this);
+    m_pSpinBoxUpperLimit->setDecimals(2);
+    m_pSpinBoxUpperLimit->setRange(0, 1000000.0);
+    m_pSpinBoxUpperLimit->setSpecialValueText("不检查");
+    controlLayout->addWidget(m_pSpinBoxUpperLimit);
+    m_pPushButtonReset = new QPushButton("清零", this);
+    controlLayout->addWidget(m_pPushButtonReset);
+    controlLayout->addStretch();
+    mainLayout->addLayout(controlLayout);
+
+    m_pLabelSummary = new QLabel(this);
+    mainLayout->addWidget(m_pLabelSummary);
+
+    m_pTableWidgetChannels = new QTableWidget(0, CHANNEL_COLUMN_TOTAL, this);
+    m_pTableWidgetChannels->setHorizontalHeaderLabels(
+        {"从机", "通道", "当前值(Ω)", "最小值", "最大值", "平均值", "标准差", "采样数", "超限次数"});
+    m_pTableWidgetChannels->verticalHeader()->setVisible(false);
+    m_pTableWidgetChannels->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_pTableWidgetChannels->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    mainLayout->addWidget(m_pTableWidgetChannels);
+
+    connect(m_pPushButtonReset, &QPushButton::clicked, this, &ResistanceWidget::OnResetClicked);
+}
+
+void ResistanceWidget::LoadSettings()
+{
+    const WhtsProtocol::ResistanceAccumulator::Config defaults;
+    m_pSpinBoxScale->setValue(m_pSettings->value("Resistance/OhmsPerLsb", defaults.ohmsPerLsb).toDouble());
+    m_pSpinBoxLowerLimit->setValue(m_pSettings->value("Resistance/LowerLimitOhms", defaults.lowerLimitOhms).toDouble());
+    m_pSpinBoxUpperLimit->setValue(m_pSettings->value("Resistance/UpperLimitOhms", 0).toDouble());
+    OnConfigChanged();
+
+    // 加载完成后再连接，避免加载过程中重复写入
+    connect(m_pSpinBoxScale, &QDoubleSpinBox::valueChanged, this, &ResistanceWidget::OnConfigChanged);
+    connect(m_pSpinBoxLowerLimit, &QDoubleSpinBox::valueChanged, this, &ResistanceWidget::OnConfigChanged);
+    connect(m_pSpinBoxUpperLimit, &QDoubleSpinBox::valueChanged, this, &ResistanceWidget::OnConfigChanged);
+}
+
+void ResistanceWidget::OnConfigChanged()
+{
+    WhtsProtocol::ResistanceAccumulator::Config config;
+    config.ohmsPerLsb = m_pSpinBoxScale->value();
+    config.lowerLimitOhms = m_pSpinBoxLowerLimit->value();
+    // 上限为 0 表示不检查
+    if (m_pSpinBoxUpperLimit->value() > 0) {
+        config.upperLimitOhms = m_pSpinBoxUpperLimit->value();
+    }
+    m_pAccumulator->setConfig(config);
+
+    m_pSettings->setValue("Resistance/OhmsPerLsb", m_pSpinBoxScale->value());
+    m_pSettings->setValue("Resistance/LowerLimitOhms", m_pSpinBoxLowerLimit->value());
+    m_pSettings->setValue("Resistance/UpperLimitOhms", m_pSpinBoxUpperLimit->value());
+}
+
+void ResistanceWidget::OnRefreshTimeout()
+{
+    // 面板不可见时不刷新表格
+    if (!isVisible()) {
+        return;
+    }
+
+    const auto slaves = m_pAccumulator->slaves();
+    uint64_t failingChannels = 0;
+    uint64_t invalidFrames = 0;
+    int rowCount = 0;
+    for (const auto &slave : slaves) {
+        failingChannels += slave.failingChannels;
+        invalidFrames += slave.invalidFrames;
+        rowCount += static_cast<int>(slave.channels);
+    }
+    m_pLabelSummary->setText(QString("从机 %1，当前超限通道 %2，长度不符的帧 %3")
+                                 .arg(slaves.size()).arg(failingChannels).arg(invalidFrames));
+
+    m_pTableWidgetChannels->setRowCount(rowCount);
+    int row = 0;
+    for (const auto &slave : slaves) {
+        QString slaveText = QString("0x%1").arg(slave.slaveId, 8, 16, QChar('0')).toUpper();
+        if (!slave.configured) {
+            slaveText += "（按长度推断）";
+        }
+        for (const WhtsProtocol::ResistanceChannelStats &stats : m_pAccumulator->channels(slave.slaveId)) {
+            bool hasData = stats.count > 0;
+            QStringList cells;
+            cells << slaveText
+                  << QString::number(stats.channel)
+                  << (hasData ? OhmsToString(stats.last) : QString("-"))
+                  << (hasData ? OhmsToString(stats.min) : QString("-"))
+                  << (hasData ? OhmsToString(stats.max) : QString("-"))
+                  << (hasData ? OhmsToString(stats.mean) : QString("-"))
+                  << (hasData ? QString::number(stats.stddev, 'f', 3) : QString("-"))
+                  << QString::number(stats.count)
+                  << QString::number(stats.outOfLimit);
+
+            QColor color = !hasData ? QColor() : (stats.lastInLimit ? QColor(0, 160, 0) : QColor(220, 0, 0));
+            for (int column = 0; column < CHANNEL_COLUMN_TOTAL; ++column) {
+                QTableWidgetItem *item = m_pTableWidgetChannels->item(row, column);
+                if (!item) {
+                    item = new QTableWidgetItem();
+                    if (column > CHANNEL_COLUMN_SLAVE) {
+                        item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+                    }
+                    m_pTableWidgetChannels->setItem(row, column, item);
+                }
+                item->setText(cells[column]);
+                if (column == CHANNEL_COLUMN_LAST) {
+                    item->setForeground(color.isValid() ? QBrush(color) : QBrush());
+                }
+            }
+            ++row;
+        }
+    }
+}
+
+void ResistanceWidget::OnResetClicked()
+{
+    m_pAccumulator->clearStats();
+    OnRefreshTimeout();
+}
@@ -0,0 +1,45 @@
+#ifndef RESISTANCEWIDGET_H
+#define RESISTANCEWIDGET_H
+
+#include <QWidget>
+#include <QTableWidget>
+#include <QPushButton>
+#include <QDoubleSpinBox>
+#include <QLabel>
+#include <QTimer>
+#include <QSettings>
+
+#include "protocol/ResistanceAccumulator.h"
+
+// 阻值数据面板：设置定点换算系数和上下限，定时显示每个从机每个通道的统计
+class ResistanceWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    ResistanceWidget(WhtsProtocol::ResistanceAccumulator *pAccumulator, QSettings *pSettings,
+                     QWidget *parent = nullptr);
+
+private slots:
+    void OnRefreshTimeout();
+    void OnConfigChanged();
+    void OnResetClicked();
+
+private:
+    void InitializeUI();
+    void LoadSettings();
+
+private:
+    WhtsProtocol::ResistanceAccumulator *m_pAccumulator;
+    QSettings *m_pSettings;
+
+    QDoubleSpinBox *m_pSpinBoxScale;
+    QDoubleSpinBox *m_pSpinBoxLowerLimit;
+    QDoubleSpinBox *m_pSpinBoxUpperLimit;
+    QPushButton *m_pPushButtonReset;
+    QLabel *m_pLabelSummary;
+    QTableWidget *m_pTableWidgetChannels;
+    QTimer *m_pRefreshTimer;
+};
+
+#endif // RESISTANCEWIDGET_H
@@ -0,0 +1,232 @@
+#include "slotplandialog.h"
+#include <QApplication>
+#include <QClipboard>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QFormLayout>
+#include <QGroupBox>
+#include <QHeaderView>
+
+namespace {
+enum PlanColumn {
+    PLAN_COLUMN_SLOT = 0,
+    PLAN_COLUMN_SLAVE,
+    PLAN_COLUMN_TEST_COUNT,
+    PLAN_COLUMN_BYTES,
+    PLAN_COLUMN_FRAMES,
+    PLAN_COLUMN_FILL,
+    PLAN_COLUMN_READY,
+    PLAN_COLUMN_UPLOAD,
+    PLAN_COLUMN_TESTS_PER_SECOND,
+    PLAN_COLUMN_BYTES_PER_SECOND,
+    PLAN_COLUMN_COUNT
+};
+
+QDoubleSpinBox* CreateMicrosecondSpinBox(double value, QWidget* parent)
+{
+    QDoubleSpinBox* spinBox = new QDoubleSpinBox(parent);
+    spinBox->setRange(0, 1000000);
+    spinBox->setDecimals(1);
+    spinBox->setValue(value);
+    spinBox->setSuffix(" us");
+    return spinBox;
+}
+}
+
+SlotPlanDialog::SlotPlanDialog(const SlaveConfigData& configData, QWidget *parent)
+    : QDialog(parent)
+    , m_configData(configData)
+    , m_pComboBoxMode(nullptr)
+    , m_pSpinBoxMtu(nullptr)
+    , m_pSpinBoxBitrate(nullptr)
+    , m_pSpinBoxFrameOverhead(nullptr)
+    , m_pSpinBoxSlotGuard(nullptr)
+    , m_pSpinBoxDrive(nullptr)
+    , m_pSpinBoxResistance(nullptr)
+    , m_pSpinBoxClip(nullptr)
+    , m_pSpinBoxMargin(nullptr)
+    , m_pLabelSummary(nullptr)
+    , m_pTableWidgetPlan(nullptr)
+    , m_pPushButtonCopySync(nullptr)
+    , m_pPushButtonClose(nullptr)
+{
+    InitializeUI();
+    setWindowTitle(QString("时隙规划 - %1").arg(m_configData.name));
+    UpdatePlan();
+}
+
+void SlotPlanDialog::InitializeUI()
+{
+    setModal(true);
+    resize(900, 560);
+
+    QVBoxLayout* mainLayout = new QVBoxLayout(this);
+
+    // 链路与测量参数
+    SlotPlanner::LinkParams defaults;
+    QGroupBox* paramGroup = new QGroupBox("链路参数", this);
+    QHBoxLayout* paramLayout = new QHBoxLayout(paramGroup);
+    QFormLayout* leftForm = new QFormLayout();
+    QFormLayout* rightForm = new QFormLayout();
+
+    m_pComboBoxMode = new QComboBox(this);
+    m_pComboBoxMode->addItem("导通检测", static_cast<int>(SlotPlanner::Mode::Conduction));
+    m_pComboBoxMode->addItem("阻值检测", static_cast<int>(SlotPlanner::Mode::Resistance));
+    m_pComboBoxMode->addItem("卡钉检测", static_cast<int>(SlotPlanner::Mode::Clip));
+
+    m_pSpinBoxMtu = new QSpinBox(this);
+    m_pSpinBoxMtu->setRange(16, 1500);
+    m_pSpinBoxMtu->setValue(static_cast<int>(defaults.mtu));
+
+    m_pSpinBoxBitrate = new QDoubleSpinBox(this);
+    m_pSpinBoxBitrate->setRange(1, 100000);
+    m_pSpinBoxBitrate->setDecimals(0);
+    m_pSpinBoxBitrate->setValue(defaults.bitrateKbps);
+    m_pSpinBoxBitrate->setSuffix(" kbps");
+
+    m_pSpinBoxFrameOverhead = CreateMicrosecondSpinBox(defaults.frameOverheadUs, this);
+    m_pSpinBoxSlotGuard = CreateMicrosecondSpinBox(defaults.slotGuardUs, this);
+    m_pSpinBoxDrive = CreateMicrosecondSpinBox(defaults.conductionDriveUs, this);
+    m_pSpinBoxResistance = CreateMicrosecondSpinBox(defaults.resistanceTestUs, this);
+    m_pSpinBoxClip = CreateMicrosecondSpinBox(defaults.clipTestUs, this);
+
+    m_pSpinBoxMargin = new QSpinBox(this);
+    m_pSpinBoxMargin->setRange(0, 100);
+    m_pSpinBoxMargin->setValue(static_cast<int>(defaults.intervalMarginRatio * 100));
+    m_pSpinBoxMargin->setSuffix(" %");
+
+    leftForm->addRow("检测模式:", m_pComboBoxMode);
+    leftForm->addRow("MTU:", m_pSpinBoxMtu);
+    leftForm->addRow("数据速率:", m_pSpinBoxBitrate);
+    leftForm->addRow("每帧开销:", m_pSpinBoxFrameOverhead);
+    leftForm->addRow("时隙保护间隔:", m_pSpinBoxSlotGuard);
+    rightForm->addRow("导通每步驱动:", m_pSpinBoxDrive);
+    rightForm->addRow("阻值每项测量:", m_pSpinBoxResistance);
+    rightForm->addRow("卡钉每项检测:", m_pSpinBoxClip);
+    rightForm->addRow("间隔余量:", m_pSpinBoxMargin);
+    paramLayout->addLayout(leftForm);
+    paramLayout->addLayout(rightForm);
+    mainLayout->addWidget(paramGroup);
+
+    m_pLabelSummary = new QLabel(this);
+    m_pLabelSummary->setWordWrap(true);
+    mainLayout->addWidget(m_pLabelSummary);
+
+    // 规划结果（按 timeSlot 排列）
+    m_pTableWidgetPlan = new QTableWidget(0, PLAN_COLUMN_COUNT, this);
+    QStringList headers;
+    headers << "时隙" << "从机ID" << "测试数量" << "数据字节" << "分片数" << "帧利用率"
+            << "测量完成 (us)" << "上传 (us)" << "测试/s" << "字节/s";
+    m_pTableWidgetPlan->setHorizontalHeaderLabels(headers);
+    m_pTableWidgetPlan->verticalHeader()->setVisible(false);
+    m_pTableWidgetPlan->horizontalHeader()->setStretchLastSection(true);
+    m_pTableWidgetPlan->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_pTableWidgetPlan->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_pTableWidgetPlan->setAlternatingRowColors(true);
+    mainLayout->addWidget(m_pTableWidgetPlan);
+
+    QHBoxLayout* bottomLayout = new QHBoxLayout();
+    bottomLayout->addStretch();
+    m_pPushButtonCopySync = new QPushButton("复制 Sync 配置", this);
+    m_pPushButtonCopySync->setToolTip("复制各从机的 timeSlot/testCount 和 Sync 报文，用于主机固件配置");
+    bottomLayout->addWidget(m_pPushButtonCopySync);
+    m_pPushButtonClose = new QPushButton("关闭", this);
+    bottomLayout->addWidget(m_pPushButtonClose);
+    mainLayout->addLayout(bottomLayout);
+
+    // 参数变化时重新规划
+    connect(m_pComboBoxMode, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &SlotPlanDialog::UpdatePlan);
+    connect(m_pSpinBoxMtu, QOverload<int>::of(&QSpinBox::valueChanged), this, &SlotPlanDialog::UpdatePlan);
+    connect(m_pSpinBoxMargin, QOverload<int>::of(&QSpinBox::valueChanged), this, &SlotPlanDialog::UpdatePlan);
+    for (QDoubleSpinBox* spinBox : {m_pSpinBoxBitrate, m_pSpinBoxFrameOverhead, m_pSpinBoxSlotGuard,
+                                    m_pSpinBoxDrive, m_pSpinBoxResistance, m_pSpinBoxClip}) {
+        connect(spinBox, QOverload<double>::of(&QDoubleSpinBox::valueChanged), this, &SlotPlanDialog::UpdatePlan);
+    }
+    connect(m_pPushButtonCopySync, &QPushButton::clicked, this, &SlotPlanDialog::CopySyncConfig);
+    connect(m_pPushButtonClose, &QPushButton::clicked, this, &QDialog::accept);
+}
+
+SlotPlanner::LinkParams SlotPlanDialog::LinkParams() const
+{
+    SlotPlanner::LinkParams params;
+    params.mtu = static_cast<size_t>(m_pSpinBoxMtu->value());
+    params.bitrateKbps = m_pSpinBoxBitrate->value();
+    params.frameOverheadUs = m_pSpinBoxFrameOverhead->value();
+    params.slotGuardUs = m_pSpinBoxSlotGuard->value();
+    params.conductionDriveUs = m_pSpinBoxDrive->value();
+    params.resistanceTestUs = m_pSpinBoxResistance->value();
+    params.clipTestUs = m_pSpinBoxClip->value();
+    params.intervalMarginRatio = m_pSpinBoxMargin->value() / 100.0;
+    return params;
+}
+
+void SlotPlanDialog::UpdatePlan()
+{
+    auto mode = static_cast<SlotPlanner::Mode>(m_pComboBoxMode->currentData().toInt());
+    m_plan = SlotPlanner::Compute(m_configData.config, mode, LinkParams());
+    const SlotPlanner::Plan& plan = m_plan;
+
+    QString summary = QString("从机 %1 个，Sync %2 us，周期 %3 us（按配置顺序 %4 us，节省 %5 us），上传信道等待测量 %6 us。")
+                          .arg(plan.slots.size())
+                          .arg(plan.syncUs, 0, 'f', 0)
+                          .arg(plan.cycleUs, 0, 'f', 0)
+                          .arg(plan.naiveCycleUs, 0, 'f', 0)
+                          .arg(plan.naiveCycleUs - plan.cycleUs, 0, 'f', 0)
+                          .arg(plan.idleUs, 0, 'f', 0);
+    if (plan.intervalOverflow) {
+        summary += QString("<font color='red'>周期超过 255 ms，间隔字段无法表示，请减少从机或拆分配置。</font>");
+    } else {
+        summary += QString("建议采集间隔 <b>%1 ms</b>。").arg(plan.intervalMs);
+    }
+    m_pLabelSummary->setText(summary);
+    // 间隔无法表示时生成的 Sync 配置没有意义
+    m_pPushButtonCopySync->setEnabled(!plan.intervalOverflow && !plan.slots.empty());
+
+    m_pTableWidgetPlan->setRowCount(static_cast<int>(plan.slots.size()));
+    for (int row = 0; row < static_cast<int>(plan.slots.size()); ++row) {
+        const SlotPlanner::SlotAssignment& slot = plan.slots[row];
+        QStringList cells;
+        cells << QString::number(slot.timeSlot)
+              << QString("0x%1").arg(slot.slaveId, 8, 16, QChar('0')).toUpper()
+              << QString::number(slot.testCount)
+              << QString::number(slot.payloadBytes)
+              << QString::number(slot.frames)
+              << QString("%1%").arg(slot.fillRatio * 100.0, 0, 'f', 0)
+              << QString::number(slot.readyUs, 'f', 0)
+              << QString("%1 - %2").arg(slot.uploadStartUs, 0, 'f', 0).arg(slot.uploadEndUs, 0, 'f', 0)
+              << QString::number(slot.testsPerSecond, 'f', 1)
+              << QString::number(slot.bytesPerSecond, 'f', 0);
+
+        for (int column = 0; column < PLAN_COLUMN_COUNT; ++column) {
+            QTableWidgetItem* item = new QTableWidgetItem(cells[column]);
+            if (column != PLAN_COLUMN_SLAVE) {
+                item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+            }
+            m_pTableWidgetPlan->setItem(row, column, item);
+        }
+    }
+}
+
+void SlotPlanDialog::CopySyncConfig()
+{
+    WhtsProtocol::Master2Slave::SyncMessage sync;
+    sync.mode = static_cast<uint8_t>(m_plan.mode);
+    sync.interval = m_plan.intervalMs;
+    sync.currentTime = 0;
+    sync.startTime = 0;
+    sync.slaveConfigs = SlotPlanner::ToSyncConfigs(m_plan);
+
+    QStringList lines;
+    lines << QString("mode=%1 interval=%2ms").arg(sync.mode).arg(sync.interval);
+    for (const auto& slave : sync.slaveConfigs) {
+        lines << QString("0x%1 timeSlot=%2 testCount=%3")
+                     .arg(slave.id, 8, 16, QChar('0')).toUpper()
+                     .arg(slave.timeSlot)
+                     .arg(slave.testCount);
+    }
+    // 时间戳由主机在广播时填写
+    std::vector<uint8_t> body = sync.serialize();
+    lines << QString("Sync: %1").arg(QString(QByteArray(reinterpret_cast<const char*>(body.data()),
+                                                         static_cast<int>(body.size())).toHex(' ').toUpper()));
+    QApplication::clipboard()->setText(lines.join('\n'));
+}
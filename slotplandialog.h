@@ -0,0 +1,51 @@
+#ifndef SLOTPLANDIALOG_H
+#define SLOTPLANDIALOG_H
+
+#include <QDialog>
+#include <QComboBox>
+#include <QSpinBox>
+#include <QDoubleSpinBox>
+#include <QLabel>
+#include <QTableWidget>
+#include <QPushButton>
+
+#include "slaveconfigdialog.h"
+#include "slotplanner.h"
+
+// 时隙规划对话框：按从机配置和链路参数给出 timeSlot/testCount 分配、建议间隔和每个从机的预测吞吐
+class SlotPlanDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit SlotPlanDialog(const SlaveConfigData& configData, QWidget *parent = nullptr);
+
+private slots:
+    void UpdatePlan();
+    // 把规划结果生成的 Sync 从机配置（可读文本和报文十六进制）复制到剪贴板
+    void CopySyncConfig();
+
+private:
+    void InitializeUI();
+    SlotPlanner::LinkParams LinkParams() const;
+
+private:
+    SlaveConfigData m_configData;
+    SlotPlanner::Plan m_plan;
+
+    QComboBox* m_pComboBoxMode;
+    QSpinBox* m_pSpinBoxMtu;
+    QDoubleSpinBox* m_pSpinBoxBitrate;
+    QDoubleSpinBox* m_pSpinBoxFrameOverhead;
+    QDoubleSpinBox* m_pSpinBoxSlotGuard;
+    QDoubleSpinBox* m_pSpinBoxDrive;
+    QDoubleSpinBox* m_pSpinBoxResistance;
+    QDoubleSpinBox* m_pSpinBoxClip;
+    QSpinBox* m_pSpinBoxMargin;
+    QLabel* m_pLabelSummary;
+    QTableWidget* m_pTableWidgetPlan;
+    QPushButton* m_pPushButtonCopySync;
+    QPushButton* m_pPushButtonClose;
+};
+
+#endif // SLOTPLANDIALOG_H
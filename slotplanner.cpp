@@ -0,0 +1,175 @@
+#include "slotplanner.h"
+#include <algorithm>
+#include <bitset>
+#include <cmath>
+
+namespace {
+// 帧头：AB CD + packetId + 分片序号 + 后续分片标志 + 长度(2)
+constexpr size_t FRAME_HEADER_BYTES = 7;
+// Slave2Backend 载荷头：msgId + slaveId(4) + DeviceStatus(2)
+constexpr size_t SLAVE2BACKEND_HEADER_BYTES = 7;
+// Master2Slave 载荷头：msgId + 目标ID(4)
+constexpr size_t MASTER2SLAVE_HEADER_BYTES = 5;
+// Sync 消息体：mode + interval + currentTime(8) + startTime(8)，每个从机 7 字节
+constexpr size_t SYNC_BODY_BYTES = 18;
+constexpr size_t SYNC_SLAVE_BYTES = 7;
+// 导通/阻值数据消息体的长度字段
+constexpr size_t DATA_LENGTH_BYTES = 2;
+// 卡钉数据消息体
+constexpr size_t CLIP_DATA_BYTES = 2;
+
+constexpr uint8_t MAX_INTERVAL_MS = 255;
+
+// 按给定顺序依次上传，返回周期时长
+double Schedule(std::vector<SlotPlanner::SlotAssignment> &slots, const std::vector<double> &uploadUs,
+                const std::vector<size_t> &order, double syncUs, double *idleUs)
+{
+    double channelFreeUs = syncUs;
+    double idle = 0;
+    for (size_t index : order) {
+        SlotPlanner::SlotAssignment &slot = slots[index];
+        double startUs = std::max(channelFreeUs, slot.readyUs);
+        idle += startUs - channelFreeUs;
+        slot.uploadStartUs = startUs;
+        slot.uploadEndUs = startUs + uploadUs[index];
+        channelFreeUs = slot.uploadEndUs;
+    }
+    if (idleUs) {
+        *idleUs = idle;
+    }
+    return channelFreeUs;
+}
+}
+
+uint8_t SlotPlanner::TestCount(const WhtsProtocol::Backend2Master::SlaveConfigMessage::SlaveInfo &slave, Mode mode)
+{
+    switch (mode) {
+    case Mode::Conduction:
+        return slave.conductionNum;
+    case Mode::Resistance:
+        return slave.resistanceNum;
+    case Mode::Clip:
+        // clipStatus 每一位对应一个卡钉
+        return static_cast<uint8_t>(std::bitset<16>(slave.clipStatus).count());
+    }
+    return 0;
+}
+
+size_t SlotPlanner::FrameCount(size_t payloadBytes, size_t mtu)
+{
+    // 与 ProtocolProcessor::fragmentFrame 一致：整帧不超过 MTU 时不分片，
+    // 否则每片载荷 MTU - 帧头
+    if (payloadBytes + FRAME_HEADER_BYTES <= mtu) {
+        return 1;
+    }
+    size_t fragmentPayload = mtu > FRAME_HEADER_BYTES ? mtu - FRAME_HEADER_BYTES : 1;
+    return (payloadBytes + fragmentPayload - 1) / fragmentPayload;
+}
+
+double SlotPlanner::FrameAirtimeUs(size_t frameBytes, const LinkParams &params)
+{
+    return params.frameOverheadUs + frameBytes * 8.0 * 1000.0 / params.bitrateKbps;
+}
+
+double SlotPlanner::MessageAirtimeUs(size_t payloadBytes, const LinkParams &params)
+{
+    size_t frames = FrameCount(payloadBytes, params.mtu);
+    return frames * params.frameOverheadUs +
+           (payloadBytes + frames * FRAME_HEADER_BYTES) * 8.0 * 1000.0 / params.bitrateKbps;
+}
+
+SlotPlanner::Plan SlotPlanner::Compute(const WhtsProtocol::Backend2Master::SlaveConfigMessage &config,
+                                       Mode mode, const LinkParams &params)
+{
+    Plan plan;
+    plan.mode = mode;
+
+    const auto &slaves = config.slaves;
+    size_t slaveCount = slaves.size();
+    size_t syncPayload = MASTER2SLAVE_HEADER_BYTES + SYNC_BODY_BYTES + SYNC_SLAVE_BYTES * slaveCount;
+    plan.syncUs = MessageAirtimeUs(syncPayload, params);
+
+    // 导通检测的驱动步骤总数
+    size_t totalDriveSteps = 0;
+    if (mode == Mode::Conduction) {
+        for (const auto &slave : slaves) {
+            totalDriveSteps += slave.conductionNum;
+        }
+    }
+
+    plan.slots.resize(slaveCount);
+    std::vector<double> uploadUs(slaveCount);
+    size_t fragmentPayload = params.mtu > FRAME_HEADER_BYTES ? params.mtu - FRAME_HEADER_BYTES : 1;
+    for (size_t i = 0; i < slaveCount; ++i) {
+        SlotAssignment &slot = plan.slots[i];
+        slot.slaveId = slaves[i].id;
+        slot.testCount = TestCount(slaves[i], mode);
+
+        size_t bodyBytes = 0;
+        double measureUs = 0;
+        switch (mode) {
+        case Mode::Conduction:
+            bodyBytes = DATA_LENGTH_BYTES + (slot.testCount * totalDriveSteps + 7) / 8;
+            measureUs = totalDriveSteps * params.conductionDriveUs;
+            break;
+        case Mode::Resistance:
+            bodyBytes = DATA_LENGTH_BYTES + slot.testCount * params.resistanceBytesPerTest;
+            measureUs = slot.testCount * params.resistanceTestUs;
+            break;
+        case Mode::Clip:
+            bodyBytes = CLIP_DATA_BYTES;
+            measureUs = slot.testCount * params.clipTestUs;
+            break;
+        }
+
+        slot.payloadBytes = SLAVE2BACKEND_HEADER_BYTES + bodyBytes;
+        slot.frames = FrameCount(slot.payloadBytes, params.mtu);
+        slot.fillRatio = static_cast<double>(slot.payloadBytes) / (slot.frames * fragmentPayload);
+        slot.readyUs = plan.syncUs + measureUs;
+        uploadUs[i] = MessageAirtimeUs(slot.payloadBytes, params) + params.slotGuardUs;
+    }
+
+    // 基准：按配置顺序
+    std::vector<size_t> order(slaveCount);
+    for (size_t i = 0; i < slaveCount; ++i) {
+        order[i] = i;
+    }
+    plan.naiveCycleUs = Schedule(plan.slots, uploadUs, order, plan.syncUs, nullptr);
+
+    // 按测量完成时间升序上传，相同时保持配置顺序
+    std::stable_sort(order.begin(), order.end(), [&plan](size_t a, size_t b) {
+        return plan.slots[a].readyUs < plan.slots[b].readyUs;
+    });
+    plan.cycleUs = Schedule(plan.slots, uploadUs, order, plan.syncUs, &plan.idleUs);
+
+    std::vector<SlotAssignment> ordered;
+    ordered.reserve(slaveCount);
+    for (size_t i = 0; i < slaveCount; ++i) {
+        ordered.push_back(plan.slots[order[i]]);
+        ordered.back().timeSlot = static_cast<uint8_t>(i);
+    }
+    plan.slots.swap(ordered);
+
+    double intervalMs = std::ceil(plan.cycleUs * (1.0 + params.intervalMarginRatio) / 1000.0);
+    plan.intervalOverflow = intervalMs > MAX_INTERVAL_MS;
+    plan.intervalMs = static_cast<uint8_t>(std::clamp(intervalMs, 1.0, static_cast<double>(MAX_INTERVAL_MS)));
+
+    // 间隔无法表示时按实际周期估算
+    double periodUs = plan.intervalOverflow ? plan.cycleUs : plan.intervalMs * 1000.0;
+    double cyclesPerSecond = periodUs > 0 ? 1e6 / periodUs : 0;
+    for (auto &slot : plan.slots) {
+        slot.testsPerSecond = slot.testCount * cyclesPerSecond;
+        slot.bytesPerSecond = slot.payloadBytes * cyclesPerSecond;
+    }
+    return plan;
+}
+
+std::vector<WhtsProtocol::Master2Slave::SyncMessage::SlaveConfig> SlotPlanner::ToSyncConfigs(const Plan &plan)
+{
+    std::vector<WhtsProtocol::Master2Slave::SyncMessage::SlaveConfig> configs;
+    configs.reserve(plan.slots.size());
+    for (const auto &slot : plan.slots) {
+        configs.emplace_back(slot.slaveId, slot.timeSlot, 0, slot.testCount);
+    }
+    return configs;
+}
@@ -0,0 +1,82 @@
+#ifndef SLOTPLANNER_H
+#define SLOTPLANNER_H
+
+#include <cstdint>
+#include <vector>
+
+#include "protocol/messages/Backend2Master.h"
+#include "protocol/messages/Master2Slave.h"
+
+// TDMA 时隙规划
+//
+// 周期模型：主机广播 Sync 之后各从机开始测量，测量完成的从机在自己的时隙内上传数据，
+// 上传共用 UWB 信道、依次进行。
+// - 导通检测：各从机依次驱动自己的引脚、其余从机同时采样，驱动独占线束，
+//   全部驱动完成后所有从机的数据才完整。每个驱动步骤本机每个引脚 1 bit
+// - 阻值 / 卡钉检测：各从机本地并行测量，测量完成即可上传
+// 上传顺序按测量完成时间升序排列（单机带释放时间的最小完工时间问题，该规则最优），
+// timeSlot 为上传顺序，testCount 为测试数量
+class SlotPlanner
+{
+public:
+    enum class Mode : uint8_t {
+        Conduction = 0,
+        Resistance = 1,
+        Clip = 2
+    };
+
+    // 链路与测量参数（时间单位：微秒）
+    struct LinkParams {
+        size_t mtu = 100;                   // 与 ProtocolProcessor 的 MTU 一致
+        double bitrateKbps = 6800;          // UWB 数据速率
+        double frameOverheadUs = 180;       // 每帧前导码、PHR 及收发切换
+        double slotGuardUs = 100;           // 相邻时隙的保护间隔（时钟漂移）
+        double conductionDriveUs = 20;      // 导通检测每个驱动步骤
+        double resistanceTestUs = 1000;     // 阻值检测每项
+        double clipTestUs = 100;            // 卡钉检测每项
+        size_t resistanceBytesPerTest = 2;  // 阻值数据每项字节数
+        double intervalMarginRatio = 0.1;   // 建议间隔在周期之外预留的余量
+    };
+
+    struct SlotAssignment {
+        uint32_t slaveId = 0;
+        uint8_t timeSlot = 0;
+        uint8_t testCount = 0;
+        size_t payloadBytes = 0;     // Slave2Backend 数据消息体
+        size_t frames = 0;           // 分片后的帧数
+        double fillRatio = 0;        // 帧载荷利用率
+        double readyUs = 0;          // 测量完成时刻（相对周期开始）
+        double uploadStartUs = 0;
+        double uploadEndUs = 0;
+        double testsPerSecond = 0;   // 按建议间隔预测
+        double bytesPerSecond = 0;
+    };
+
+    struct Plan {
+        Mode mode = Mode::Conduction;
+        std::vector<SlotAssignment> slots;   // 按 timeSlot 排列
+        double syncUs = 0;                   // Sync 广播时长
+        double cycleUs = 0;                  // 规划后的周期
+        double naiveCycleUs = 0;             // 按配置顺序排列的周期
+        double idleUs = 0;                   // 上传信道空闲（等待测量）的时间
+        uint8_t intervalMs = 0;              // 建议的采集间隔
+        bool intervalOverflow = false;       // 周期超过 255 ms，间隔无法表示
+    };
+
+    static Plan Compute(const WhtsProtocol::Backend2Master::SlaveConfigMessage &config,
+                        Mode mode, const LinkParams &params);
+
+    // 生成可直接下发的 Sync 从机配置
+    static std::vector<WhtsProtocol::Master2Slave::SyncMessage::SlaveConfig> ToSyncConfigs(const Plan &plan);
+
+    // 单帧（含帧头）在空口上的时长
+    static double FrameAirtimeUs(size_t frameBytes, const LinkParams &params);
+    // 一条消息（payload 为帧载荷长度）分片后的帧数与总空口时长
+    static size_t FrameCount(size_t payloadBytes, size_t mtu);
+    static double MessageAirtimeUs(size_t payloadBytes, const LinkParams &params);
+
+private:
+    static uint8_t TestCount(const WhtsProtocol::Backend2Master::SlaveConfigMessage::SlaveInfo &slave, Mode mode);
+};
+
+#endif // SLOTPLANNER_H
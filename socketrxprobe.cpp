@@ -0,0 +1,143 @@
+#include "socketrxprobe.h"
+#include <chrono>
+#include <cstring>
+
+#ifdef __linux__
+#include <cerrno>
+#include <ctime>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#endif
+
+namespace {
+uint64_t SteadyNowNs()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::steady_clock::now().time_since_epoch())
+                                     .count());
+}
+}
+
+SocketRxProbe::SocketRxProbe()
+    : m_socketDescriptor(-1)
+    , m_bActive(false)
+    , m_lastDropCounter(0)
+    , m_effectiveReceiveBuffer(0)
+{
+}
+
+int64_t SocketRxProbe::RealtimeNowNs()
+{
+    return static_cast<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                    std::chrono::system_clock::now().time_since_epoch())
+                                    .count());
+}
+
+bool SocketRxProbe::Attach(intptr_t socketDescriptor, int receiveBufferBytes)
+{
+    Detach();
+    m_socketDescriptor = socketDescriptor;
+
+#ifdef __linux__
+    int fd = static_cast<int>(socketDescriptor);
+
+    if (receiveBufferBytes > 0) {
+        // SO_RCVBUFFORCE 需要 CAP_NET_ADMIN，失败时退回受 rmem_max 限制的 SO_RCVBUF
+        if (setsockopt(fd, SOL_SOCKET, SO_RCVBUFFORCE, &receiveBufferBytes, sizeof(receiveBufferBytes)) != 0) {
+            setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &receiveBufferBytes, sizeof(receiveBufferBytes));
+        }
+    }
+    int actual = 0;
+    socklen_t actualLength = sizeof(actual);
+    if (getsockopt(fd, SOL_SOCKET, SO_RCVBUF, &actual, &actualLength) == 0) {
+        m_effectiveReceiveBuffer = actual;
+    }
+
+    int enable = 1;
+    if (setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof(enable)) != 0) {
+        m_lastError = std::string("SO_TIMESTAMPNS: ") + std::strerror(errno);
+        return false;
+    }
+    if (setsockopt(fd, SOL_SOCKET, SO_RXQ_OVFL, &enable, sizeof(enable)) != 0) {
+        m_lastError = std::string("SO_RXQ_OVFL: ") + std::strerror(errno);
+        return false;
+    }
+
+    m_bActive = true;
+    return true;
+#else
+    (void)receiveBufferBytes;
+    m_lastError = "kernel receive timestamps are only supported on Linux";
+    return false;
+#endif
+}
+
+void SocketRxProbe::Detach()
+{
+    m_socketDescriptor = -1;
+    m_bActive = false;
+    m_lastDropCounter = 0;
+    m_effectiveReceiveBuffer = 0;
+    m_lastError.clear();
+}
+
+SocketRxInfo SocketRxProbe::PeekNext()
+{
+    SocketRxInfo info;
+    info.hasKernelTimestamp = false;
+    info.realtimeNs = 0;
+    info.steadyNs = 0;
+    info.newDrops = 0;
+
+#ifdef __linux__
+    if (m_bActive) {
+        // 只需要控制消息，数据读 1 字节即可（超出部分被截断，不影响队列中的数据报）
+        char byte;
+        struct iovec iov;
+        iov.iov_base = &byte;
+        iov.iov_len = sizeof(byte);
+
+        alignas(struct cmsghdr) char control[CMSG_SPACE(sizeof(struct timespec)) + CMSG_SPACE(sizeof(uint32_t))];
+        struct msghdr msg;
+        std::memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        if (recvmsg(static_cast<int>(m_socketDescriptor), &msg, MSG_PEEK | MSG_DONTWAIT) >= 0) {
+            for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+                if (cmsg->cmsg_level != SOL_SOCKET) {
+                    continue;
+                }
+                if (cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+                    struct timespec ts;
+                    std::memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+                    info.realtimeNs = static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+                    info.hasKernelTimestamp = true;
+                } else if (cmsg->cmsg_type == SO_RXQ_OVFL) {
+                    // 内核累计丢弃计数（无丢包时不携带该控制消息）
+                    uint32_t dropCounter;
+                    std::memcpy(&dropCounter, CMSG_DATA(cmsg), sizeof(dropCounter));
+                    info.newDrops = dropCounter - m_lastDropCounter;
+                    m_lastDropCounter = dropCounter;
+                }
+            }
+        }
+    }
+#endif
+
+    uint64_t steadyNow = SteadyNowNs();
+    if (info.hasKernelTimestamp) {
+        // 把内核的实时时钟时间换算到单调时钟：steadyNow - (realtimeNow - kernelTs)
+        int64_t age = RealtimeNowNs() - info.realtimeNs;
+        if (age < 0) {
+            age = 0;
+        }
+        info.steadyNs = static_cast<uint64_t>(age) < steadyNow ? steadyNow - static_cast<uint64_t>(age) : steadyNow;
+    } else {
+        info.realtimeNs = RealtimeNowNs();
+        info.steadyNs = steadyNow;
+    }
+    return info;
+}
@@ -0,0 +1,47 @@
+#ifndef SOCKETRXPROBE_H
+#define SOCKETRXPROBE_H
+
+#include <cstdint>
+#include <string>
+
+// 单个数据报的内核接收信息
+struct SocketRxInfo {
+    bool hasKernelTimestamp;   // 是否取到了内核时间戳
+    int64_t realtimeNs;        // 到达时间 (CLOCK_REALTIME 纳秒)，用于日志
+    uint64_t steadyNs;         // 到达时间换算到 steady_clock（纳秒），用于延迟统计
+    uint32_t newDrops;         // 自上一个数据报以来内核丢弃的数据报数（随下一个入队的数据报上报）
+};
+
+// UDP 接收 socket 的内核时间戳与丢包探针
+// Linux 下在 socket 上开启 SO_TIMESTAMPNS / SO_RXQ_OVFL 并调大 SO_RCVBUF，
+// 每个数据报读取前先用 MSG_PEEK 取出控制消息，数据本身仍由 QUdpSocket 读取，
+// 这样不会打乱 Qt 的读通知状态。其他平台退化为用户态时间，不统计丢包。
+class SocketRxProbe
+{
+public:
+    SocketRxProbe();
+
+    // 在已绑定的 socket 上开启探针，receiveBufferBytes <= 0 时不修改接收缓冲区
+    bool Attach(intptr_t socketDescriptor, int receiveBufferBytes);
+    void Detach();
+
+    bool IsActive() const { return m_bActive; }
+    // 内核实际分配的接收缓冲区大小（字节），未知时为 0
+    int EffectiveReceiveBuffer() const { return m_effectiveReceiveBuffer; }
+    const std::string &LastError() const { return m_lastError; }
+
+    // 队首数据报的接收信息，须在读取该数据报之前调用
+    SocketRxInfo PeekNext();
+
+    // 当前时间（CLOCK_REALTIME 纳秒）
+    static int64_t RealtimeNowNs();
+
+private:
+    intptr_t m_socketDescriptor;
+    bool m_bActive;
+    uint32_t m_lastDropCounter;
+    int m_effectiveReceiveBuffer;
+    std::string m_lastError;
+};
+
+#endif // SOCKETRXPROBE_H
@@ -0,0 +1,357 @@
+#include "testsequence.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <algorithm>
+
+#include "protocol/messages/Backend2Master.h"
+#include "protocol/messages/Master2Backend.h"
+
+namespace {
+constexpr int DEFAULT_WAIT_DATA_TIMEOUT_MS = 10000;
+
+bool ParseStep(const QJsonObject &object, const QList<SlaveConfigData> &slaveConfigs,
+               TestStep &step, QString &error)
+{
+    using namespace WhtsProtocol::Backend2Master;
+    QString type = object["type"].toString();
+    step.options.timeoutMs = object["timeoutMs"].toInt(step.options.timeoutMs);
+    step.options.retries = object["retries"].toInt(step.options.retries);
+    step.expectStatus = object["expectStatus"].toInt(0);
+
+    if (type == "mode") {
+        auto message = std::make_shared<ModeConfigMessage>();
+        message->mode = static_cast<uint8_t>(object["mode"].toInt());
+        step.type = TestStep::Type::ModeConfig;
+        step.description = QString("模式配置 (mode=%1)").arg(message->mode);
+        step.message = message;
+    } else if (type == "slaveConfig") {
+        auto message = std::make_shared<SlaveConfigMessage>();
+        if (object.contains("config")) {
+            // 引用已保存的从机配置
+            QString name = object["config"].toString();
+            auto it = std::find_if(slaveConfigs.begin(), slaveConfigs.end(),
+                                   [&name](const SlaveConfigData &data) { return data.name == name; });
+            if (it == slaveConfigs.end()) {
+                error = QString("未找到从机配置 \"%1\"").arg(name);
+                return false;
+            }
+            *message = it->config;
+            step.description = QString("从机配置 \"%1\"").arg(name);
+        } else {
+            for (const auto &value : object["slaves"].toArray()) {
+                QJsonObject slaveObj = value.toObject();
+                SlaveConfigMessage::SlaveInfo slave;
+                slave.id = static_cast<uint32_t>(slaveObj["id"].toInteger());
+                slave.conductionNum = static_cast<uint8_t>(slaveObj["conductionNum"].toInt());
+                slave.resistanceNum = static_cast<uint8_t>(slaveObj["resistanceNum"].toInt());
+                slave.clipMode = static_cast<uint8_t>(slaveObj["clipMode"].toInt());
+                slave.clipStatus = static_cast<uint16_t>(slaveObj["clipStatus"].toInt());
+                message->slaves.push_back(slave);
+            }
+            message->slaveNum = static_cast<uint8_t>(message->slaves.size());
+            step.description = QString("从机配置 (%1 个从机)").arg(message->slaveNum);
+        }
+        step.type = TestStep::Type::SlaveConfig;
+        step.message = message;
+    } else if (type == "interval") {
+        auto message = std::make_shared<IntervalConfigMessage>();
+        message->intervalMs = static_cast<uint8_t>(object["intervalMs"].toInt());
+        step.type = TestStep::Type::IntervalConfig;
+        step.description = QString("采集间隔 %1 ms").arg(message->intervalMs);
+        step.message = message;
+    } else if (type == "ctrl") {
+        auto message = std::make_shared<CtrlMessage>();
+        message->runningStatus = static_cast<uint8_t>(object["running"].toInt());
+        step.type = TestStep::Type::Ctrl;
+        step.description = message->runningStatus ? "启动采集" : "停止采集";
+        step.message = message;
+    } else if (type == "reset") {
+        auto message = std::make_shared<RstMessage>();
+        for (const auto &value : object["slaves"].toArray()) {
+            QJsonObject slaveObj = value.toObject();
+            RstMessage::SlaveRstInfo slave;
+            slave.id = static_cast<uint32_t>(slaveObj["id"].toInteger());
+            slave.lock = static_cast<uint8_t>(slaveObj["lock"].toInt());
+            slave.clipStatus = static_cast<uint16_t>(slaveObj["clipStatus"].toInt());
+            message->slaves.push_back(slave);
+        }
+        message->slaveNum = static_cast<uint8_t>(message->slaves.size());
+        step.type = TestStep::Type::Reset;
+        step.description = QString("复位 (%1 个从机)").arg(message->slaveNum);
+        step.message = message;
+    } else if (type == "wait") {
+        step.type = TestStep::Type::Wait;
+        step.durationMs = object["ms"].toInt();
+        step.description = QString("等待 %1 ms").arg(step.durationMs);
+    } else if (type == "waitData") {
+        step.type = TestStep::Type::WaitData;
+        step.samples = static_cast<uint32_t>(object["samples"].toInt(1));
+        step.durationMs = object["timeoutMs"].toInt(DEFAULT_WAIT_DATA_TIMEOUT_MS);
+        step.slaveId = object.contains("slaveId") ? object["slaveId"].toInteger() : -1;
+        step.description = step.slaveId >= 0
+            ? QString("等待从机 0x%1 的 %2 个导通采样")
+                  .arg(static_cast<uint32_t>(step.slaveId), 8, 16, QChar('0')).arg(step.samples)
+            : QString("等待 %1 个导通采样").arg(step.samples);
+    } else {
+        error = QString("未知的步骤类型 \"%1\"").arg(type);
+        return false;
+    }
+
+    if (object.contains("description")) {
+        step.description = object["description"].toString();
+    }
+    return true;
+}
+
+bool ParseSteps(const QJsonArray &array, const QList<SlaveConfigData> &slaveConfigs,
+                std::vector<TestStep> &steps, QString &error)
+{
+    steps.clear();
+    for (int i = 0; i < array.size(); ++i) {
+        TestStep step;
+        if (!ParseStep(array[i].toObject(), slaveConfigs, step, error)) {
+            error = QString("第 %1 步: %2").arg(i + 1).arg(error);
+            return false;
+        }
+        steps.push_back(std::move(step));
+    }
+    return true;
+}
+}
+
+bool TestPlan::FromJson(const QByteArray &json, const QList<SlaveConfigData> &slaveConfigs,
+                        TestPlan &plan, QString &error)
+{
+    QJsonParseError parseError;
+    QJsonDocument doc = QJsonDocument::fromJson(json, &parseError);
+    if (parseError.error != QJsonParseError::NoError || !doc.isObject()) {
+        error = QString("JSON 解析失败: %1").arg(parseError.errorString());
+        return false;
+    }
+
+    QJsonObject root = doc.object();
+    plan.name = root["name"].toString("未命名计划");
+    if (!ParseSteps(root["steps"].toArray(), slaveConfigs, plan.steps, error)) {
+        return false;
+    }
+    QString cleanupError;
+    if (!ParseSteps(root["cleanup"].toArray(), slaveConfigs, plan.cleanup, cleanupError)) {
+        error = QString("收尾%1").arg(cleanupError);
+        return false;
+    }
+    if (plan.steps.empty()) {
+        error = "计划中没有步骤";
+        return false;
+    }
+    return true;
+}
+
+TestSequenceEngine::TestSequenceEngine(CommandEngine *pCommandEngine, QObject *parent)
+    : QObject(parent)
+    , m_pCommandEngine(pCommandEngine)
+    , m_pWaitTimer(new QTimer(this))
+    , m_bRunning(false)
+    , m_bInCleanup(false)
+    , m_bPassed(false)
+    , m_stepIndex(0)
+    , m_stepToken(0)
+    , m_samplesSeen(0)
+    , m_bAcquisitionStarted(false)
+{
+    m_pWaitTimer->setSingleShot(true);
+    connect(m_pWaitTimer, &QTimer::timeout, this, &TestSequenceEngine::OnWaitTimeout);
+}
+
+bool TestSequenceEngine::Start(const TestPlan &plan)
+{
+    if (m_bRunning || plan.steps.empty()) {
+        return false;
+    }
+    m_plan = plan;
+    m_bRunning = true;
+    m_bInCleanup = false;
+    m_bPassed = true;
+    m_failure.clear();
+    m_stepIndex = 0;
+    m_bAcquisitionStarted = false;
+    m_planTimer.start();
+    RunCurrentStep();
+    return true;
+}
+
+void TestSequenceEngine::Abort()
+{
+    if (!m_bRunning) {
+        return;
+    }
+    if (m_bInCleanup) {
+        // 收尾中再次中止则直接结束
+        m_pWaitTimer->stop();
+        ++m_stepToken;
+        m_pCommandEngine->Cancel(this);
+        Finish();
+        return;
+    }
+    CompleteStep(false, "已中止");
+}
+
+void TestSequenceEngine::OnConductionSamples(uint32_t slaveId, uint32_t samples)
+{
+    if (!m_bRunning || CurrentStep().type != TestStep::Type::WaitData) {
+        return;
+    }
+    const TestStep &step = CurrentStep();
+    if (step.slaveId >= 0 && static_cast<uint32_t>(step.slaveId) != slaveId) {
+        return;
+    }
+    m_samplesSeen += samples;
+    if (m_samplesSeen >= step.samples) {
+        m_pWaitTimer->stop();
+        CompleteStep(true, QString("收到 %1 个采样").arg(m_samplesSeen));
+    }
+}
+
+const TestStep &TestSequenceEngine::CurrentStep() const
+{
+    return m_bInCleanup ? m_plan.cleanup[m_stepIndex] : m_plan.steps[m_stepIndex];
+}
+
+void TestSequenceEngine::RunCurrentStep()
+{
+    const std::vector<TestStep> &steps = m_bInCleanup ? m_plan.cleanup : m_plan.steps;
+    if (m_stepIndex >= steps.size()) {
+        if (!m_bPassed && !m_bInCleanup && !m_plan.cleanup.empty()) {
+            m_bInCleanup = true;
+            m_stepIndex = 0;
+            RunCurrentStep();
+            return;
+        }
+        Finish();
+        return;
+    }
+
+    const TestStep &step = steps[m_stepIndex];
+    uint64_t token = ++m_stepToken;
+    m_stepTimer.start();
+    emit StepStarted(static_cast<int>(m_stepIndex), m_bInCleanup, step.description);
+
+    switch (step.type) {
+    case TestStep::Type::Wait:
+        m_pWaitTimer->start(step.durationMs);
+        break;
+    case TestStep::Type::WaitData:
+        m_samplesSeen = 0;
+        m_pWaitTimer->start(step.durationMs);
+        break;
+    default: {
+        int expectStatus = step.expectStatus;
+        // ctrl 步骤: -1 表示非采集控制; 启动命令在发出时即记录, 应答超时也需要补发停止
+        int running = -1;
+        if (step.type == TestStep::Type::Ctrl) {
+            running = static_cast<const WhtsProtocol::Backend2Master::CtrlMessage &>(*step.message).runningStatus != 0;
+            if (running) {
+                m_bAcquisitionStarted = true;
+            }
+        }
+        m_pCommandEngine->Send(step.message, step.options, this)
+            .then(this, [this, token, expectStatus, running](const CommandResult &result) {
+                if (token != m_stepToken) {
+                    return;
+                }
+                if (!result.Ok()) {
+                    QString reason = "发送失败";
+                    if (result.status == CommandResult::Status::Timeout) {
+                        reason = QString("应答超时 (发送 %1 次)").arg(result.attempts);
+                    } else if (result.status == CommandResult::Status::Cancelled) {
+                        reason = "已取消";
+                    }
+                    CompleteStep(false, reason);
+                    return;
+                }
+                int status = ResponseStatus(*result.response);
+                QString detail = QString("status=%1, %2 ms").arg(status).arg(result.latencyNs / 1000000.0, 0, 'f', 1);
+                bool ok = expectStatus < 0 || status == expectStatus;
+                if (ok && running >= 0) {
+                    if (!running) {
+                        m_bAcquisitionStarted = false;
+                    }
+                    emit AcquisitionChanged(running != 0);
+                }
+                CompleteStep(ok, detail);
+            });
+        break;
+    }
+    }
+}
+
+void TestSequenceEngine::OnWaitTimeout()
+{
+    if (!m_bRunning) {
+        return;
+    }
+    if (CurrentStep().type == TestStep::Type::WaitData) {
+        CompleteStep(false, QString("超时, 只收到 %1/%2 个采样").arg(m_samplesSeen).arg(CurrentStep().samples));
+    } else {
+        CompleteStep(true, QString());
+    }
+}
+
+void TestSequenceEngine::CompleteStep(bool ok, const QString &detail)
+{
+    ++m_stepToken;
+    m_pWaitTimer->stop();
+    if (!ok) {
+        // 中止或失败时撤回本步骤仍在重发的命令，避免与收尾命令交错
+        m_pCommandEngine->Cancel(this);
+    }
+    emit StepFinished(static_cast<int>(m_stepIndex), m_bInCleanup, ok, detail, m_stepTimer.elapsed());
+
+    if (!ok && !m_bInCleanup) {
+        m_bPassed = false;
+        m_failure = QString("第 %1 步 %2 失败: %3").arg(m_stepIndex + 1).arg(CurrentStep().description, detail);
+        // 跳过剩余步骤，转入收尾
+        m_stepIndex = m_plan.steps.size();
+    } else {
+        ++m_stepIndex;
+    }
+    RunCurrentStep();
+}
+
+void TestSequenceEngine::Finish()
+{
+    m_bRunning = false;
+    if (!m_bPassed && m_bAcquisitionStarted) {
+        // 收尾没有停止采集（或计划没有收尾），补发停止命令；不归属本引擎，不会被 Cancel 撤回
+        auto stop = std::make_shared<WhtsProtocol::Backend2Master::CtrlMessage>();
+        stop->runningStatus = 0;
+        m_pCommandEngine->Send(stop);
+        m_bAcquisitionStarted = false;
+        emit AcquisitionChanged(false);
+    }
+    QString summary = m_bPassed ? QString("\"%1\" 通过").arg(m_plan.name)
+                                : QString("\"%1\" 未通过: %2").arg(m_plan.name, m_failure);
+    emit Finished(m_bPassed, summary, m_planTimer.elapsed());
+}
+
+int TestSequenceEngine::ResponseStatus(const WhtsProtocol::Message &response)
+{
+    using namespace WhtsProtocol::Master2Backend;
+    if (auto message = dynamic_cast<const ModeConfigResponseMessage *>(&response)) {
+        return message->status;
+    }
+    if (auto message = dynamic_cast<const SlaveConfigResponseMessage *>(&response)) {
+        return message->status;
+    }
+    if (auto message = dynamic_cast<const IntervalConfigResponseMessage *>(&response)) {
+        return message->status;
+    }
+    if (auto message = dynamic_cast<const CtrlResponseMessage *>(&response)) {
+        return message->status;
+    }
+    if (auto message = dynamic_cast<const RstResponseMessage *>(&response)) {
+        return message->status;
+    }
+    return 0;
+}
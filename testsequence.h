@@ -0,0 +1,108 @@
+#ifndef TESTSEQUENCE_H
+#define TESTSEQUENCE_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "commandengine.h"
+#include "slaveconfigdialog.h"
+
+// 测试序列中的一步
+struct TestStep {
+    enum class Type {
+        ModeConfig,      // ModeConfigMessage，等待应答
+        SlaveConfig,     // SlaveConfigMessage，等待应答
+        IntervalConfig,  // IntervalConfigMessage，等待应答
+        Ctrl,            // CtrlMessage，等待应答
+        Reset,           // RstMessage，等待应答
+        Wait,            // 固定等待
+        WaitData         // 等待收到足够的导通采样
+    };
+
+    Type type = Type::Wait;
+    QString description;
+    // 命令步骤
+    std::shared_ptr<const WhtsProtocol::Message> message;
+    CommandEngine::Options options;
+    int expectStatus = 0;       // 应答 status 的期望值，-1 表示不检查
+    // Wait / WaitData
+    int durationMs = 0;         // Wait 的时长，WaitData 的超时
+    uint32_t samples = 0;       // WaitData 需要的导通采样数
+    int64_t slaveId = -1;       // WaitData 只统计该从机，-1 表示任意从机
+};
+
+// 测试计划，从 JSON 文件加载，格式见 readme
+struct TestPlan {
+    QString name;
+    std::vector<TestStep> steps;
+    // 失败或中止后执行的收尾步骤（如停止采集），其结果不影响判定
+    std::vector<TestStep> cleanup;
+
+    // slaveConfigs 用于按名称引用已保存的从机配置
+    static bool FromJson(const QByteArray &json, const QList<SlaveConfigData> &slaveConfigs,
+                         TestPlan &plan, QString &error);
+};
+
+// 测试序列引擎：按顺序异步执行计划中的步骤，命令经 CommandEngine 发送并等待应答，
+// 任一步骤失败即停止并执行收尾步骤。不阻塞界面线程。
+// 序列启动过采集时，失败或中止后若收尾没有停止采集，结束时补发停止命令
+class TestSequenceEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestSequenceEngine(CommandEngine *pCommandEngine, QObject *parent = nullptr);
+
+    bool Start(const TestPlan &plan);
+    void Abort();
+    bool IsRunning() const { return m_bRunning; }
+    // 当前步骤是否为等待应答中的该类型命令（应答先交给界面处理，再由命令层完成步骤）
+    bool IsAwaiting(TestStep::Type type) const { return m_bRunning && CurrentStep().type == type; }
+    const TestPlan &Plan() const { return m_plan; }
+
+    // 由 MainWindow 在收到导通数据时调用（批量帧按采样数计）
+    void OnConductionSamples(uint32_t slaveId, uint32_t samples = 1);
+
+signals:
+    // ctrl 步骤成功或结束时补发停止，MainWindow 据此同步采集状态
+    void AcquisitionChanged(bool running);
+    void StepStarted(int index, bool cleanup, const QString &description);
+    void StepFinished(int index, bool cleanup, bool ok, const QString &detail, qint64 elapsedMs);
+    void Finished(bool passed, const QString &summary, qint64 elapsedMs);
+
+private slots:
+    void OnWaitTimeout();
+
+private:
+    void RunCurrentStep();
+    void CompleteStep(bool ok, const QString &detail);
+    void Finish();
+    const TestStep &CurrentStep() const;
+    static int ResponseStatus(const WhtsProtocol::Message &response);
+
+private:
+    CommandEngine *m_pCommandEngine;
+    QTimer *m_pWaitTimer;
+    TestPlan m_plan;
+    bool m_bRunning;
+    bool m_bInCleanup;
+    bool m_bPassed;
+    QString m_failure;
+    size_t m_stepIndex;
+    // 每次步骤切换递增，丢弃已中止步骤迟到的命令结果
+    uint64_t m_stepToken;
+    QElapsedTimer m_planTimer;
+    QElapsedTimer m_stepTimer;
+    uint32_t m_samplesSeen;
+    // 已发出启动采集且尚未确认停止
+    bool m_bAcquisitionStarted;
+};
+
+#endif // TESTSEQUENCE_H
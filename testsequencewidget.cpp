@@ -0,0 +1,189 @@
+#include "testsequencewidget.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QColor>
+#include <QFile>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QMessageBox>
+
+namespace {
+enum StepColumn {
+    STEP_COLUMN_INDEX = 0,
+    STEP_COLUMN_DESCRIPTION,
+    STEP_COLUMN_RESULT,
+    STEP_COLUMN_ELAPSED,
+    STEP_COLUMN_DETAIL,
+    STEP_COLUMN_COUNT
+};
+}
+
+TestSequenceWidget::TestSequenceWidget(TestSequenceEngine *pEngine, const QList<SlaveConfigData> *pSlaveConfigs,
+                                       QWidget *parent)
+    : QWidget(parent)
+    , m_pEngine(pEngine)
+    , m_pSlaveConfigs(pSlaveConfigs)
+    , m_bPlanLoaded(false)
+    , m_pPushButtonLoad(nullptr)
+    , m_pPushButtonRun(nullptr)
+    , m_pPushButtonAbort(nullptr)
+    , m_pLabelPlan(nullptr)
+    , m_pLabelStatus(nullptr)
+    , m_pTableWidgetSteps(nullptr)
+{
+    InitializeUI();
+
+    connect(m_pEngine, &TestSequenceEngine::StepStarted, this, &TestSequenceWidget::OnStepStarted);
+    connect(m_pEngine, &TestSequenceEngine::StepFinished, this, &TestSequenceWidget::OnStepFinished);
+    connect(m_pEngine, &TestSequenceEngine::Finished, this, &TestSequenceWidget::OnFinished);
+
+    UpdateControls();
+}
+
+void TestSequenceWidget::InitializeUI()
+{
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+
+    QHBoxLayout *controlLayout = new QHBoxLayout();
+    m_pPushButtonLoad = new QPushButton("加载计划", this);
+    m_pPushButtonRun = new QPushButton("开始测试", this);
+    m_pPushButtonAbort = new QPushButton("中止", this);
+    m_pLabelPlan = new QLabel("未加载测试计划", this);
+    controlLayout->addWidget(m_pPushButtonLoad);
+    controlLayout->addWidget(m_pPushButtonRun);
+    controlLayout->addWidget(m_pPushButtonAbort);
+    controlLayout->addWidget(m_pLabelPlan, 1);
+    mainLayout->addLayout(controlLayout);
+
+    m_pTableWidgetSteps = new QTableWidget(0, STEP_COLUMN_COUNT, this);
+    m_pTableWidgetSteps->setHorizontalHeaderLabels({"步骤", "说明", "结果", "耗时(ms)", "详情"});
+    m_pTableWidgetSteps->verticalHeader()->setVisible(false);
+    m_pTableWidgetSteps->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_pTableWidgetSteps->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_pTableWidgetSteps->horizontalHeader()->setSectionResizeMode(STEP_COLUMN_DESCRIPTION, QHeaderView::Stretch);
+    m_pTableWidgetSteps->horizontalHeader()->setSectionResizeMode(STEP_COLUMN_DETAIL, QHeaderView::Stretch);
+    mainLayout->addWidget(m_pTableWidgetSteps);
+
+    m_pLabelStatus = new QLabel(this);
+    mainLayout->addWidget(m_pLabelStatus);
+
+    connect(m_pPushButtonLoad, &QPushButton::clicked, this, &TestSequenceWidget::OnLoadClicked);
+    connect(m_pPushButtonRun, &QPushButton::clicked, this, &TestSequenceWidget::OnRunClicked);
+    connect(m_pPushButtonAbort, &QPushButton::clicked, this, &TestSequenceWidget::OnAbortClicked);
+}
+
+void TestSequenceWidget::UpdateControls()
+{
+    bool running = m_pEngine->IsRunning();
+    m_pPushButtonLoad->setEnabled(!running);
+    m_pPushButtonRun->setEnabled(!running && m_bPlanLoaded);
+    m_pPushButtonAbort->setEnabled(running);
+}
+
+void TestSequenceWidget::OnLoadClicked()
+{
+    QString fileName = QFileDialog::getOpenFileName(this, "加载测试计划", m_planFileName, "JSON (*.json)");
+    if (fileName.isEmpty()) {
+        return;
+    }
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        QMessageBox::warning(this, "警告", QString("无法打开文件: %1").arg(fileName));
+        return;
+    }
+
+    TestPlan plan;
+    QString error;
+    if (!TestPlan::FromJson(file.readAll(), *m_pSlaveConfigs, plan, error)) {
+        QMessageBox::warning(this, "警告", QString("测试计划无效: %1").arg(error));
+        return;
+    }
+
+    m_plan = plan;
+    m_planFileName = fileName;
+    m_bPlanLoaded = true;
+    m_pLabelPlan->setText(QString("%1 (%2)").arg(m_plan.name, QFileInfo(fileName).fileName()));
+    m_pLabelStatus->clear();
+    PopulateSteps();
+    UpdateControls();
+}
+
+void TestSequenceWidget::OnRunClicked()
+{
+    // 重新加载一次，使计划引用的从机配置为最新
+    if (!m_planFileName.isEmpty()) {
+        QFile file(m_planFileName);
+        TestPlan plan;
+        QString error;
+        if (file.open(QIODevice::ReadOnly) && TestPlan::FromJson(file.readAll(), *m_pSlaveConfigs, plan, error)) {
+            m_plan = plan;
+        }
+    }
+
+    PopulateSteps();
+    if (m_pEngine->Start(m_plan)) {
+        m_pLabelStatus->setStyleSheet(QString());
+    }
+    UpdateControls();
+}
+
+void TestSequenceWidget::OnAbortClicked()
+{
+    m_pEngine->Abort();
+    UpdateControls();
+}
+
+void TestSequenceWidget::PopulateSteps()
+{
+    int total = static_cast<int>(m_plan.steps.size() + m_plan.cleanup.size());
+    m_pTableWidgetSteps->setRowCount(total);
+    for (int row = 0; row < total; ++row) {
+        bool cleanup = row >= static_cast<int>(m_plan.steps.size());
+        int index = cleanup ? row - static_cast<int>(m_plan.steps.size()) : row;
+        const TestStep &step = cleanup ? m_plan.cleanup[index] : m_plan.steps[index];
+        QString label = cleanup ? QString("收尾 %1").arg(index + 1) : QString::number(index + 1);
+        m_pTableWidgetSteps->setItem(row, STEP_COLUMN_INDEX, new QTableWidgetItem(label));
+        m_pTableWidgetSteps->setItem(row, STEP_COLUMN_DESCRIPTION, new QTableWidgetItem(step.description));
+        for (int column = STEP_COLUMN_RESULT; column < STEP_COLUMN_COUNT; ++column) {
+            m_pTableWidgetSteps->setItem(row, column, new QTableWidgetItem());
+        }
+    }
+}
+
+int TestSequenceWidget::RowFor(int index, bool cleanup) const
+{
+    return cleanup ? static_cast<int>(m_plan.steps.size()) + index : index;
+}
+
+void TestSequenceWidget::OnStepStarted(int index, bool cleanup, const QString &description)
+{
+    int row = RowFor(index, cleanup);
+    if (row >= m_pTableWidgetSteps->rowCount()) {
+        return;
+    }
+    m_pTableWidgetSteps->item(row, STEP_COLUMN_RESULT)->setText("执行中");
+    m_pTableWidgetSteps->scrollToItem(m_pTableWidgetSteps->item(row, STEP_COLUMN_INDEX));
+    m_pLabelStatus->setText(QString("正在执行: %1").arg(description));
+}
+
+void TestSequenceWidget::OnStepFinished(int index, bool cleanup, bool ok, const QString &detail, qint64 elapsedMs)
+{
+    int row = RowFor(index, cleanup);
+    if (row >= m_pTableWidgetSteps->rowCount()) {
+        return;
+    }
+    QTableWidgetItem *resultItem = m_pTableWidgetSteps->item(row, STEP_COLUMN_RESULT);
+    resultItem->setText(ok ? "通过" : "失败");
+    resultItem->setForeground(ok ? QColor(0, 160, 0) : QColor(220, 0, 0));
+    m_pTableWidgetSteps->item(row, STEP_COLUMN_ELAPSED)->setText(QString::number(elapsedMs));
+    m_pTableWidgetSteps->item(row, STEP_COLUMN_DETAIL)->setText(detail);
+}
+
+void TestSequenceWidget::OnFinished(bool passed, const QString &summary, qint64 elapsedMs)
+{
+    m_pLabelStatus->setText(QString("%1，总耗时 %2 ms").arg(summary).arg(elapsedMs));
+    m_pLabelStatus->setStyleSheet(passed ? "color: rgb(0, 160, 0);" : "color: rgb(220, 0, 0);");
+    UpdateControls();
+}
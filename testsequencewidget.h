@@ -0,0 +1,50 @@
+#ifndef TESTSEQUENCEWIDGET_H
+#define TESTSEQUENCEWIDGET_H
+
+#include <QWidget>
+#include <QTableWidget>
+#include <QPushButton>
+#include <QLabel>
+
+#include "testsequence.h"
+
+// 测试序列面板：加载测试计划文件，执行并逐步显示结果与耗时
+class TestSequenceWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    // pSlaveConfigs 为已保存的从机配置，计划中可按名称引用
+    TestSequenceWidget(TestSequenceEngine *pEngine, const QList<SlaveConfigData> *pSlaveConfigs,
+                       QWidget *parent = nullptr);
+
+private slots:
+    void OnLoadClicked();
+    void OnRunClicked();
+    void OnAbortClicked();
+    void OnStepStarted(int index, bool cleanup, const QString &description);
+    void OnStepFinished(int index, bool cleanup, bool ok, const QString &detail, qint64 elapsedMs);
+    void OnFinished(bool passed, const QString &summary, qint64 elapsedMs);
+
+private:
+    void InitializeUI();
+    void UpdateControls();
+    void PopulateSteps();
+    int RowFor(int index, bool cleanup) const;
+
+private:
+    TestSequenceEngine *m_pEngine;
+    const QList<SlaveConfigData> *m_pSlaveConfigs;
+    TestPlan m_plan;
+    QString m_planFileName;
+    bool m_bPlanLoaded;
+
+    QPushButton *m_pPushButtonLoad;
+    QPushButton *m_pPushButtonRun;
+    QPushButton *m_pPushButtonAbort;
+    QLabel *m_pLabelPlan;
+    QLabel *m_pLabelStatus;
+    QTableWidget *m_pTableWidgetSteps;
+};
+
+#endif // TESTSEQUENCEWIDGET_H